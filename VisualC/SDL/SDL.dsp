@@ -108,6 +108,18 @@ SOURCE=..\..\src\events\SDL_active.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\file\SDL_archive.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\atomic\SDL_atomic.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\atomic\SDL_atomic_c.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\audio\SDL_audio.c
 # End Source File
 # Begin Source File
@@ -160,6 +172,14 @@ SOURCE=..\..\src\cdrom\SDL_cdrom.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\stdlib\SDL_copyrows.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\stdlib\SDL_copyrows_c.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\cpuinfo\SDL_cpuinfo.c
 # End Source File
 # Begin Source File
@@ -244,6 +264,14 @@ SOURCE=..\..\src\video\windx5\SDL_dx5yuv_c.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\file\SDL_endian.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\file\SDL_endian_c.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\SDL_error.c
 # End Source File
 # Begin Source File
@@ -348,6 +376,10 @@ SOURCE=..\..\src\video\dummy\SDL_nullvideo.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\video\SDL_pacer.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\video\SDL_pixels.c
 # End Source File
 # Begin Source File
@@ -376,10 +408,22 @@ SOURCE=..\..\src\video\SDL_RLEaccel_c.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\file\SDL_rwasync.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\file\SDL_rwcompress.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\file\SDL_rwops.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\cpuinfo\SDL_simd.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\video\SDL_stretch.c
 # End Source File
 # Begin Source File
@@ -488,6 +532,10 @@ SOURCE=..\..\src\thread\SDL_thread_c.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\thread\SDL_threadpool.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\timer\SDL_timer.c
 # End Source File
 # Begin Source File
@@ -496,6 +544,14 @@ SOURCE=..\..\src\timer\SDL_timer_c.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\stdlib\SDL_utf8.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\stdlib\SDL_utf8_c.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\video\SDL_video.c
 # End Source File
 # Begin Source File
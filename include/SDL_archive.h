@@ -0,0 +1,100 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/** @file SDL_archive.h
+ *  Read-only archives of many files, for when opening each file on its
+ *  own costs too much.
+ *
+ *  An archive is opened once, and its directory is kept in memory as a
+ *  hash table, so finding a file in it doesn't touch the disk.  When the
+ *  archive is memory mapped, opening a file in it is just an allocation.
+ *  Compressed files are decompressed as they're read.
+ */
+
+#ifndef _SDL_archive_h
+#define _SDL_archive_h
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+#include "SDL_rwops.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** An open archive, defined in SDL_archive.c */
+struct SDL_Archive;
+typedef struct SDL_Archive SDL_Archive;
+
+/**
+ * Open an archive for reading.  If 'freesrc' is non-zero, 'src' is
+ * closed when the archive is, or right away on error.
+ *
+ * @return The archive, or NULL on error.
+ */
+extern DECLSPEC SDL_Archive * SDLCALL SDL_OpenArchive_RW(SDL_RWops *src, int freesrc);
+
+/** Convenience macro -- open an archive file */
+#define SDL_OpenArchive(file)	SDL_OpenArchive_RW(SDL_RWFromFileMapped(file), 1)
+
+/**
+ * Open a file in an archive.  The SDL_RWops is read-only, can be used
+ * from any thread, and must be closed before the archive is.
+ *
+ * @return The SDL_RWops, or NULL if the file isn't in the archive.
+ */
+extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromArchive(SDL_Archive *archive, const char *name);
+
+/** Get the number of files in an archive */
+extern DECLSPEC int SDLCALL SDL_GetArchiveSize(SDL_Archive *archive);
+
+/** Get the name of file 'index' in an archive, or NULL if out of range */
+extern DECLSPEC const char * SDLCALL SDL_GetArchiveName(SDL_Archive *archive, int index);
+
+/** Close an archive */
+extern DECLSPEC void SDLCALL SDL_CloseArchive(SDL_Archive *archive);
+
+/**
+ * Write an archive holding 'count' files.  'files' are the paths to
+ * read them from, and 'names' what they're called in the archive, or
+ * NULL to use the paths.  'method' is 0 to store the files as they are,
+ * or one of the SDL_COMPRESS_* methods in SDL_rwops.h to compress all
+ * but the smallest ones.  If 'freedst' is non-zero, 'dst' is closed when
+ * this returns.
+ *
+ * @return 0, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SaveArchive_RW(SDL_RWops *dst, int freedst, const char **files, const char **names, int count, int method);
+
+/** Convenience macro -- write an archive to a file */
+#define SDL_SaveArchive(file, files, names, count, method) \
+	SDL_SaveArchive_RW(SDL_RWFromFile(file, "wb"), 1, files, names, count, method)
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* _SDL_archive_h */
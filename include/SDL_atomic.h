@@ -0,0 +1,162 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+#ifndef _SDL_atomic_h
+#define _SDL_atomic_h
+
+/** @file SDL_atomic.h
+ *  Atomic operations, spinlocks and memory barriers
+ *
+ *  These use the compiler's atomic builtins where it has them.  Elsewhere
+ *  they are emulated with a lock, which is correct but a lot slower;
+ *  SDL_AtomicIsLockFree() tells you which one you got.
+ *
+ *  @note These are independent of the other SDL routines.
+ */
+
+#include "SDL_stdinc.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** An atomic integer, only touch it through the functions below */
+typedef struct SDL_atomic_t {
+	volatile int value;
+} SDL_atomic_t;
+
+/** A spinlock, 0 when it's unlocked */
+typedef int SDL_SpinLock;
+
+/**
+ * Memory ordering for the *Explicit functions, with the same meaning as
+ * in C11.  An ordering that doesn't apply to an operation, like acquire
+ * on a store, is strengthened to SDL_MEMORY_ORDER_SEQ_CST.
+ */
+typedef enum {
+	SDL_MEMORY_ORDER_RELAXED,
+	SDL_MEMORY_ORDER_ACQUIRE,
+	SDL_MEMORY_ORDER_RELEASE,
+	SDL_MEMORY_ORDER_ACQ_REL,
+	SDL_MEMORY_ORDER_SEQ_CST
+} SDL_MemoryOrder;
+
+/** Returns SDL_TRUE if the atomic operations don't take a lock */
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicIsLockFree(void);
+
+/** @name Atomic integers
+ *  SDL_AtomicSet() and SDL_AtomicAdd() return the previous value.
+ *  SDL_AtomicCAS() sets the value to 'newval' if it is 'oldval', and
+ *  returns SDL_TRUE if it did.  The plain versions are sequentially
+ *  consistent.
+ */
+/*@{*/
+extern DECLSPEC int SDLCALL SDL_AtomicGet(SDL_atomic_t *a);
+extern DECLSPEC int SDLCALL SDL_AtomicSet(SDL_atomic_t *a, int v);
+extern DECLSPEC int SDLCALL SDL_AtomicAdd(SDL_atomic_t *a, int v);
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicCAS(SDL_atomic_t *a, int oldval, int newval);
+
+extern DECLSPEC int SDLCALL SDL_AtomicGetExplicit(SDL_atomic_t *a, SDL_MemoryOrder order);
+extern DECLSPEC void SDLCALL SDL_AtomicSetExplicit(SDL_atomic_t *a, int v, SDL_MemoryOrder order);
+extern DECLSPEC int SDLCALL SDL_AtomicAddExplicit(SDL_atomic_t *a, int v, SDL_MemoryOrder order);
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicCASExplicit(SDL_atomic_t *a, int oldval, int newval, SDL_MemoryOrder order);
+
+/** Increment an atomic reference count */
+#define SDL_AtomicIncRef(a)	((void)SDL_AtomicAdd(a, 1))
+/** Decrement an atomic reference count, SDL_TRUE when it drops to 0 */
+#define SDL_AtomicDecRef(a)	(SDL_AtomicAdd(a, -1) == 1)
+/*@}*/
+
+/** @name Atomic pointers
+ *  The same operations on a pointer variable.
+ */
+/*@{*/
+extern DECLSPEC void * SDLCALL SDL_AtomicGetPtr(void **a);
+extern DECLSPEC void * SDLCALL SDL_AtomicSetPtr(void **a, void *v);
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicCASPtr(void **a, void *oldval, void *newval);
+
+extern DECLSPEC void * SDLCALL SDL_AtomicGetPtrExplicit(void **a, SDL_MemoryOrder order);
+extern DECLSPEC void SDLCALL SDL_AtomicSetPtrExplicit(void **a, void *v, SDL_MemoryOrder order);
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicCASPtrExplicit(void **a, void *oldval, void *newval, SDL_MemoryOrder order);
+/*@}*/
+
+/** @name Memory barriers
+ *  SDL_MemoryBarrier() is a full fence.  The acquire barrier keeps later
+ *  memory accesses from moving before it, the release barrier keeps
+ *  earlier ones from moving after it.  SDL_CompilerBarrier() only stops
+ *  the compiler from reordering.
+ */
+/*@{*/
+extern DECLSPEC void SDLCALL SDL_MemoryBarrier(void);
+extern DECLSPEC void SDLCALL SDL_MemoryBarrierAcquire(void);
+extern DECLSPEC void SDLCALL SDL_MemoryBarrierRelease(void);
+
+#if defined(__GNUC__)
+#define SDL_CompilerBarrier()	__asm__ __volatile__ ("" : : : "memory")
+#elif defined(_MSC_VER) && (_MSC_VER >= 1400)
+void _ReadWriteBarrier(void);
+#pragma intrinsic(_ReadWriteBarrier)
+#define SDL_CompilerBarrier()	_ReadWriteBarrier()
+#else
+#define SDL_CompilerBarrier()	SDL_MemoryBarrier()
+#endif
+/*@}*/
+
+/** @name Spinlocks
+ *  SDL_AtomicLock() spins with exponential backoff, and starts yielding
+ *  the CPU once the lock has been held for a while.  Only hold spinlocks
+ *  for a few instructions, use a mutex for anything longer.
+ */
+/*@{*/
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicTryLock(SDL_SpinLock *lock);
+extern DECLSPEC void SDLCALL SDL_AtomicLock(SDL_SpinLock *lock);
+extern DECLSPEC void SDLCALL SDL_AtomicUnlock(SDL_SpinLock *lock);
+/*@}*/
+
+/* With gcc 4.7+ or clang the common operations are inlined, the library
+   still has real functions for them.  Define SDL_ATOMIC_NOINLINE before
+   including this header to always call those instead.
+ */
+#if defined(__ATOMIC_SEQ_CST) && defined(__GCC_ATOMIC_INT_LOCK_FREE) && \
+    (__GCC_ATOMIC_INT_LOCK_FREE == 2) && (__GCC_ATOMIC_POINTER_LOCK_FREE == 2) && \
+    !defined(SDL_ATOMIC_NOINLINE)
+#define SDL_AtomicGet(a)	__atomic_load_n(&(a)->value, __ATOMIC_SEQ_CST)
+#define SDL_AtomicSet(a, v)	__atomic_exchange_n(&(a)->value, v, __ATOMIC_SEQ_CST)
+#define SDL_AtomicAdd(a, v)	__atomic_fetch_add(&(a)->value, v, __ATOMIC_SEQ_CST)
+#define SDL_AtomicCAS(a, o, n)	\
+	((SDL_bool)__sync_bool_compare_and_swap(&(a)->value, o, n))
+#define SDL_AtomicGetPtr(a)	__atomic_load_n(a, __ATOMIC_SEQ_CST)
+#define SDL_AtomicSetPtr(a, v)	__atomic_exchange_n(a, v, __ATOMIC_SEQ_CST)
+#define SDL_AtomicCASPtr(a, o, n)	\
+	((SDL_bool)__sync_bool_compare_and_swap(a, o, n))
+#define SDL_MemoryBarrier()	__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* _SDL_atomic_h */
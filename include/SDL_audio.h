@@ -210,7 +210,10 @@ extern DECLSPEC void SDLCALL SDL_PauseAudio(int pause_on);
  *
  * This function returns NULL and sets the SDL error message if the 
  * wave file cannot be opened, uses an unknown data format, or is 
- * corrupt.  Currently raw and MS-ADPCM WAVE files are supported.
+ * corrupt.  Currently raw PCM (8, 16, 24 and 32-bit, and floating point),
+ * MS-ADPCM and IMA-ADPCM WAVE files are supported, including files using
+ * WAVE_FORMAT_EXTENSIBLE.  Anything wider than 16 bits is converted to
+ * AUDIO_S16.
  */
 extern DECLSPEC SDL_AudioSpec * SDLCALL SDL_LoadWAV_RW(SDL_RWops *src, int freesrc, SDL_AudioSpec *spec, Uint8 **audio_buf, Uint32 *audio_len);
 
@@ -223,6 +226,39 @@ extern DECLSPEC SDL_AudioSpec * SDLCALL SDL_LoadWAV_RW(SDL_RWops *src, int frees
  */
 extern DECLSPEC void SDLCALL SDL_FreeWAV(Uint8 *audio_buf);
 
+/** An incrementally decoded WAVE file */
+typedef struct SDL_WAVStream SDL_WAVStream;
+
+/**
+ * This function reads the header of a WAVE from the data source and
+ * prepares to decode the audio data on demand, instead of loading it
+ * all into memory like SDL_LoadWAV_RW().  The data source is freed with
+ * the stream if 'freesrc' is non-zero, and 'spec' is filled in with the
+ * format SDL_ReadWAVStream() will produce.
+ *
+ * @return The new stream, or NULL with the SDL error message set.
+ */
+extern DECLSPEC SDL_WAVStream * SDLCALL SDL_OpenWAVStream_RW(SDL_RWops *src, int freesrc, SDL_AudioSpec *spec);
+
+/** Convenience function -- opens a WAV file for streaming */
+#define SDL_OpenWAVStream(file, spec) \
+	SDL_OpenWAVStream_RW(SDL_RWFromFile(file, "rb"),1, spec)
+
+/**
+ * Decode up to 'len' bytes of audio data into 'buf'.
+ * Whole ADPCM blocks are decoded straight into the buffer.
+ *
+ * @return The number of bytes decoded, 0 at the end of the data,
+ *         or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_ReadWAVStream(SDL_WAVStream *stream, Uint8 *buf, Uint32 len);
+
+/** Go back to the start of the audio data, returns 0, or -1 on error */
+extern DECLSPEC int SDLCALL SDL_RewindWAVStream(SDL_WAVStream *stream);
+
+/** Close the stream, and its data source if it was opened with 'freesrc' */
+extern DECLSPEC void SDLCALL SDL_CloseWAVStream(SDL_WAVStream *stream);
+
 /**
  * This function takes a source format and rate and a destination format
  * and rate, and initializes the 'cvt' structure with information needed
@@ -269,6 +305,47 @@ extern DECLSPEC void SDLCALL SDL_LockAudio(void);
 extern DECLSPEC void SDLCALL SDL_UnlockAudio(void);
 /*@}*/
 
+/**
+ * This function fills 'frames' and 'ms' with the amount of audio that has
+ * been handed to the audio device but not yet played, i.e. the current
+ * output latency.  Either pointer may be NULL.
+ *
+ * @return This function returns 0, or -1 if the audio device isn't open
+ *         or the audio driver can't report its latency.
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioLatency(int *frames, int *ms);
+
+/**
+ * This function returns the clock the audio device plays by, in
+ * milliseconds.  This is SDL_GetTicks(), unless the audio driver keeps
+ * its own clock, like the disk driver does when SDL_DISKAUDIOCLOCK=1 is
+ * set.  It only makes sense to compare the values it returns with each
+ * other.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetAudioTicks(void);
+
+/** Audio thread statistics, filled in by SDL_GetAudioStats() */
+typedef struct SDL_AudioStats {
+	Uint32 callbacks;	/**< Number of times the audio callback was run */
+	Uint32 callback_min;	/**< Shortest callback run, in microseconds */
+	Uint32 callback_avg;	/**< Average callback run, in microseconds */
+	Uint32 callback_max;	/**< Longest callback run, in microseconds */
+	Uint32 xruns;		/**< Underruns recovered by the audio driver */
+	Uint32 fake_streams;	/**< Buffers mixed while the device was busy */
+} SDL_AudioStats;
+
+/**
+ * This function fills 'stats' with the audio thread statistics gathered
+ * since the audio device was opened, or since the last call to
+ * SDL_ResetAudioStats().
+ *
+ * @return This function returns 0, or -1 if the audio device isn't open.
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioStats(SDL_AudioStats *stats);
+
+/** This function clears the audio thread statistics */
+extern DECLSPEC void SDLCALL SDL_ResetAudioStats(void);
+
 /**
  * This function shuts down audio processing and closes the audio device.
  */
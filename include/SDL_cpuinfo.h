@@ -57,9 +57,27 @@ extern DECLSPEC SDL_bool SDLCALL SDL_HasSSE(void);
 /** This function returns true if the CPU has SSE2 features */
 extern DECLSPEC SDL_bool SDLCALL SDL_HasSSE2(void);
 
+/** This function returns true if the CPU has SSSE3 features */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasSSSE3(void);
+
+/** This function returns true if the CPU and OS support AVX2 */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasAVX2(void);
+
 /** This function returns true if the CPU has AltiVec features */
 extern DECLSPEC SDL_bool SDLCALL SDL_HasAltiVec(void);
 
+/**
+ * This function returns the number of CPUs this process can run on,
+ * which is at least 1.
+ */
+extern DECLSPEC int SDLCALL SDL_GetCPUCount(void);
+
+/**
+ * This function returns the size in bytes of the largest CPU data cache,
+ * or 0 if it isn't known.
+ */
+extern DECLSPEC int SDLCALL SDL_GetCPUCacheSize(void);
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
@@ -289,12 +289,38 @@ extern DECLSPEC int SDLCALL SDL_PollEvent(SDL_Event *event);
  */
 extern DECLSPEC int SDLCALL SDL_WaitEvent(SDL_Event *event);
 
+/** Waits until the specified timeout (in milliseconds) for the next available
+ *  event, returning 1, or 0 if the timeout elapsed or there was an error while
+ *  waiting for events.  A timeout of -1 waits indefinitely.  If 'event' is not
+ *  NULL, the next event is removed from the queue and stored in that area.
+ */
+extern DECLSPEC int SDLCALL SDL_WaitEventTimeout(SDL_Event *event, int timeout);
+
 /** Add an event to the event queue.
  *  This function returns 0 on success, or -1 if the event queue was full
  *  or there was some other error.
+ *  The queue grows as needed, and can be added to from any thread without
+ *  waiting on readers.
  */
 extern DECLSPEC int SDLCALL SDL_PushEvent(SDL_Event *event);
 
+/** Event queue statistics */
+typedef struct SDL_EventQueueStats {
+	Uint32 queued;		/**< Events currently in the queue */
+	Uint32 high_water;	/**< Most events queued at once */
+	Uint32 dropped;		/**< Events lost because the queue was full */
+	Uint32 thread_wakeups;	/**< Times the event thread woke up */
+	float thread_wakeups_per_sec;	/**< Average rate of those wakeups */
+} SDL_EventQueueStats;
+
+/** Fill in 'stats' with the event queue statistics since the event loop
+ *  was started, or since they were last reset.
+ */
+extern DECLSPEC void SDLCALL SDL_GetEventQueueStats(SDL_EventQueueStats *stats);
+
+/** Clear the drop counter and set the high water mark to the current size */
+extern DECLSPEC void SDLCALL SDL_ResetEventQueueStats(void);
+
 /** @name Event Filtering */
 /*@{*/
 typedef int (SDLCALL *SDL_EventFilter)(const SDL_Event *event);
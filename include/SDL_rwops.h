@@ -98,6 +98,18 @@ typedef struct SDL_RWops {
 
 extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromFile(const char *file, const char *mode);
 
+/**
+ * Open a file for reading.  Where the system supports it, a regular file
+ * is memory mapped, or read into memory if it's small, which makes reading
+ * it cheaper and lets SDL_RWmap() get at its contents.  Otherwise this is
+ * the same as SDL_RWFromFile(file, "rb").
+ *
+ * A mapped file must not be truncated while it's open, reading the part
+ * that's gone crashes the program, and data added to the end later isn't
+ * seen.
+ */
+extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromFileMapped(const char *file);
+
 #ifdef HAVE_STDIO_H
 extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromFP(FILE *fp, int autoclose);
 #endif
@@ -126,6 +138,82 @@ extern DECLSPEC void SDLCALL SDL_FreeRW(SDL_RWops *area);
 #define SDL_RWclose(ctx)		(ctx)->close(ctx)
 /*@}*/
 
+#ifdef SDL_HAS_64BIT_TYPE
+/** @name 64-bit offsets
+ *  The seek function in SDL_RWops only handles offsets up to 2 GB.  These
+ *  work with larger files for the SDL_RWops made by SDL itself, and with
+ *  offsets that fit in an int for any other SDL_RWops.
+ */
+/*@{*/
+/** Like SDL_RWseek(), returns the new offset, or -1 on error */
+extern DECLSPEC Sint64 SDLCALL SDL_RWseek64(SDL_RWops *context, Sint64 offset, int whence);
+#define SDL_RWtell64(ctx)		SDL_RWseek64(ctx, 0, RW_SEEK_CUR)
+
+/** Returns the total size of the data source, or -1 on error */
+extern DECLSPEC Sint64 SDLCALL SDL_RWsize(SDL_RWops *context);
+/*@}*/
+#endif /* SDL_HAS_64BIT_TYPE */
+
+/**
+ * Get a pointer to the data at the current position, for SDL_RWops that
+ * are memory or memory mapped files, so it can be used without copying.
+ * 'size' is set to the number of bytes from there to the end.  It doesn't
+ * move the current position, seek past what you use.  The pointer is
+ * valid until the SDL_RWops is closed, and must not be written to.
+ *
+ * @return NULL if the SDL_RWops isn't in memory, use SDL_RWread() then.
+ */
+extern DECLSPEC const void * SDLCALL SDL_RWmap(SDL_RWops *context, size_t *size);
+
+/** @name Read-ahead
+ *  An SDL_RWops that reads 'src' sequentially on a background thread into
+ *  'nbufs' buffers of 'bufsize' bytes, so reads rarely have to wait for
+ *  the disk.  Seeks outside the buffered data throw it away and start
+ *  reading again from there.  It's read-only, and closing it closes
+ *  'src', which must not be used directly in the meantime.  0 picks the
+ *  default for either size.
+ */
+/*@{*/
+extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromRWAsync(SDL_RWops *src, int bufsize, int nbufs);
+
+typedef struct SDL_RWAsyncStats {
+	Uint32 reads;		/**< Calls to read */
+	Uint32 hits;		/**< Reads that found all their data buffered */
+	Uint32 stalls;		/**< Reads that had to wait for data */
+	Uint32 stall_us;	/**< Microseconds spent waiting, wraps around */
+	Uint32 seeks;		/**< Seeks that threw the buffered data away */
+	Uint32 fills;		/**< Buffers read from the source */
+} SDL_RWAsyncStats;
+
+/** Get the statistics of a read-ahead SDL_RWops, returns 0 or -1 */
+extern DECLSPEC int SDLCALL SDL_GetRWAsyncStats(SDL_RWops *context, SDL_RWAsyncStats *stats);
+/*@}*/
+
+/** @name Compressed data
+ *  Data is compressed in blocks, 64 KB by default, with a table of where
+ *  each block starts.  Reading decompresses one block at a time, so the
+ *  memory used doesn't depend on the size of the data, and seeking only
+ *  decompresses the block it lands in.
+ */
+/*@{*/
+#define SDL_COMPRESS_LZ		1	/**< Very fast to decompress, always there */
+#define SDL_COMPRESS_ZLIB	2	/**< Smaller, if SDL was built with zlib */
+
+/**
+ * A read-only SDL_RWops of the data compressed in 'src'.  If 'freesrc'
+ * is non-zero, 'src' is closed with it, or right away on error.
+ */
+extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromCompressed(SDL_RWops *src, int freesrc);
+
+/**
+ * Compress everything left in 'src' into 'dst', which has to be able to
+ * seek.  A 'blocksize' of 0 picks the default.
+ *
+ * @return 0, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_CompressRW(SDL_RWops *src, SDL_RWops *dst, int method, int blocksize);
+/*@}*/
+
 /** @name Read an item of the specified endianness and return in native format */
 /*@{*/
 extern DECLSPEC Uint16 SDLCALL SDL_ReadLE16(SDL_RWops *src);
@@ -146,6 +234,28 @@ extern DECLSPEC int SDLCALL SDL_WriteLE64(SDL_RWops *dst, Uint64 value);
 extern DECLSPEC int SDLCALL SDL_WriteBE64(SDL_RWops *dst, Uint64 value);
 /*@}*/
 
+/** @name Read and write arrays
+ *  Like the functions above, but for 'n' items at once, with a single
+ *  read or write of the data source in most cases.  They return how
+ *  many whole items were read or written, which is less than 'n' at the
+ *  end of the data or on an error.
+ */
+/*@{*/
+extern DECLSPEC size_t SDLCALL SDL_ReadLE16Array(SDL_RWops *src, Uint16 *dst, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_ReadBE16Array(SDL_RWops *src, Uint16 *dst, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_ReadLE32Array(SDL_RWops *src, Uint32 *dst, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_ReadBE32Array(SDL_RWops *src, Uint32 *dst, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_ReadLE64Array(SDL_RWops *src, Uint64 *dst, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_ReadBE64Array(SDL_RWops *src, Uint64 *dst, size_t n);
+
+extern DECLSPEC size_t SDLCALL SDL_WriteLE16Array(SDL_RWops *dst, const Uint16 *src, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_WriteBE16Array(SDL_RWops *dst, const Uint16 *src, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_WriteLE32Array(SDL_RWops *dst, const Uint32 *src, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_WriteBE32Array(SDL_RWops *dst, const Uint32 *src, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_WriteLE64Array(SDL_RWops *dst, const Uint64 *src, size_t n);
+extern DECLSPEC size_t SDLCALL SDL_WriteBE64Array(SDL_RWops *dst, const Uint64 *src, size_t n);
+/*@}*/
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
@@ -180,30 +180,61 @@ SDL_COMPILE_TIME_ASSERT(enum, sizeof(SDL_DUMMY_ENUM) == sizeof(int));
 extern "C" {
 #endif
 
-#ifdef HAVE_MALLOC
+#if defined(HAVE_MALLOC) && !defined(SDL_MALLOC_THREADED)
 #define SDL_malloc	malloc
 #else
 extern DECLSPEC void * SDLCALL SDL_malloc(size_t size);
 #endif
 
-#ifdef HAVE_CALLOC
+#if defined(HAVE_CALLOC) && !defined(SDL_MALLOC_THREADED)
 #define SDL_calloc	calloc
 #else
 extern DECLSPEC void * SDLCALL SDL_calloc(size_t nmemb, size_t size);
 #endif
 
-#ifdef HAVE_REALLOC
+#if defined(HAVE_REALLOC) && !defined(SDL_MALLOC_THREADED)
 #define SDL_realloc	realloc
 #else
 extern DECLSPEC void * SDLCALL SDL_realloc(void *mem, size_t size);
 #endif
 
-#ifdef HAVE_FREE
+#if defined(HAVE_FREE) && !defined(SDL_MALLOC_THREADED)
 #define SDL_free	free
 #else
 extern DECLSPEC void SDLCALL SDL_free(void *mem);
 #endif
 
+/** @name Allocator statistics
+ *  These are only kept when SDL was configured with
+ *  --enable-threaded-malloc, which gives SDL_malloc() per-thread caches
+ *  for small blocks and several separately locked arenas for the rest.
+ */
+/*@{*/
+#define SDL_MALLOC_CLASSES	16
+
+typedef struct SDL_MallocStats {
+	size_t class_size[SDL_MALLOC_CLASSES];	/**< Block size of each small size class */
+	size_t class_bytes[SDL_MALLOC_CLASSES];	/**< Bytes in use in each small size class */
+	size_t large_bytes;	/**< Bytes in use in larger blocks */
+	size_t cached_bytes;	/**< Free small blocks held by thread caches */
+	size_t in_use;		/**< Total bytes in use */
+	size_t peak;		/**< Most bytes ever taken from each arena, cached blocks included, added up */
+	Uint32 arenas;		/**< Number of arenas */
+	Uint32 threads;		/**< Number of threads with a cache */
+	Uint32 lock_acquires;	/**< Number of times an arena lock was taken */
+	Uint32 lock_contended;	/**< Number of times that meant waiting for another thread */
+} SDL_MallocStats;
+
+/**
+ * Get a snapshot of the allocator statistics.  The numbers are gathered
+ * without stopping other threads, so they can be slightly out of step
+ * with each other.
+ *
+ * @return 0, or -1 if SDL_malloc() doesn't keep statistics.
+ */
+extern DECLSPEC int SDLCALL SDL_GetMallocStats(SDL_MallocStats *stats);
+/*@}*/
+
 #ifdef HAVE_ALLOCA
 #define SDL_stack_alloc(type, count)    (type*)alloca(sizeof(type)*(count))
 #define SDL_stack_free(data)
@@ -231,6 +262,28 @@ extern DECLSPEC void SDLCALL SDL_qsort(void *base, size_t nmemb, size_t size,
            int (*compare)(const void *, const void *));
 #endif
 
+/**
+ * Sort an array of integers into ascending order.  These are radix
+ * sorts, much faster than SDL_qsort() with a comparison function on all
+ * but short arrays.  They use a temporary copy of the array, and fall
+ * back to a comparison sort if it can't be allocated.
+ */
+extern DECLSPEC void SDLCALL SDL_qsort_u32(Uint32 *base, size_t nmemb);
+extern DECLSPEC void SDLCALL SDL_qsort_s32(Sint32 *base, size_t nmemb);
+#ifdef SDL_HAS_64BIT_TYPE
+extern DECLSPEC void SDLCALL SDL_qsort_u64(Uint64 *base, size_t nmemb);
+#endif
+
+/**
+ * Sort like SDL_qsort(), with large arrays split over the thread pool in
+ * SDL_thread.h.  Each worker sorts a piece and the pieces are merged back
+ * together, which takes a temporary copy of the array.  Small arrays are
+ * sorted on the calling thread, as is everything if the copy can't be
+ * allocated.  'compare' is called from several threads at once.
+ */
+extern DECLSPEC void SDLCALL SDL_qsort_parallel(void *base, size_t nmemb, size_t size,
+           int (*compare)(const void *, const void *));
+
 #ifdef HAVE_ABS
 #define SDL_abs		abs
 #else
@@ -409,9 +462,9 @@ extern DECLSPEC size_t SDLCALL SDL_strlcpy(char *dst, const char *src, size_t ma
 extern DECLSPEC size_t SDLCALL SDL_strlcat(char *dst, const char *src, size_t maxlen);
 #endif
 
-#if defined(HAVE_STRDUP) && defined(_WIN32)
+#if defined(HAVE_STRDUP) && defined(_WIN32) && !defined(SDL_MALLOC_THREADED)
 #define SDL_strdup    _strdup
-#elif defined(HAVE_STRDUP)
+#elif defined(HAVE_STRDUP) && !defined(SDL_MALLOC_THREADED)
 #define SDL_strdup     strdup
 #else
 extern DECLSPEC char * SDLCALL SDL_strdup(const char *string);
@@ -108,6 +108,69 @@ extern DECLSPEC void SDLCALL SDL_WaitThread(SDL_Thread *thread, int *status);
 /** Forcefully kill a thread without worrying about its state */
 extern DECLSPEC void SDLCALL SDL_KillThread(SDL_Thread *thread);
 
+/** @name Thread local storage
+ *  Each thread has its own value for every ID, NULL until it is set.
+ *  The values work in any thread, not just ones made by SDL_CreateThread().
+ */
+/*@{*/
+/** An ID for a thread local value, 0 is never a valid ID */
+typedef unsigned int SDL_TLSID;
+
+/** Create an ID for a thread local value, or return 0 on error */
+extern DECLSPEC SDL_TLSID SDLCALL SDL_TLSCreate(void);
+
+/** Get the current thread's value for 'id' */
+extern DECLSPEC void * SDLCALL SDL_TLSGet(SDL_TLSID id);
+
+/**
+ * Set the current thread's value for 'id'.  If 'destructor' isn't NULL,
+ * it is called with the value when the thread exits.
+ *
+ * @return 0, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_TLSSet(SDL_TLSID id, const void *value, void (SDLCALL *destructor)(void *));
+/*@}*/
+
+/** @name Thread pool
+ *  SDL keeps a pool of worker threads, one per CPU by default, which is
+ *  created the first time one of these functions is called.  The
+ *  SDL_THREADPOOL_SIZE environment variable overrides the number of
+ *  workers.  Each worker has its own job queue, jobs submitted from a
+ *  job go on the queue of the worker running it, and idle workers steal
+ *  jobs from the others.
+ */
+/*@{*/
+/** A handle to a submitted job, defined in SDL_threadpool.c */
+struct SDL_Job;
+typedef struct SDL_Job SDL_Job;
+
+/**
+ * Queue fn(data) to run on the thread pool.
+ *
+ * @return A handle that must be passed to SDL_WaitJob(), or NULL on error.
+ */
+extern DECLSPEC SDL_Job * SDLCALL SDL_SubmitJob(void (SDLCALL *fn)(void *data), void *data);
+
+/**
+ * Wait for a job to finish, and release its handle.  The calling thread
+ * runs other queued jobs while it waits.
+ */
+extern DECLSPEC void SDLCALL SDL_WaitJob(SDL_Job *job);
+
+/**
+ * Call fn(data, first, last) for ranges covering the indices 0 to
+ * count-1, spread over the thread pool, and wait for all of them.
+ * Each range holds at least 'grain' indices, or a share picked from the
+ * pool size if 'grain' is 0.  'last' is one past the end of the range.
+ *
+ * @return 0, or -1 if count is negative.
+ */
+extern DECLSPEC int SDLCALL SDL_ParallelFor(int count, int grain, void (SDLCALL *fn)(void *data, int first, int last), void *data);
+
+/** Get the number of worker threads in the thread pool */
+extern DECLSPEC int SDLCALL SDL_GetThreadPoolSize(void);
+/*@}*/
+
 
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
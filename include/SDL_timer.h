@@ -51,6 +51,27 @@ extern DECLSPEC Uint32 SDLCALL SDL_GetTicks(void);
 /** Wait a specified number of milliseconds before returning */
 extern DECLSPEC void SDLCALL SDL_Delay(Uint32 ms);
 
+#ifdef SDL_HAS_64BIT_TYPE
+/**
+ * Get the current value of the high resolution counter.
+ * This is only useful for measuring intervals, divide the difference
+ * between two values by SDL_GetPerformanceFrequency() to get seconds.
+ * On Linux it counts nanoseconds of CLOCK_MONOTONIC_RAW.
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_GetPerformanceCounter(void);
+
+/** Get the number of high resolution counter ticks per second */
+extern DECLSPEC Uint64 SDLCALL SDL_GetPerformanceFrequency(void);
+
+/**
+ * Wait a specified number of nanoseconds before returning.
+ * This sleeps for most of the time, then spins on the performance
+ * counter for the last fraction of a millisecond, so it's much more
+ * accurate than SDL_Delay() at the cost of some CPU time.
+ */
+extern DECLSPEC void SDLCALL SDL_DelayPrecise(Uint64 ns);
+#endif
+
 /** Function prototype for the timer callback function */
 typedef Uint32 (SDLCALL *SDL_TimerCallback)(Uint32 interval);
 
@@ -67,12 +88,11 @@ typedef Uint32 (SDLCALL *SDL_TimerCallback)(Uint32 interval);
  * The timer callback function may run in a different thread than your
  * main code, and so shouldn't call any functions from within itself.
  *
- * The maximum resolution of this timer is 10 ms, which means that if
- * you request a 16 ms timer, your callback will run approximately 20 ms
- * later on an unloaded system.  If you wanted to set a flag signaling
- * a frame update at 30 frames per second (every 33 ms), you might set a 
- * timer for 30 ms:
- *   @code SDL_SetTimer((33/10)*10, flag_update); @endcode
+ * On some platforms the resolution of this timer is only 10 ms, which
+ * means that if you request a 16 ms timer, your callback will run
+ * approximately 20 ms later on an unloaded system.  Threaded timers on
+ * UNIX run within about a millisecond of their deadline, and periodic
+ * timers keep to their original schedule instead of drifting.
  *
  * If you use this function, you need to pass SDL_INIT_TIMER to SDL_Init().
  *
@@ -414,6 +414,68 @@ extern DECLSPEC void SDLCALL SDL_UpdateRect
  */
 extern DECLSPEC int SDLCALL SDL_Flip(SDL_Surface *screen);
 
+/**
+ * This function returns the refresh period of the display, in
+ * microseconds, or 0 if the video driver can't tell.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetRefreshInterval(void);
+
+#ifdef SDL_HAS_64BIT_TYPE
+/** @name Frame pacing */
+/*@{*/
+#define SDL_FRAME_HISTOGRAM_BINS	32
+#define SDL_FRAME_HISTOGRAM_STEP	250	/**< Bin width, in microseconds */
+
+/** Frame pacing statistics, filled in by SDL_GetFrameStats() */
+typedef struct SDL_FrameStats {
+	Uint32 frames;		/**< Number of frames measured */
+	Uint32 missed;		/**< Frames that were ready after their deadline */
+	Uint32 interval;	/**< Target frame interval, in microseconds */
+	Uint32 frame_min;	/**< Shortest frame, in microseconds */
+	Uint32 frame_avg;	/**< Average frame, in microseconds */
+	Uint32 frame_max;	/**< Longest frame, in microseconds */
+	/**
+	 * Frame times minus the target interval, in bins that are
+	 * SDL_FRAME_HISTOGRAM_STEP microseconds wide.  The frames that were
+	 * on time are counted in bin SDL_FRAME_HISTOGRAM_BINS/2, and the
+	 * first and last bins also count everything beyond them.
+	 */
+	Uint32 histogram[SDL_FRAME_HISTOGRAM_BINS];
+} SDL_FrameStats;
+
+/**
+ * Set the interval SDL_PaceFrame() keeps frames apart, in microseconds.
+ * Pass SDL_GetRefreshInterval() to run at the display refresh rate.
+ * An interval of 0 turns off pacing, SDL_PaceFrame() then only measures.
+ *
+ * If the interval is a multiple of the display refresh period and the
+ * video driver can wait for vertical retrace, frames are also lined
+ * up with the retrace.
+ */
+extern DECLSPEC void SDLCALL SDL_SetFrameInterval(Uint32 usec);
+
+/**
+ * Call this once per frame, after SDL_Flip() or SDL_UpdateRects().
+ * It waits until the frame deadline, sleeping most of the way and then
+ * spinning for accuracy.  Deadlines are kept on a fixed schedule so
+ * sleeping errors don't add up; after a frame has fallen more than a
+ * whole interval behind, the schedule restarts from the current time.
+ *
+ * @return The time since the previous call, in microseconds.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_PaceFrame(void);
+
+/**
+ * This function fills 'stats' with the frame times measured by
+ * SDL_PaceFrame() since the last call to SDL_ResetFrameStats().
+ */
+extern DECLSPEC void SDLCALL SDL_GetFrameStats(SDL_FrameStats *stats);
+
+/** This function clears the frame pacing statistics */
+extern DECLSPEC void SDLCALL SDL_ResetFrameStats(void);
+/*@}*/
+#endif /* SDL_HAS_64BIT_TYPE */
+
 /**
  * Set the gamma correction for each of the color channels.
  * The gamma values range (approximately) between 0.1 and 10.0
@@ -768,6 +830,17 @@ extern DECLSPEC int SDLCALL SDL_LowerBlit
 extern DECLSPEC int SDLCALL SDL_FillRect
 		(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color);
 
+/**
+ * This function fills 'n' rectangles with 'color', like SDL_FillRect(),
+ * but locks the destination surface only once for all of them.
+ * Each rectangle is clipped to the destination surface clip area and
+ * the final fill rectangles are saved in the passed in array.  Any that
+ * are clipped away entirely are left with a width and height of 0.
+ * This function returns 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_FillRects
+		(SDL_Surface *dst, SDL_Rect *rects, int n, Uint32 color);
+
 /**
  * This function takes a surface and copies it to a new surface of the
  * pixel format and colors of the video framebuffer, suitable for fast
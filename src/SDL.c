@@ -42,6 +42,7 @@ extern void SDL_JoystickQuit(void);
 extern int  SDL_CDROMInit(void);
 extern void SDL_CDROMQuit(void);
 #endif
+extern void SDL_ThreadPoolQuit(void);
 #if !SDL_TIMERS_DISABLED
 extern void SDL_StartTicks(void);
 extern int  SDL_TimerInit(void);
@@ -221,6 +222,9 @@ void SDL_Quit(void)
 #endif
 	SDL_QuitSubSystem(SDL_INIT_EVERYTHING);
 
+	/* Stop the thread pool, if it was used */
+	SDL_ThreadPoolQuit();
+
 #ifdef CHECK_LEAKS
 #ifdef DEBUG_BUILD
   printf("[SDL_Quit] : CHECK_LEAKS\n"); fflush(stdout);
@@ -35,8 +35,6 @@ static SDL_error SDL_global_error;
 extern SDL_error *SDL_GetErrBuf(void);
 #endif /* SDL_THREADS_DISABLED */
 
-#define SDL_ERRBUFIZE	1024
-
 /* Private functions */
 
 static const char *SDL_LookupString(const char *key)
@@ -226,9 +224,7 @@ char *SDL_GetErrorMsg(char *errstr, int maxlen)
 /* Available for backwards compatibility */
 char *SDL_GetError (void)
 {
-	static char errmsg[SDL_ERRBUFIZE];
-
-	return((char *)SDL_GetErrorMsg(errmsg, SDL_ERRBUFIZE));
+	return((char *)SDL_GetErrorMsg(SDL_GetErrBuf()->errmsg, SDL_ERRBUFIZE));
 }
 
 void SDL_ClearError(void)
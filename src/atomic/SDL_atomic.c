@@ -0,0 +1,533 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Atomic operations, spinlocks and memory barriers */
+
+/* We define the real functions for the macros in SDL_atomic.h */
+#define SDL_ATOMIC_NOINLINE
+
+#include "SDL_timer.h"
+#include "SDL_atomic_c.h"
+
+#if SDL_ATOMIC_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif !SDL_ATOMIC_LOCKFREE && !SDL_THREADS_DISABLED
+#include "SDL_mutex.h"
+#endif
+
+/* Spin this many times between looks at a busy spinlock before yielding */
+#define SPIN_BACKOFF_MAX	1024
+
+
+#if SDL_ATOMIC_GCC_ATOMIC
+
+/* The builtins want a constant memory order to do anything but SEQ_CST */
+#define ATOMIC_LOAD(ptr, order, result) \
+	switch (order) { \
+	    case SDL_MEMORY_ORDER_RELAXED: \
+		result = __atomic_load_n(ptr, __ATOMIC_RELAXED); break; \
+	    case SDL_MEMORY_ORDER_ACQUIRE: \
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); break; \
+	    default: \
+		result = __atomic_load_n(ptr, __ATOMIC_SEQ_CST); break; \
+	}
+#define ATOMIC_STORE(ptr, v, order) \
+	switch (order) { \
+	    case SDL_MEMORY_ORDER_RELAXED: \
+		__atomic_store_n(ptr, v, __ATOMIC_RELAXED); break; \
+	    case SDL_MEMORY_ORDER_RELEASE: \
+		__atomic_store_n(ptr, v, __ATOMIC_RELEASE); break; \
+	    default: \
+		__atomic_store_n(ptr, v, __ATOMIC_SEQ_CST); break; \
+	}
+#define ATOMIC_CAS(ptr, o, n, order, result) \
+	switch (order) { \
+	    case SDL_MEMORY_ORDER_RELAXED: \
+		result = __atomic_compare_exchange_n(ptr, &o, n, 0, \
+		                 __ATOMIC_RELAXED, __ATOMIC_RELAXED); break; \
+	    case SDL_MEMORY_ORDER_ACQUIRE: \
+		result = __atomic_compare_exchange_n(ptr, &o, n, 0, \
+		                 __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); break; \
+	    case SDL_MEMORY_ORDER_RELEASE: \
+		result = __atomic_compare_exchange_n(ptr, &o, n, 0, \
+		                 __ATOMIC_RELEASE, __ATOMIC_RELAXED); break; \
+	    case SDL_MEMORY_ORDER_ACQ_REL: \
+		result = __atomic_compare_exchange_n(ptr, &o, n, 0, \
+		                 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); break; \
+	    default: \
+		result = __atomic_compare_exchange_n(ptr, &o, n, 0, \
+		                 __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); break; \
+	}
+
+SDL_bool SDL_AtomicIsLockFree(void)
+{
+	return SDL_TRUE;
+}
+
+int SDL_AtomicAddExplicit(SDL_atomic_t *a, int v, SDL_MemoryOrder order)
+{
+	switch (order) {
+	    case SDL_MEMORY_ORDER_RELAXED:
+		return __atomic_fetch_add(&a->value, v, __ATOMIC_RELAXED);
+	    case SDL_MEMORY_ORDER_ACQUIRE:
+		return __atomic_fetch_add(&a->value, v, __ATOMIC_ACQUIRE);
+	    case SDL_MEMORY_ORDER_RELEASE:
+		return __atomic_fetch_add(&a->value, v, __ATOMIC_RELEASE);
+	    case SDL_MEMORY_ORDER_ACQ_REL:
+		return __atomic_fetch_add(&a->value, v, __ATOMIC_ACQ_REL);
+	    default:
+		return __atomic_fetch_add(&a->value, v, __ATOMIC_SEQ_CST);
+	}
+}
+
+int SDL_AtomicGetExplicit(SDL_atomic_t *a, SDL_MemoryOrder order)
+{
+	int result;
+	ATOMIC_LOAD(&a->value, order, result);
+	return result;
+}
+
+void SDL_AtomicSetExplicit(SDL_atomic_t *a, int v, SDL_MemoryOrder order)
+{
+	ATOMIC_STORE(&a->value, v, order);
+}
+
+SDL_bool SDL_AtomicCASExplicit(SDL_atomic_t *a, int oldval, int newval, SDL_MemoryOrder order)
+{
+	int result;
+	ATOMIC_CAS(&a->value, oldval, newval, order, result);
+	return result ? SDL_TRUE : SDL_FALSE;
+}
+
+int SDL_AtomicSet(SDL_atomic_t *a, int v)
+{
+	return __atomic_exchange_n(&a->value, v, __ATOMIC_SEQ_CST);
+}
+
+void *SDL_AtomicGetPtrExplicit(void **a, SDL_MemoryOrder order)
+{
+	void *result;
+	ATOMIC_LOAD(a, order, result);
+	return result;
+}
+
+void SDL_AtomicSetPtrExplicit(void **a, void *v, SDL_MemoryOrder order)
+{
+	ATOMIC_STORE(a, v, order);
+}
+
+SDL_bool SDL_AtomicCASPtrExplicit(void **a, void *oldval, void *newval, SDL_MemoryOrder order)
+{
+	int result;
+	ATOMIC_CAS(a, oldval, newval, order, result);
+	return result ? SDL_TRUE : SDL_FALSE;
+}
+
+void *SDL_AtomicSetPtr(void **a, void *v)
+{
+	return __atomic_exchange_n(a, v, __ATOMIC_SEQ_CST);
+}
+
+void SDL_MemoryBarrier(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void SDL_MemoryBarrierAcquire(void)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+void SDL_MemoryBarrierRelease(void)
+{
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+SDL_bool SDL_AtomicTryLock(SDL_SpinLock *lock)
+{
+	if ( __atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) == 0 ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
+void SDL_AtomicUnlock(SDL_SpinLock *lock)
+{
+	__atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+#define SpinLockBusy(lock)	__atomic_load_n(lock, __ATOMIC_RELAXED)
+
+#elif SDL_ATOMIC_GCC_SYNC || SDL_ATOMIC_WIN32
+
+/* These only have full barriers, so the memory order is ignored */
+#if SDL_ATOMIC_GCC_SYNC
+#define FetchAdd(p, v)		__sync_fetch_and_add(p, v)
+#define CompareSwap(p, o, n)	__sync_bool_compare_and_swap(p, o, n)
+#define CompareSwapPtr(p, o, n)	__sync_bool_compare_and_swap(p, o, n)
+#define FullBarrier()		__sync_synchronize()
+#else
+#define FetchAdd(p, v)		InterlockedExchangeAdd((LONG volatile *)(p), v)
+#define CompareSwap(p, o, n)	\
+	(InterlockedCompareExchange((LONG volatile *)(p), n, o) == (LONG)(o))
+#define CompareSwapPtr(p, o, n)	\
+	(InterlockedCompareExchangePointer((PVOID volatile *)(p), n, o) == (o))
+#define FullBarrier()		MemoryBarrier()
+#endif
+
+SDL_bool SDL_AtomicIsLockFree(void)
+{
+	return SDL_TRUE;
+}
+
+int SDL_AtomicAddExplicit(SDL_atomic_t *a, int v, SDL_MemoryOrder order)
+{
+	return FetchAdd(&a->value, v);
+}
+
+int SDL_AtomicGetExplicit(SDL_atomic_t *a, SDL_MemoryOrder order)
+{
+	int value;
+
+	value = a->value;
+	if ( order != SDL_MEMORY_ORDER_RELAXED ) {
+		FullBarrier();
+	}
+	return value;
+}
+
+void SDL_AtomicSetExplicit(SDL_atomic_t *a, int v, SDL_MemoryOrder order)
+{
+	if ( order != SDL_MEMORY_ORDER_RELAXED ) {
+		FullBarrier();
+	}
+	a->value = v;
+	if ( order == SDL_MEMORY_ORDER_SEQ_CST ) {
+		FullBarrier();
+	}
+}
+
+SDL_bool SDL_AtomicCASExplicit(SDL_atomic_t *a, int oldval, int newval, SDL_MemoryOrder order)
+{
+	return CompareSwap(&a->value, oldval, newval) ? SDL_TRUE : SDL_FALSE;
+}
+
+int SDL_AtomicSet(SDL_atomic_t *a, int v)
+{
+	int value;
+	do {
+		value = a->value;
+	} while ( !CompareSwap(&a->value, value, v) );
+	return value;
+}
+
+void *SDL_AtomicGetPtrExplicit(void **a, SDL_MemoryOrder order)
+{
+	void *value;
+
+	value = *(void * volatile *)a;
+	if ( order != SDL_MEMORY_ORDER_RELAXED ) {
+		FullBarrier();
+	}
+	return value;
+}
+
+void SDL_AtomicSetPtrExplicit(void **a, void *v, SDL_MemoryOrder order)
+{
+	if ( order != SDL_MEMORY_ORDER_RELAXED ) {
+		FullBarrier();
+	}
+	*(void * volatile *)a = v;
+	if ( order == SDL_MEMORY_ORDER_SEQ_CST ) {
+		FullBarrier();
+	}
+}
+
+SDL_bool SDL_AtomicCASPtrExplicit(void **a, void *oldval, void *newval, SDL_MemoryOrder order)
+{
+	return CompareSwapPtr(a, oldval, newval) ? SDL_TRUE : SDL_FALSE;
+}
+
+void *SDL_AtomicSetPtr(void **a, void *v)
+{
+	void *value;
+	do {
+		value = *(void * volatile *)a;
+	} while ( !CompareSwapPtr(a, value, v) );
+	return value;
+}
+
+void SDL_MemoryBarrier(void)
+{
+	FullBarrier();
+}
+
+void SDL_MemoryBarrierAcquire(void)
+{
+	FullBarrier();
+}
+
+void SDL_MemoryBarrierRelease(void)
+{
+	FullBarrier();
+}
+
+SDL_bool SDL_AtomicTryLock(SDL_SpinLock *lock)
+{
+	return CompareSwap(lock, 0, 1) ? SDL_TRUE : SDL_FALSE;
+}
+
+void SDL_AtomicUnlock(SDL_SpinLock *lock)
+{
+	FullBarrier();
+	*(volatile SDL_SpinLock *)lock = 0;
+}
+
+#define SpinLockBusy(lock)	(*(volatile SDL_SpinLock *)(lock))
+
+#else
+
+/* No atomic operations, everything goes through one big lock.
+
+   WARNING:
+   The lock is created the first time it's needed, so the very first
+   atomic operation has to happen before there are several threads,
+   just like with the thread list in SDL_thread.c.
+ */
+#if SDL_THREADS_DISABLED
+#define LockAtomics()
+#define UnlockAtomics()
+#else
+static SDL_mutex *SDL_atomic_lock = NULL;
+static int SDL_atomic_lock_failed = 0;
+
+static void LockAtomics(void)
+{
+	/* If it can't be made, don't try again on every operation */
+	if ( SDL_atomic_lock == NULL && !SDL_atomic_lock_failed ) {
+		SDL_atomic_lock = SDL_CreateMutex();
+		if ( SDL_atomic_lock == NULL ) {
+			SDL_atomic_lock_failed = 1;
+		}
+	}
+	if ( SDL_atomic_lock ) {
+		SDL_mutexP(SDL_atomic_lock);
+	}
+}
+
+static void UnlockAtomics(void)
+{
+	if ( SDL_atomic_lock ) {
+		SDL_mutexV(SDL_atomic_lock);
+	}
+}
+#endif /* SDL_THREADS_DISABLED */
+
+SDL_bool SDL_AtomicIsLockFree(void)
+{
+	return SDL_FALSE;
+}
+
+int SDL_AtomicAddExplicit(SDL_atomic_t *a, int v, SDL_MemoryOrder order)
+{
+	int value;
+
+	LockAtomics();
+	value = a->value;
+	a->value = value + v;
+	UnlockAtomics();
+	return value;
+}
+
+int SDL_AtomicGetExplicit(SDL_atomic_t *a, SDL_MemoryOrder order)
+{
+	int value;
+
+	LockAtomics();
+	value = a->value;
+	UnlockAtomics();
+	return value;
+}
+
+void SDL_AtomicSetExplicit(SDL_atomic_t *a, int v, SDL_MemoryOrder order)
+{
+	LockAtomics();
+	a->value = v;
+	UnlockAtomics();
+}
+
+SDL_bool SDL_AtomicCASExplicit(SDL_atomic_t *a, int oldval, int newval, SDL_MemoryOrder order)
+{
+	SDL_bool retval = SDL_FALSE;
+
+	LockAtomics();
+	if ( a->value == oldval ) {
+		a->value = newval;
+		retval = SDL_TRUE;
+	}
+	UnlockAtomics();
+	return retval;
+}
+
+int SDL_AtomicSet(SDL_atomic_t *a, int v)
+{
+	int value;
+
+	LockAtomics();
+	value = a->value;
+	a->value = v;
+	UnlockAtomics();
+	return value;
+}
+
+void *SDL_AtomicGetPtrExplicit(void **a, SDL_MemoryOrder order)
+{
+	void *value;
+
+	LockAtomics();
+	value = *a;
+	UnlockAtomics();
+	return value;
+}
+
+void SDL_AtomicSetPtrExplicit(void **a, void *v, SDL_MemoryOrder order)
+{
+	LockAtomics();
+	*a = v;
+	UnlockAtomics();
+}
+
+SDL_bool SDL_AtomicCASPtrExplicit(void **a, void *oldval, void *newval, SDL_MemoryOrder order)
+{
+	SDL_bool retval = SDL_FALSE;
+
+	LockAtomics();
+	if ( *a == oldval ) {
+		*a = newval;
+		retval = SDL_TRUE;
+	}
+	UnlockAtomics();
+	return retval;
+}
+
+void *SDL_AtomicSetPtr(void **a, void *v)
+{
+	void *value;
+
+	LockAtomics();
+	value = *a;
+	*a = v;
+	UnlockAtomics();
+	return value;
+}
+
+/* Taking and releasing the lock orders memory for us */
+void SDL_MemoryBarrier(void)
+{
+	LockAtomics();
+	UnlockAtomics();
+}
+
+void SDL_MemoryBarrierAcquire(void)
+{
+	SDL_MemoryBarrier();
+}
+
+void SDL_MemoryBarrierRelease(void)
+{
+	SDL_MemoryBarrier();
+}
+
+SDL_bool SDL_AtomicTryLock(SDL_SpinLock *lock)
+{
+	SDL_bool retval = SDL_FALSE;
+
+	LockAtomics();
+	if ( *lock == 0 ) {
+		*lock = 1;
+		retval = SDL_TRUE;
+	}
+	UnlockAtomics();
+	return retval;
+}
+
+void SDL_AtomicUnlock(SDL_SpinLock *lock)
+{
+	LockAtomics();
+	*lock = 0;
+	UnlockAtomics();
+}
+
+#define SpinLockBusy(lock)	(*(volatile SDL_SpinLock *)(lock))
+
+#endif /* SDL_ATOMIC_GCC_ATOMIC */
+
+
+/* The rest is the same for every implementation */
+
+int SDL_AtomicGet(SDL_atomic_t *a)
+{
+	return SDL_AtomicGetExplicit(a, SDL_MEMORY_ORDER_SEQ_CST);
+}
+
+int SDL_AtomicAdd(SDL_atomic_t *a, int v)
+{
+	return SDL_AtomicAddExplicit(a, v, SDL_MEMORY_ORDER_SEQ_CST);
+}
+
+SDL_bool SDL_AtomicCAS(SDL_atomic_t *a, int oldval, int newval)
+{
+	return SDL_AtomicCASExplicit(a, oldval, newval, SDL_MEMORY_ORDER_SEQ_CST);
+}
+
+void *SDL_AtomicGetPtr(void **a)
+{
+	return SDL_AtomicGetPtrExplicit(a, SDL_MEMORY_ORDER_SEQ_CST);
+}
+
+SDL_bool SDL_AtomicCASPtr(void **a, void *oldval, void *newval)
+{
+	return SDL_AtomicCASPtrExplicit(a, oldval, newval, SDL_MEMORY_ORDER_SEQ_CST);
+}
+
+void SDL_AtomicLock(SDL_SpinLock *lock)
+{
+	int spins = 1;
+	int i;
+
+	while ( !SDL_AtomicTryLock(lock) ) {
+		/* Back off, and only retry once the lock looks free, so
+		   waiting threads don't keep stealing the cache line */
+		do {
+			if ( spins <= SPIN_BACKOFF_MAX ) {
+				for ( i = 0; i < spins; ++i ) {
+					SDL_CPUPause();
+				}
+				spins *= 2;
+			} else {
+				SDL_Delay(0);
+			}
+		} while ( SpinLockBusy(lock) );
+	}
+}
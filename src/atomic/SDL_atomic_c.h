@@ -0,0 +1,61 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_atomic_c_h
+#define _SDL_atomic_c_h
+
+#include "SDL_atomic.h"
+
+/* Which implementation of the atomic operations we're using.
+   SDL_ATOMIC_LOCKFREE is set when they don't need a lock, so code that
+   has a locked path of its own can pick it instead.
+ */
+#if defined(__ATOMIC_SEQ_CST) && defined(__GCC_ATOMIC_INT_LOCK_FREE) && \
+    (__GCC_ATOMIC_INT_LOCK_FREE == 2) && (__GCC_ATOMIC_POINTER_LOCK_FREE == 2)
+#define SDL_ATOMIC_GCC_ATOMIC	1	/* gcc 4.7+, clang */
+#define SDL_ATOMIC_LOCKFREE	1
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) && \
+    ((__SIZEOF_POINTER__ == 4) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8))
+#define SDL_ATOMIC_GCC_SYNC	1	/* gcc 4.1+ */
+#define SDL_ATOMIC_LOCKFREE	1
+#elif defined(_MSC_VER) && (_MSC_VER >= 1400)
+#define SDL_ATOMIC_WIN32	1
+#define SDL_ATOMIC_LOCKFREE	1
+#else
+#define SDL_ATOMIC_LOCKFREE	0
+#endif
+
+/* A hint to the CPU that we're spinning */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define SDL_CPUPause()	__asm__ __volatile__ ("pause")
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define SDL_CPUPause()	__asm__ __volatile__ ("yield")
+#elif defined(_MSC_VER) && (_MSC_VER >= 1400) && (defined(_M_IX86) || defined(_M_X64))
+void _mm_pause(void);
+#pragma intrinsic(_mm_pause)
+#define SDL_CPUPause()	_mm_pause()
+#else
+#define SDL_CPUPause()	SDL_CompilerBarrier()
+#endif
+
+#endif /* _SDL_atomic_c_h */
@@ -27,6 +27,7 @@
 #include "SDL_audio_c.h"
 #include "SDL_audiomem.h"
 #include "SDL_sysaudio.h"
+#include "../stdlib/SDL_copyrows_c.h"
 
 /* Available audio drivers */
 static AudioBootStrap *bootstrap[] = {
@@ -118,6 +119,22 @@ SDL_AudioDevice *current_audio = NULL;
 int SDL_AudioInit(const char *driver_name);
 void SDL_AudioQuit(void);
 
+/* Record the time spent in one run of the audio callback */
+static void SDL_UpdateAudioStats(SDL_AudioDevice *audio, Uint32 elapsed)
+{
+	SDL_AudioStats *stats = &audio->stats;
+
+	if ( (stats->callbacks == 0) || (elapsed < stats->callback_min) ) {
+		stats->callback_min = elapsed;
+	}
+	if ( elapsed > stats->callback_max ) {
+		stats->callback_max = elapsed;
+	}
+	++stats->callbacks;
+	audio->callback_total += elapsed;
+	stats->callback_avg = (Uint32)(audio->callback_total / stats->callbacks);
+}
+
 /* The general mixing thread function */
 int SDLCALL SDL_RunAudio(void *audiop)
 {
@@ -167,12 +184,29 @@ int SDLCALL SDL_RunAudio(void *audiop)
 			}
 		}
 
-		SDL_memset(stream, silence, stream_len);
+		SDL_FillBlock(stream, (Uint32)silence * 0x01010101, stream_len);
 
 		if ( ! audio->paused ) {
+#ifdef SDL_HAS_64BIT_TYPE
+			Uint64 start, elapsed;
+
 			SDL_mutexP(audio->mixer_lock);
+			start = SDL_GetPerformanceCounter();
 			(*fill)(udata, stream, stream_len);
+			elapsed = (SDL_GetPerformanceCounter() - start) * 1000000 /
+			          SDL_GetPerformanceFrequency();
+			SDL_UpdateAudioStats(audio, (Uint32)elapsed);
 			SDL_mutexV(audio->mixer_lock);
+#else
+			Uint32 start, elapsed;
+
+			SDL_mutexP(audio->mixer_lock);
+			start = SDL_GetTicks();
+			(*fill)(udata, stream, stream_len);
+			elapsed = (SDL_GetTicks() - start) * 1000;
+			SDL_UpdateAudioStats(audio, elapsed);
+			SDL_mutexV(audio->mixer_lock);
+#endif
 		}
 
 		/* Convert the audio if necessary */
@@ -189,6 +223,8 @@ int SDLCALL SDL_RunAudio(void *audiop)
 		/* Ready current buffer for play and change current buffer */
 		if ( stream != audio->fake_stream ) {
 			audio->PlayAudio(audio);
+		} else {
+			SDL_AtomicIncRef(&audio->fake_streams);
 		}
 
 		/* Wait for an audio buffer to become available */
@@ -471,6 +507,10 @@ int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 	/* Open the audio subsystem */
 	SDL_memcpy(&audio->spec, desired, sizeof(audio->spec));
 	audio->convert.needed = 0;
+	SDL_memset(&audio->stats, 0, sizeof(audio->stats));
+	audio->callback_total = 0.0;
+	SDL_AtomicSet(&audio->xruns, 0);
+	SDL_AtomicSet(&audio->fake_streams, 0);
 	audio->enabled = 1;
 	audio->paused  = 1;
 
@@ -593,6 +633,73 @@ void SDL_UnlockAudio (void)
 	}
 }
 
+int SDL_GetAudioLatency(int *frames, int *ms)
+{
+	SDL_AudioDevice *audio = current_audio;
+	int latency;
+
+	if ( !audio || !audio->opened ) {
+		SDL_SetError("Audio device is not open");
+		return(-1);
+	}
+	if ( !audio->GetLatency ) {
+		SDL_Unsupported();
+		return(-1);
+	}
+	latency = audio->GetLatency(audio);
+	if ( latency < 0 ) {
+		SDL_SetError("Couldn't query audio latency");
+		return(-1);
+	}
+	if ( frames ) {
+		*frames = latency;
+	}
+	if ( ms ) {
+		*ms = (int)(((double)latency * 1000.0) / audio->spec.freq);
+	}
+	return(0);
+}
+
+Uint32 SDL_GetAudioTicks(void)
+{
+	SDL_AudioDevice *audio = current_audio;
+
+	if ( audio && audio->opened && audio->GetTicks ) {
+		return(audio->GetTicks(audio));
+	}
+	return(SDL_GetTicks());
+}
+
+int SDL_GetAudioStats(SDL_AudioStats *stats)
+{
+	SDL_AudioDevice *audio = current_audio;
+
+	if ( !audio || !audio->opened ) {
+		SDL_SetError("Audio device is not open");
+		return(-1);
+	}
+	SDL_LockAudio();
+	SDL_memcpy(stats, &audio->stats, sizeof(*stats));
+	SDL_UnlockAudio();
+	stats->xruns = (Uint32)SDL_AtomicGet(&audio->xruns);
+	stats->fake_streams = (Uint32)SDL_AtomicGet(&audio->fake_streams);
+	return(0);
+}
+
+void SDL_ResetAudioStats(void)
+{
+	SDL_AudioDevice *audio = current_audio;
+
+	if ( audio ) {
+		SDL_LockAudio();
+		SDL_memset(&audio->stats, 0, sizeof(audio->stats));
+		audio->callback_total = 0.0;
+		SDL_UnlockAudio();
+		SDL_AtomicSet(&audio->xruns, 0);
+		SDL_AtomicSet(&audio->fake_streams, 0);
+	}
+}
+
 void SDL_CloseAudio (void)
 {
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
@@ -26,6 +26,7 @@
 
 #include "SDL_mutex.h"
 #include "SDL_thread.h"
+#include "SDL_atomic.h"
 
 /* The SDL audio driver */
 typedef struct SDL_AudioDevice SDL_AudioDevice;
@@ -61,6 +62,14 @@ struct SDL_AudioDevice {
 
 	void (*SetCaption)(_THIS, const char *caption);
 
+	/* * * */
+	/* Returns the number of frames queued in the device, or -1 */
+	int  (*GetLatency)(_THIS);
+
+	/* Returns the milliseconds of audio played, for drivers that keep
+	   their own clock.  Called from outside the audio thread. */
+	Uint32 (*GetTicks)(_THIS);
+
 	/* * * */
 	/* Data common to all devices */
 
@@ -78,6 +87,14 @@ struct SDL_AudioDevice {
 	/* Fake audio buffer for when the audio hardware is busy */
 	Uint8 *fake_stream;
 
+	/* Audio thread statistics (protected by the mixer lock) */
+	SDL_AudioStats stats;
+	double callback_total;
+
+	/* Counted outside the mixer lock, by drivers and the audio thread */
+	SDL_atomic_t xruns;
+	SDL_atomic_t fake_streams;
+
 	/* A semaphore for locking the mixing buffers */
 	SDL_mutex *mixer_lock;
 
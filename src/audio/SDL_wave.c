@@ -24,61 +24,80 @@
 /* Microsoft WAVE file loading routines */
 
 #include "SDL_audio.h"
+#include "SDL_thread.h"
 #include "SDL_wave.h"
 
 
 static int ReadChunk(SDL_RWops *src, Chunk *chunk);
 
+/* Everything needed to decode the data chunk, one block at a time.
+   For ADPCM a block is 'blockalign' bytes holding 'wSamplesPerBlock'
+   frames, for PCM a block is a single frame.
+ */
+typedef struct WaveDecoder {
+	WaveFMT wavefmt;
+	Uint16 encoding;		/* Resolved for WAVE_FORMAT_EXTENSIBLE */
+	Uint16 wSamplesPerBlock;
+	Uint16 wNumCoef;
+	Sint16 aCoeff[7][2];
+	Uint32 blocksize;		/* Bytes per encoded block */
+	Uint32 decodedsize;		/* Bytes per decoded block */
+	int (*decode)(const struct WaveDecoder *dec,
+	              const Uint8 *encoded, Uint8 *decoded, Uint32 nblocks);
+} WaveDecoder;
+
+/* Decoding a file of at least this many blocks is split across threads,
+   in ranges of at least WAVE_PARALLEL_GRAIN blocks */
+#define WAVE_PARALLEL_BLOCKS	256
+#define WAVE_PARALLEL_GRAIN	64
+
+/* How many encoded bytes SDL_ReadWAVStream() reads at a time */
+#define WAVE_STREAM_BATCH	16384
+
 struct MS_ADPCM_decodestate {
 	Uint8 hPredictor;
 	Uint16 iDelta;
 	Sint16 iSamp1;
 	Sint16 iSamp2;
 };
-static struct MS_ADPCM_decoder {
-	WaveFMT wavefmt;
-	Uint16 wSamplesPerBlock;
-	Uint16 wNumCoef;
-	Sint16 aCoeff[7][2];
-	/* * * */
-	struct MS_ADPCM_decodestate state[2];
-} MS_ADPCM_state;
 
-static int InitMS_ADPCM(WaveFMT *format, int length)
+static int InitMS_ADPCM(WaveDecoder *dec, WaveFMT *format, int length)
 {
 	Uint8 *rogue_feel, *rogue_feel_end;
 	int i;
 
 	/* Set the rogue pointer to the MS_ADPCM specific data */
-	if (length < sizeof(*format)) goto too_short;
-	MS_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-	MS_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-	MS_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-	MS_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-	MS_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-	MS_ADPCM_state.wavefmt.bitspersample =
-					 SDL_SwapLE16(format->bitspersample);
 	rogue_feel = (Uint8 *)format+sizeof(*format);
 	rogue_feel_end = (Uint8 *)format + length;
 	if ( sizeof(*format) == 16 ) {
 		rogue_feel += sizeof(Uint16);
 	}
 	if (rogue_feel + 4 > rogue_feel_end) goto too_short;
-	MS_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1]<<8)|rogue_feel[0]);
+	dec->wSamplesPerBlock = ((rogue_feel[1]<<8)|rogue_feel[0]);
 	rogue_feel += sizeof(Uint16);
-	MS_ADPCM_state.wNumCoef = ((rogue_feel[1]<<8)|rogue_feel[0]);
+	dec->wNumCoef = ((rogue_feel[1]<<8)|rogue_feel[0]);
 	rogue_feel += sizeof(Uint16);
-	if ( MS_ADPCM_state.wNumCoef != 7 ) {
+	if ( dec->wNumCoef != 7 ) {
 		SDL_SetError("Unknown set of MS_ADPCM coefficients");
 		return(-1);
 	}
-	for ( i=0; i<MS_ADPCM_state.wNumCoef; ++i ) {
+	for ( i=0; i<dec->wNumCoef; ++i ) {
 		if (rogue_feel + 4 > rogue_feel_end) goto too_short;
-		MS_ADPCM_state.aCoeff[i][0] = ((rogue_feel[1]<<8)|rogue_feel[0]);
+		dec->aCoeff[i][0] = ((rogue_feel[1]<<8)|rogue_feel[0]);
 		rogue_feel += sizeof(Uint16);
-		MS_ADPCM_state.aCoeff[i][1] = ((rogue_feel[1]<<8)|rogue_feel[0]);
+		dec->aCoeff[i][1] = ((rogue_feel[1]<<8)|rogue_feel[0]);
 		rogue_feel += sizeof(Uint16);
 	}
+
+	/* Make sure every block holds the samples it claims to */
+	if ( (dec->wavefmt.channels < 1) || (dec->wavefmt.channels > 2) ||
+	     (dec->wSamplesPerBlock < 2) ||
+	     (7 * dec->wavefmt.channels +
+	      ((dec->wSamplesPerBlock-2) * dec->wavefmt.channels + 1) / 2 >
+	      dec->wavefmt.blockalign) ) {
+		SDL_SetError("Unexpected chunk length for a MS ADPCM decoder");
+		return(-1);
+	}
 	return(0);
 too_short:
 	SDL_SetError("Unexpected length of a chunk with a MS ADPCM format");
@@ -86,7 +105,7 @@ too_short:
 }
 
 static Sint32 MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
-					Uint8 nybble, Sint16 *coeff)
+					Uint8 nybble, const Sint16 *coeff)
 {
 	const Sint32 max_audioval = ((1<<(16-1))-1);
 	const Sint32 min_audioval = -(1<<(16-1));
@@ -119,44 +138,33 @@ static Sint32 MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
 	return(new_sample);
 }
 
-static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
+static int MS_ADPCM_decode(const WaveDecoder *dec,
+                           const Uint8 *encoded, Uint8 *decoded, Uint32 nblocks)
 {
+	struct MS_ADPCM_decodestate states[2];
 	struct MS_ADPCM_decodestate *state[2];
-	Uint8 *freeable, *encoded, *encoded_end, *decoded, *decoded_end;
-	Sint32 encoded_len, samplesleft;
-	Sint8 nybble, stereo;
-	Sint16 *coeff[2];
+	const Uint8 *block;
+	Sint32 samplesleft;
+	Uint8 nybble;
+	Sint8 stereo;
+	const Sint16 *coeff[2];
 	Sint32 new_sample;
 
-	/* Allocate the proper sized output buffer */
-	encoded_len = *audio_len;
-	encoded = *audio_buf;
-	encoded_end = encoded + encoded_len;
-	freeable = *audio_buf;
-	*audio_len = (encoded_len/MS_ADPCM_state.wavefmt.blockalign) * 
-				MS_ADPCM_state.wSamplesPerBlock*
-				MS_ADPCM_state.wavefmt.channels*sizeof(Sint16);
-	*audio_buf = (Uint8 *)SDL_malloc(*audio_len);
-	if ( *audio_buf == NULL ) {
-		SDL_Error(SDL_ENOMEM);
-		return(-1);
-	}
-	decoded = *audio_buf;
-	decoded_end = decoded + *audio_len;
-
 	/* Get ready... Go! */
-	stereo = (MS_ADPCM_state.wavefmt.channels == 2);
-	state[0] = &MS_ADPCM_state.state[0];
-	state[1] = &MS_ADPCM_state.state[stereo];
-	while ( encoded_len >= MS_ADPCM_state.wavefmt.blockalign ) {
+	stereo = (dec->wavefmt.channels == 2);
+	state[0] = &states[0];
+	state[1] = &states[stereo];
+	for ( block = encoded; nblocks--; block += dec->blocksize ) {
+		encoded = block;
+
 		/* Grab the initial information for this block */
-		if (encoded + 7 + (stereo ? 7 : 0) > encoded_end) goto invalid_size;
 		state[0]->hPredictor = *encoded++;
 		if ( stereo ) {
 			state[1]->hPredictor = *encoded++;
 		}
 		if (state[0]->hPredictor >= 7 || state[1]->hPredictor >= 7) {
-			goto invalid_predictor;
+			SDL_SetError("Invalid predictor value for a MS ADPCM decoder");
+			return(-1);
 		}
 		state[0]->iDelta = ((encoded[1]<<8)|encoded[0]);
 		encoded += sizeof(Sint16);
@@ -176,11 +184,10 @@ static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 			state[1]->iSamp2 = ((encoded[1]<<8)|encoded[0]);
 			encoded += sizeof(Sint16);
 		}
-		coeff[0] = MS_ADPCM_state.aCoeff[state[0]->hPredictor];
-		coeff[1] = MS_ADPCM_state.aCoeff[state[1]->hPredictor];
+		coeff[0] = dec->aCoeff[state[0]->hPredictor];
+		coeff[1] = dec->aCoeff[state[1]->hPredictor];
 
 		/* Store the two initial samples we start with */
-		if (decoded + 4 + (stereo ? 4 : 0) > decoded_end) goto invalid_size;
 		decoded[0] = state[0]->iSamp2&0xFF;
 		decoded[1] = state[0]->iSamp2>>8;
 		decoded += 2;
@@ -199,12 +206,8 @@ static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 		}
 
 		/* Decode and store the other samples in this block */
-		samplesleft = (MS_ADPCM_state.wSamplesPerBlock-2)*
-					MS_ADPCM_state.wavefmt.channels;
+		samplesleft = (dec->wSamplesPerBlock-2)*dec->wavefmt.channels;
 		while ( samplesleft > 0 ) {
-			if (encoded + 1 > encoded_end) goto invalid_size;
-			if (decoded + 4 > decoded_end) goto invalid_size;
-
 			nybble = (*encoded)>>4;
 			new_sample = MS_ADPCM_nibble(state[0],nybble,coeff[0]);
 			decoded[0] = new_sample&0xFF;
@@ -212,61 +215,54 @@ static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 			decoded[1] = new_sample&0xFF;
 			decoded += 2;
 
-			nybble = (*encoded)&0x0F;
-			new_sample = MS_ADPCM_nibble(state[1],nybble,coeff[1]);
-			decoded[0] = new_sample&0xFF;
-			new_sample >>= 8;
-			decoded[1] = new_sample&0xFF;
-			decoded += 2;
+			if ( samplesleft > 1 ) {
+				nybble = (*encoded)&0x0F;
+				new_sample = MS_ADPCM_nibble(state[1],nybble,coeff[1]);
+				decoded[0] = new_sample&0xFF;
+				new_sample >>= 8;
+				decoded[1] = new_sample&0xFF;
+				decoded += 2;
+			}
 
 			++encoded;
 			samplesleft -= 2;
 		}
-		encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
 	}
-	SDL_free(freeable);
 	return(0);
-invalid_size:
-	SDL_SetError("Unexpected chunk length for a MS ADPCM decoder");
-	SDL_free(freeable);
-	return(-1);
-invalid_predictor:
-	SDL_SetError("Invalid predictor value for a MS ADPCM decoder");
-	SDL_free(freeable);
-	return(-1);
 }
 
 struct IMA_ADPCM_decodestate {
 	Sint32 sample;
 	Sint8 index;
 };
-static struct IMA_ADPCM_decoder {
-	WaveFMT wavefmt;
-	Uint16 wSamplesPerBlock;
-	/* * * */
-	struct IMA_ADPCM_decodestate state[2];
-} IMA_ADPCM_state;
 
-static int InitIMA_ADPCM(WaveFMT *format, int length)
+static int InitIMA_ADPCM(WaveDecoder *dec, WaveFMT *format, int length)
 {
 	Uint8 *rogue_feel, *rogue_feel_end;
+	Uint32 channels;
 
 	/* Set the rogue pointer to the IMA_ADPCM specific data */
-	if (length < sizeof(*format)) goto too_short;
-	IMA_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-	IMA_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-	IMA_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-	IMA_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-	IMA_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-	IMA_ADPCM_state.wavefmt.bitspersample =
-					 SDL_SwapLE16(format->bitspersample);
 	rogue_feel = (Uint8 *)format+sizeof(*format);
 	rogue_feel_end = (Uint8 *)format + length;
 	if ( sizeof(*format) == 16 ) {
 		rogue_feel += sizeof(Uint16);
 	}
 	if (rogue_feel + 2 > rogue_feel_end) goto too_short;
-	IMA_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1]<<8)|rogue_feel[0]);
+	dec->wSamplesPerBlock = ((rogue_feel[1]<<8)|rogue_feel[0]);
+
+	/* Each block has a header per channel, then groups of 8 samples */
+	channels = dec->wavefmt.channels;
+	if ( (channels < 1) || (channels > 2) ) {
+		SDL_SetError("IMA ADPCM decoder can only handle %d channels", 2);
+		return(-1);
+	}
+	if ( (dec->wSamplesPerBlock < 1) ||
+	     ((dec->wSamplesPerBlock-1) % 8) != 0 ||
+	     (4 * channels + ((dec->wSamplesPerBlock-1) / 8) * 4 * channels >
+	      dec->wavefmt.blockalign) ) {
+		SDL_SetError("Unexpected chunk length for an IMA ADPCM decoder");
+		return(-1);
+	}
 	return(0);
 too_short:
 	SDL_SetError("Unexpected length of a chunk with an IMA ADPCM format");
@@ -326,7 +322,7 @@ static Sint32 IMA_ADPCM_nibble(struct IMA_ADPCM_decodestate *state,Uint8 nybble)
 }
 
 /* Fill the decode buffer with a channel block of data (8 samples) */
-static void Fill_IMA_ADPCM_block(Uint8 *decoded, Uint8 *encoded,
+static void Fill_IMA_ADPCM_block(Uint8 *decoded, const Uint8 *encoded,
 	int channel, int numchannels, struct IMA_ADPCM_decodestate *state)
 {
 	int i;
@@ -353,43 +349,21 @@ static void Fill_IMA_ADPCM_block(Uint8 *decoded, Uint8 *encoded,
 	}
 }
 
-static int IMA_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
+static int IMA_ADPCM_decode(const WaveDecoder *dec,
+                            const Uint8 *encoded, Uint8 *decoded, Uint32 nblocks)
 {
-	struct IMA_ADPCM_decodestate *state;
-	Uint8 *freeable, *encoded, *encoded_end, *decoded, *decoded_end;
-	Sint32 encoded_len, samplesleft;
+	struct IMA_ADPCM_decodestate state[2];
+	const Uint8 *block;
+	Sint32 samplesleft;
 	unsigned int c, channels;
 
-	/* Check to make sure we have enough variables in the state array */
-	channels = IMA_ADPCM_state.wavefmt.channels;
-	if ( channels > SDL_arraysize(IMA_ADPCM_state.state) ) {
-		SDL_SetError("IMA ADPCM decoder can only handle %d channels",
-					SDL_arraysize(IMA_ADPCM_state.state));
-		return(-1);
-	}
-	state = IMA_ADPCM_state.state;
-
-	/* Allocate the proper sized output buffer */
-	encoded_len = *audio_len;
-	encoded = *audio_buf;
-	encoded_end = encoded + encoded_len;
-	freeable = *audio_buf;
-	*audio_len = (encoded_len/IMA_ADPCM_state.wavefmt.blockalign) * 
-				IMA_ADPCM_state.wSamplesPerBlock*
-				IMA_ADPCM_state.wavefmt.channels*sizeof(Sint16);
-	*audio_buf = (Uint8 *)SDL_malloc(*audio_len);
-	if ( *audio_buf == NULL ) {
-		SDL_Error(SDL_ENOMEM);
-		return(-1);
-	}
-	decoded = *audio_buf;
-	decoded_end = decoded + *audio_len;
-
 	/* Get ready... Go! */
-	while ( encoded_len >= IMA_ADPCM_state.wavefmt.blockalign ) {
+	channels = dec->wavefmt.channels;
+	for ( block = encoded; nblocks--; block += dec->blocksize ) {
+		encoded = block;
+
 		/* Grab the initial information for this block */
 		for ( c=0; c<channels; ++c ) {
-			if (encoded + 4 > encoded_end) goto invalid_size;
 			/* Fill the state information for this block */
 			state[c].sample = ((encoded[1]<<8)|encoded[0]);
 			encoded += 2;
@@ -403,19 +377,15 @@ static int IMA_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 			}
 
 			/* Store the initial sample we start with */
-			if (decoded + 2 > decoded_end) goto invalid_size;
 			decoded[0] = (Uint8)(state[c].sample&0xFF);
 			decoded[1] = (Uint8)(state[c].sample>>8);
 			decoded += 2;
 		}
 
 		/* Decode and store the other samples in this block */
-		samplesleft = (IMA_ADPCM_state.wSamplesPerBlock-1)*channels;
+		samplesleft = (dec->wSamplesPerBlock-1)*channels;
 		while ( samplesleft > 0 ) {
 			for ( c=0; c<channels; ++c ) {
-				if (encoded + 4 > encoded_end) goto invalid_size;
-				if (decoded + 4 * 4 * channels > decoded_end)
-					goto invalid_size;
 				Fill_IMA_ADPCM_block(decoded, encoded,
 						c, channels, &state[c]);
 				encoded += 4;
@@ -423,57 +393,259 @@ static int IMA_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 			}
 			decoded += (channels * 8 * 2);
 		}
-		encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
 	}
-	SDL_free(freeable);
 	return(0);
-invalid_size:
-	SDL_SetError("Unexpected chunk length for an IMA ADPCM decoder");
-	SDL_free(freeable);
-	return(-1);
 }
 
-SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
-		SDL_AudioSpec *spec, Uint8 **audio_buf, Uint32 *audio_len)
+/* 8 and 16-bit PCM is used as-is */
+static int PCM_decode(const WaveDecoder *dec,
+                      const Uint8 *encoded, Uint8 *decoded, Uint32 nblocks)
+{
+	if ( encoded != decoded ) {
+		SDL_memmove(decoded, encoded, nblocks * dec->blocksize);
+	}
+	return(0);
+}
+
+/* 24 and 32-bit PCM keeps the top 16 bits of each sample.
+   This works in place, since the output is never larger than the input.
+ */
+static int PCM_decode_wide(const WaveDecoder *dec,
+                           const Uint8 *encoded, Uint8 *decoded, Uint32 nblocks)
+{
+	const Uint32 width = dec->wavefmt.bitspersample / 8;
+	const Uint32 skip = dec->blocksize - width * dec->wavefmt.channels;
+	Uint32 c;
+
+	while ( nblocks-- ) {
+		for ( c = 0; c < dec->wavefmt.channels; ++c ) {
+			decoded[0] = encoded[width-2];
+			decoded[1] = encoded[width-1];
+			decoded += 2;
+			encoded += width;
+		}
+		encoded += skip;
+	}
+	return(0);
+}
+
+/* 32 and 64-bit IEEE float is clamped and scaled to 16-bit */
+static int FLOAT_decode(const WaveDecoder *dec,
+                        const Uint8 *encoded, Uint8 *decoded, Uint32 nblocks)
+{
+	const Uint32 width = dec->wavefmt.bitspersample / 8;
+	const Uint32 skip = dec->blocksize - width * dec->wavefmt.channels;
+	union { Uint32 u; float f; } f32;
+#ifdef SDL_HAS_64BIT_TYPE
+	union { Uint64 u; double d; } f64;
+#endif
+	double value;
+	Sint32 sample;
+	Uint32 c;
+
+	while ( nblocks-- ) {
+		for ( c = 0; c < dec->wavefmt.channels; ++c ) {
+#ifdef SDL_HAS_64BIT_TYPE
+			if ( width == 8 ) {
+				SDL_memcpy(&f64.u, encoded, 8);
+				f64.u = SDL_SwapLE64(f64.u);
+				value = f64.d;
+			} else
+#endif
+			{
+				SDL_memcpy(&f32.u, encoded, 4);
+				f32.u = SDL_SwapLE32(f32.u);
+				value = f32.f;
+			}
+			encoded += width;
+
+			if ( value >= 1.0 ) {
+				sample = 32767;
+			} else if ( value <= -1.0 ) {
+				sample = -32768;
+			} else {
+				sample = (Sint32)(value * 32768.0);
+				if ( sample > 32767 ) {
+					sample = 32767;
+				}
+			}
+			decoded[0] = (Uint8)(sample & 0xFF);
+			decoded[1] = (Uint8)((sample >> 8) & 0xFF);
+			decoded += 2;
+		}
+		encoded += skip;
+	}
+	return(0);
+}
+
+/* Set up 'dec' for a PCM or float format chunk */
+static int InitPCM(WaveDecoder *dec)
+{
+	const Uint16 bits = dec->wavefmt.bitspersample;
+	const Uint16 channels = dec->wavefmt.channels;
+
+	if ( (bits == 0) || (bits % 8) != 0 ||
+	     (dec->wavefmt.blockalign < channels * (bits / 8)) ) {
+		SDL_SetError("Unexpected block alignment for %d-bit PCM", bits);
+		return(-1);
+	}
+	dec->wSamplesPerBlock = 1;
+	if ( dec->encoding == IEEE_FLOAT_CODE ) {
+		if ( (bits != 32) && (bits != 64) ) {
+			SDL_SetError("Unknown %d-bit float data format", bits);
+			return(-1);
+		}
+#ifndef SDL_HAS_64BIT_TYPE
+		if ( bits == 64 ) {
+			SDL_SetError("64-bit float data not supported");
+			return(-1);
+		}
+#endif
+		dec->decode = FLOAT_decode;
+		return(0);
+	}
+	switch (bits) {
+		case 8:
+		case 16:
+			/* Padded frames need to be repacked */
+			if ( dec->wavefmt.blockalign == channels * (bits / 8) ) {
+				dec->decode = PCM_decode;
+			} else {
+				dec->decode = PCM_decode_wide;
+			}
+			if ( bits == 8 && dec->decode != PCM_decode ) {
+				SDL_SetError("Unexpected block alignment for %d-bit PCM", bits);
+				return(-1);
+			}
+			break;
+		case 24:
+		case 32:
+			dec->decode = PCM_decode_wide;
+			break;
+		default:
+			SDL_SetError("Unknown %d-bit PCM data format", bits);
+			return(-1);
+	}
+	return(0);
+}
+
+/* Parse the format chunk into a decoder and matching audio spec */
+static int InitWaveDecoder(WaveDecoder *dec, WaveFMT *format, int length,
+                           SDL_AudioSpec *spec)
+{
+	SDL_memset(dec, 0, sizeof(*dec));
+	if ( length < 16 ) {
+		SDL_SetError("Unexpected length of a WAVE format chunk");
+		return(-1);
+	}
+	dec->wavefmt.encoding = SDL_SwapLE16(format->encoding);
+	dec->wavefmt.channels = SDL_SwapLE16(format->channels);
+	dec->wavefmt.frequency = SDL_SwapLE32(format->frequency);
+	dec->wavefmt.byterate = SDL_SwapLE32(format->byterate);
+	dec->wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
+	dec->wavefmt.bitspersample = SDL_SwapLE16(format->bitspersample);
+	dec->encoding = dec->wavefmt.encoding;
+
+	/* The real format code is the start of the SubFormat GUID */
+	if ( dec->encoding == EXTENSIBLE_CODE ) {
+		const Uint8 *ext = (const Uint8 *)format + 16;
+		if ( length < 40 ) {
+			SDL_SetError("Unexpected length of a WAVE_FORMAT_EXTENSIBLE chunk");
+			return(-1);
+		}
+		dec->encoding = ((ext[9]<<8)|ext[8]);
+
+		/* The ADPCM fields would be where wValidBitsPerSample is */
+		if ( (dec->encoding == MS_ADPCM_CODE) ||
+		     (dec->encoding == IMA_ADPCM_CODE) ) {
+			SDL_SetError("ADPCM in a WAVE_FORMAT_EXTENSIBLE chunk not supported");
+			return(-1);
+		}
+	}
+
+	if ( (dec->wavefmt.channels == 0) || (dec->wavefmt.blockalign == 0) ) {
+		SDL_SetError("Invalid WAVE format chunk");
+		return(-1);
+	}
+
+	switch (dec->encoding) {
+		case PCM_CODE:
+		case IEEE_FLOAT_CODE:
+			if ( InitPCM(dec) < 0 ) {
+				return(-1);
+			}
+			break;
+		case MS_ADPCM_CODE:
+			/* Try to understand this */
+			if ( InitMS_ADPCM(dec, format, length) < 0 ) {
+				return(-1);
+			}
+			dec->decode = MS_ADPCM_decode;
+			break;
+		case IMA_ADPCM_CODE:
+			/* Try to understand this */
+			if ( InitIMA_ADPCM(dec, format, length) < 0 ) {
+				return(-1);
+			}
+			dec->decode = IMA_ADPCM_decode;
+			break;
+		case MP3_CODE:
+			SDL_SetError("MPEG Layer 3 data not supported");
+			return(-1);
+		default:
+			SDL_SetError("Unknown WAVE data format: 0x%.4x",
+					dec->encoding);
+			return(-1);
+	}
+
+	SDL_memset(spec, 0, (sizeof *spec));
+	spec->freq = dec->wavefmt.frequency;
+	if ( (dec->encoding == PCM_CODE) && (dec->wavefmt.bitspersample == 8) ) {
+		spec->format = AUDIO_U8;
+	} else {
+		spec->format = AUDIO_S16;
+	}
+	spec->channels = (Uint8)dec->wavefmt.channels;
+	spec->samples = 4096;		/* Good default buffer size */
+
+	dec->blocksize = dec->wavefmt.blockalign;
+	dec->decodedsize = dec->wSamplesPerBlock * spec->channels *
+	                   ((spec->format & 0xFF) / 8);
+	return(0);
+}
+
+/* Read the RIFF header and format chunk, leaving 'src' at the start of the
+   data chunk contents.  'riffend' is set to the end of the RIFF chunk.
+ */
+static int ReadWaveHeader(SDL_RWops *src, WaveDecoder *dec,
+                          SDL_AudioSpec *spec, Uint32 *datalen, int *riffend)
 {
-	int was_error;
 	Chunk chunk;
 	int lenread;
-	int MS_ADPCM_encoded, IMA_ADPCM_encoded;
-	int samplesize;
+	int start;
 
 	/* WAV magic header */
 	Uint32 RIFFchunk;
 	Uint32 wavelen = 0;
 	Uint32 WAVEmagic;
-	Uint32 headerDiff = 0;
-
-	/* FMT chunk */
-	WaveFMT *format = NULL;
 
-	/* Make sure we are passed a valid data source */
-	was_error = 0;
-	if ( src == NULL ) {
-		was_error = 1;
-		goto done;
-	}
-		
 	/* Check the magic header */
+	start = SDL_RWtell(src);
 	RIFFchunk	= SDL_ReadLE32(src);
 	wavelen		= SDL_ReadLE32(src);
 	if ( wavelen == WAVE ) { /* The RIFFchunk has already been read */
 		WAVEmagic = wavelen;
 		wavelen   = RIFFchunk;
 		RIFFchunk = RIFF;
+		start    -= sizeof(Uint32);
 	} else {
 		WAVEmagic = SDL_ReadLE32(src);
 	}
 	if ( (RIFFchunk != RIFF) || (WAVEmagic != WAVE) ) {
 		SDL_SetError("Unrecognized file type (not WAVE)");
-		was_error = 1;
-		goto done;
+		return(-1);
 	}
-	headerDiff += sizeof(Uint32); /* for WAVE */
+	*riffend = start + 2 * sizeof(Uint32) + wavelen;
 
 	/* Read the audio data format chunk */
 	chunk.data = NULL;
@@ -484,128 +656,191 @@ SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
 		}
 		lenread = ReadChunk(src, &chunk);
 		if ( lenread < 0 ) {
-			was_error = 1;
-			goto done;
+			return(-1);
 		}
-		/* 2 Uint32's for chunk header+len, plus the lenread */
-		headerDiff += lenread + 2 * sizeof(Uint32);
 	} while ( (chunk.magic == FACT) || (chunk.magic == LIST) );
 
 	/* Decode the audio data format */
-	format = (WaveFMT *)chunk.data;
 	if ( chunk.magic != FMT ) {
 		SDL_SetError("Complex WAVE files not supported");
+		SDL_free(chunk.data);
+		return(-1);
+	}
+	if ( InitWaveDecoder(dec, (WaveFMT *)chunk.data, lenread, spec) < 0 ) {
+		SDL_free(chunk.data);
+		return(-1);
+	}
+	SDL_free(chunk.data);
+
+	/* Find the audio data chunk, skipping anything else */
+	for ( ;; ) {
+		Uint32 header[2];
+
+		if ( SDL_ReadLE32Array(src, header, 2) != 2 ) {
+			SDL_SetError("No audio data chunk in WAVE file");
+			return(-1);
+		}
+		chunk.magic	= header[0];
+		chunk.length	= header[1];
+		if ( chunk.magic == DATA ) {
+			break;
+		}
+		if ( SDL_RWseek(src, chunk.length, RW_SEEK_CUR) < 0 ) {
+			SDL_Error(SDL_EFSEEK);
+			return(-1);
+		}
+	}
+	*datalen = chunk.length;
+	return(0);
+}
+
+typedef struct WaveDecodeJob {
+	const WaveDecoder *dec;
+	const Uint8 *encoded;
+	Uint8 *decoded;
+	int status;
+} WaveDecodeJob;
+
+static void SDLCALL WaveDecodeRange(void *data, int first, int last)
+{
+	WaveDecodeJob *job = (WaveDecodeJob *)data;
+	const WaveDecoder *dec = job->dec;
+
+	if ( dec->decode(dec, job->encoded + first * dec->blocksize,
+	                 job->decoded + first * dec->decodedsize,
+	                 (Uint32)(last - first)) < 0 ) {
+		job->status = -1;
+	}
+}
+
+/* Decode a run of blocks, splitting large runs over the thread pool.
+   ADPCM blocks carry their own predictor state, so they're independent.
+ */
+static int WaveDecodeBlocks(const WaveDecoder *dec, const Uint8 *encoded,
+                            Uint8 *decoded, Uint32 nblocks)
+{
+	WaveDecodeJob job;
+
+	/* PCM is decoded in place, which can't be split up */
+	if ( (nblocks < WAVE_PARALLEL_BLOCKS) || (nblocks > 0x7FFFFFFF) ||
+	     (encoded == decoded) ) {
+		return dec->decode(dec, encoded, decoded, nblocks);
+	}
+
+	job.dec = dec;
+	job.encoded = encoded;
+	job.decoded = decoded;
+	job.status = 0;
+	SDL_ParallelFor((int)nblocks, WAVE_PARALLEL_GRAIN, WaveDecodeRange, &job);
+	return(job.status);
+}
+
+SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
+		SDL_AudioSpec *spec, Uint8 **audio_buf, Uint32 *audio_len)
+{
+	int was_error;
+	WaveDecoder dec;
+	Uint32 datalen, nblocks;
+	Uint8 *encoded = NULL;
+	const Uint8 *mapped;
+	size_t maplen;
+	int riffend = 0;
+
+	/* Make sure we are passed a valid data source */
+	was_error = 0;
+	*audio_buf = NULL;
+	if ( src == NULL ) {
 		was_error = 1;
 		goto done;
 	}
-	MS_ADPCM_encoded = IMA_ADPCM_encoded = 0;
-	switch (SDL_SwapLE16(format->encoding)) {
-		case PCM_CODE:
-			/* We can understand this */
-			break;
-		case MS_ADPCM_CODE:
-			/* Try to understand this */
-			if ( InitMS_ADPCM(format, lenread) < 0 ) {
-				was_error = 1;
-				goto done;
-			}
-			MS_ADPCM_encoded = 1;
-			break;
-		case IMA_ADPCM_CODE:
-			/* Try to understand this */
-			if ( InitIMA_ADPCM(format, lenread) < 0 ) {
-				was_error = 1;
-				goto done;
-			}
-			IMA_ADPCM_encoded = 1;
-			break;
-		case MP3_CODE:
-			SDL_SetError("MPEG Layer 3 data not supported",
-					SDL_SwapLE16(format->encoding));
+
+	if ( ReadWaveHeader(src, &dec, spec, &datalen, &riffend) < 0 ) {
+		was_error = 1;
+		goto done;
+	}
+
+	/* Read the whole blocks of the audio data chunk */
+	nblocks = datalen / dec.blocksize;
+	datalen = nblocks * dec.blocksize;
+	*audio_len = nblocks * dec.decodedsize;
+
+	/* Nothing to decode, but still hand back a buffer to free */
+	if ( nblocks == 0 ) {
+		*audio_buf = (Uint8 *)SDL_malloc(1);
+		if ( *audio_buf == NULL ) {
+			SDL_Error(SDL_ENOMEM);
+			was_error = 1;
+		}
+		goto done;
+	}
+
+	/* Decode straight out of memory, if the data is there */
+	mapped = (const Uint8 *)SDL_RWmap(src, &maplen);
+	if ( mapped && maplen >= datalen ) {
+		*audio_buf = (Uint8 *)SDL_malloc(*audio_len);
+		if ( *audio_buf == NULL ) {
+			SDL_Error(SDL_ENOMEM);
 			was_error = 1;
 			goto done;
-		default:
-			SDL_SetError("Unknown WAVE data format: 0x%.4x",
-					SDL_SwapLE16(format->encoding));
+		}
+		if ( WaveDecodeBlocks(&dec, mapped, *audio_buf, nblocks) < 0 ) {
 			was_error = 1;
 			goto done;
+		}
+		SDL_RWseek(src, datalen, RW_SEEK_CUR);
+		goto done;
 	}
-	SDL_memset(spec, 0, (sizeof *spec));
-	spec->freq = SDL_SwapLE32(format->frequency);
-	switch (SDL_SwapLE16(format->bitspersample)) {
-		case 4:
-			if ( MS_ADPCM_encoded || IMA_ADPCM_encoded ) {
-				spec->format = AUDIO_S16;
-			} else {
-				was_error = 1;
-			}
-			break;
-		case 8:
-			spec->format = AUDIO_U8;
-			break;
-		case 16:
-			spec->format = AUDIO_S16;
-			break;
-		default:
-			was_error = 1;
-			break;
+
+	encoded = (Uint8 *)SDL_malloc(datalen);
+	if ( encoded == NULL ) {
+		SDL_Error(SDL_ENOMEM);
+		was_error = 1;
+		goto done;
 	}
-	if ( was_error ) {
-		SDL_SetError("Unknown %d-bit PCM data format",
-			SDL_SwapLE16(format->bitspersample));
+	if ( SDL_RWread(src, encoded, datalen, 1) != 1 ) {
+		SDL_Error(SDL_EFREAD);
+		was_error = 1;
 		goto done;
 	}
-	spec->channels = (Uint8)SDL_SwapLE16(format->channels);
-	spec->samples = 4096;		/* Good default buffer size */
 
-	/* Read the audio data chunk */
-	*audio_buf = NULL;
-	do {
-		if ( *audio_buf != NULL ) {
-			SDL_free(*audio_buf);
-			*audio_buf = NULL;
-		}
-		lenread = ReadChunk(src, &chunk);
-		if ( lenread < 0 ) {
+	/* Decode in place unless the data grows */
+	if ( dec.decodedsize <= dec.blocksize ) {
+		*audio_buf = encoded;
+		encoded = NULL;
+		if ( dec.decode(&dec, *audio_buf, *audio_buf, nblocks) < 0 ) {
 			was_error = 1;
 			goto done;
 		}
-		*audio_len = lenread;
-		*audio_buf = chunk.data;
-		if(chunk.magic != DATA) headerDiff += lenread + 2 * sizeof(Uint32);
-	} while ( chunk.magic != DATA );
-	headerDiff += 2 * sizeof(Uint32); /* for the data chunk and len */
-
-	if ( MS_ADPCM_encoded ) {
-		if ( MS_ADPCM_decode(audio_buf, audio_len) < 0 ) {
+	} else {
+		*audio_buf = (Uint8 *)SDL_malloc(*audio_len);
+		if ( *audio_buf == NULL ) {
+			SDL_Error(SDL_ENOMEM);
 			was_error = 1;
 			goto done;
 		}
-	}
-	if ( IMA_ADPCM_encoded ) {
-		if ( IMA_ADPCM_decode(audio_buf, audio_len) < 0 ) {
+		if ( WaveDecodeBlocks(&dec, encoded, *audio_buf, nblocks) < 0 ) {
 			was_error = 1;
 			goto done;
 		}
 	}
 
-	/* Don't return a buffer that isn't a multiple of samplesize */
-	samplesize = ((spec->format & 0xFF)/8)*spec->channels;
-	*audio_len &= ~(samplesize-1);
-
 done:
-	if ( format != NULL ) {
-		SDL_free(format);
+	if ( encoded != NULL ) {
+		SDL_free(encoded);
 	}
 	if ( src ) {
 		if ( freesrc ) {
 			SDL_RWclose(src);
-		} else {
+		} else if ( riffend ) {
 			/* seek to the end of the file (given by the RIFF chunk) */
-			SDL_RWseek(src, wavelen - chunk.length - headerDiff, RW_SEEK_CUR);
+			SDL_RWseek(src, riffend, RW_SEEK_SET);
 		}
 	}
 	if ( was_error ) {
+		if ( *audio_buf != NULL ) {
+			SDL_free(*audio_buf);
+			*audio_buf = NULL;
+		}
 		spec = NULL;
 	}
 	return(spec);
@@ -621,10 +856,187 @@ void SDL_FreeWAV(Uint8 *audio_buf)
 	}
 }
 
+/* Incremental WAVE decoding */
+struct SDL_WAVStream {
+	SDL_RWops *src;
+	int freesrc;
+	WaveDecoder dec;
+
+	/* Position of the audio data in the source */
+	int data_start;
+	Uint32 data_len;
+	Uint32 data_pos;
+
+	/* A batch of encoded blocks */
+	Uint8 *encoded;
+	Uint32 batch;
+
+	/* One decoded block, for reads that end in the middle of a block */
+	Uint8 *decoded;
+	Uint32 decoded_pos;
+	Uint32 decoded_len;
+};
+
+SDL_WAVStream * SDL_OpenWAVStream_RW(SDL_RWops *src, int freesrc,
+                                     SDL_AudioSpec *spec)
+{
+	SDL_WAVStream *wav;
+	int riffend;
+	Uint32 datalen;
+
+	if ( src == NULL ) {
+		return(NULL);
+	}
+	wav = (SDL_WAVStream *)SDL_malloc(sizeof(*wav));
+	if ( wav == NULL ) {
+		SDL_OutOfMemory();
+		if ( freesrc ) {
+			SDL_RWclose(src);
+		}
+		return(NULL);
+	}
+	SDL_memset(wav, 0, sizeof(*wav));
+	wav->src = src;
+	wav->freesrc = freesrc;
+
+	if ( ReadWaveHeader(src, &wav->dec, spec, &datalen, &riffend) < 0 ) {
+		SDL_CloseWAVStream(wav);
+		return(NULL);
+	}
+	wav->data_start = SDL_RWtell(src);
+	wav->data_len = (datalen / wav->dec.blocksize) * wav->dec.blocksize;
+
+	wav->batch = WAVE_STREAM_BATCH / wav->dec.blocksize;
+	if ( wav->batch == 0 ) {
+		wav->batch = 1;
+	}
+	wav->encoded = (Uint8 *)SDL_malloc(wav->batch * wav->dec.blocksize);
+	wav->decoded = (Uint8 *)SDL_malloc(wav->dec.decodedsize);
+	if ( (wav->encoded == NULL) || (wav->decoded == NULL) ) {
+		SDL_OutOfMemory();
+		SDL_CloseWAVStream(wav);
+		return(NULL);
+	}
+	return(wav);
+}
+
+/* Read and decode 'nblocks' whole blocks into 'dst' */
+static int ReadWAVBlocks(SDL_WAVStream *wav, Uint8 *dst, Uint32 nblocks)
+{
+	const WaveDecoder *dec = &wav->dec;
+	Uint32 len = nblocks * dec->blocksize;
+	const Uint8 *mapped;
+	size_t maplen;
+	Uint8 *encoded;
+
+	/* Decode straight out of memory, if the data is there */
+	mapped = (const Uint8 *)SDL_RWmap(wav->src, &maplen);
+	if ( mapped && maplen >= len ) {
+		if ( SDL_RWseek(wav->src, len, RW_SEEK_CUR) < 0 ) {
+			return(-1);
+		}
+		wav->data_pos += len;
+		return dec->decode(dec, mapped, dst, nblocks);
+	}
+
+	/* Plain PCM can be read straight into the caller's buffer */
+	encoded = (dec->decode == PCM_decode) ? dst : wav->encoded;
+	if ( SDL_RWread(wav->src, encoded, len, 1) != 1 ) {
+		SDL_Error(SDL_EFREAD);
+		return(-1);
+	}
+	wav->data_pos += len;
+	return dec->decode(dec, encoded, dst, nblocks);
+}
+
+int SDL_ReadWAVStream(SDL_WAVStream *wav, Uint8 *buf, Uint32 len)
+{
+	const WaveDecoder *dec = &wav->dec;
+	Uint32 total = 0;
+	Uint32 n, nblocks;
+
+	while ( len > 0 ) {
+		/* Use up what's left of a partially read block first */
+		if ( wav->decoded_pos < wav->decoded_len ) {
+			n = wav->decoded_len - wav->decoded_pos;
+			if ( n > len ) {
+				n = len;
+			}
+			SDL_memcpy(buf, wav->decoded + wav->decoded_pos, n);
+			wav->decoded_pos += n;
+			buf += n;
+			len -= n;
+			total += n;
+			continue;
+		}
+		if ( wav->data_pos >= wav->data_len ) {
+			break;
+		}
+
+		nblocks = (wav->data_len - wav->data_pos) / dec->blocksize;
+		if ( nblocks > wav->batch ) {
+			nblocks = wav->batch;
+		}
+		if ( len >= dec->decodedsize ) {
+			/* Decode whole blocks straight into the caller's buffer */
+			if ( nblocks > len / dec->decodedsize ) {
+				nblocks = len / dec->decodedsize;
+			}
+			if ( ReadWAVBlocks(wav, buf, nblocks) < 0 ) {
+				return(-1);
+			}
+			n = nblocks * dec->decodedsize;
+			buf += n;
+			len -= n;
+			total += n;
+		} else {
+			if ( ReadWAVBlocks(wav, wav->decoded, 1) < 0 ) {
+				return(-1);
+			}
+			wav->decoded_pos = 0;
+			wav->decoded_len = dec->decodedsize;
+		}
+	}
+	return(total);
+}
+
+int SDL_RewindWAVStream(SDL_WAVStream *wav)
+{
+	if ( SDL_RWseek(wav->src, wav->data_start, RW_SEEK_SET) < 0 ) {
+		return(-1);
+	}
+	wav->data_pos = 0;
+	wav->decoded_pos = wav->decoded_len = 0;
+	return(0);
+}
+
+void SDL_CloseWAVStream(SDL_WAVStream *wav)
+{
+	if ( wav == NULL ) {
+		return;
+	}
+	if ( wav->freesrc ) {
+		SDL_RWclose(wav->src);
+	}
+	if ( wav->encoded ) {
+		SDL_free(wav->encoded);
+	}
+	if ( wav->decoded ) {
+		SDL_free(wav->decoded);
+	}
+	SDL_free(wav);
+}
+
 static int ReadChunk(SDL_RWops *src, Chunk *chunk)
 {
-	chunk->magic	= SDL_ReadLE32(src);
-	chunk->length	= SDL_ReadLE32(src);
+	Uint32 header[2];
+
+	if ( SDL_ReadLE32Array(src, header, 2) != 2 ) {
+		SDL_Error(SDL_EFREAD);
+		return(-1);
+	}
+	chunk->magic	= header[0];
+	chunk->length	= header[1];
 	chunk->data = (Uint8 *)SDL_malloc(chunk->length);
 	if ( chunk->data == NULL ) {
 		SDL_Error(SDL_ENOMEM);
@@ -49,6 +49,7 @@ static void ALSA_WaitAudio(_THIS);
 static void ALSA_PlayAudio(_THIS);
 static Uint8 *ALSA_GetAudioBuf(_THIS);
 static void ALSA_CloseAudio(_THIS);
+static int ALSA_GetLatency(_THIS);
 
 #ifdef SDL_AUDIO_DRIVER_ALSA_DYNAMIC
 
@@ -61,6 +62,14 @@ static int (*SDL_NAME(snd_pcm_close))(snd_pcm_t *pcm);
 static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_writei))(snd_pcm_t *pcm, const void *buffer, snd_pcm_uframes_t size);
 static int (*SDL_NAME(snd_pcm_resume))(snd_pcm_t *pcm);
 static int (*SDL_NAME(snd_pcm_prepare))(snd_pcm_t *pcm);
+static int (*SDL_NAME(snd_pcm_delay))(snd_pcm_t *pcm, snd_pcm_sframes_t *delayp);
+static int (*SDL_NAME(snd_pcm_start))(snd_pcm_t *pcm);
+static snd_pcm_state_t (*SDL_NAME(snd_pcm_state))(snd_pcm_t *pcm);
+static int (*SDL_NAME(snd_pcm_wait))(snd_pcm_t *pcm, int timeout);
+static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_avail_update))(snd_pcm_t *pcm);
+static int (*SDL_NAME(snd_pcm_mmap_begin))(snd_pcm_t *pcm, const snd_pcm_channel_area_t **areas, snd_pcm_uframes_t *offset, snd_pcm_uframes_t *frames);
+static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_mmap_commit))(snd_pcm_t *pcm, snd_pcm_uframes_t offset, snd_pcm_uframes_t frames);
+static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_mmap_writei))(snd_pcm_t *pcm, const void *buffer, snd_pcm_uframes_t size);
 static const char *(*SDL_NAME(snd_strerror))(int errnum);
 static size_t (*SDL_NAME(snd_pcm_hw_params_sizeof))(void);
 static size_t (*SDL_NAME(snd_pcm_sw_params_sizeof))(void);
@@ -99,6 +108,14 @@ static struct {
 	{ "snd_pcm_writei",	(void**)(char*)&SDL_NAME(snd_pcm_writei)	},
 	{ "snd_pcm_resume",	(void**)(char*)&SDL_NAME(snd_pcm_resume)	},
 	{ "snd_pcm_prepare",	(void**)(char*)&SDL_NAME(snd_pcm_prepare)	},
+	{ "snd_pcm_delay",	(void**)(char*)&SDL_NAME(snd_pcm_delay)	},
+	{ "snd_pcm_start",	(void**)(char*)&SDL_NAME(snd_pcm_start)	},
+	{ "snd_pcm_state",	(void**)(char*)&SDL_NAME(snd_pcm_state)	},
+	{ "snd_pcm_wait",	(void**)(char*)&SDL_NAME(snd_pcm_wait)	},
+	{ "snd_pcm_avail_update",	(void**)(char*)&SDL_NAME(snd_pcm_avail_update)	},
+	{ "snd_pcm_mmap_begin",	(void**)(char*)&SDL_NAME(snd_pcm_mmap_begin)	},
+	{ "snd_pcm_mmap_commit",	(void**)(char*)&SDL_NAME(snd_pcm_mmap_commit)	},
+	{ "snd_pcm_mmap_writei",	(void**)(char*)&SDL_NAME(snd_pcm_mmap_writei)	},
 	{ "snd_strerror",	(void**)(char*)&SDL_NAME(snd_strerror)		},
 	{ "snd_pcm_hw_params_sizeof",		(void**)(char*)&SDL_NAME(snd_pcm_hw_params_sizeof)		},
 	{ "snd_pcm_sw_params_sizeof",		(void**)(char*)&SDL_NAME(snd_pcm_sw_params_sizeof)		},
@@ -238,6 +255,7 @@ static SDL_AudioDevice *Audio_CreateDevice(int devindex)
 	this->PlayAudio = ALSA_PlayAudio;
 	this->GetAudioBuf = ALSA_GetAudioBuf;
 	this->CloseAudio = ALSA_CloseAudio;
+	this->GetLatency = ALSA_GetLatency;
 
 	this->free = Audio_DeleteDevice;
 
@@ -249,10 +267,68 @@ AudioBootStrap ALSA_bootstrap = {
 	Audio_Available, Audio_CreateDevice
 };
 
+/* snd_pcm_recover() is available in alsa-lib >= 1.0.11 */
+static int ALSA_pcm_recover(snd_pcm_t *handle, int err, int silent)
+{
+	(void) silent;
+	if (err == -EINTR) return 0;
+	if (err == -EPIPE) {		/* under-run */
+		err = SDL_NAME(snd_pcm_prepare)(handle);
+		return (err < 0)? err : 0;
+	}
+	if (err == -ESTRPIPE) {
+		/* wait until suspend flag is released */
+		while ((err = SDL_NAME(snd_pcm_resume)(handle)) == -EAGAIN)
+			SDL_Delay(100);
+		if (err < 0) err = SDL_NAME(snd_pcm_prepare)(handle);
+		return (err < 0)? err : 0;
+	}
+	return err;
+}
+
+/* Recover from an error, counting under-runs; returns -1 if it's fatal */
+static int ALSA_handle_error(_THIS, int status)
+{
+	if ( status == -EPIPE ) {
+		SDL_AtomicIncRef(&this->xruns);
+	}
+	status = ALSA_pcm_recover(pcm_handle, status, 0);
+	if ( status < 0 ) {
+		/* Hmm, not much we can do - abort */
+		fprintf(stderr, "ALSA write failed (unrecoverable): %s\n", SDL_NAME(snd_strerror)(status));
+		this->enabled = 0;
+		return(-1);
+	}
+	return(0);
+}
+
 /* This function waits until it is possible to write a full sound buffer */
 static void ALSA_WaitAudio(_THIS)
 {
-	/* We're in blocking mode, so there's nothing to do here */
+	snd_pcm_sframes_t avail;
+
+	/* In blocking write mode there's nothing to do here */
+	if ( !use_mmap ) {
+		return;
+	}
+
+	while ( this->enabled ) {
+		avail = SDL_NAME(snd_pcm_avail_update)(pcm_handle);
+		if ( avail < 0 ) {
+			if ( ALSA_handle_error(this, (int)avail) < 0 ) {
+				return;
+			}
+			continue;
+		}
+		if ( avail >= (snd_pcm_sframes_t)this->spec.samples ) {
+			return;
+		}
+		/* Not started yet, so no space will ever free up */
+		if ( SDL_NAME(snd_pcm_state)(pcm_handle) == SND_PCM_STATE_PREPARED ) {
+			SDL_NAME(snd_pcm_start)(pcm_handle);
+		}
+		SDL_NAME(snd_pcm_wait)(pcm_handle, 1000);
+	}
 }
 
 
@@ -262,7 +338,7 @@ static void ALSA_WaitAudio(_THIS)
  *  and for Windows DirectX [and CoreAudio], this is FL-FR-C-LFE-RL-RR"
  */
 #define SWIZ6(T) \
-    T *ptr = (T *) mixbuf; \
+    T *ptr = (T *) buf; \
     Uint32 i; \
     for (i = 0; i < this->spec.samples; i++, ptr += 6) { \
         T tmp; \
@@ -270,79 +346,76 @@ static void ALSA_WaitAudio(_THIS)
         tmp = ptr[3]; ptr[3] = ptr[5]; ptr[5] = tmp; \
     }
 
-static __inline__ void swizzle_alsa_channels_6_64bit(_THIS) { SWIZ6(Uint64); }
-static __inline__ void swizzle_alsa_channels_6_32bit(_THIS) { SWIZ6(Uint32); }
-static __inline__ void swizzle_alsa_channels_6_16bit(_THIS) { SWIZ6(Uint16); }
-static __inline__ void swizzle_alsa_channels_6_8bit(_THIS) { SWIZ6(Uint8); }
+static __inline__ void swizzle_alsa_channels_6_64bit(_THIS, void *buf) { SWIZ6(Uint64); }
+static __inline__ void swizzle_alsa_channels_6_32bit(_THIS, void *buf) { SWIZ6(Uint32); }
+static __inline__ void swizzle_alsa_channels_6_16bit(_THIS, void *buf) { SWIZ6(Uint16); }
+static __inline__ void swizzle_alsa_channels_6_8bit(_THIS, void *buf) { SWIZ6(Uint8); }
 
 #undef SWIZ6
 
 
 /*
- * Called right before feeding this->mixbuf to the hardware. Swizzle channels
- *  from Windows/Mac order to the format alsalib will want.
+ * Called right before handing a buffer to the hardware. Swizzle channels
+ *  from Windows/Mac order to the format alsalib will want.  This works in
+ *  place, so with mmap access it runs directly on the device ring.
  */
-static __inline__ void swizzle_alsa_channels(_THIS)
+static __inline__ void swizzle_alsa_channels(_THIS, void *buf)
 {
     if (this->spec.channels == 6) {
         const Uint16 fmtsize = (this->spec.format & 0xFF); /* bits/channel. */
         if (fmtsize == 16)
-            swizzle_alsa_channels_6_16bit(this);
+            swizzle_alsa_channels_6_16bit(this, buf);
         else if (fmtsize == 8)
-            swizzle_alsa_channels_6_8bit(this);
+            swizzle_alsa_channels_6_8bit(this, buf);
         else if (fmtsize == 32)
-            swizzle_alsa_channels_6_32bit(this);
+            swizzle_alsa_channels_6_32bit(this, buf);
         else if (fmtsize == 64)
-            swizzle_alsa_channels_6_64bit(this);
+            swizzle_alsa_channels_6_64bit(this, buf);
     }
 
     /* !!! FIXME: update this for 7.1 if needed, later. */
 }
 
 
-/* snd_pcm_recover() is available in alsa-lib >= 1.0.11 */
-static int ALSA_pcm_recover(snd_pcm_t *handle, int err, int silent)
+/* Commit a period that was mixed straight into the mmap area */
+static void ALSA_CommitMmap(_THIS)
 {
-	(void) silent;
-	if (err == -EINTR) return 0;
-	if (err == -EPIPE) {		/* under-run */
-		err = SDL_NAME(snd_pcm_prepare)(handle);
-		return (err < 0)? err : 0;
+	snd_pcm_sframes_t status;
+
+	mmap_pending = 0;
+	status = SDL_NAME(snd_pcm_mmap_commit)(pcm_handle, mmap_offset, this->spec.samples);
+	if ( status < 0 || (snd_pcm_uframes_t)status != this->spec.samples ) {
+		ALSA_handle_error(this, (status < 0) ? (int)status : -EPIPE);
+		return;
 	}
-	if (err == -ESTRPIPE) {
-		/* wait until suspend flag is released */
-		while ((err = SDL_NAME(snd_pcm_resume)(handle)) == -EAGAIN)
-			SDL_Delay(100);
-		if (err < 0) err = SDL_NAME(snd_pcm_prepare)(handle);
-		return (err < 0)? err : 0;
+	if ( SDL_NAME(snd_pcm_state)(pcm_handle) == SND_PCM_STATE_PREPARED ) {
+		SDL_NAME(snd_pcm_start)(pcm_handle);
 	}
-	return err;
 }
 
-static void ALSA_PlayAudio(_THIS)
+/* Write a period from the mixing buffer, copying it to the device */
+static void ALSA_WriteMixbuf(_THIS)
 {
 	int status;
 	snd_pcm_uframes_t frames_left;
 	const Uint8 *sample_buf = (const Uint8 *) mixbuf;
 	const int frame_size = (((int) (this->spec.format & 0xFF)) / 8) * this->spec.channels;
 
-	swizzle_alsa_channels(this);
-
 	frames_left = ((snd_pcm_uframes_t) this->spec.samples);
 
 	while ( frames_left > 0 && this->enabled ) {
-		status = SDL_NAME(snd_pcm_writei)(pcm_handle, sample_buf, frames_left);
+		if ( use_mmap ) {
+			status = SDL_NAME(snd_pcm_mmap_writei)(pcm_handle, sample_buf, frames_left);
+		} else {
+			status = SDL_NAME(snd_pcm_writei)(pcm_handle, sample_buf, frames_left);
+		}
 		if ( status < 0 ) {
 			if ( status == -EAGAIN ) {
 				/* Apparently snd_pcm_recover() doesn't handle this case. Foo. */
 				SDL_Delay(1);
 				continue;
 			}
-			status = ALSA_pcm_recover(pcm_handle, status, 0);
-			if ( status < 0 ) {
-				/* Hmm, not much we can do - abort */
-				fprintf(stderr, "ALSA write failed (unrecoverable): %s\n", SDL_NAME(snd_strerror)(status));
-				this->enabled = 0;
+			if ( ALSA_handle_error(this, status) < 0 ) {
 				return;
 			}
 			continue;
@@ -352,9 +425,68 @@ static void ALSA_PlayAudio(_THIS)
 	}
 }
 
+static void ALSA_PlayAudio(_THIS)
+{
+	if ( mmap_pending ) {
+		swizzle_alsa_channels(this, mmap_buf);
+		ALSA_CommitMmap(this);
+	} else {
+		swizzle_alsa_channels(this, mixbuf);
+		ALSA_WriteMixbuf(this);
+	}
+
+	/* Cache the delay here, the PCM handle belongs to the audio thread */
+	{ snd_pcm_sframes_t delay;
+		if ( SDL_NAME(snd_pcm_delay)(pcm_handle, &delay) == 0 ) {
+			pcm_delay = (delay > 0) ? (int)delay : 0;
+		}
+	}
+}
+
+static int ALSA_GetLatency(_THIS)
+{
+	return(pcm_delay);
+}
+
+/* Hand out a pointer into the device ring if a whole period fits there,
+   otherwise fall back to the mixing buffer.
+ */
 static Uint8 *ALSA_GetAudioBuf(_THIS)
 {
-	return(mixbuf);
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t offset, frames;
+	snd_pcm_sframes_t avail;
+
+	if ( !use_mmap ) {
+		return(mixbuf);
+	}
+
+	avail = SDL_NAME(snd_pcm_avail_update)(pcm_handle);
+	if ( avail < 0 ) {
+		if ( ALSA_handle_error(this, (int)avail) < 0 ) {
+			return(mixbuf);
+		}
+		avail = SDL_NAME(snd_pcm_avail_update)(pcm_handle);
+	}
+	if ( avail < (snd_pcm_sframes_t)this->spec.samples ) {
+		return(mixbuf);
+	}
+
+	frames = this->spec.samples;
+	if ( SDL_NAME(snd_pcm_mmap_begin)(pcm_handle, &areas, &offset, &frames) < 0 ) {
+		return(mixbuf);
+	}
+	if ( frames < this->spec.samples ) {
+		/* The period wraps around the end of the ring, give it back */
+		SDL_NAME(snd_pcm_mmap_commit)(pcm_handle, offset, 0);
+		return(mixbuf);
+	}
+
+	mmap_offset = offset;
+	mmap_buf = (Uint8 *)areas[0].addr + (areas[0].first / 8) +
+	           (offset * (areas[0].step / 8));
+	mmap_pending = 1;
+	return(mmap_buf);
 }
 
 static void ALSA_CloseAudio(_THIS)
@@ -486,6 +618,7 @@ static int ALSA_OpenAudio(_THIS, SDL_AudioSpec *spec)
 	unsigned int         rate;
 	unsigned int 	     channels;
 	Uint16               test_format;
+	const char          *env;
 
 	/* Open the audio device */
 	/* Name of device should depend on # channels in spec */
@@ -509,8 +642,21 @@ static int ALSA_OpenAudio(_THIS, SDL_AudioSpec *spec)
 		return(-1);
 	}
 
-	/* SDL only uses interleaved sample output */
-	status = SDL_NAME(snd_pcm_hw_params_set_access)(pcm_handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED);
+	/* SDL only uses interleaved sample output.  Prefer mmap access so the
+	   callback can mix straight into the device ring, unless disabled with
+	   SDL_AUDIO_ALSA_MMAP=0 or unsupported by the device.
+	 */
+	use_mmap = 0;
+	env = getenv("SDL_AUDIO_ALSA_MMAP");
+	if ( !env || SDL_atoi(env) ) {
+		status = SDL_NAME(snd_pcm_hw_params_set_access)(pcm_handle, hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+		if ( status >= 0 ) {
+			use_mmap = 1;
+		}
+	}
+	if ( !use_mmap ) {
+		status = SDL_NAME(snd_pcm_hw_params_set_access)(pcm_handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED);
+	}
 	if ( status < 0 ) {
 		SDL_SetError("Couldn't set interleaved access: %s", SDL_NAME(snd_strerror)(status));
 		ALSA_CloseAudio(this);
@@ -631,6 +777,8 @@ static int ALSA_OpenAudio(_THIS, SDL_AudioSpec *spec)
 		return(-1);
 	}
 	SDL_memset(mixbuf, spec->silence, spec->size);
+	pcm_delay = 0;
+	mmap_pending = 0;
 
 	/* We're ready to rock and roll. :-) */
 	return(0);
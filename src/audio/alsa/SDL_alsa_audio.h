@@ -38,11 +38,25 @@ struct SDL_PrivateAudioData {
 	/* Raw mixing buffer */
 	Uint8 *mixbuf;
 	int    mixlen;
+
+	/* Frames queued in the device after the last write */
+	int    pcm_delay;
+
+	/* Direct access to the device ring buffer */
+	int    use_mmap;
+	int    mmap_pending;
+	Uint8 *mmap_buf;
+	snd_pcm_uframes_t mmap_offset;
 };
 
 /* Old variable names */
 #define pcm_handle		(this->hidden->pcm_handle)
 #define mixbuf			(this->hidden->mixbuf)
 #define mixlen			(this->hidden->mixlen)
+#define pcm_delay		(this->hidden->pcm_delay)
+#define use_mmap		(this->hidden->use_mmap)
+#define mmap_pending		(this->hidden->mmap_pending)
+#define mmap_buf		(this->hidden->mmap_buf)
+#define mmap_offset		(this->hidden->mmap_offset)
 
 #endif /* _ALSA_PCM_audio_h */
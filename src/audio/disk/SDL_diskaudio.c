@@ -23,7 +23,13 @@
 */
 #include "SDL_config.h"
 
-/* Output raw audio data to a file. */
+/* Output raw audio data to a file.
+
+   Setting SDL_DISKAUDIOOFFLINE=1 writes a WAVE file instead and runs the
+   audio thread as fast as the callback allows, for offline rendering.
+   Setting SDL_DISKAUDIOCLOCK=1 makes SDL_GetAudioTicks() follow the
+   amount of audio written rather than the system clock.
+ */
 
 #if HAVE_STDIO_H
 #include <stdio.h>
@@ -31,10 +37,12 @@
 
 #include "SDL_rwops.h"
 #include "SDL_timer.h"
+#include "SDL_atomic.h"
 #include "SDL_audio.h"
 #include "../SDL_audiomem.h"
 #include "../SDL_audio_c.h"
 #include "../SDL_audiodev_c.h"
+#include "../SDL_wave.h"
 #include "SDL_diskaudio.h"
 
 /* The tag name used by DISK audio */
@@ -45,6 +53,14 @@
 #define DISKDEFAULT_OUTFILE      "sdlaudio.raw"
 #define DISKENVR_WRITEDELAY      "SDL_DISKAUDIODELAY"
 #define DISKDEFAULT_WRITEDELAY   150
+#define DISKENVR_OFFLINE         "SDL_DISKAUDIOOFFLINE"
+#define DISKENVR_CLOCK           "SDL_DISKAUDIOCLOCK"
+
+/* Size of the RIFF/WAVE header written in offline mode */
+#define WAVE_HEADER_SIZE         44
+
+/* Most data a WAVE file can hold, as its RIFF chunk size is 32 bits */
+#define WAVE_MAX_DATALEN         (0xFFFFFFFF - (WAVE_HEADER_SIZE - 8))
 
 /* Audio driver functions */
 static int DISKAUD_OpenAudio(_THIS, SDL_AudioSpec *spec);
@@ -52,6 +68,14 @@ static void DISKAUD_WaitAudio(_THIS);
 static void DISKAUD_PlayAudio(_THIS);
 static Uint8 *DISKAUD_GetAudioBuf(_THIS);
 static void DISKAUD_CloseAudio(_THIS);
+static int DISKAUD_GetLatency(_THIS);
+static Uint32 DISKAUD_GetTicks(_THIS);
+
+static SDL_bool DISKAUD_GetEnvFlag(const char *name)
+{
+	const char *envr = SDL_getenv(name);
+	return((envr && SDL_atoi(envr)) ? SDL_TRUE : SDL_FALSE);
+}
 
 static const char *DISKAUD_GetOutputFilename(void)
 {
@@ -98,6 +122,11 @@ static SDL_AudioDevice *DISKAUD_CreateDevice(int devindex)
 
 	envr = SDL_getenv(DISKENVR_WRITEDELAY);
 	this->hidden->write_delay = (envr) ? SDL_atoi(envr) : DISKDEFAULT_WRITEDELAY;
+	this->hidden->offline = DISKAUD_GetEnvFlag(DISKENVR_OFFLINE);
+	this->hidden->virtual_clock = DISKAUD_GetEnvFlag(DISKENVR_CLOCK);
+	if ( this->hidden->offline ) {
+		this->hidden->write_delay = 0;
+	}
 
 	/* Set the function pointers */
 	this->OpenAudio = DISKAUD_OpenAudio;
@@ -105,6 +134,10 @@ static SDL_AudioDevice *DISKAUD_CreateDevice(int devindex)
 	this->PlayAudio = DISKAUD_PlayAudio;
 	this->GetAudioBuf = DISKAUD_GetAudioBuf;
 	this->CloseAudio = DISKAUD_CloseAudio;
+	this->GetLatency = DISKAUD_GetLatency;
+	if ( this->hidden->virtual_clock ) {
+		this->GetTicks = DISKAUD_GetTicks;
+	}
 
 	this->free = DISKAUD_DeleteDevice;
 
@@ -119,7 +152,25 @@ AudioBootStrap DISKAUD_bootstrap = {
 /* This function waits until it is possible to write a full sound buffer */
 static void DISKAUD_WaitAudio(_THIS)
 {
-	SDL_Delay(this->hidden->write_delay);
+	if ( this->hidden->write_delay ) {
+		SDL_Delay(this->hidden->write_delay);
+	}
+}
+
+/* Bytes per sample frame */
+#define DISKAUD_FrameSize(this)	((this)->hidden->mixlen / (this)->spec.samples)
+
+static DISKAUD_Frames DISKAUD_GetFramesWritten(_THIS, Uint32 *start_ticks)
+{
+	DISKAUD_Frames frames;
+
+	SDL_AtomicLock(&this->hidden->frames_lock);
+	frames = this->hidden->frames_written;
+	if ( start_ticks ) {
+		*start_ticks = this->hidden->start_ticks;
+	}
+	SDL_AtomicUnlock(&this->hidden->frames_lock);
+	return(frames);
 }
 
 static void DISKAUD_PlayAudio(_THIS)
@@ -135,18 +186,97 @@ static void DISKAUD_PlayAudio(_THIS)
 	if ( (Uint32)written != this->hidden->mixlen ) {
 		this->enabled = 0;
 	}
+
+	/* The virtual clock starts with the first buffer written, and only
+	   counts what actually made it to the file */
+	if ( written > 0 ) {
+		SDL_AtomicLock(&this->hidden->frames_lock);
+		if ( this->hidden->frames_written == 0 ) {
+			this->hidden->start_ticks = SDL_GetTicks();
+		}
+		this->hidden->frames_written += written / DISKAUD_FrameSize(this);
+		SDL_AtomicUnlock(&this->hidden->frames_lock);
+	}
 #ifdef DEBUG_AUDIO
 	fprintf(stderr, "Wrote %d bytes of audio data\n", written);
 #endif
 }
 
+/* Milliseconds of audio written so far, read from any thread.
+   Like SDL_GetTicks(), it wraps around after about 49 days.
+ */
+static Uint32 DISKAUD_GetTicks(_THIS)
+{
+	DISKAUD_Frames frames = DISKAUD_GetFramesWritten(this, NULL);
+	Uint32 freq = this->spec.freq;
+
+	return (Uint32)((frames / freq) * 1000 + (frames % freq) * 1000 / freq);
+}
+
+/* Frames written to disk that the virtual clock hasn't "played" yet */
+static int DISKAUD_GetLatency(_THIS)
+{
+	DISKAUD_Frames written;
+	Uint32 start_ticks;
+	double played;
+
+	/* In offline mode everything written counts as played */
+	written = DISKAUD_GetFramesWritten(this, &start_ticks);
+	if ( this->hidden->offline || written == 0 ) {
+		return(0);
+	}
+	played = ((double)(SDL_GetTicks() - start_ticks) * this->spec.freq) / 1000.0;
+	if ( played >= (double)written ) {
+		return(0);
+	}
+	return((int)((double)written - played));
+}
+
 static Uint8 *DISKAUD_GetAudioBuf(_THIS)
 {
 	return(this->hidden->mixbuf);
 }
 
+/* Write a RIFF/WAVE header for the given amount of PCM data */
+static int DISKAUD_WriteWaveHeader(_THIS, Uint32 datalen)
+{
+	SDL_RWops *dst = this->hidden->output;
+	const Uint16 bits = (this->spec.format & 0xFF);
+	const Uint16 blockalign = (bits / 8) * this->spec.channels;
+
+	if ( SDL_RWseek(dst, 0, RW_SEEK_SET) < 0 ) {
+		return(-1);
+	}
+	SDL_WriteLE32(dst, RIFF);
+	SDL_WriteLE32(dst, WAVE_HEADER_SIZE - 8 + datalen);
+	SDL_WriteLE32(dst, WAVE);
+	SDL_WriteLE32(dst, FMT);
+	SDL_WriteLE32(dst, 16);
+	SDL_WriteLE16(dst, PCM_CODE);
+	SDL_WriteLE16(dst, this->spec.channels);
+	SDL_WriteLE32(dst, this->spec.freq);
+	SDL_WriteLE32(dst, this->spec.freq * blockalign);
+	SDL_WriteLE16(dst, blockalign);
+	SDL_WriteLE16(dst, bits);
+	SDL_WriteLE32(dst, DATA);
+	if ( !SDL_WriteLE32(dst, datalen) ) {
+		return(-1);
+	}
+	return(0);
+}
+
 static void DISKAUD_CloseAudio(_THIS)
 {
+	if ( this->hidden->offline && this->hidden->output != NULL ) {
+		/* Patch the header now that we know how much we wrote.
+		   Anything past what a WAVE file can hold is left out of it. */
+		const Uint32 framesize = DISKAUD_FrameSize(this);
+		DISKAUD_Frames frames = DISKAUD_GetFramesWritten(this, NULL);
+		if ( frames > WAVE_MAX_DATALEN / framesize ) {
+			frames = WAVE_MAX_DATALEN / framesize;
+		}
+		DISKAUD_WriteWaveHeader(this, (Uint32)frames * framesize);
+	}
 	if ( this->hidden->mixbuf != NULL ) {
 		SDL_FreeAudioMem(this->hidden->mixbuf);
 		this->hidden->mixbuf = NULL;
@@ -172,6 +302,24 @@ static int DISKAUD_OpenAudio(_THIS, SDL_AudioSpec *spec)
                     " audio driver!\n Writing to file [%s].\n", fname);
 #endif
 
+	if ( this->hidden->offline ) {
+		/* WAVE files hold unsigned 8-bit or signed little-endian 16-bit */
+		if ( (spec->format & 0xFF) == 8 ) {
+			spec->format = AUDIO_U8;
+		} else {
+			spec->format = AUDIO_S16LSB;
+		}
+		SDL_CalculateAudioSpec(spec);
+
+		/* Reserve space for the header, it's patched on close */
+		SDL_memcpy(&this->spec, spec, sizeof(this->spec));
+		if ( DISKAUD_WriteWaveHeader(this, 0) < 0 ) {
+			SDL_SetError("Couldn't write WAVE header to %s", fname);
+			return(-1);
+		}
+	}
+	this->hidden->frames_written = 0;
+
 	/* Allocate mixing buffer */
 	this->hidden->mixlen = spec->size;
 	this->hidden->mixbuf = (Uint8 *) SDL_AllocAudioMem(this->hidden->mixlen);
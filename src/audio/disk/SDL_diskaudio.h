@@ -25,17 +25,36 @@
 #define _SDL_diskaudio_h
 
 #include "SDL_rwops.h"
+#include "SDL_atomic.h"
 #include "../SDL_sysaudio.h"
 
 /* Hidden "this" pointer for the video functions */
 #define _THIS	SDL_AudioDevice *this
 
+/* A count of frames that won't wrap, where there's a type for it */
+#ifdef SDL_HAS_64BIT_TYPE
+typedef Uint64 DISKAUD_Frames;
+#else
+typedef Uint32 DISKAUD_Frames;
+#endif
+
 struct SDL_PrivateAudioData {
 	/* The file descriptor for the audio device */
 	SDL_RWops *output;
 	Uint8 *mixbuf;
 	Uint32 mixlen;
 	Uint32 write_delay;
+
+	/* Write a WAVE file as fast as possible instead of raw audio */
+	SDL_bool offline;
+
+	/* Drive SDL_GetAudioTicks() from the amount of audio written */
+	SDL_bool virtual_clock;
+
+	/* Used to report latency, and by the virtual clock */
+	SDL_SpinLock frames_lock;	/* The audio thread updates these */
+	Uint32 start_ticks;
+	DISKAUD_Frames frames_written;
 };
 
 #endif /* _SDL_diskaudio_h */
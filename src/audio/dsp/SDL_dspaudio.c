@@ -63,6 +63,7 @@ static void DSP_WaitAudio(_THIS);
 static void DSP_PlayAudio(_THIS);
 static Uint8 *DSP_GetAudioBuf(_THIS);
 static void DSP_CloseAudio(_THIS);
+static int DSP_GetLatency(_THIS);
 
 /* Audio driver bootstrap functions */
 
@@ -113,6 +114,7 @@ static SDL_AudioDevice *Audio_CreateDevice(int devindex)
 	this->PlayAudio = DSP_PlayAudio;
 	this->GetAudioBuf = DSP_GetAudioBuf;
 	this->CloseAudio = DSP_CloseAudio;
+	this->GetLatency = DSP_GetLatency;
 
 	this->free = Audio_DeleteDevice;
 
@@ -143,6 +145,19 @@ static void DSP_PlayAudio(_THIS)
 #endif
 }
 
+static int DSP_GetLatency(_THIS)
+{
+#ifdef SNDCTL_DSP_GETODELAY
+	int bytes;
+	const int frame_size = ((this->spec.format & 0xFF) / 8) * this->spec.channels;
+
+	if ( ioctl(audio_fd, SNDCTL_DSP_GETODELAY, &bytes) == 0 ) {
+		return(bytes / frame_size);
+	}
+#endif
+	return(-1);
+}
+
 static Uint8 *DSP_GetAudioBuf(_THIS)
 {
 	return(mixbuf);
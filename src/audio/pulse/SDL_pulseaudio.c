@@ -58,6 +58,7 @@ static Uint8 *PULSE_GetAudioBuf(_THIS);
 static void PULSE_CloseAudio(_THIS);
 static void PULSE_WaitDone(_THIS);
 static void PULSE_SetCaption(_THIS, const char *str);
+static int PULSE_GetLatency(_THIS);
 
 #ifdef SDL_AUDIO_DRIVER_PULSE_DYNAMIC
 
@@ -84,10 +85,16 @@ static pa_channel_map* (*SDL_NAME(pa_channel_map_init_auto))(
 	pa_channel_map_def_t def
 );
 
-static pa_mainloop * (*SDL_NAME(pa_mainloop_new))(void);
-static pa_mainloop_api * (*SDL_NAME(pa_mainloop_get_api))(pa_mainloop *m);
-static int (*SDL_NAME(pa_mainloop_iterate))(pa_mainloop *m, int block, int *retval);
-static void (*SDL_NAME(pa_mainloop_free))(pa_mainloop *m);
+static pa_threaded_mainloop * (*SDL_NAME(pa_threaded_mainloop_new))(void);
+static pa_mainloop_api * (*SDL_NAME(pa_threaded_mainloop_get_api))(pa_threaded_mainloop *m);
+static int (*SDL_NAME(pa_threaded_mainloop_start))(pa_threaded_mainloop *m);
+static void (*SDL_NAME(pa_threaded_mainloop_stop))(pa_threaded_mainloop *m);
+static void (*SDL_NAME(pa_threaded_mainloop_lock))(pa_threaded_mainloop *m);
+static void (*SDL_NAME(pa_threaded_mainloop_unlock))(pa_threaded_mainloop *m);
+static void (*SDL_NAME(pa_threaded_mainloop_wait))(pa_threaded_mainloop *m);
+static void (*SDL_NAME(pa_threaded_mainloop_signal))(pa_threaded_mainloop *m,
+	int wait_for_accept);
+static void (*SDL_NAME(pa_threaded_mainloop_free))(pa_threaded_mainloop *m);
 
 static pa_operation_state_t (*SDL_NAME(pa_operation_get_state))(pa_operation *o);
 static void (*SDL_NAME(pa_operation_cancel))(pa_operation *o);
@@ -99,6 +106,8 @@ static int (*SDL_NAME(pa_context_connect))(
 	pa_context *c, const char *server,
 	pa_context_flags_t flags, const pa_spawn_api *api);
 static pa_context_state_t (*SDL_NAME(pa_context_get_state))(pa_context *c);
+static void (*SDL_NAME(pa_context_set_state_callback))(pa_context *c,
+	pa_context_notify_cb_t cb, void *userdata);
 static void (*SDL_NAME(pa_context_disconnect))(pa_context *c);
 static void (*SDL_NAME(pa_context_unref))(pa_context *c);
 
@@ -111,12 +120,25 @@ static pa_stream_state_t (*SDL_NAME(pa_stream_get_state))(pa_stream *s);
 static size_t (*SDL_NAME(pa_stream_writable_size))(pa_stream *s);
 static int (*SDL_NAME(pa_stream_write))(pa_stream *s, const void *data, size_t nbytes,
 	pa_free_cb_t free_cb, int64_t offset, pa_seek_mode_t seek);
+#if PULSE_HAVE_BEGIN_WRITE
+static int (*SDL_NAME(pa_stream_begin_write))(pa_stream *s, void **data,
+	size_t *nbytes);
+static int (*SDL_NAME(pa_stream_cancel_write))(pa_stream *s);
+#endif
+static void (*SDL_NAME(pa_stream_set_state_callback))(pa_stream *s,
+	pa_stream_notify_cb_t cb, void *userdata);
+static void (*SDL_NAME(pa_stream_set_write_callback))(pa_stream *s,
+	pa_stream_request_cb_t cb, void *userdata);
 static pa_operation * (*SDL_NAME(pa_stream_drain))(pa_stream *s,
 	pa_stream_success_cb_t cb, void *userdata);
 static int (*SDL_NAME(pa_stream_disconnect))(pa_stream *s);
 static void (*SDL_NAME(pa_stream_unref))(pa_stream *s);
 static pa_operation* (*SDL_NAME(pa_context_set_name))(pa_context *c,
 	const char *name, pa_context_success_cb_t cb, void *userdata);
+static int (*SDL_NAME(pa_stream_get_latency))(pa_stream *s,
+	pa_usec_t *r_usec, int *negative);
+static void (*SDL_NAME(pa_stream_set_underflow_callback))(pa_stream *s,
+	pa_stream_notify_cb_t cb, void *userdata);
 
 static struct {
 	const char *name;
@@ -128,14 +150,24 @@ static struct {
 		(void **)&SDL_NAME(pa_simple_free)		},
 	{ "pa_channel_map_init_auto",
 		(void **)&SDL_NAME(pa_channel_map_init_auto)	},
-	{ "pa_mainloop_new",
-		(void **)&SDL_NAME(pa_mainloop_new)		},
-	{ "pa_mainloop_get_api",
-		(void **)&SDL_NAME(pa_mainloop_get_api)		},
-	{ "pa_mainloop_iterate",
-		(void **)&SDL_NAME(pa_mainloop_iterate)		},
-	{ "pa_mainloop_free",
-		(void **)&SDL_NAME(pa_mainloop_free)		},
+	{ "pa_threaded_mainloop_new",
+		(void **)&SDL_NAME(pa_threaded_mainloop_new)	},
+	{ "pa_threaded_mainloop_get_api",
+		(void **)&SDL_NAME(pa_threaded_mainloop_get_api)	},
+	{ "pa_threaded_mainloop_start",
+		(void **)&SDL_NAME(pa_threaded_mainloop_start)	},
+	{ "pa_threaded_mainloop_stop",
+		(void **)&SDL_NAME(pa_threaded_mainloop_stop)	},
+	{ "pa_threaded_mainloop_lock",
+		(void **)&SDL_NAME(pa_threaded_mainloop_lock)	},
+	{ "pa_threaded_mainloop_unlock",
+		(void **)&SDL_NAME(pa_threaded_mainloop_unlock)	},
+	{ "pa_threaded_mainloop_wait",
+		(void **)&SDL_NAME(pa_threaded_mainloop_wait)	},
+	{ "pa_threaded_mainloop_signal",
+		(void **)&SDL_NAME(pa_threaded_mainloop_signal)	},
+	{ "pa_threaded_mainloop_free",
+		(void **)&SDL_NAME(pa_threaded_mainloop_free)	},
 	{ "pa_operation_get_state",
 		(void **)&SDL_NAME(pa_operation_get_state)	},
 	{ "pa_operation_cancel",
@@ -148,6 +180,8 @@ static struct {
 		(void **)&SDL_NAME(pa_context_connect)		},
 	{ "pa_context_get_state",
 		(void **)&SDL_NAME(pa_context_get_state)	},
+	{ "pa_context_set_state_callback",
+		(void **)&SDL_NAME(pa_context_set_state_callback)	},
 	{ "pa_context_disconnect",
 		(void **)&SDL_NAME(pa_context_disconnect)	},
 	{ "pa_context_unref",
@@ -162,6 +196,16 @@ static struct {
 		(void **)&SDL_NAME(pa_stream_writable_size)	},
 	{ "pa_stream_write",
 		(void **)&SDL_NAME(pa_stream_write)		},
+#if PULSE_HAVE_BEGIN_WRITE
+	{ "pa_stream_begin_write",
+		(void **)&SDL_NAME(pa_stream_begin_write)	},
+	{ "pa_stream_cancel_write",
+		(void **)&SDL_NAME(pa_stream_cancel_write)	},
+#endif
+	{ "pa_stream_set_state_callback",
+		(void **)&SDL_NAME(pa_stream_set_state_callback)	},
+	{ "pa_stream_set_write_callback",
+		(void **)&SDL_NAME(pa_stream_set_write_callback)	},
 	{ "pa_stream_drain",
 		(void **)&SDL_NAME(pa_stream_drain)		},
 	{ "pa_stream_disconnect",
@@ -170,6 +214,10 @@ static struct {
 		(void **)&SDL_NAME(pa_stream_unref)		},
 	{ "pa_context_set_name",
 		(void **)&SDL_NAME(pa_context_set_name)		},
+	{ "pa_stream_get_latency",
+		(void **)&SDL_NAME(pa_stream_get_latency)	},
+	{ "pa_stream_set_underflow_callback",
+		(void **)&SDL_NAME(pa_stream_set_underflow_callback)	},
 };
 
 static void UnloadPulseLibrary()
@@ -289,6 +337,7 @@ static SDL_AudioDevice *Audio_CreateDevice(int devindex)
 	this->CloseAudio = PULSE_CloseAudio;
 	this->WaitDone = PULSE_WaitDone;
 	this->SetCaption = PULSE_SetCaption;
+	this->GetLatency = PULSE_GetLatency;
 
 	this->free = Audio_DeleteDevice;
 
@@ -300,37 +349,112 @@ AudioBootStrap PULSE_bootstrap = {
 	Audio_Available, Audio_CreateDevice
 };
 
+/* Main loop callbacks, these just wake up whoever is waiting on the loop */
+static void context_state_changed(pa_context *c, void *userdata)
+{
+	SDL_AudioDevice *this = (SDL_AudioDevice *)userdata;
+	SDL_NAME(pa_threaded_mainloop_signal)(mainloop, 0);
+}
+
+static void stream_state_changed(pa_stream *s, void *userdata)
+{
+	SDL_AudioDevice *this = (SDL_AudioDevice *)userdata;
+	SDL_NAME(pa_threaded_mainloop_signal)(mainloop, 0);
+}
+
+static void stream_write_requested(pa_stream *s, size_t nbytes, void *userdata)
+{
+	SDL_AudioDevice *this = (SDL_AudioDevice *)userdata;
+	SDL_NAME(pa_threaded_mainloop_signal)(mainloop, 0);
+}
+
+static void stream_underflow(pa_stream *s, void *userdata)
+{
+	SDL_AudioDevice *this = (SDL_AudioDevice *)userdata;
+	SDL_AtomicIncRef(&this->xruns);
+}
+
+/* Returns non-zero if the connection is still usable, call with the lock */
+static int PULSE_StreamIsGood(_THIS)
+{
+	return (SDL_NAME(pa_context_get_state)(context) == PA_CONTEXT_READY &&
+	        SDL_NAME(pa_stream_get_state)(stream) == PA_STREAM_READY);
+}
+
 /* This function waits until it is possible to write a full sound buffer */
 static void PULSE_WaitAudio(_THIS)
 {
-	int size;
-	while(1) {
-		if (SDL_NAME(pa_context_get_state)(context) != PA_CONTEXT_READY ||
-		    SDL_NAME(pa_stream_get_state)(stream) != PA_STREAM_READY ||
-		    SDL_NAME(pa_mainloop_iterate)(mainloop, 1, NULL) < 0) {
+	SDL_NAME(pa_threaded_mainloop_lock)(mainloop);
+	while ( this->enabled ) {
+		if ( !PULSE_StreamIsGood(this) ) {
 			this->enabled = 0;
-			return;
+			break;
 		}
-		size = SDL_NAME(pa_stream_writable_size)(stream);
-		if (size >= mixlen)
-			return;
+		if ( SDL_NAME(pa_stream_writable_size)(stream) >= (size_t)mixlen ) {
+			break;
+		}
+		/* Sleep until the server asks for more data */
+		SDL_NAME(pa_threaded_mainloop_wait)(mainloop);
 	}
+	SDL_NAME(pa_threaded_mainloop_unlock)(mainloop);
 }
 
 static void PULSE_PlayAudio(_THIS)
 {
-	/* Write the audio data */
-	if (SDL_NAME(pa_stream_write)(stream, mixbuf, mixlen, NULL, 0LL, PA_SEEK_RELATIVE) < 0)
+	const void *data = pending_write ? pending_write : mixbuf;
+
+	/* Write the audio data, this doesn't copy if it came from the server */
+	SDL_NAME(pa_threaded_mainloop_lock)(mainloop);
+	if (SDL_NAME(pa_stream_write)(stream, data, mixlen, NULL, 0LL, PA_SEEK_RELATIVE) < 0)
 		this->enabled = 0;
+	SDL_NAME(pa_threaded_mainloop_unlock)(mainloop);
+	pending_write = NULL;
 }
 
 static Uint8 *PULSE_GetAudioBuf(_THIS)
 {
+#if PULSE_HAVE_BEGIN_WRITE
+	void *data = NULL;
+	size_t nbytes = mixlen;
+
+	/* Ask the server for a buffer so the callback mixes straight into it */
+	SDL_NAME(pa_threaded_mainloop_lock)(mainloop);
+	if (SDL_NAME(pa_stream_begin_write)(stream, &data, &nbytes) == 0) {
+		if (data && nbytes >= (size_t)mixlen) {
+			pending_write = data;
+		} else {
+			SDL_NAME(pa_stream_cancel_write)(stream);
+		}
+	}
+	SDL_NAME(pa_threaded_mainloop_unlock)(mainloop);
+	if (pending_write) {
+		return((Uint8 *)pending_write);
+	}
+#endif
 	return(mixbuf);
 }
 
+static int PULSE_GetLatency(_THIS)
+{
+	pa_usec_t usec;
+	int negative;
+	int frames = -1;
+
+	SDL_NAME(pa_threaded_mainloop_lock)(mainloop);
+	if (SDL_NAME(pa_stream_get_latency)(stream, &usec, &negative) == 0) {
+		frames = negative ? 0 :
+			(int)((usec * this->spec.freq) / 1000000);
+	}
+	SDL_NAME(pa_threaded_mainloop_unlock)(mainloop);
+	return(frames);
+}
+
 static void PULSE_CloseAudio(_THIS)
 {
+	/* Stop the main loop thread first, then nobody else touches the objects */
+	if (mainloop != NULL) {
+		SDL_NAME(pa_threaded_mainloop_stop)(mainloop);
+	}
 	if ( mixbuf != NULL ) {
 		SDL_FreeAudioMem(mixbuf);
 		mixbuf = NULL;
@@ -346,7 +470,7 @@ static void PULSE_CloseAudio(_THIS)
 		context = NULL;
 	}
 	if (mainloop != NULL) {
-		SDL_NAME(pa_mainloop_free)(mainloop);
+		SDL_NAME(pa_threaded_mainloop_free)(mainloop);
 		mainloop = NULL;
 	}
 }
@@ -393,43 +517,114 @@ static void PULSE_SetCaption(_THIS, const char *str)
 	}
 	this->hidden->caption = SDL_strdup(str);
 	if (context != NULL) {
-		SDL_NAME(pa_context_set_name)(context, this->hidden->caption,
-		                              caption_set_complete, 0);
+		pa_operation *o;
+
+		SDL_NAME(pa_threaded_mainloop_lock)(mainloop);
+		o = SDL_NAME(pa_context_set_name)(context, this->hidden->caption,
+		                                  caption_set_complete, 0);
+		if (o) {
+			SDL_NAME(pa_operation_unref)(o);
+		}
+		SDL_NAME(pa_threaded_mainloop_unlock)(mainloop);
 	}
 }
 
 static void stream_drain_complete(pa_stream *s, int success, void *userdata)
 {
-	/* no-op. */
+	SDL_AudioDevice *this = (SDL_AudioDevice *)userdata;
+	SDL_NAME(pa_threaded_mainloop_signal)(mainloop, 0);
 }
 
 static void PULSE_WaitDone(_THIS)
 {
 	pa_operation *o;
 
-	o = SDL_NAME(pa_stream_drain)(stream, stream_drain_complete, NULL);
-	if (!o)
-		return;
+	SDL_NAME(pa_threaded_mainloop_lock)(mainloop);
+	o = SDL_NAME(pa_stream_drain)(stream, stream_drain_complete, this);
+	if (o) {
+		while (SDL_NAME(pa_operation_get_state)(o) == PA_OPERATION_RUNNING) {
+			if (!PULSE_StreamIsGood(this)) {
+				SDL_NAME(pa_operation_cancel)(o);
+				break;
+			}
+			SDL_NAME(pa_threaded_mainloop_wait)(mainloop);
+		}
+		SDL_NAME(pa_operation_unref)(o);
+	}
+	SDL_NAME(pa_threaded_mainloop_unlock)(mainloop);
+}
 
-	while (SDL_NAME(pa_operation_get_state)(o) != PA_OPERATION_DONE) {
-		if (SDL_NAME(pa_context_get_state)(context) != PA_CONTEXT_READY ||
-		    SDL_NAME(pa_stream_get_state)(stream) != PA_STREAM_READY ||
-		    SDL_NAME(pa_mainloop_iterate)(mainloop, 1, NULL) < 0) {
-			SDL_NAME(pa_operation_cancel)(o);
-			break;
+/* Connect the context and stream, call with the main loop lock held */
+static int PULSE_Connect(_THIS, const pa_sample_spec *paspec,
+                         const pa_buffer_attr *paattr,
+                         const pa_channel_map *pacmap)
+{
+	pa_context_state_t cstate;
+	pa_stream_state_t sstate;
+	pa_stream_flags_t flags;
+
+	if (!(context = SDL_NAME(pa_context_new)(mainloop_api,
+	                                         this->hidden->caption))) {
+		SDL_SetError("pa_context_new() failed");
+		return(-1);
+	}
+	SDL_NAME(pa_context_set_state_callback)(context, context_state_changed, this);
+
+	/* Connect to the PulseAudio server */
+	if (SDL_NAME(pa_context_connect)(context, NULL, 0, NULL) < 0) {
+		SDL_SetError("Could not setup connection to PulseAudio");
+		return(-1);
+	}
+	while ((cstate = SDL_NAME(pa_context_get_state)(context)) != PA_CONTEXT_READY) {
+		if (!PA_CONTEXT_IS_GOOD(cstate)) {
+			SDL_SetError("Could not connect to PulseAudio");
+			return(-1);
+		}
+		SDL_NAME(pa_threaded_mainloop_wait)(mainloop);
+	}
+
+	stream = SDL_NAME(pa_stream_new)(
+		context,
+		"Simple DirectMedia Layer",  /* stream description */
+		paspec,                      /* sample format spec */
+		pacmap                       /* channel map */
+	);
+	if ( stream == NULL ) {
+		SDL_SetError("Could not setup PulseAudio stream");
+		return(-1);
+	}
+	SDL_NAME(pa_stream_set_state_callback)(stream, stream_state_changed, this);
+	SDL_NAME(pa_stream_set_write_callback)(stream, stream_write_requested, this);
+	SDL_NAME(pa_stream_set_underflow_callback)(stream, stream_underflow, this);
+
+	/* Keep timing info current so we can report latency cheaply */
+	flags = PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE;
+#ifdef PA_STREAM_ADJUST_LATENCY
+	flags |= PA_STREAM_ADJUST_LATENCY;
+#endif
+
+	if (SDL_NAME(pa_stream_connect_playback)(stream, NULL, paattr, flags,
+			NULL, NULL) < 0) {
+		SDL_SetError("Could not connect PulseAudio stream");
+		return(-1);
+	}
+	while ((sstate = SDL_NAME(pa_stream_get_state)(stream)) != PA_STREAM_READY) {
+		if (!PA_STREAM_IS_GOOD(sstate)) {
+			SDL_SetError("Could not create to PulseAudio stream");
+			return(-1);
 		}
+		SDL_NAME(pa_threaded_mainloop_wait)(mainloop);
 	}
-	SDL_NAME(pa_operation_unref)(o);
+	return(0);
 }
 
 static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 {
-	int             state;
+	int             status;
 	Uint16          test_format;
 	pa_sample_spec  paspec;
 	pa_buffer_attr  paattr;
 	pa_channel_map  pacmap;
-	pa_stream_flags_t flags = 0;
 
 	paspec.format = PA_SAMPLE_INVALID;
 	for ( test_format = SDL_FirstAudioFormat(spec->format); test_format; ) {
@@ -458,9 +653,6 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 	paspec.rate = spec->freq;
 
 	/* Calculate the final parameters for this audio specification */
-#ifdef PA_STREAM_ADJUST_LATENCY
-	spec->samples /= 2; /* Mix in smaller chunck to avoid underruns */
-#endif
 	SDL_CalculateAudioSpec(spec);
 
 	/* Allocate mixing buffer */
@@ -470,31 +662,26 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 		return(-1);
 	}
 	SDL_memset(mixbuf, spec->silence, spec->size);
+	pending_write = NULL;
 
-	/* Reduced prebuffering compared to the defaults. */
-#ifdef PA_STREAM_ADJUST_LATENCY
-	paattr.tlength = mixlen * 4; /* 2x original requested bufsize */
-	paattr.prebuf = -1;
-	paattr.maxlength = -1;
-	paattr.minreq = mixlen; /* -1 can lead to pa_stream_writable_size()
-				   >= mixlen never becoming true */
-	flags = PA_STREAM_ADJUST_LATENCY;
-#else
-	paattr.tlength = mixlen*2;
-	paattr.prebuf = mixlen*2;
-	paattr.maxlength = mixlen*2;
+	/* Ask for exactly two buffers of latency, and to be woken up whenever
+	   there's room for one more buffer.
+	 */
+	paattr.tlength = mixlen * 2;
 	paattr.minreq = mixlen;
-#endif
+	paattr.prebuf = (Uint32) -1;
+	paattr.maxlength = (Uint32) -1;
+	paattr.fragsize = (Uint32) -1;
 
 	/* The SDL ALSA output hints us that we use Windows' channel mapping */
 	/* http://bugzilla.libsdl.org/show_bug.cgi?id=110 */
 	SDL_NAME(pa_channel_map_init_auto)(
 		&pacmap, spec->channels, PA_CHANNEL_MAP_WAVEEX);
 
-	/* Set up a new main loop */
-	if (!(mainloop = SDL_NAME(pa_mainloop_new)())) {
+	/* Set up a new main loop, running in its own thread */
+	if (!(mainloop = SDL_NAME(pa_threaded_mainloop_new)())) {
 		PULSE_CloseAudio(this);
-		SDL_SetError("pa_mainloop_new() failed");
+		SDL_SetError("pa_threaded_mainloop_new() failed");
 		return(-1);
 	}
 
@@ -504,67 +691,21 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 		PULSE_SetCaption(this, title);
 	}
 
-	mainloop_api = SDL_NAME(pa_mainloop_get_api)(mainloop);
-	if (!(context = SDL_NAME(pa_context_new)(mainloop_api,
-	                                         this->hidden->caption))) {
-		PULSE_CloseAudio(this);
-		SDL_SetError("pa_context_new() failed");
-		return(-1);
-	}
+	mainloop_api = SDL_NAME(pa_threaded_mainloop_get_api)(mainloop);
 
-	/* Connect to the PulseAudio server */
-	if (SDL_NAME(pa_context_connect)(context, NULL, 0, NULL) < 0) {
+	if (SDL_NAME(pa_threaded_mainloop_start)(mainloop) < 0) {
 		PULSE_CloseAudio(this);
-		SDL_SetError("Could not setup connection to PulseAudio");
+		SDL_SetError("pa_threaded_mainloop_start() failed");
 		return(-1);
 	}
 
-	do {
-		if (SDL_NAME(pa_mainloop_iterate)(mainloop, 1, NULL) < 0) {
-			PULSE_CloseAudio(this);
-			SDL_SetError("pa_mainloop_iterate() failed");
-			return(-1);
-		}
-		state = SDL_NAME(pa_context_get_state)(context);
-		if (!PA_CONTEXT_IS_GOOD(state)) {
-			PULSE_CloseAudio(this);
-			SDL_SetError("Could not connect to PulseAudio");
-			return(-1);
-		}
-	} while (state != PA_CONTEXT_READY);
+	SDL_NAME(pa_threaded_mainloop_lock)(mainloop);
+	status = PULSE_Connect(this, &paspec, &paattr, &pacmap);
+	SDL_NAME(pa_threaded_mainloop_unlock)(mainloop);
 
-	stream = SDL_NAME(pa_stream_new)(
-		context,
-		"Simple DirectMedia Layer",  /* stream description */
-		&paspec,                     /* sample format spec */
-		&pacmap                      /* channel map */
-	);
-	if ( stream == NULL ) {
+	if (status < 0) {
 		PULSE_CloseAudio(this);
-		SDL_SetError("Could not setup PulseAudio stream");
-		return(-1);
-	}
-
-	if (SDL_NAME(pa_stream_connect_playback)(stream, NULL, &paattr, flags,
-			NULL, NULL) < 0) {
-		PULSE_CloseAudio(this);
-		SDL_SetError("Could not connect PulseAudio stream");
 		return(-1);
 	}
-
-	do {
-		if (SDL_NAME(pa_mainloop_iterate)(mainloop, 1, NULL) < 0) {
-			PULSE_CloseAudio(this);
-			SDL_SetError("pa_mainloop_iterate() failed");
-			return(-1);
-		}
-		state = SDL_NAME(pa_stream_get_state)(stream);
-		if (!PA_STREAM_IS_GOOD(state)) {
-			PULSE_CloseAudio(this);
-			SDL_SetError("Could not create to PulseAudio stream");
-			return(-1);
-		}
-	} while (state != PA_STREAM_READY);
-
 	return(0);
 }
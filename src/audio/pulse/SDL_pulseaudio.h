@@ -31,8 +31,15 @@
 /* Hidden "this" pointer for the video functions */
 #define _THIS	SDL_AudioDevice *this
 
+/* pa_stream_begin_write() is available in PulseAudio >= 0.9.16 */
+#ifdef PA_CHECK_VERSION
+#if PA_CHECK_VERSION(0,9,16)
+#define PULSE_HAVE_BEGIN_WRITE	1
+#endif
+#endif
+
 struct SDL_PrivateAudioData {
-	pa_mainloop *mainloop;
+	pa_threaded_mainloop *mainloop;
 	pa_mainloop_api *mainloop_api;
 	pa_context *context;
 	pa_stream *stream;
@@ -42,6 +49,9 @@ struct SDL_PrivateAudioData {
 	/* Raw mixing buffer */
 	Uint8 *mixbuf;
 	int    mixlen;
+
+	/* Server buffer being mixed into, from pa_stream_begin_write() */
+	void  *pending_write;
 };
 
 #if (PA_API_VERSION < 12)
@@ -68,6 +78,7 @@ static inline int PA_STREAM_IS_GOOD(pa_stream_state_t x) {
 #define stream			(this->hidden->stream)
 #define mixbuf			(this->hidden->mixbuf)
 #define mixlen			(this->hidden->mixlen)
+#define pending_write		(this->hidden->pending_write)
 
 #endif /* _SDL_pulseaudio_h */
 
@@ -41,6 +41,16 @@
 #include <sys/syspage.h>
 #endif
 
+#if defined(__LINUX__)
+#include <sched.h>	/* For sched_getaffinity() */
+#endif
+#if defined(__WIN32__)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__unix__) || defined(__MACOSX__)
+#include <unistd.h>
+#endif
+
 #if defined(__LINUX__) && defined(__arm__)
 #include <unistd.h>
 #include <sys/types.h>
@@ -79,6 +89,8 @@
 #define CPU_HAS_ALTIVEC	0x00000100
 #define CPU_HAS_ARM_SIMD 0x00000200
 #define CPU_HAS_NEON     0x00000400
+#define CPU_HAS_SSSE3	0x00000800
+#define CPU_HAS_AVX2	0x00001000
 
 #if SDL_ALTIVEC_BLITTERS && HAVE_SETJMP && !__MACOSX__ && !__OpenBSD__
 /* This is the brute force way of detecting instruction sets...
@@ -395,6 +407,138 @@ static __inline__ int CPU_haveSSE2(void)
 	return 0;
 }
 
+/* Run CPUID with a leaf and subleaf, for the features past leaf 1 */
+static __inline__ void CPU_cpuid(int leaf, int subleaf, int regs[4])
+{
+	regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#if defined(__GNUC__) && defined(__i386__)
+	__asm__ (
+"        movl    %%ebx,%%esi         # Keep ebx for PIC code           \n"
+"        cpuid                                                         \n"
+"        xchgl   %%ebx,%%esi                                           \n"
+	: "=a" (regs[0]), "=S" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	: "a" (leaf), "c" (subleaf)
+	);
+#elif defined(__GNUC__) && defined(__x86_64__)
+	__asm__ (
+"        movq    %%rbx,%%rsi         # Keep rbx for PIC code           \n"
+"        cpuid                                                         \n"
+"        xchgq   %%rbx,%%rsi                                           \n"
+	: "=a" (regs[0]), "=S" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	: "a" (leaf), "c" (subleaf)
+	);
+#elif defined(_MSC_VER) && defined(_M_IX86)
+	__asm {
+        mov     eax, leaf
+        mov     ecx, subleaf
+        push    ebx
+        cpuid
+        mov     esi, regs
+        mov     [esi], eax
+        mov     [esi+4], ebx
+        mov     [esi+8], ecx
+        mov     [esi+12], edx
+        pop     ebx
+	}
+#endif
+}
+
+static __inline__ int CPU_haveSSSE3(void)
+{
+	int regs[4];
+
+	if ( CPU_haveCPUID() ) {
+		CPU_cpuid(0, 0, regs);
+		if ( regs[0] >= 1 ) {
+			CPU_cpuid(1, 0, regs);
+			return (regs[2] & 0x00000200);
+		}
+	}
+	return 0;
+}
+
+/* AVX2 also needs the OS to save the AVX registers, which it tells us
+   through XGETBV */
+static __inline__ int CPU_haveAVX2(void)
+{
+	int regs[4];
+	Uint32 xcr0 = 0;
+
+	if ( !CPU_haveCPUID() ) {
+		return 0;
+	}
+	CPU_cpuid(0, 0, regs);
+	if ( regs[0] < 7 ) {
+		return 0;
+	}
+	CPU_cpuid(1, 0, regs);
+	if ( (regs[2] & 0x18000000) != 0x18000000 ) {	/* OSXSAVE and AVX */
+		return 0;
+	}
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	{
+		Uint32 edx;
+		__asm__ (".byte 0x0f, 0x01, 0xd0" : "=a" (xcr0), "=d" (edx) : "c" (0));
+	}
+#elif defined(_MSC_VER) && defined(_M_IX86)
+	__asm {
+        xor     ecx, ecx
+        _emit   0x0f
+        _emit   0x01
+        _emit   0xd0
+        mov     xcr0, eax
+	}
+#endif
+	if ( (xcr0 & 0x6) != 0x6 ) {
+		return 0;
+	}
+	CPU_cpuid(7, 0, regs);
+	return (regs[1] & 0x00000020);
+}
+
+/* The biggest data or unified cache, from the deterministic cache
+   parameters on Intel, or the L2 and L3 sizes on AMD */
+static int CPU_getCacheSize(void)
+{
+	int regs[4];
+	int i, size, largest = 0;
+
+	if ( !CPU_haveCPUID() ) {
+		return 0;
+	}
+	CPU_cpuid(0, 0, regs);
+	if ( regs[0] >= 4 ) {
+		for ( i = 0; i < 16; ++i ) {
+			CPU_cpuid(4, i, regs);
+			if ( (regs[0] & 0x1F) == 0 ) {
+				break;	/* No more caches */
+			}
+			if ( (regs[0] & 0x1F) == 2 ) {
+				continue;	/* Instruction cache */
+			}
+			size = (((regs[1] >> 22) & 0x3FF) + 1) *	/* ways */
+			       (((regs[1] >> 12) & 0x3FF) + 1) *	/* partitions */
+			       ((regs[1] & 0xFFF) + 1) *		/* line size */
+			       (regs[2] + 1);				/* sets */
+			if ( size > largest ) {
+				largest = size;
+			}
+		}
+	}
+	if ( largest == 0 ) {
+		CPU_cpuid(0x80000000, 0, regs);
+		if ( (Uint32)regs[0] >= 0x80000006 ) {
+			CPU_cpuid(0x80000006, 0, regs);
+			largest = (int)(((Uint32)regs[2] >> 16) * 1024);
+			size = (int)(((Uint32)regs[3] >> 18) * 512 * 1024);
+			if ( size > largest ) {
+				largest = size;
+			}
+		}
+	}
+	return largest;
+}
+
 static __inline__ int CPU_haveAltiVec(void)
 {
 	volatile int altivec = 0;
@@ -597,6 +741,12 @@ static Uint32 SDL_GetCPUFeatures(void)
 		if ( CPU_haveSSE2() ) {
 			SDL_CPUFeatures |= CPU_HAS_SSE2;
 		}
+		if ( CPU_haveSSSE3() ) {
+			SDL_CPUFeatures |= CPU_HAS_SSSE3;
+		}
+		if ( CPU_haveAVX2() ) {
+			SDL_CPUFeatures |= CPU_HAS_AVX2;
+		}
 		if ( CPU_haveAltiVec() ) {
 			SDL_CPUFeatures |= CPU_HAS_ALTIVEC;
 		}
@@ -666,6 +816,22 @@ SDL_bool SDL_HasSSE2(void)
 	return SDL_FALSE;
 }
 
+SDL_bool SDL_HasSSSE3(void)
+{
+	if ( SDL_GetCPUFeatures() & CPU_HAS_SSSE3 ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
+SDL_bool SDL_HasAVX2(void)
+{
+	if ( SDL_GetCPUFeatures() & CPU_HAS_AVX2 ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
 SDL_bool SDL_HasAltiVec(void)
 {
 	if ( SDL_GetCPUFeatures() & CPU_HAS_ALTIVEC ) {
@@ -690,6 +856,56 @@ SDL_bool SDL_HasNEON(void)
 	return SDL_FALSE;
 }
 
+static int SDL_CPUCount = 0;
+
+int SDL_GetCPUCount(void)
+{
+	if ( !SDL_CPUCount ) {
+#if defined(__LINUX__) && defined(CPU_COUNT)
+		/* Only count the CPUs we're allowed to run on */
+		cpu_set_t set;
+		if ( sched_getaffinity(0, sizeof(set), &set) == 0 ) {
+			SDL_CPUCount = CPU_COUNT(&set);
+		}
+#endif
+#if defined(__WIN32__)
+		if ( SDL_CPUCount <= 0 ) {
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			SDL_CPUCount = (int)info.dwNumberOfProcessors;
+		}
+#elif defined(__IRIX__)
+		if ( SDL_CPUCount <= 0 ) {
+			SDL_CPUCount = (int)sysconf(_SC_NPROC_ONLN);
+		}
+#elif defined(_SC_NPROCESSORS_ONLN)
+		/* number of processors online (SVR4.0MP compliant machines) */
+		if ( SDL_CPUCount <= 0 ) {
+			SDL_CPUCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		}
+#elif defined(_SC_NPROCESSORS_CONF)
+		/* number of processors configured (SVR4.0MP compliant machines) */
+		if ( SDL_CPUCount <= 0 ) {
+			SDL_CPUCount = (int)sysconf(_SC_NPROCESSORS_CONF);
+		}
+#endif
+		if ( SDL_CPUCount <= 0 ) {
+			SDL_CPUCount = 1;
+		}
+	}
+	return SDL_CPUCount;
+}
+
+static int SDL_CPUCacheSize = -1;
+
+int SDL_GetCPUCacheSize(void)
+{
+	if ( SDL_CPUCacheSize < 0 ) {
+		SDL_CPUCacheSize = CPU_getCacheSize();
+	}
+	return SDL_CPUCacheSize;
+}
+
 #ifdef TEST_MAIN
 
 #include <stdio.h>
@@ -703,9 +919,13 @@ int main()
 	printf("3DNowExt: %d\n", SDL_Has3DNowExt());
 	printf("SSE: %d\n", SDL_HasSSE());
 	printf("SSE2: %d\n", SDL_HasSSE2());
+	printf("SSSE3: %d\n", SDL_HasSSSE3());
+	printf("AVX2: %d\n", SDL_HasAVX2());
 	printf("AltiVec: %d\n", SDL_HasAltiVec());
 	printf("ARM SIMD: %d\n", SDL_HasARMSIMD());
 	printf("NEON: %d\n", SDL_HasNEON());
+	printf("CPUs: %d\n", SDL_GetCPUCount());
+	printf("Cache: %d bytes\n", SDL_GetCPUCacheSize());
 	return 0;
 }
 
@@ -0,0 +1,59 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_simd_h
+#define _SDL_simd_h
+
+/* Compiler support for x86 SIMD code.
+
+   The whole library is built for the baseline CPU, so functions using
+   newer instructions are marked with SDL_TARGETING() and only called
+   after the matching SDL_HasXXX() check in SDL_cpuinfo.h.
+*/
+
+#include "SDL_cpuinfo.h"
+
+#if SDL_ASSEMBLY_ROUTINES
+#  if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+      (defined(__clang__) || (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#    define SDL_TARGETING(x)	__attribute__((target(x)))
+#    define HAVE_SSE2_INTRINSICS	1
+#    define HAVE_SSSE3_INTRINSICS	1
+#    define HAVE_AVX2_INTRINSICS	1
+#  elif defined(_MSC_VER) && (_MSC_VER >= 1700) && (defined(_M_IX86) || defined(_M_X64))
+#    define SDL_TARGETING(x)
+#    define HAVE_SSE2_INTRINSICS	1
+#    define HAVE_SSSE3_INTRINSICS	1
+#    define HAVE_AVX2_INTRINSICS	1
+#  endif
+#endif /* SDL_ASSEMBLY_ROUTINES */
+
+#if HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#elif HAVE_SSSE3_INTRINSICS
+#include <tmmintrin.h>
+#elif HAVE_SSE2_INTRINSICS
+#include <emmintrin.h>
+#endif
+
+#endif /* _SDL_simd_h */
@@ -28,6 +28,7 @@
 #include "SDL_sysevents.h"
 #include "SDL_events_c.h"
 #include "../timer/SDL_timer_c.h"
+#include "../atomic/SDL_atomic_c.h"
 #if !SDL_JOYSTICK_DISABLED
 #include "../joystick/SDL_joystick_c.h"
 #endif
@@ -37,27 +38,255 @@ SDL_EventFilter SDL_EventOK = NULL;
 Uint8 SDL_ProcessEvents[SDL_NUMEVENTS];
 static Uint32 SDL_eventstate = 0;
 
-/* Private data -- event queue */
-#define MAXEVENTS	128
+/* Private data -- event queue
+
+   The queue is a linked list of fixed size segments.  Any thread can add
+   events without taking a lock: a producer claims a slot in the tail
+   segment with an atomic increment, and links in a new segment when the
+   tail is full.  Reading is serialized by the queue lock, and removing an
+   event just marks its slot as taken, so nothing is ever shifted around.
+   Segments the reader has finished with are recycled once no producer
+   can still be looking at them.
+
+   Without compiler support for atomic operations, producers take the
+   queue lock too.
+ */
+#if !SDL_THREADS_DISABLED && SDL_ATOMIC_LOCKFREE
+#define SDL_EVENTQ_LOCKFREE	1
+#define EVQ_FetchAdd(a, v)	SDL_AtomicAdd(a, v)
+#define EVQ_CAS(a, o, n)	SDL_AtomicCAS(a, o, n)
+#define EVQ_CASPtr(p, o, n)	SDL_AtomicCASPtr((void **)(p), o, n)
+#define EVQ_Barrier()		SDL_MemoryBarrier()
+#else
+#define SDL_EVENTQ_LOCKFREE	0
+static int EVQ_FetchAdd(SDL_atomic_t *a, int v)
+{
+	int old = a->value;
+	a->value = old + v;
+	return(old);
+}
+#define EVQ_CAS(a, o, n)	(((a)->value == (o)) ? (((a)->value = (n)), 1) : 0)
+#define EVQ_CASPtr(p, o, n)	((*(p) == (o)) ? ((*(p) = (n)), 1) : 0)
+#define EVQ_Barrier()
+#endif
+
+#define EVENTS_PER_SEGMENT	128
+#define MAXEVENTS		65536	/* Events queued before dropping */
+#define MAXWMMSGS		MAXEVENTS	/* A message for every queued event */
+
+#define SLOT_EMPTY	0	/* Claimed, but not written yet */
+#define SLOT_READY	1
+#define SLOT_TAKEN	2
+
+typedef struct SDL_EventSegment {
+	struct SDL_EventSegment * volatile next;
+	SDL_atomic_t reserved;		/* Slots claimed by producers */
+	volatile Uint8 state[EVENTS_PER_SEGMENT];
+	SDL_Event event[EVENTS_PER_SEGMENT];
+} SDL_EventSegment;
+
 static struct {
 	SDL_mutex *lock;
 	int active;
-	int head;
-	int tail;
-	SDL_Event event[MAXEVENTS];
-	int wmmsg_next;
-	struct SDL_SysWMmsg wmmsg[MAXEVENTS];
+
+	/* Reader side, protected by the lock */
+	SDL_EventSegment *head;
+	int head_slot;
+	SDL_EventSegment *retired;
+
+	/* Writer side */
+	SDL_EventSegment * volatile tail;
+	SDL_EventSegment * volatile spare;
+	SDL_atomic_t producers;		/* Writers currently in the queue */
+	SDL_atomic_t count;
+
+	SDL_atomic_t wmmsg_next;
+	struct SDL_SysWMmsg wmmsg[MAXWMMSGS];
+
+	SDL_atomic_t dropped;
+	SDL_atomic_t high_water;
 } SDL_EventQ;
 
+/* Private data -- waking up sleeping threads
+
+   Threads blocked in SDL_WaitEvent() poll the video driver's file
+   descriptors together with the read end of a pipe, which is written to
+   whenever an event is added while somebody is waiting.  The event thread
+   has a pipe of its own, for changes that affect how long it can sleep.
+ */
+#if SDL_EVENTQ_LOCKFREE && (defined(__unix__) || (defined(__APPLE__) && defined(__MACH__)))
+#define SDL_EVENT_WAKEUP_PIPE	1
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#define MAXEVENTFDS	8
+
+typedef struct SDL_EventWakeup {
+	int fds[2];
+	SDL_atomic_t waiting;
+} SDL_EventWakeup;
+
+static SDL_EventWakeup SDL_QueueWakeup = { { -1, -1 }, { 0 } };
+static SDL_EventWakeup SDL_ThreadWakeup = { { -1, -1 }, { 0 } };
+#else
+#define SDL_EVENT_WAKEUP_PIPE	0
+#endif
+
 /* Private data -- event locking structure */
 static struct {
 	SDL_mutex *lock;
 	int safe;
 } SDL_EventLock;
 
+static SDL_EventSegment *SDL_AllocEventSegment(void)
+{
+	SDL_EventSegment *segment;
+
+	/* Reuse the last segment the reader recycled, if there is one */
+	do {
+		segment = SDL_EventQ.spare;
+	} while ( segment && !EVQ_CASPtr(&SDL_EventQ.spare, segment, NULL) );
+
+	if ( segment == NULL ) {
+		segment = (SDL_EventSegment *)SDL_malloc(sizeof(*segment));
+		if ( segment == NULL ) {
+			return(NULL);
+		}
+	}
+	segment->next = NULL;
+	segment->reserved.value = 0;
+	SDL_memset((void *)segment->state, SLOT_EMPTY, sizeof(segment->state));
+	return(segment);
+}
+
+static void SDL_RecycleEventSegment(SDL_EventSegment *segment)
+{
+	EVQ_Barrier();
+	if ( !EVQ_CASPtr(&SDL_EventQ.spare, NULL, segment) ) {
+		SDL_free(segment);
+	}
+}
+
+#if SDL_EVENT_WAKEUP_PIPE
+static int SDL_InitEventWakeup(SDL_EventWakeup *wakeup)
+{
+	int i;
+
+	if ( pipe(wakeup->fds) < 0 ) {
+		wakeup->fds[0] = wakeup->fds[1] = -1;
+		SDL_SetError("Couldn't create event wakeup pipe");
+		return(-1);
+	}
+	for ( i = 0; i < 2; ++i ) {
+		fcntl(wakeup->fds[i], F_SETFL,
+		      fcntl(wakeup->fds[i], F_GETFL) | O_NONBLOCK);
+		fcntl(wakeup->fds[i], F_SETFD, FD_CLOEXEC);
+	}
+	wakeup->waiting.value = 0;
+	return(0);
+}
+
+static void SDL_QuitEventWakeup(SDL_EventWakeup *wakeup)
+{
+	int i;
+
+	for ( i = 0; i < 2; ++i ) {
+		if ( wakeup->fds[i] >= 0 ) {
+			close(wakeup->fds[i]);
+			wakeup->fds[i] = -1;
+		}
+	}
+}
+
+/* This is safe to call from a signal handler */
+static void SDL_SignalEventWakeup(SDL_EventWakeup *wakeup)
+{
+	static const char c = 0;
+	int saved_errno = errno;
+
+	/* If the pipe is full, the waiter will wake up anyway */
+	if ( write(wakeup->fds[1], &c, 1) < 0 ) {
+		;
+	}
+	errno = saved_errno;
+}
+
+static void SDL_DrainEventWakeup(SDL_EventWakeup *wakeup)
+{
+	char buf[64];
+
+	while ( read(wakeup->fds[0], buf, sizeof(buf)) > 0 ) {
+		;
+	}
+}
+#endif /* SDL_EVENT_WAKEUP_PIPE */
+
+static int SDL_InitEventQueue(void)
+{
+	SDL_EventQ.head = SDL_AllocEventSegment();
+	if ( SDL_EventQ.head == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	SDL_EventQ.head_slot = 0;
+	SDL_EventQ.tail = SDL_EventQ.head;
+	SDL_EventQ.count.value = 0;
+	SDL_EventQ.wmmsg_next.value = 0;
+	SDL_EventQ.dropped.value = 0;
+	SDL_EventQ.high_water.value = 0;
+#if SDL_EVENT_WAKEUP_PIPE
+	if ( SDL_InitEventWakeup(&SDL_QueueWakeup) < 0 ) {
+		return(-1);
+	}
+#endif
+	return(0);
+}
+
+static void SDL_FreeEventQueue(void)
+{
+	SDL_EventSegment *segment, *next;
+
+	for ( segment = SDL_EventQ.head; segment; segment = next ) {
+		next = segment->next;
+		SDL_free(segment);
+	}
+	for ( segment = SDL_EventQ.retired; segment; segment = next ) {
+		next = segment->next;
+		SDL_free(segment);
+	}
+	if ( SDL_EventQ.spare ) {
+		SDL_free(SDL_EventQ.spare);
+	}
+	SDL_EventQ.head = NULL;
+	SDL_EventQ.head_slot = 0;
+	SDL_EventQ.retired = NULL;
+	SDL_EventQ.tail = NULL;
+	SDL_EventQ.spare = NULL;
+	SDL_EventQ.count.value = 0;
+	SDL_EventQ.wmmsg_next.value = 0;
+#if SDL_EVENT_WAKEUP_PIPE
+	SDL_QuitEventWakeup(&SDL_QueueWakeup);
+#endif
+}
+
 /* Thread functions */
 static SDL_Thread *SDL_EventThread = NULL;	/* Thread handle */
 static Uint32 event_thread;			/* The event thread id */
+static volatile Uint32 event_thread_wakeups;	/* Times it stopped sleeping */
+static Uint32 event_stats_ticks;		/* When the stats were reset */
+
+static void SDL_EventThreadWait(void);
+
+void SDL_WakeupEventThread(void)
+{
+#if SDL_EVENT_WAKEUP_PIPE
+	if ( SDL_EventThread ) {
+		SDL_SignalEventWakeup(&SDL_ThreadWakeup);
+	}
+#endif
+}
 
 void SDL_Lock_EventThread(void)
 {
@@ -73,6 +302,9 @@ void SDL_Unlock_EventThread(void)
 {
 	if ( SDL_EventThread && (SDL_ThreadID() != event_thread) ) {
 		SDL_mutexV(SDL_EventLock.lock);
+
+		/* We may have read input the event thread was waiting for */
+		SDL_WakeupEventThread();
 	}
 }
 
@@ -117,12 +349,12 @@ static int SDLCALL SDL_GobbleEvents(void *unused)
 		}
 #endif
 
-		/* Give up the CPU for the rest of our timeslice */
+		/* Sleep until there's input, a timer is due or we're woken */
 		SDL_EventLock.safe = 1;
 		if ( SDL_timer_running ) {
 			SDL_ThreadedTimerCheck();
 		}
-		SDL_Delay(1);
+		SDL_EventThreadWait();
 
 		/* Check for event locking.
 		   On the P of the lock mutex, if the lock is held, this thread
@@ -158,6 +390,9 @@ static int SDL_StartEventThread(Uint32 flags)
 #endif
 	}
 #endif /* !SDL_THREADS_DISABLED */
+	if ( SDL_InitEventQueue() < 0 ) {
+		return(-1);
+	}
 	SDL_EventQ.active = 1;
 
 	if ( (flags&SDL_INIT_EVENTTHREAD) == SDL_INIT_EVENTTHREAD ) {
@@ -166,6 +401,13 @@ static int SDL_StartEventThread(Uint32 flags)
 			return(-1);
 		}
 		SDL_EventLock.safe = 0;
+#if SDL_EVENT_WAKEUP_PIPE
+		if ( SDL_InitEventWakeup(&SDL_ThreadWakeup) < 0 ) {
+			return(-1);
+		}
+#endif
+		event_thread_wakeups = 0;
+		event_stats_ticks = SDL_GetTicks();
 
 		/* The event thread will handle timers too */
 		SDL_SetTimerThreaded(2);
@@ -188,11 +430,15 @@ static void SDL_StopEventThread(void)
 {
 	SDL_EventQ.active = 0;
 	if ( SDL_EventThread ) {
+		SDL_WakeupEventThread();
 		SDL_WaitThread(SDL_EventThread, NULL);
 		SDL_EventThread = NULL;
 		SDL_DestroyMutex(SDL_EventLock.lock);
 		SDL_EventLock.lock = NULL;
 	}
+#if SDL_EVENT_WAKEUP_PIPE
+	SDL_QuitEventWakeup(&SDL_ThreadWakeup);
+#endif
 #ifndef IPOD
 	SDL_DestroyMutex(SDL_EventQ.lock);
 	SDL_EventQ.lock = NULL;
@@ -218,9 +464,7 @@ void SDL_StopEventLoop(void)
 	SDL_QuitQuit();
 
 	/* Clean out EventQ */
-	SDL_EventQ.head = 0;
-	SDL_EventQ.tail = 0;
-	SDL_EventQ.wmmsg_next = 0;
+	SDL_FreeEventQueue();
 }
 
 /* This function (and associated calls) may be called more than once */
@@ -261,58 +505,109 @@ int SDL_StartEventLoop(Uint32 flags)
 }
 
 
-/* Add an event to the event queue -- called with the queue locked */
+/* Add an event to the event queue -- called without the queue locked,
+   unless the queue isn't lock-free.
+ */
 static int SDL_AddEvent(SDL_Event *event)
 {
-	int tail, added;
+	SDL_EventSegment *segment, *next;
+	SDL_Event *slot;
+	int index, count, high_water;
 
-	tail = (SDL_EventQ.tail+1)%MAXEVENTS;
-	if ( tail == SDL_EventQ.head ) {
+	if ( SDL_EventQ.count.value >= MAXEVENTS ) {
 		/* Overflow, drop event */
-		added = 0;
-	} else {
-		SDL_EventQ.event[SDL_EventQ.tail] = *event;
-		if (event->type == SDL_SYSWMEVENT) {
-			/* Note that it's possible to lose an event */
-			int next = SDL_EventQ.wmmsg_next;
-			SDL_EventQ.wmmsg[next] = *event->syswm.msg;
-		        SDL_EventQ.event[SDL_EventQ.tail].syswm.msg =
-						&SDL_EventQ.wmmsg[next];
-			SDL_EventQ.wmmsg_next = (next+1)%MAXEVENTS;
+		EVQ_FetchAdd(&SDL_EventQ.dropped, 1);
+		return(0);
+	}
+
+	/* The reader won't recycle a segment while we're in here */
+	EVQ_FetchAdd(&SDL_EventQ.producers, 1);
+	for ( ; ; ) {
+		segment = SDL_EventQ.tail;
+		index = EVQ_FetchAdd(&segment->reserved, 1);
+		if ( index < EVENTS_PER_SEGMENT ) {
+			break;
 		}
-		SDL_EventQ.tail = tail;
-		added = 1;
-	}
-	return(added);
-}
-
-/* Cut an event, and return the next valid spot, or the tail */
-/*                           -- called with the queue locked */
-static int SDL_CutEvent(int spot)
-{
-	if ( spot == SDL_EventQ.head ) {
-		SDL_EventQ.head = (SDL_EventQ.head+1)%MAXEVENTS;
-		return(SDL_EventQ.head);
-	} else
-	if ( (spot+1)%MAXEVENTS == SDL_EventQ.tail ) {
-		SDL_EventQ.tail = spot;
-		return(SDL_EventQ.tail);
-	} else
-	/* We cut the middle -- shift everything over */
-	{
-		int here, next;
-
-		/* This can probably be optimized with SDL_memcpy() -- careful! */
-		if ( --SDL_EventQ.tail < 0 ) {
-			SDL_EventQ.tail = MAXEVENTS-1;
+
+		/* The tail is full, link in a new one and move the tail on */
+		next = segment->next;
+		if ( next == NULL ) {
+			next = SDL_AllocEventSegment();
+			if ( next == NULL ) {
+				EVQ_FetchAdd(&SDL_EventQ.producers, -1);
+				EVQ_FetchAdd(&SDL_EventQ.dropped, 1);
+				return(0);
+			}
+			if ( !EVQ_CASPtr(&segment->next, NULL, next) ) {
+				/* Somebody else got there first */
+				SDL_RecycleEventSegment(next);
+				next = segment->next;
+			}
 		}
-		for ( here=spot; here != SDL_EventQ.tail; here = next ) {
-			next = (here+1)%MAXEVENTS;
-			SDL_EventQ.event[here] = SDL_EventQ.event[next];
+		EVQ_CASPtr(&SDL_EventQ.tail, segment, next);
+	}
+
+	slot = &segment->event[index];
+	*slot = *event;
+	if (event->type == SDL_SYSWMEVENT) {
+		/* The ring is as big as the queue, so the messages of
+		   events still in the queue are never overwritten */
+		int wmmsg = EVQ_FetchAdd(&SDL_EventQ.wmmsg_next, 1) % MAXWMMSGS;
+		if ( wmmsg < 0 ) {
+			wmmsg += MAXWMMSGS;
+		}
+		SDL_EventQ.wmmsg[wmmsg] = *event->syswm.msg;
+		slot->syswm.msg = &SDL_EventQ.wmmsg[wmmsg];
+	}
+	EVQ_Barrier();
+	segment->state[index] = SLOT_READY;
+
+	count = EVQ_FetchAdd(&SDL_EventQ.count, 1) + 1;
+	do {
+		high_water = SDL_EventQ.high_water.value;
+	} while ( (count > high_water) &&
+	          !EVQ_CAS(&SDL_EventQ.high_water, high_water, count) );
+
+	EVQ_FetchAdd(&SDL_EventQ.producers, -1);
+	return(1);
+}
+
+/* Move the head past taken events, and recycle finished segments
+   -- called with the queue locked
+ */
+static void SDL_AdvanceEventHead(void)
+{
+	SDL_EventSegment *segment;
+
+	for ( ; ; ) {
+		segment = SDL_EventQ.head;
+		if ( SDL_EventQ.head_slot == EVENTS_PER_SEGMENT ) {
+			if ( segment->next == NULL ) {
+				break;
+			}
+			SDL_EventQ.head = segment->next;
+			SDL_EventQ.head_slot = 0;
+			segment->next = SDL_EventQ.retired;
+			SDL_EventQ.retired = segment;
+		} else
+		if ( segment->state[SDL_EventQ.head_slot] == SLOT_TAKEN ) {
+			++SDL_EventQ.head_slot;
+		} else {
+			break;
+		}
+	}
+
+	/* Once no producer is running, nobody can see the retired segments */
+	if ( SDL_EventQ.retired ) {
+		EVQ_Barrier();
+		if ( SDL_EventQ.producers.value == 0 ) {
+			while ( SDL_EventQ.retired ) {
+				segment = SDL_EventQ.retired;
+				SDL_EventQ.retired = segment->next;
+				SDL_RecycleEventSegment(segment);
+			}
 		}
-		return(spot);
 	}
-	/* NOTREACHED */
 }
 
 /* Lock the event queue, take a peep at it, and unlock it */
@@ -325,8 +620,23 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 	if ( ! SDL_EventQ.active ) {
 		return(-1);
 	}
-	/* Lock the event queue */
 	used = 0;
+#if SDL_EVENTQ_LOCKFREE
+	/* Adding events doesn't need the lock */
+	if ( action == SDL_ADDEVENT ) {
+		for ( i=0; i<numevents; ++i ) {
+			used += SDL_AddEvent(&events[i]);
+		}
+#if SDL_EVENT_WAKEUP_PIPE
+		/* The queue count was updated with a full barrier */
+		if ( used && SDL_QueueWakeup.waiting.value ) {
+			SDL_SignalEventWakeup(&SDL_QueueWakeup);
+		}
+#endif
+		return(used);
+	}
+#endif
+	/* Lock the event queue */
 	if ( SDL_mutexP(SDL_EventQ.lock) == 0 ) {
 		if ( action == SDL_ADDEVENT ) {
 			for ( i=0; i<numevents; ++i ) {
@@ -334,7 +644,8 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 			}
 		} else {
 			SDL_Event tmpevent;
-			int spot;
+			SDL_EventSegment *segment;
+			int spot, state;
 
 			/* If 'events' is NULL, just see if they exist */
 			if ( events == NULL ) {
@@ -342,18 +653,35 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 				numevents = 1;
 				events = &tmpevent;
 			}
-			spot = SDL_EventQ.head;
-			while ((used < numevents)&&(spot != SDL_EventQ.tail)) {
-				if ( mask & SDL_EVENTMASK(SDL_EventQ.event[spot].type) ) {
-					events[used++] = SDL_EventQ.event[spot];
+			segment = SDL_EventQ.head;
+			spot = SDL_EventQ.head_slot;
+			while ( used < numevents ) {
+				if ( spot == EVENTS_PER_SEGMENT ) {
+					segment = segment->next;
+					if ( segment == NULL ) {
+						break;
+					}
+					spot = 0;
+				}
+				/* Stop at a slot that's still being written,
+				   so events are seen in the order they came */
+				state = segment->state[spot];
+				if ( state == SLOT_EMPTY ) {
+					break;
+				}
+				EVQ_Barrier();
+				if ( (state == SLOT_READY) &&
+				     (mask & SDL_EVENTMASK(segment->event[spot].type)) ) {
+					events[used++] = segment->event[spot];
 					if ( action == SDL_GETEVENT ) {
-						spot = SDL_CutEvent(spot);
-					} else {
-						spot = (spot+1)%MAXEVENTS;
+						segment->state[spot] = SLOT_TAKEN;
+						EVQ_FetchAdd(&SDL_EventQ.count, -1);
 					}
-				} else {
-					spot = (spot+1)%MAXEVENTS;
 				}
+				++spot;
+			}
+			if ( action == SDL_GETEVENT ) {
+				SDL_AdvanceEventHead();
 			}
 		}
 		SDL_mutexV(SDL_EventQ.lock);
@@ -364,6 +692,32 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 	return(used);
 }
 
+void SDL_GetEventQueueStats(SDL_EventQueueStats *stats)
+{
+	stats->queued = SDL_EventQ.count.value;
+	stats->high_water = SDL_EventQ.high_water.value;
+	stats->dropped = SDL_EventQ.dropped.value;
+	stats->thread_wakeups = 0;
+	stats->thread_wakeups_per_sec = 0.0f;
+	if ( SDL_EventThread ) {
+		Uint32 elapsed = SDL_GetTicks() - event_stats_ticks;
+
+		stats->thread_wakeups = event_thread_wakeups;
+		if ( elapsed > 0 ) {
+			stats->thread_wakeups_per_sec =
+				(float)stats->thread_wakeups * 1000.0f / elapsed;
+		}
+	}
+}
+
+void SDL_ResetEventQueueStats(void)
+{
+	SDL_EventQ.high_water.value = SDL_EventQ.count.value;
+	SDL_EventQ.dropped.value = 0;
+	event_thread_wakeups = 0;
+	event_stats_ticks = SDL_GetTicks();
+}
+
 /* Run the system dependent event loops */
 void SDL_PumpEvents(void)
 {
@@ -400,18 +754,149 @@ int SDL_PollEvent (SDL_Event *event)
 	return 1;
 }
 
-int SDL_WaitEvent (SDL_Event *event)
+static void SDL_LowerTimeout(int *timeout, int limit)
+{
+	if ( (limit >= 0) && ((*timeout < 0) || (limit < *timeout)) ) {
+		*timeout = limit;
+	}
+}
+
+#if SDL_EVENT_WAKEUP_PIPE
+/* Fill 'pfd' with the descriptors that PumpEvents() and the joystick code
+   read from, and lower 'timeout' to when they next have to be checked.
+   If any of them can't be waited on, they're checked every 'interval' ms.
+ */
+static int SDL_GetEventSources(struct pollfd *pfd, int maxfds,
+                               int *timeout, int interval)
+{
+	SDL_VideoDevice *this = current_video;
+	int fds[MAXEVENTFDS];
+	int i, n, nfds, polled;
+
+	nfds = 0;
+	polled = 0;
+	if ( this ) {
+		n = -1;
+		if ( this->GetEventFDs ) {
+			n = this->GetEventFDs(this, fds, maxfds, timeout);
+		}
+		if ( n < 0 ) {
+			polled = 1;
+		}
+		for ( i = 0; i < n; ++i ) {
+			pfd[nfds].fd = fds[i];
+			pfd[nfds].events = POLLIN;
+			++nfds;
+		}
+	}
+#if !SDL_JOYSTICK_DISABLED
+	if ( SDL_numjoysticks && (SDL_eventstate & SDL_JOYEVENTMASK) ) {
+		n = SDL_JoystickGetFDs(fds, maxfds - nfds);
+		if ( n < 0 ) {
+			polled = 1;
+		}
+		for ( i = 0; i < n; ++i ) {
+			pfd[nfds].fd = fds[i];
+			pfd[nfds].events = POLLIN;
+			++nfds;
+		}
+	}
+#endif
+	SDL_LowerTimeout(timeout, SDL_NextKeyRepeat());
+	if ( polled ) {
+		SDL_LowerTimeout(timeout, interval);
+	}
+	return(nfds);
+}
+#endif /* SDL_EVENT_WAKEUP_PIPE */
+
+/* Sleep until the event thread has something to do */
+static void SDL_EventThreadWait(void)
+{
+#if SDL_EVENT_WAKEUP_PIPE
+	struct pollfd pfd[1+MAXEVENTFDS];
+	int nfds, timeout;
+
+	timeout = -1;
+	if ( SDL_timer_running ) {
+		SDL_LowerTimeout(&timeout, SDL_ThreadedTimerTimeout());
+	}
+	nfds = SDL_GetEventSources(&pfd[1], MAXEVENTFDS, &timeout, 1);
+	pfd[0].fd = SDL_ThreadWakeup.fds[0];
+	pfd[0].events = POLLIN;
+	if ( poll(pfd, 1+nfds, timeout) > 0 && pfd[0].revents ) {
+		SDL_DrainEventWakeup(&SDL_ThreadWakeup);
+	}
+#else
+	SDL_Delay(1);
+#endif
+	++event_thread_wakeups;
+}
+
+/* Sleep until there might be new events, or 'timeout' ms have passed */
+static void SDL_WaitForEvents(int timeout)
+{
+#if SDL_EVENT_WAKEUP_PIPE
+	struct pollfd pfd[1+MAXEVENTFDS];
+	int nfds;
+
+	/* The event thread does the pumping, it will push events */
+	nfds = 0;
+	if ( !SDL_EventThread ) {
+		nfds = SDL_GetEventSources(&pfd[1], MAXEVENTFDS, &timeout, 10);
+	}
+	pfd[0].fd = SDL_QueueWakeup.fds[0];
+	pfd[0].events = POLLIN;
+
+	/* Tell producers to wake us, then make sure nothing came in
+	   before they could see that. */
+	EVQ_FetchAdd(&SDL_QueueWakeup.waiting, 1);
+	if ( SDL_EventQ.count.value == 0 ) {
+		poll(pfd, 1+nfds, timeout);
+	}
+	EVQ_FetchAdd(&SDL_QueueWakeup.waiting, -1);
+	SDL_DrainEventWakeup(&SDL_QueueWakeup);
+#else
+	/* Nothing to block on, poll for events */
+	SDL_LowerTimeout(&timeout, SDL_NextKeyRepeat());
+	SDL_LowerTimeout(&timeout, 10);
+	SDL_Delay(timeout);
+#endif
+}
+
+int SDL_WaitEventTimeout (SDL_Event *event, int timeout)
 {
+	Uint32 expiration = 0;
+	int wait;
+
+	if ( timeout > 0 ) {
+		expiration = SDL_GetTicks() + timeout;
+	}
 	while ( 1 ) {
 		SDL_PumpEvents();
 		switch(SDL_PeepEvents(event, 1, SDL_GETEVENT, SDL_ALLEVENTS)) {
 		    case -1: return 0;
 		    case 1: return 1;
-		    case 0: SDL_Delay(10);
+		    case 0: break;
 		}
+		wait = -1;
+		if ( timeout == 0 ) {
+			return 0;
+		} else if ( timeout > 0 ) {
+			wait = (int)(expiration - SDL_GetTicks());
+			if ( wait <= 0 ) {
+				return 0;
+			}
+		}
+		SDL_WaitForEvents(wait);
 	}
 }
 
+int SDL_WaitEvent (SDL_Event *event)
+{
+	return SDL_WaitEventTimeout(event, -1);
+}
+
 int SDL_PushEvent(SDL_Event *event)
 {
 	if ( SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0) <= 0 )
@@ -29,6 +29,9 @@ extern int SDL_StartEventLoop(Uint32 flags);
 extern void SDL_StopEventLoop(void);
 extern void SDL_QuitInterrupt(void);
 
+/* Make the event thread recheck how long it can sleep */
+extern void SDL_WakeupEventThread(void);
+
 extern void SDL_Lock_EventThread(void);
 extern void SDL_Unlock_EventThread(void);
 extern Uint32 SDL_EventThreadID(void);
@@ -76,6 +79,9 @@ extern void SDL_ResetKeyboard(void);
 /* Used by the event loop to queue pending keyboard repeat events */
 extern void SDL_CheckKeyRepeat(void);
 
+/* Used by the event loop to know how long it can sleep, in milliseconds */
+extern int SDL_NextKeyRepeat(void);
+
 /* Used by the OS keyboard code to detect whether or not to do UNICODE */
 #ifndef DEFAULT_UNICODE_TRANSLATION
 #define DEFAULT_UNICODE_TRANSLATION 0	/* Default off because of overhead */
@@ -609,6 +609,26 @@ void SDL_CheckKeyRepeat(void)
 	}
 }
 
+/* How long until SDL_CheckKeyRepeat() has work to do, or -1 for never */
+int SDL_NextKeyRepeat(void)
+{
+	Uint32 elapsed, wait;
+
+	if ( ! SDL_KeyRepeat.timestamp ) {
+		return(-1);
+	}
+	elapsed = (SDL_GetTicks() - SDL_KeyRepeat.timestamp);
+	if ( SDL_KeyRepeat.firsttime ) {
+		wait = (Uint32)SDL_KeyRepeat.delay;
+	} else {
+		wait = (Uint32)SDL_KeyRepeat.interval;
+	}
+	if ( elapsed > wait ) {
+		return(0);
+	}
+	return(wait - elapsed + 1);
+}
+
 int SDL_EnableKeyRepeat(int delay, int interval)
 {
 	if ( (delay < 0) || (interval < 0) ) {
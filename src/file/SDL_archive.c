@@ -0,0 +1,717 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Read-only archives of many files, looked up by name through a hash table.
+
+   Everything is little endian, and offsets are from the start of the
+   archive, which doesn't have to be the start of the file.
+
+	Header, 32 bytes:
+		"SDLPACK1", version, flags, count, nbuckets, dir_offset, dir_size
+	File data, each file starting on a 64 byte boundary, either stored
+	as is or written by SDL_CompressRW()
+	Directory, at dir_offset:
+		Uint32 buckets[nbuckets+1], the first entry of each bucket
+		SDL_ArchiveEntry entries[count], sorted by bucket
+		The names, each one followed by a '\0'
+
+   A name's bucket is the low bits of its FNV-1a hash, nbuckets being a
+   power of two, so finding a file only compares against the few names
+   in its bucket.
+*/
+
+#include "SDL_endian.h"
+#include "SDL_mutex.h"
+#include "SDL_rwops.h"
+#include "SDL_archive.h"
+#include "SDL_endian_c.h"
+
+#define ARCHIVE_MAGIC		"SDLPACK1"
+#define ARCHIVE_VERSION		1
+#define ARCHIVE_HEADER_SIZE	32
+#define ARCHIVE_ALIGN		64
+#define ARCHIVE_MAX_COUNT	0x00100000
+#define ARCHIVE_COPY_SIZE	(64*1024)
+#define ARCHIVE_MIN_COMPRESS	1024
+
+/* How file data is kept in the archive */
+#define ARCHIVE_STORED		0
+#define ARCHIVE_COMPRESSED	1
+
+typedef struct SDL_ArchiveEntry {
+	Uint32 hash;
+	Uint32 name;		/* Offset of the name in the names */
+	Uint32 namelen;
+	Uint32 offset;		/* Offset of the data in the archive */
+	Uint32 size;		/* Size of the file */
+	Uint32 stored;		/* Size of the data in the archive */
+	Uint32 method;
+	Uint32 reserved;
+} SDL_ArchiveEntry;
+
+struct SDL_Archive {
+	SDL_RWops *src;
+	int freesrc;
+	int start;		/* Where the archive starts in src */
+	const Uint8 *base;	/* The archive, if src is in memory */
+	SDL_mutex *lock;	/* Keeps reads of src from interleaving */
+	Uint32 srcpos;		/* Where src was left, if srcknown */
+	int srcknown;
+
+	Uint32 count;
+	Uint32 nbuckets;
+	Uint32 *directory;
+	Uint32 *buckets;
+	SDL_ArchiveEntry *entries;
+	char *names;
+	Uint32 namesize;
+};
+
+/* A file in an archive that isn't in memory */
+typedef struct SDL_ArchiveFile {
+	SDL_Archive *archive;
+	Uint32 offset;
+	Uint32 size;
+	Uint32 pos;
+} SDL_ArchiveFile;
+
+static Uint32 Archive_Hash(const char *name, Uint32 *len)
+{
+	const Uint8 *p = (const Uint8 *)name;
+	Uint32 hash = 2166136261u;
+
+	while ( *p ) {
+		hash ^= *p++;
+		hash *= 16777619u;
+	}
+	*len = (Uint32)(p - (const Uint8 *)name);
+	return(hash);
+}
+
+static int Archive_SeekSrc(SDL_Archive *archive, Uint32 offset)
+{
+	if ( archive->srcknown && archive->srcpos == offset ) {
+		return(0);
+	}
+#ifdef SDL_HAS_64BIT_TYPE
+	if ( SDL_RWseek64(archive->src, (Sint64)archive->start + offset, RW_SEEK_SET) < 0 ) {
+		archive->srcknown = 0;
+		return(-1);
+	}
+#else
+	if ( offset > (Uint32)(0x7FFFFFFF - archive->start) ||
+	     SDL_RWseek(archive->src, archive->start + (int)offset, RW_SEEK_SET) < 0 ) {
+		archive->srcknown = 0;
+		return(-1);
+	}
+#endif
+	archive->srcpos = offset;
+	archive->srcknown = 1;
+	return(0);
+}
+
+static int SDLCALL archive_seek(SDL_RWops *context, int offset, int whence)
+{
+	SDL_ArchiveFile *file = (SDL_ArchiveFile *)context->hidden.unknown.data1;
+	Sint32 newpos;
+
+	switch (whence) {
+		case RW_SEEK_SET:
+			newpos = offset;
+			break;
+		case RW_SEEK_CUR:
+			newpos = (Sint32)file->pos + offset;
+			break;
+		case RW_SEEK_END:
+			newpos = (Sint32)file->size + offset;
+			break;
+		default:
+			SDL_SetError("Unknown value for 'whence'");
+			return(-1);
+	}
+	if ( newpos < 0 ) {
+		newpos = 0;
+	}
+	if ( (Uint32)newpos > file->size ) {
+		newpos = (Sint32)file->size;
+	}
+	file->pos = (Uint32)newpos;
+	return(newpos);
+}
+
+static int SDLCALL archive_read(SDL_RWops *context, void *ptr, int size, int maxnum)
+{
+	SDL_ArchiveFile *file = (SDL_ArchiveFile *)context->hidden.unknown.data1;
+	SDL_Archive *archive = file->archive;
+	size_t total_bytes;
+	int n;
+
+	total_bytes = (maxnum * size);
+	if ( (maxnum <= 0) || (size <= 0) || ((total_bytes / maxnum) != (size_t) size) ) {
+		return 0;
+	}
+	if ( total_bytes > file->size - file->pos ) {
+		total_bytes = file->size - file->pos;
+	}
+	if ( total_bytes == 0 ) {
+		return 0;
+	}
+
+	if ( archive->lock ) {
+		SDL_mutexP(archive->lock);
+	}
+	if ( Archive_SeekSrc(archive, file->offset + file->pos) < 0 ) {
+		n = -1;
+	} else {
+		n = SDL_RWread(archive->src, ptr, 1, (int)total_bytes);
+		if ( n > 0 ) {
+			archive->srcpos += n;
+		} else {
+			archive->srcknown = 0;
+		}
+	}
+	if ( archive->lock ) {
+		SDL_mutexV(archive->lock);
+	}
+	if ( n < 0 ) {
+		return(-1);
+	}
+
+	file->pos += n;
+	return(n / size);
+}
+
+static int SDLCALL archive_write(SDL_RWops *context, const void *ptr, int size, int num)
+{
+	SDL_SetError("Can't write to a file in an archive");
+	return(-1);
+}
+
+static int SDLCALL archive_close(SDL_RWops *context)
+{
+	if ( context ) {
+		SDL_free(context->hidden.unknown.data1);
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+
+static void Archive_Free(SDL_Archive *archive)
+{
+	if ( archive->freesrc ) {
+		SDL_RWclose(archive->src);
+	}
+	if ( archive->lock ) {
+		SDL_DestroyMutex(archive->lock);
+	}
+	if ( archive->directory ) {
+		SDL_free(archive->directory);
+	}
+	SDL_free(archive);
+}
+
+/* Check that everything in the directory points somewhere sensible, so
+   lookups and reads don't have to.
+ */
+static int Archive_CheckDirectory(SDL_Archive *archive, Uint32 dir_offset)
+{
+	const SDL_ArchiveEntry *entry;
+	Uint32 i;
+
+	if ( archive->buckets[0] != 0 ||
+	     archive->buckets[archive->nbuckets] != archive->count ) {
+		return(-1);
+	}
+	for ( i = 0; i < archive->nbuckets; ++i ) {
+		if ( archive->buckets[i] > archive->buckets[i+1] ) {
+			return(-1);
+		}
+	}
+	for ( i = 0; i < archive->count; ++i ) {
+		entry = &archive->entries[i];
+		if ( entry->name >= archive->namesize ||
+		     entry->namelen >= archive->namesize - entry->name ||
+		     archive->names[entry->name + entry->namelen] != '\0' ) {
+			return(-1);
+		}
+		if ( entry->offset > dir_offset ||
+		     entry->stored > dir_offset - entry->offset ||
+		     entry->size > 0x7FFFFFFF || entry->stored > 0x7FFFFFFF ) {
+			return(-1);
+		}
+	}
+	return(0);
+}
+
+SDL_Archive *SDL_OpenArchive_RW(SDL_RWops *src, int freesrc)
+{
+	SDL_Archive *archive;
+	char magic[8];
+	Uint32 header[6];
+	Uint32 version, count, nbuckets, dir_offset, dir_size, tables;
+	const void *base;
+	size_t avail;
+
+	if ( !src ) {
+		/* The error message has been set in SDL_RWFromFile */
+		return(NULL);
+	}
+
+	archive = (SDL_Archive *)SDL_malloc(sizeof(*archive));
+	if ( !archive ) {
+		SDL_OutOfMemory();
+		if ( freesrc ) {
+			SDL_RWclose(src);
+		}
+		return(NULL);
+	}
+	SDL_memset(archive, 0, sizeof(*archive));
+	archive->src = src;
+	archive->freesrc = freesrc;
+	archive->start = SDL_RWtell(src);
+	if ( archive->start < 0 ) {
+		archive->start = 0;
+	}
+	base = SDL_RWmap(src, &avail);
+
+	if ( SDL_RWread(src, magic, sizeof(magic), 1) != 1 ||
+	     SDL_ReadLE32Array(src, header, SDL_arraysize(header)) != SDL_arraysize(header) ) {
+		SDL_SetError("Couldn't read archive header");
+		goto error;
+	}
+	if ( SDL_memcmp(magic, ARCHIVE_MAGIC, sizeof(magic)) != 0 ) {
+		SDL_SetError("File is not an SDL archive");
+		goto error;
+	}
+	version = header[0];
+	count = header[2];
+	nbuckets = header[3];
+	dir_offset = header[4];
+	dir_size = header[5];
+	if ( version != ARCHIVE_VERSION ) {
+		SDL_SetError("Unsupported archive version %d", (int)version);
+		goto error;
+	}
+
+	/* Sizes are limited so none of this can overflow */
+	if ( count > ARCHIVE_MAX_COUNT ||
+	     nbuckets == 0 || nbuckets > ARCHIVE_MAX_COUNT ||
+	     (nbuckets & (nbuckets - 1)) != 0 ) {
+		SDL_SetError("Corrupt archive header");
+		goto error;
+	}
+	tables = (nbuckets + 1) * sizeof(Uint32) + count * sizeof(SDL_ArchiveEntry);
+	if ( dir_size < tables || dir_size > 0x7FFFFFFF ||
+	     dir_offset < ARCHIVE_HEADER_SIZE ||
+	     dir_size > 0xFFFFFFFF - dir_offset ) {
+		SDL_SetError("Corrupt archive header");
+		goto error;
+	}
+
+	/* One allocation for the whole directory, with room for a '\0' */
+	archive->directory = (Uint32 *)SDL_malloc(dir_size + 1);
+	if ( !archive->directory ) {
+		SDL_OutOfMemory();
+		goto error;
+	}
+	if ( Archive_SeekSrc(archive, dir_offset) < 0 ||
+	     SDL_RWread(src, archive->directory, 1, dir_size) != (int)dir_size ) {
+		SDL_SetError("Couldn't read archive directory");
+		goto error;
+	}
+	archive->srcknown = 0;
+	SDL_SwapArrayLE32(archive->directory, tables / sizeof(Uint32));
+
+	archive->count = count;
+	archive->nbuckets = nbuckets;
+	archive->buckets = archive->directory;
+	archive->entries = (SDL_ArchiveEntry *)(archive->buckets + nbuckets + 1);
+	archive->names = (char *)archive->directory + tables;
+	archive->namesize = dir_size - tables;
+	archive->names[archive->namesize] = '\0';
+	if ( Archive_CheckDirectory(archive, dir_offset) < 0 ) {
+		SDL_SetError("Corrupt archive directory");
+		goto error;
+	}
+
+	/* Files in memory are used in place, anything else is shared */
+	if ( base && avail >= (size_t)dir_offset + dir_size ) {
+		archive->base = (const Uint8 *)base;
+	} else {
+		archive->lock = SDL_CreateMutex();
+	}
+	return(archive);
+
+error:
+	Archive_Free(archive);
+	return(NULL);
+}
+
+static const SDL_ArchiveEntry *Archive_Find(SDL_Archive *archive, const char *name)
+{
+	const SDL_ArchiveEntry *entry, *last;
+	Uint32 hash, len, bucket;
+
+	hash = Archive_Hash(name, &len);
+	bucket = hash & (archive->nbuckets - 1);
+	entry = &archive->entries[archive->buckets[bucket]];
+	last = &archive->entries[archive->buckets[bucket+1]];
+	for ( ; entry < last; ++entry ) {
+		if ( entry->hash == hash && entry->namelen == len &&
+		     SDL_memcmp(archive->names + entry->name, name, len) == 0 ) {
+			return(entry);
+		}
+	}
+	return(NULL);
+}
+
+SDL_RWops *SDL_RWFromArchive(SDL_Archive *archive, const char *name)
+{
+	const SDL_ArchiveEntry *entry;
+	SDL_ArchiveFile *file;
+	SDL_RWops *rwops;
+
+	if ( !archive || !name ) {
+		SDL_SetError("SDL_RWFromArchive(): passed NULL");
+		return(NULL);
+	}
+	entry = Archive_Find(archive, name);
+	if ( !entry ) {
+		SDL_SetError("Couldn't find %s in archive", name);
+		return(NULL);
+	}
+	if ( (entry->method != ARCHIVE_STORED || entry->stored != entry->size) &&
+	     entry->method != ARCHIVE_COMPRESSED ) {
+		SDL_SetError("Unsupported compression method for %s", name);
+		return(NULL);
+	}
+
+	if ( archive->base ) {
+		rwops = SDL_RWFromConstMem(archive->base + entry->offset, (int)entry->stored);
+	} else {
+		file = (SDL_ArchiveFile *)SDL_malloc(sizeof(*file));
+		if ( !file ) {
+			SDL_OutOfMemory();
+			return(NULL);
+		}
+		file->archive = archive;
+		file->offset = entry->offset;
+		file->size = entry->stored;
+		file->pos = 0;
+
+		rwops = SDL_AllocRW();
+		if ( !rwops ) {
+			SDL_free(file);
+			return(NULL);
+		}
+		rwops->seek = archive_seek;
+		rwops->read = archive_read;
+		rwops->write = archive_write;
+		rwops->close = archive_close;
+		rwops->hidden.unknown.data1 = file;
+	}
+
+	if ( rwops && entry->method == ARCHIVE_COMPRESSED ) {
+		rwops = SDL_RWFromCompressed(rwops, 1);
+	}
+	return(rwops);
+}
+
+int SDL_GetArchiveSize(SDL_Archive *archive)
+{
+	if ( !archive ) {
+		return(0);
+	}
+	return((int)archive->count);
+}
+
+const char *SDL_GetArchiveName(SDL_Archive *archive, int index)
+{
+	if ( !archive || index < 0 || (Uint32)index >= archive->count ) {
+		return(NULL);
+	}
+	return(archive->names + archive->entries[index].name);
+}
+
+void SDL_CloseArchive(SDL_Archive *archive)
+{
+	if ( archive ) {
+		Archive_Free(archive);
+	}
+}
+
+/* Pad the archive with zeros up to the next ARCHIVE_ALIGN boundary */
+static int Archive_Pad(SDL_RWops *dst, Uint32 *pos)
+{
+	static const Uint8 zeros[ARCHIVE_ALIGN];
+	Uint32 pad = (ARCHIVE_ALIGN - (*pos % ARCHIVE_ALIGN)) % ARCHIVE_ALIGN;
+
+	if ( pad > 0xFFFFFFFF - *pos ) {
+		SDL_SetError("Archive is too large");
+		return(-1);
+	}
+	if ( pad && SDL_RWwrite(dst, zeros, pad, 1) != 1 ) {
+		return(-1);
+	}
+	*pos += pad;
+	return(0);
+}
+
+/* Compress a file into the archive, returns its size or -1 */
+static Sint32 Archive_Compress(SDL_RWops *dst, int start, SDL_RWops *src, int method, Uint32 *pos)
+{
+	int end;
+
+	if ( SDL_CompressRW(src, dst, method, 0) < 0 ) {
+		return(-1);
+	}
+	end = SDL_RWtell(dst);
+	if ( end < start || (Uint32)(end - start) < *pos ) {
+		SDL_SetError("Archive is too large");
+		return(-1);
+	}
+	end -= start;
+	*pos = (Uint32)end;
+	return(0);
+}
+
+/* Copy a file into the archive, compressing it if 'method' is set and
+   it's big enough to be worth it.  Returns 0 or -1.
+ */
+static int Archive_Copy(SDL_RWops *dst, int start, const char *path, Uint8 *buf, int method, SDL_ArchiveEntry *entry, Uint32 *pos)
+{
+	SDL_RWops *src;
+	Sint32 size;
+	int n;
+
+	src = SDL_RWFromFile(path, "rb");
+	if ( !src ) {
+		return(-1);
+	}
+	size = SDL_RWseek(src, 0, RW_SEEK_END);
+	if ( size < 0 || SDL_RWseek(src, 0, RW_SEEK_SET) < 0 ) {
+		SDL_RWclose(src);
+		return(-1);
+	}
+	if ( method && size >= ARCHIVE_MIN_COMPRESS ) {
+		n = Archive_Compress(dst, start, src, method, pos);
+		SDL_RWclose(src);
+		entry->method = ARCHIVE_COMPRESSED;
+		entry->size = (Uint32)size;
+		entry->stored = *pos - entry->offset;
+		return(n);
+	}
+
+	size = 0;
+	while ( (n = SDL_RWread(src, buf, 1, ARCHIVE_COPY_SIZE)) > 0 ) {
+		if ( (Uint32)n > 0xFFFFFFFF - *pos || size > 0x7FFFFFFF - n ) {
+			SDL_SetError("Archive is too large");
+			size = -1;
+			break;
+		}
+		if ( SDL_RWwrite(dst, buf, n, 1) != 1 ) {
+			size = -1;
+			break;
+		}
+		*pos += n;
+		size += n;
+	}
+	if ( n < 0 ) {
+		size = -1;
+	}
+	SDL_RWclose(src);
+	entry->method = ARCHIVE_STORED;
+	entry->size = (Uint32)size;
+	entry->stored = (Uint32)size;
+	return(size < 0 ? -1 : 0);
+}
+
+int SDL_SaveArchive_RW(SDL_RWops *dst, int freedst, const char **files, const char **names, int count, int method)
+{
+	SDL_ArchiveEntry *entries = NULL;
+	Uint32 *directory = NULL;
+	Uint32 *buckets;
+	int *order = NULL;
+	Uint8 *buf = NULL;
+	Uint32 nbuckets, tables, namesize, pos, dir_offset, dir_size;
+	Uint32 header[6];
+	Uint32 hash, len, bucket, i, j;
+	const char *name;
+	int start;
+	int status = -1;
+
+	if ( !dst ) {
+		/* The error message has been set in SDL_RWFromFile */
+		return(-1);
+	}
+	if ( count < 0 || count > ARCHIVE_MAX_COUNT || (count && !files) ) {
+		SDL_SetError("SDL_SaveArchive_RW(): bad file list");
+		goto done;
+	}
+	if ( method != 0 && method != SDL_COMPRESS_LZ && method != SDL_COMPRESS_ZLIB ) {
+		SDL_SetError("Unsupported compression method %d", method);
+		goto done;
+	}
+
+	nbuckets = 1;
+	while ( nbuckets < (Uint32)count ) {
+		nbuckets *= 2;
+	}
+	tables = (nbuckets + 1) * sizeof(Uint32) + count * sizeof(SDL_ArchiveEntry);
+
+	entries = (SDL_ArchiveEntry *)SDL_malloc((count + 1) * sizeof(*entries));
+	order = (int *)SDL_malloc((count + 1) * sizeof(*order));
+	directory = (Uint32 *)SDL_malloc(tables);
+	buf = (Uint8 *)SDL_malloc(ARCHIVE_COPY_SIZE);
+	if ( !entries || !order || !directory || !buf ) {
+		SDL_OutOfMemory();
+		goto done;
+	}
+	buckets = directory;
+
+	/* Hash the names, and count how many are in each bucket */
+	SDL_memset(buckets, 0, (nbuckets + 1) * sizeof(Uint32));
+	namesize = 0;
+	for ( i = 0; i < (Uint32)count; ++i ) {
+		name = names ? names[i] : files[i];
+		hash = Archive_Hash(name, &len);
+		if ( len + 1 > 0xFFFFFFFF - tables - namesize ) {
+			SDL_SetError("Archive directory is too large");
+			goto done;
+		}
+		SDL_memset(&entries[i], 0, sizeof(entries[i]));
+		entries[i].hash = hash;
+		entries[i].namelen = len;
+		namesize += len + 1;
+		++buckets[(hash & (nbuckets - 1)) + 1];
+	}
+
+	/* Turn the counts into the first entry of each bucket, and sort */
+	for ( i = 0; i < nbuckets; ++i ) {
+		buckets[i+1] += buckets[i];
+	}
+	for ( i = 0; i < (Uint32)count; ++i ) {
+		bucket = entries[i].hash & (nbuckets - 1);
+		order[buckets[bucket]++] = i;
+	}
+	for ( i = nbuckets; i > 0; --i ) {
+		buckets[i] = buckets[i-1];
+	}
+	buckets[0] = 0;
+
+	/* Lookups would only ever find the first of two files with a name */
+	for ( i = 0; i < nbuckets; ++i ) {
+		for ( j = buckets[i]; j < buckets[i+1]; ++j ) {
+			Uint32 k;
+			const char *a = names ? names[order[j]] : files[order[j]];
+
+			for ( k = j + 1; k < buckets[i+1]; ++k ) {
+				const char *b = names ? names[order[k]] : files[order[k]];
+				if ( SDL_strcmp(a, b) == 0 ) {
+					SDL_SetError("%s is in the archive twice", a);
+					goto done;
+				}
+			}
+		}
+	}
+
+	/* The header is written last, when we know where everything is */
+	start = SDL_RWtell(dst);
+	pos = 0;
+	SDL_memset(buf, 0, ARCHIVE_HEADER_SIZE);
+	if ( SDL_RWwrite(dst, buf, ARCHIVE_HEADER_SIZE, 1) != 1 ) {
+		goto done;
+	}
+	pos += ARCHIVE_HEADER_SIZE;
+
+	for ( i = 0; i < (Uint32)count; ++i ) {
+		if ( Archive_Pad(dst, &pos) < 0 ) {
+			goto done;
+		}
+		entries[i].offset = pos;
+		if ( Archive_Copy(dst, start, files[i], buf, method, &entries[i], &pos) < 0 ) {
+			goto done;
+		}
+	}
+	if ( Archive_Pad(dst, &pos) < 0 ) {
+		goto done;
+	}
+	dir_offset = pos;
+	dir_size = tables + namesize;
+	if ( dir_size > 0xFFFFFFFF - dir_offset ) {
+		SDL_SetError("Archive is too large");
+		goto done;
+	}
+
+	/* The directory, with the names in the same order as the entries */
+	len = 0;
+	for ( i = 0; i < (Uint32)count; ++i ) {
+		SDL_ArchiveEntry *entry = &entries[order[i]];
+
+		entry->name = len;
+		len += entry->namelen + 1;
+		SDL_memcpy((SDL_ArchiveEntry *)(buckets + nbuckets + 1) + i,
+		           entry, sizeof(*entry));
+	}
+	if ( SDL_WriteLE32Array(dst, directory, tables / sizeof(Uint32)) != tables / sizeof(Uint32) ) {
+		goto done;
+	}
+	for ( i = 0; i < (Uint32)count; ++i ) {
+		name = names ? names[order[i]] : files[order[i]];
+		if ( SDL_RWwrite(dst, name, entries[order[i]].namelen + 1, 1) != 1 ) {
+			goto done;
+		}
+	}
+
+	header[0] = ARCHIVE_VERSION;
+	header[1] = 0;
+	header[2] = (Uint32)count;
+	header[3] = nbuckets;
+	header[4] = dir_offset;
+	header[5] = dir_size;
+	if ( SDL_RWseek(dst, start, RW_SEEK_SET) < 0 ||
+	     SDL_RWwrite(dst, ARCHIVE_MAGIC, 8, 1) != 1 ||
+	     SDL_WriteLE32Array(dst, header, SDL_arraysize(header)) != SDL_arraysize(header) ||
+	     SDL_RWseek(dst, start + (int)(dir_offset + dir_size), RW_SEEK_SET) < 0 ) {
+		goto done;
+	}
+	status = 0;
+
+done:
+	if ( buf ) {
+		SDL_free(buf);
+	}
+	if ( directory ) {
+		SDL_free(directory);
+	}
+	if ( order ) {
+		SDL_free(order);
+	}
+	if ( entries ) {
+		SDL_free(entries);
+	}
+	if ( freedst ) {
+		SDL_RWclose(dst);
+	}
+	return(status);
+}
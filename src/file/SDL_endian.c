@@ -0,0 +1,155 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Byte swapping whole arrays, 16 or 32 bytes at a time where we can */
+
+#include "SDL_endian.h"
+#include "../cpuinfo/SDL_simd.h"
+#include "SDL_endian_c.h"
+
+#if HAVE_AVX2_INTRINSICS
+SDL_TARGETING("avx2") static size_t AVX2_SwapArray(Uint8 *data, size_t len, int width)
+{
+	__m256i mask, v;
+	size_t i;
+
+	switch (width) {
+		case 2:
+			mask = _mm256_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14,
+			                        1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+			break;
+		case 4:
+			mask = _mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+			                        3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+			break;
+		default:
+			mask = _mm256_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8,
+			                        7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+			break;
+	}
+	for ( i = 0; i + 32 <= len; i += 32 ) {
+		v = _mm256_loadu_si256((const __m256i *)(data + i));
+		_mm256_storeu_si256((__m256i *)(data + i), _mm256_shuffle_epi8(v, mask));
+	}
+	return(i);
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+#if HAVE_SSSE3_INTRINSICS
+SDL_TARGETING("ssse3") static size_t SSSE3_SwapArray(Uint8 *data, size_t len, int width)
+{
+	__m128i mask, v;
+	size_t i;
+
+	switch (width) {
+		case 2:
+			mask = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+			break;
+		case 4:
+			mask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+			break;
+		default:
+			mask = _mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+			break;
+	}
+	for ( i = 0; i + 16 <= len; i += 16 ) {
+		v = _mm_loadu_si128((const __m128i *)(data + i));
+		_mm_storeu_si128((__m128i *)(data + i), _mm_shuffle_epi8(v, mask));
+	}
+	return(i);
+}
+#endif /* HAVE_SSSE3_INTRINSICS */
+
+#if HAVE_SSE2_INTRINSICS
+/* Without a byte shuffle, reverse the 16-bit words and then the bytes */
+SDL_TARGETING("sse2") static size_t SSE2_SwapArray(Uint8 *data, size_t len, int width)
+{
+	__m128i v;
+	size_t i;
+
+	for ( i = 0; i + 16 <= len; i += 16 ) {
+		v = _mm_loadu_si128((const __m128i *)(data + i));
+		if ( width == 4 ) {
+			v = _mm_shufflelo_epi16(v, 0xB1);
+			v = _mm_shufflehi_epi16(v, 0xB1);
+		} else if ( width == 8 ) {
+			v = _mm_shufflelo_epi16(v, 0x1B);
+			v = _mm_shufflehi_epi16(v, 0x1B);
+		}
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128((__m128i *)(data + i), v);
+	}
+	return(i);
+}
+#endif /* HAVE_SSE2_INTRINSICS */
+
+/* Returns how many bytes were swapped, the caller does the rest */
+static size_t SDL_SwapArraySIMD(Uint8 *data, size_t len, int width)
+{
+#if HAVE_AVX2_INTRINSICS
+	if ( len >= 64 && SDL_HasAVX2() ) {
+		return AVX2_SwapArray(data, len, width);
+	}
+#endif
+#if HAVE_SSSE3_INTRINSICS
+	if ( len >= 32 && SDL_HasSSSE3() ) {
+		return SSSE3_SwapArray(data, len, width);
+	}
+#endif
+#if HAVE_SSE2_INTRINSICS
+	if ( len >= 32 && SDL_HasSSE2() ) {
+		return SSE2_SwapArray(data, len, width);
+	}
+#endif
+	return(0);
+}
+
+void SDL_SwapArray16(Uint16 *data, size_t n)
+{
+	size_t i = SDL_SwapArraySIMD((Uint8 *)data, n * 2, 2) / 2;
+
+	for ( ; i < n; ++i ) {
+		data[i] = SDL_Swap16(data[i]);
+	}
+}
+
+void SDL_SwapArray32(Uint32 *data, size_t n)
+{
+	size_t i = SDL_SwapArraySIMD((Uint8 *)data, n * 4, 4) / 4;
+
+	for ( ; i < n; ++i ) {
+		data[i] = SDL_Swap32(data[i]);
+	}
+}
+
+/* Like SDL_Swap64(), this does nothing without a real 64-bit type */
+void SDL_SwapArray64(Uint64 *data, size_t n)
+{
+#ifdef SDL_HAS_64BIT_TYPE
+	size_t i = SDL_SwapArraySIMD((Uint8 *)data, n * 8, 8) / 8;
+
+	for ( ; i < n; ++i ) {
+		data[i] = SDL_Swap64(data[i]);
+	}
+#endif
+}
@@ -0,0 +1,51 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_endian_c_h
+#define _SDL_endian_c_h
+
+#include "SDL_endian.h"
+
+/* Byte swap every value in an array, in place */
+extern void SDL_SwapArray16(Uint16 *data, size_t n);
+extern void SDL_SwapArray32(Uint32 *data, size_t n);
+extern void SDL_SwapArray64(Uint64 *data, size_t n);
+
+/* Convert an array between native and little or big endian order */
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define SDL_SwapArrayLE16(data, n)	((void)0)
+#define SDL_SwapArrayLE32(data, n)	((void)0)
+#define SDL_SwapArrayLE64(data, n)	((void)0)
+#define SDL_SwapArrayBE16(data, n)	SDL_SwapArray16(data, n)
+#define SDL_SwapArrayBE32(data, n)	SDL_SwapArray32(data, n)
+#define SDL_SwapArrayBE64(data, n)	SDL_SwapArray64(data, n)
+#else
+#define SDL_SwapArrayLE16(data, n)	SDL_SwapArray16(data, n)
+#define SDL_SwapArrayLE32(data, n)	SDL_SwapArray32(data, n)
+#define SDL_SwapArrayLE64(data, n)	SDL_SwapArray64(data, n)
+#define SDL_SwapArrayBE16(data, n)	((void)0)
+#define SDL_SwapArrayBE32(data, n)	((void)0)
+#define SDL_SwapArrayBE64(data, n)	((void)0)
+#endif
+
+#endif /* _SDL_endian_c_h */
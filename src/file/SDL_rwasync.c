@@ -0,0 +1,443 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* An SDL_RWops that reads ahead of the caller on a background thread.
+
+   The thread reads the source sequentially into a ring of buffers, and
+   reads are copied out of the buffers at the head of the ring.  Only the
+   thread touches the source while it's running, except for seeks, which
+   stop the thread from starting another read and wait for the one it's
+   doing to finish first.
+*/
+
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+#include "SDL_rwops.h"
+
+#define ASYNC_MIN_BUFSIZE	512
+#define ASYNC_DEFAULT_BUFSIZE	(64*1024)
+#define ASYNC_DEFAULT_NBUFS	4
+
+typedef struct SDL_RWAsyncBuffer {
+	Uint8 *data;
+	int len;		/* Bytes of data in the buffer */
+} SDL_RWAsyncBuffer;
+
+typedef struct SDL_RWAsync {
+	SDL_RWops *src;
+	SDL_mutex *lock;	/* Protects everything shared with the thread */
+	SDL_cond *filled;	/* Signaled when the thread finishes a read */
+	SDL_cond *drained;	/* Signaled when a buffer is free or on seeks */
+	SDL_Thread *thread;
+	int threaded;		/* Without a thread, reads fill the buffers */
+
+	SDL_RWAsyncBuffer *bufs;
+	int bufsize;
+	int nbufs;
+	int head;		/* The buffer being read from */
+	int count;		/* Buffers with data, starting at head */
+	int here;		/* Read position in the head buffer */
+
+	int pos;		/* Read position in the source */
+	int fillpos;		/* Where the next buffer is read from */
+	int generation;		/* Changes when seeks throw the data away */
+	int busy;		/* The thread is reading from the source */
+	int seeking;		/* The thread mustn't start another read */
+	int eof;
+	int error;
+	int quit;
+
+	SDL_RWAsyncStats stats;
+} SDL_RWAsync;
+
+static void RWAsync_Lock(SDL_RWAsync *async)
+{
+	if ( async->threaded ) {
+		SDL_mutexP(async->lock);
+	}
+}
+
+static void RWAsync_Unlock(SDL_RWAsync *async)
+{
+	if ( async->threaded ) {
+		SDL_mutexV(async->lock);
+	}
+}
+
+/* Read the source into the next free buffer, called with the lock held.
+   The lock is let go during the read so the reader can use the buffers
+   that are already full.
+ */
+static void RWAsync_Fill(SDL_RWAsync *async)
+{
+	SDL_RWAsyncBuffer *buf;
+	int generation;
+	int n;
+
+	buf = &async->bufs[(async->head + async->count) % async->nbufs];
+	generation = async->generation;
+	async->busy = 1;
+	RWAsync_Unlock(async);
+
+	n = SDL_RWread(async->src, buf->data, 1, async->bufsize);
+
+	RWAsync_Lock(async);
+	async->busy = 0;
+	/* If there was a seek in the meantime, the data is from before it */
+	if ( generation == async->generation ) {
+		if ( n > 0 ) {
+			buf->len = n;
+			async->fillpos += n;
+			++async->count;
+			++async->stats.fills;
+		} else {
+			async->eof = 1;
+			async->error = (n < 0);
+		}
+	}
+	if ( async->threaded ) {
+		SDL_CondSignal(async->filled);
+	}
+}
+
+/* Wait for the thread to fill a buffer, or fill one ourselves without it */
+static void RWAsync_Stall(SDL_RWAsync *async)
+{
+#ifdef SDL_HAS_64BIT_TYPE
+	Uint64 start = SDL_GetPerformanceCounter();
+#else
+	Uint32 start = SDL_GetTicks();
+#endif
+
+	if ( async->threaded ) {
+		while ( async->count == 0 && !async->eof ) {
+			SDL_CondWait(async->filled, async->lock);
+		}
+	} else {
+		RWAsync_Fill(async);
+	}
+#ifdef SDL_HAS_64BIT_TYPE
+	async->stats.stall_us += (Uint32)((SDL_GetPerformanceCounter() - start) *
+	                                  1000000 / SDL_GetPerformanceFrequency());
+#else
+	async->stats.stall_us += (SDL_GetTicks() - start) * 1000;
+#endif
+}
+
+static int SDLCALL RWAsync_Thread(void *data)
+{
+	SDL_RWAsync *async = (SDL_RWAsync *)data;
+
+	SDL_mutexP(async->lock);
+	while ( !async->quit ) {
+		if ( !async->seeking &&
+		     async->count < async->nbufs && !async->eof ) {
+			RWAsync_Fill(async);
+		} else {
+			SDL_CondWait(async->drained, async->lock);
+		}
+	}
+	SDL_mutexV(async->lock);
+	return(0);
+}
+
+static int SDLCALL async_seek(SDL_RWops *context, int offset, int whence)
+{
+	SDL_RWAsync *async = (SDL_RWAsync *)context->hidden.unknown.data1;
+	int start, newpos;
+
+	switch (whence) {
+		case RW_SEEK_SET:
+			break;
+		case RW_SEEK_CUR:
+			offset += async->pos;
+			whence = RW_SEEK_SET;
+			break;
+		case RW_SEEK_END:
+			break;
+		default:
+			SDL_SetError("Unknown value for 'whence'");
+			return(-1);
+	}
+
+	RWAsync_Lock(async);
+
+	/* Seeks within the data we have just skip over some of it */
+	start = async->pos - async->here;
+	if ( whence != RW_SEEK_END &&
+	     offset >= start && offset <= async->fillpos ) {
+		async->here = offset - start;
+		while ( async->count > 0 &&
+		        async->here >= async->bufs[async->head].len ) {
+			async->here -= async->bufs[async->head].len;
+			async->head = (async->head + 1) % async->nbufs;
+			--async->count;
+		}
+		async->pos = offset;
+		if ( async->threaded ) {
+			SDL_CondSignal(async->drained);
+		}
+		RWAsync_Unlock(async);
+		return(offset);
+	}
+
+	/* Anything else throws it all away and starts reading again */
+	++async->generation;
+	async->seeking = 1;
+	while ( async->busy ) {
+		SDL_CondWait(async->filled, async->lock);
+	}
+	newpos = SDL_RWseek(async->src, offset, whence);
+	if ( newpos >= 0 ) {
+		async->pos = newpos;
+	} else {
+		/* Carry on reading from where the caller was */
+		SDL_RWseek(async->src, async->pos, RW_SEEK_SET);
+		newpos = -1;
+	}
+	async->fillpos = async->pos;
+	async->head = 0;
+	async->count = 0;
+	async->here = 0;
+	async->eof = 0;
+	async->error = 0;
+	++async->stats.seeks;
+	async->seeking = 0;
+	if ( async->threaded ) {
+		SDL_CondSignal(async->drained);
+	}
+	RWAsync_Unlock(async);
+	return(newpos);
+}
+
+static int SDLCALL async_read(SDL_RWops *context, void *ptr, int size, int maxnum)
+{
+	SDL_RWAsync *async = (SDL_RWAsync *)context->hidden.unknown.data1;
+	SDL_RWAsyncBuffer *buf;
+	Uint8 *dst = (Uint8 *)ptr;
+	int total, left, n;
+	SDL_bool stalled = SDL_FALSE;
+
+	if ( size <= 0 || maxnum <= 0 ) {
+		return(0);
+	}
+	total = size * maxnum;
+	left = total;
+
+	RWAsync_Lock(async);
+	++async->stats.reads;
+	while ( left > 0 ) {
+		if ( async->count == 0 ) {
+			if ( async->eof ) {
+				break;
+			}
+			RWAsync_Stall(async);
+			stalled = SDL_TRUE;
+			continue;
+		}
+
+		/* The thread doesn't touch buffers that have data in them */
+		buf = &async->bufs[async->head];
+		RWAsync_Unlock(async);
+		n = buf->len - async->here;
+		if ( n > left ) {
+			n = left;
+		}
+		SDL_memcpy(dst, buf->data + async->here, n);
+		dst += n;
+		left -= n;
+		RWAsync_Lock(async);
+
+		async->here += n;
+		async->pos += n;
+		if ( async->here == buf->len ) {
+			async->head = (async->head + 1) % async->nbufs;
+			--async->count;
+			async->here = 0;
+			if ( async->threaded ) {
+				SDL_CondSignal(async->drained);
+			}
+		}
+	}
+	if ( stalled ) {
+		++async->stats.stalls;
+	} else {
+		++async->stats.hits;
+	}
+	if ( left == total && async->error ) {
+		RWAsync_Unlock(async);
+		SDL_Error(SDL_EFREAD);
+		return(-1);
+	}
+	RWAsync_Unlock(async);
+
+	return((total - left) / size);
+}
+
+static int SDLCALL async_write(SDL_RWops *context, const void *ptr, int size, int num)
+{
+	SDL_SetError("Can't write to a read-ahead SDL_RWops");
+	return(-1);
+}
+
+static void RWAsync_Free(SDL_RWAsync *async)
+{
+	int i;
+
+	if ( async->bufs ) {
+		for ( i = 0; i < async->nbufs; ++i ) {
+			if ( async->bufs[i].data ) {
+				SDL_free(async->bufs[i].data);
+			}
+		}
+		SDL_free(async->bufs);
+	}
+	if ( async->drained ) {
+		SDL_DestroyCond(async->drained);
+	}
+	if ( async->filled ) {
+		SDL_DestroyCond(async->filled);
+	}
+	if ( async->lock ) {
+		SDL_DestroyMutex(async->lock);
+	}
+	SDL_free(async);
+}
+
+static int SDLCALL async_close(SDL_RWops *context)
+{
+	SDL_RWAsync *async;
+	int status = 0;
+
+	if ( context ) {
+		async = (SDL_RWAsync *)context->hidden.unknown.data1;
+		if ( async->threaded ) {
+			SDL_mutexP(async->lock);
+			async->quit = 1;
+			SDL_CondSignal(async->drained);
+			SDL_mutexV(async->lock);
+			SDL_WaitThread(async->thread, NULL);
+		}
+		status = SDL_RWclose(async->src);
+		RWAsync_Free(async);
+		SDL_FreeRW(context);
+	}
+	return(status);
+}
+
+SDL_RWops *SDL_RWFromRWAsync(SDL_RWops *src, int bufsize, int nbufs)
+{
+	SDL_RWAsync *async;
+	SDL_RWops *rwops;
+	int i;
+
+	if ( !src ) {
+		SDL_SetError("SDL_RWFromRWAsync(): src is NULL");
+		return(NULL);
+	}
+	if ( bufsize <= 0 ) {
+		bufsize = ASYNC_DEFAULT_BUFSIZE;
+	} else if ( bufsize < ASYNC_MIN_BUFSIZE ) {
+		bufsize = ASYNC_MIN_BUFSIZE;
+	}
+	if ( nbufs <= 0 ) {
+		nbufs = ASYNC_DEFAULT_NBUFS;
+	}
+
+	async = (SDL_RWAsync *)SDL_malloc(sizeof(*async));
+	if ( !async ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	SDL_memset(async, 0, sizeof(*async));
+	async->src = src;
+	async->bufsize = bufsize;
+	async->nbufs = nbufs;
+	async->bufs = (SDL_RWAsyncBuffer *)SDL_malloc(nbufs*sizeof(*async->bufs));
+	if ( !async->bufs ) {
+		SDL_OutOfMemory();
+		RWAsync_Free(async);
+		return(NULL);
+	}
+	SDL_memset(async->bufs, 0, nbufs*sizeof(*async->bufs));
+	for ( i = 0; i < nbufs; ++i ) {
+		async->bufs[i].data = (Uint8 *)SDL_malloc(bufsize);
+		if ( !async->bufs[i].data ) {
+			SDL_OutOfMemory();
+			RWAsync_Free(async);
+			return(NULL);
+		}
+	}
+
+	/* Sources that can't tell where they are just start at 0 */
+	async->pos = SDL_RWtell(src);
+	if ( async->pos < 0 ) {
+		async->pos = 0;
+	}
+	async->fillpos = async->pos;
+
+	rwops = SDL_AllocRW();
+	if ( !rwops ) {
+		RWAsync_Free(async);
+		return(NULL);
+	}
+	rwops->seek = async_seek;
+	rwops->read = async_read;
+	rwops->write = async_write;
+	rwops->close = async_close;
+	rwops->hidden.unknown.data1 = async;
+
+	/* Without threads this still works, reading a buffer at a time */
+	async->lock = SDL_CreateMutex();
+	async->filled = SDL_CreateCond();
+	async->drained = SDL_CreateCond();
+	if ( async->lock && async->filled && async->drained ) {
+		async->threaded = 1;
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThread
+		async->thread = SDL_CreateThread(RWAsync_Thread, async, NULL, NULL);
+#else
+		async->thread = SDL_CreateThread(RWAsync_Thread, async);
+#endif
+		if ( !async->thread ) {
+			async->threaded = 0;
+		}
+	}
+	return(rwops);
+}
+
+int SDL_GetRWAsyncStats(SDL_RWops *context, SDL_RWAsyncStats *stats)
+{
+	SDL_RWAsync *async;
+
+	if ( !context || context->read != async_read ) {
+		SDL_SetError("Not a read-ahead SDL_RWops");
+		return(-1);
+	}
+	async = (SDL_RWAsync *)context->hidden.unknown.data1;
+	RWAsync_Lock(async);
+	*stats = async->stats;
+	RWAsync_Unlock(async);
+	return(0);
+}
@@ -0,0 +1,779 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Compressed data, decompressed a block at a time as it's read.
+
+   Everything is little endian, and offsets are from the start of the
+   compressed data.
+
+	Header, 28 bytes:
+		"SDLZ", version, method, blocksize, size, nblocks, table_offset
+	The blocks, each one compressed on its own
+	Uint32 offsets[nblocks+1] at table_offset, where each block starts
+
+   Every block but the last decompresses to blocksize bytes.  A block
+   that's as big compressed as it was to begin with is stored as is.
+
+   The built-in method writes blocks in the LZ4 block format, which is
+   simple enough to decompress about as fast as memory can be copied.
+*/
+
+#include "SDL_endian.h"
+#include "SDL_rwops.h"
+#include "SDL_endian_c.h"
+
+#if SDL_RWOPS_ZLIB
+#include <zlib.h>
+#endif
+
+#define COMPRESS_MAGIC		"SDLZ"
+#define COMPRESS_VERSION	1
+#define COMPRESS_HEADER_SIZE	28
+#define COMPRESS_MIN_BLOCKSIZE	1024
+#define COMPRESS_MAX_BLOCKSIZE	(16*1024*1024)
+#define COMPRESS_DEFAULT_BLOCKSIZE	(64*1024)
+
+/* LZ4 block format limits */
+#define LZ_HASH_BITS		12
+#define LZ_MIN_MATCH		4
+#define LZ_LAST_LITERALS	5
+#define LZ_MFLIMIT		12
+#define LZ_MAX_OFFSET		65535
+
+typedef struct SDL_RWCompressed {
+	SDL_RWops *src;
+	int freesrc;
+	int start;		/* Where the compressed data starts in src */
+	const Uint8 *base;	/* The compressed data, if src is in memory */
+	int method;
+	Uint32 blocksize;
+	Uint32 size;		/* Size of the decompressed data */
+	Uint32 nblocks;
+	Uint32 *offsets;
+	Uint8 *packed;		/* A compressed block, if src isn't in memory */
+	Uint8 *block;		/* The last block decompressed */
+	Uint32 current;		/* Which block that is, nblocks if none */
+	Uint32 pos;
+#if SDL_RWOPS_ZLIB
+	z_stream zstream;
+	int zinit;
+#endif
+} SDL_RWCompressed;
+
+static Uint32 LZ_Read32(const Uint8 *p)
+{
+	return((Uint32)p[0] | ((Uint32)p[1] << 8) |
+	       ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24));
+}
+
+#define LZ_HASH(v)	(((v) * 2654435761u) >> (32 - LZ_HASH_BITS))
+
+/* Write a literal run and a match, or just the literals at the end.
+   Returns NULL if it doesn't fit.
+ */
+static Uint8 *LZ_Emit(Uint8 *op, Uint8 *oend, const Uint8 *lit, Uint32 litlen, Uint32 offset, Uint32 matchlen)
+{
+	Uint8 *token;
+	Uint32 len;
+
+	if ( (Uint32)(oend - op) < 1 + litlen/255 + 1 + litlen + 2 + matchlen/255 + 1 ) {
+		return(NULL);
+	}
+	token = op++;
+	if ( litlen >= 15 ) {
+		*token = 15 << 4;
+		for ( len = litlen - 15; len >= 255; len -= 255 ) {
+			*op++ = 255;
+		}
+		*op++ = (Uint8)len;
+	} else {
+		*token = (Uint8)(litlen << 4);
+	}
+	SDL_memcpy(op, lit, litlen);
+	op += litlen;
+
+	if ( matchlen ) {
+		*op++ = (Uint8)(offset & 0xFF);
+		*op++ = (Uint8)(offset >> 8);
+		len = matchlen - LZ_MIN_MATCH;
+		if ( len >= 15 ) {
+			*token |= 15;
+			for ( len -= 15; len >= 255; len -= 255 ) {
+				*op++ = 255;
+			}
+			*op++ = (Uint8)len;
+		} else {
+			*token |= (Uint8)len;
+		}
+	}
+	return(op);
+}
+
+/* Greedy compression with a hash table of where 4 byte sequences were
+   last seen, returns the compressed size or -1 if it's over 'dstlen'.
+ */
+static int LZ_Compress(const Uint8 *src, int srclen, Uint8 *dst, int dstlen, Uint32 *table)
+{
+	const Uint8 *ip = src;
+	const Uint8 *anchor = src;
+	const Uint8 *iend = src + srclen;
+	const Uint8 *mflimit, *matchlimit;
+	const Uint8 *ref, *m, *r;
+	Uint8 *op = dst;
+	Uint8 *oend = dst + dstlen;
+	Uint32 v, h;
+
+	SDL_memset(table, 0, sizeof(*table) << LZ_HASH_BITS);
+	if ( srclen > LZ_MFLIMIT ) {
+		mflimit = iend - LZ_MFLIMIT;
+		matchlimit = iend - LZ_LAST_LITERALS;
+		while ( ip < mflimit ) {
+			v = LZ_Read32(ip);
+			h = LZ_HASH(v);
+			ref = src + table[h];
+			table[h] = (Uint32)(ip - src);
+			if ( ref < ip && ip - ref <= LZ_MAX_OFFSET && LZ_Read32(ref) == v ) {
+				m = ip + LZ_MIN_MATCH;
+				r = ref + LZ_MIN_MATCH;
+				while ( m < matchlimit && *m == *r ) {
+					++m;
+					++r;
+				}
+				while ( ip > anchor && ref > src && ip[-1] == ref[-1] ) {
+					--ip;
+					--ref;
+				}
+				op = LZ_Emit(op, oend, anchor, (Uint32)(ip - anchor),
+				             (Uint32)(ip - ref), (Uint32)(m - ip));
+				if ( !op ) {
+					return(-1);
+				}
+				ip = anchor = m;
+				if ( ip < mflimit ) {
+					table[LZ_HASH(LZ_Read32(ip - 2))] = (Uint32)(ip - 2 - src);
+				}
+			} else {
+				/* Skip faster through data that doesn't compress */
+				ip += 1 + ((ip - anchor) >> 6);
+			}
+		}
+	}
+	op = LZ_Emit(op, oend, anchor, (Uint32)(iend - anchor), 0, 0);
+	if ( !op ) {
+		return(-1);
+	}
+	return((int)(op - dst));
+}
+
+/* Copy in 8 byte pieces, which can write up to 7 bytes past the end, so
+   the caller has to leave room for that.  With 'src' at least 8 bytes
+   behind 'dst' this works for overlapping copies too.
+ */
+static void LZ_WildCopy(Uint8 *dst, const Uint8 *src, Uint32 len)
+{
+	Uint8 *end = dst + len;
+
+	do {
+		SDL_memcpy(dst, src, 8);
+		dst += 8;
+		src += 8;
+	} while ( dst < end );
+}
+
+/* Returns the decompressed size, or -1 if the data is corrupt */
+static int LZ_Decompress(const Uint8 *src, int srclen, Uint8 *dst, int dstlen)
+{
+	const Uint8 *ip = src;
+	const Uint8 *iend = src + srclen;
+	const Uint8 *ref;
+	Uint8 *op = dst;
+	Uint8 *oend = dst + dstlen;
+	Uint32 token, len, offset;
+	Uint8 b;
+
+	for ( ;; ) {
+		if ( ip >= iend ) {
+			return(-1);
+		}
+		token = *ip++;
+
+		len = token >> 4;
+		if ( len == 15 ) {
+			do {
+				if ( ip >= iend ) {
+					return(-1);
+				}
+				b = *ip++;
+				len += b;
+			} while ( b == 255 );
+		}
+		if ( len > (Uint32)(iend - ip) || len > (Uint32)(oend - op) ) {
+			return(-1);
+		}
+		if ( len + 8 <= (Uint32)(iend - ip) && len + 8 <= (Uint32)(oend - op) ) {
+			LZ_WildCopy(op, ip, len);
+		} else {
+			SDL_memcpy(op, ip, len);
+		}
+		op += len;
+		ip += len;
+		if ( ip == iend ) {
+			break;
+		}
+
+		if ( iend - ip < 2 ) {
+			return(-1);
+		}
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if ( offset == 0 || offset > (Uint32)(op - dst) ) {
+			return(-1);
+		}
+		len = token & 15;
+		if ( len == 15 ) {
+			do {
+				if ( ip >= iend ) {
+					return(-1);
+				}
+				b = *ip++;
+				len += b;
+			} while ( b == 255 );
+		}
+		len += LZ_MIN_MATCH;
+		if ( len > (Uint32)(oend - op) ) {
+			return(-1);
+		}
+		ref = op - offset;
+		if ( offset >= 8 && len + 8 <= (Uint32)(oend - op) ) {
+			LZ_WildCopy(op, ref, len);
+			op += len;
+		} else if ( offset >= len ) {
+			SDL_memcpy(op, ref, len);
+			op += len;
+		} else {
+			/* The match overlaps what it's writing, repeating it */
+			while ( len-- ) {
+				*op++ = *ref++;
+			}
+		}
+	}
+	return((int)(op - dst));
+}
+
+static int Compressed_SeekSrc(SDL_RWCompressed *z, Uint32 offset)
+{
+#ifdef SDL_HAS_64BIT_TYPE
+	if ( SDL_RWseek64(z->src, (Sint64)z->start + offset, RW_SEEK_SET) < 0 ) {
+		return(-1);
+	}
+#else
+	if ( offset > (Uint32)(0x7FFFFFFF - z->start) ||
+	     SDL_RWseek(z->src, z->start + (int)offset, RW_SEEK_SET) < 0 ) {
+		return(-1);
+	}
+#endif
+	return(0);
+}
+
+/* Decompress a block into 'dst', which has room for all of it */
+static int Compressed_Load(SDL_RWCompressed *z, Uint32 index, Uint8 *dst)
+{
+	const Uint8 *packed;
+	Uint32 packedlen, len;
+	int n;
+
+	packedlen = z->offsets[index+1] - z->offsets[index];
+	len = z->size - index * z->blocksize;
+	if ( len > z->blocksize ) {
+		len = z->blocksize;
+	}
+
+	if ( z->base ) {
+		packed = z->base + z->offsets[index];
+	} else {
+		if ( packedlen == len ) {
+			/* Stored blocks go straight where they're wanted */
+			packed = dst;
+		} else {
+			packed = z->packed;
+		}
+		if ( Compressed_SeekSrc(z, z->offsets[index]) < 0 ||
+		     SDL_RWread(z->src, (void *)packed, 1, packedlen) != (int)packedlen ) {
+			SDL_Error(SDL_EFREAD);
+			return(-1);
+		}
+	}
+
+	if ( packedlen == len ) {
+		if ( packed != dst ) {
+			SDL_memcpy(dst, packed, len);
+		}
+		return(0);
+	}
+
+	switch (z->method) {
+		case SDL_COMPRESS_LZ:
+			n = LZ_Decompress(packed, packedlen, dst, len);
+			break;
+#if SDL_RWOPS_ZLIB
+		case SDL_COMPRESS_ZLIB:
+			inflateReset(&z->zstream);
+			z->zstream.next_in = (Bytef *)packed;
+			z->zstream.avail_in = packedlen;
+			z->zstream.next_out = dst;
+			z->zstream.avail_out = len;
+			if ( inflate(&z->zstream, Z_FINISH) == Z_STREAM_END ) {
+				n = (int)z->zstream.total_out;
+			} else {
+				n = -1;
+			}
+			break;
+#endif
+		default:
+			n = -1;
+			break;
+	}
+	if ( n != (int)len ) {
+		SDL_SetError("Corrupt compressed data");
+		return(-1);
+	}
+	return(0);
+}
+
+static int SDLCALL compressed_seek(SDL_RWops *context, int offset, int whence)
+{
+	SDL_RWCompressed *z = (SDL_RWCompressed *)context->hidden.unknown.data1;
+	Sint32 newpos;
+
+	switch (whence) {
+		case RW_SEEK_SET:
+			newpos = offset;
+			break;
+		case RW_SEEK_CUR:
+			newpos = (Sint32)z->pos + offset;
+			break;
+		case RW_SEEK_END:
+			newpos = (Sint32)z->size + offset;
+			break;
+		default:
+			SDL_SetError("Unknown value for 'whence'");
+			return(-1);
+	}
+	if ( newpos < 0 ) {
+		newpos = 0;
+	}
+	if ( (Uint32)newpos > z->size ) {
+		newpos = (Sint32)z->size;
+	}
+	z->pos = (Uint32)newpos;
+	return(newpos);
+}
+
+static int SDLCALL compressed_read(SDL_RWops *context, void *ptr, int size, int maxnum)
+{
+	SDL_RWCompressed *z = (SDL_RWCompressed *)context->hidden.unknown.data1;
+	Uint8 *dst = (Uint8 *)ptr;
+	size_t total_bytes, left;
+	Uint32 index, here, len;
+
+	total_bytes = (maxnum * size);
+	if ( (maxnum <= 0) || (size <= 0) || ((total_bytes / maxnum) != (size_t) size) ) {
+		return 0;
+	}
+	if ( total_bytes > z->size - z->pos ) {
+		total_bytes = z->size - z->pos;
+	}
+
+	left = total_bytes;
+	while ( left > 0 ) {
+		index = z->pos / z->blocksize;
+		here = z->pos % z->blocksize;
+		len = z->size - index * z->blocksize;
+		if ( len > z->blocksize ) {
+			len = z->blocksize;
+		}
+
+		if ( index != z->current ) {
+			/* Whole blocks are decompressed right where they go */
+			if ( here == 0 && left >= len ) {
+				if ( Compressed_Load(z, index, dst) < 0 ) {
+					break;
+				}
+				dst += len;
+				left -= len;
+				z->pos += len;
+				continue;
+			}
+			if ( Compressed_Load(z, index, z->block) < 0 ) {
+				z->current = z->nblocks;
+				break;
+			}
+			z->current = index;
+		}
+
+		len -= here;
+		if ( len > left ) {
+			len = (Uint32)left;
+		}
+		SDL_memcpy(dst, z->block + here, len);
+		dst += len;
+		left -= len;
+		z->pos += len;
+	}
+	if ( left == total_bytes && total_bytes > 0 ) {
+		return(-1);
+	}
+	return((int)((total_bytes - left) / size));
+}
+
+static int SDLCALL compressed_write(SDL_RWops *context, const void *ptr, int size, int num)
+{
+	SDL_SetError("Can't write to compressed data");
+	return(-1);
+}
+
+static void Compressed_Free(SDL_RWCompressed *z)
+{
+#if SDL_RWOPS_ZLIB
+	if ( z->zinit ) {
+		inflateEnd(&z->zstream);
+	}
+#endif
+	if ( z->freesrc ) {
+		SDL_RWclose(z->src);
+	}
+	if ( z->block ) {
+		SDL_free(z->block);
+	}
+	if ( z->packed ) {
+		SDL_free(z->packed);
+	}
+	if ( z->offsets ) {
+		SDL_free(z->offsets);
+	}
+	SDL_free(z);
+}
+
+static int SDLCALL compressed_close(SDL_RWops *context)
+{
+	if ( context ) {
+		Compressed_Free((SDL_RWCompressed *)context->hidden.unknown.data1);
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+
+SDL_RWops *SDL_RWFromCompressed(SDL_RWops *src, int freesrc)
+{
+	SDL_RWCompressed *z;
+	SDL_RWops *rwops;
+	char magic[4];
+	Uint32 header[6];
+	Uint32 table_offset, maxpacked, packedlen, len, i;
+	const void *base;
+	size_t avail;
+
+	if ( !src ) {
+		SDL_SetError("SDL_RWFromCompressed(): src is NULL");
+		return(NULL);
+	}
+
+	z = (SDL_RWCompressed *)SDL_malloc(sizeof(*z));
+	if ( !z ) {
+		SDL_OutOfMemory();
+		if ( freesrc ) {
+			SDL_RWclose(src);
+		}
+		return(NULL);
+	}
+	SDL_memset(z, 0, sizeof(*z));
+	z->src = src;
+	z->freesrc = freesrc;
+	z->start = SDL_RWtell(src);
+	if ( z->start < 0 ) {
+		z->start = 0;
+	}
+	base = SDL_RWmap(src, &avail);
+
+	if ( SDL_RWread(src, magic, sizeof(magic), 1) != 1 ||
+	     SDL_ReadLE32Array(src, header, SDL_arraysize(header)) != SDL_arraysize(header) ) {
+		SDL_SetError("Couldn't read compressed data header");
+		goto error;
+	}
+	if ( SDL_memcmp(magic, COMPRESS_MAGIC, sizeof(magic)) != 0 ||
+	     header[0] != COMPRESS_VERSION ) {
+		SDL_SetError("Unknown compressed data format");
+		goto error;
+	}
+	z->method = (int)header[1];
+	z->blocksize = header[2];
+	z->size = header[3];
+	z->nblocks = header[4];
+	table_offset = header[5];
+	if ( z->method != SDL_COMPRESS_LZ
+#if SDL_RWOPS_ZLIB
+	     && z->method != SDL_COMPRESS_ZLIB
+#endif
+	   ) {
+		SDL_SetError("Unsupported compression method %d", z->method);
+		goto error;
+	}
+	if ( z->blocksize < COMPRESS_MIN_BLOCKSIZE ||
+	     z->blocksize > COMPRESS_MAX_BLOCKSIZE ||
+	     z->size > 0x7FFFFFFF ||
+	     z->nblocks != (z->size + z->blocksize - 1) / z->blocksize ||
+	     table_offset < COMPRESS_HEADER_SIZE ) {
+		SDL_SetError("Corrupt compressed data header");
+		goto error;
+	}
+
+	/* The seek table, and the biggest compressed block to make room for */
+	z->offsets = (Uint32 *)SDL_malloc((z->nblocks + 1) * sizeof(Uint32));
+	if ( !z->offsets ) {
+		SDL_OutOfMemory();
+		goto error;
+	}
+	if ( Compressed_SeekSrc(z, table_offset) < 0 ||
+	     SDL_ReadLE32Array(src, z->offsets, z->nblocks + 1) != z->nblocks + 1 ) {
+		SDL_SetError("Couldn't read compressed data seek table");
+		goto error;
+	}
+	if ( z->offsets[0] != COMPRESS_HEADER_SIZE ||
+	     z->offsets[z->nblocks] != table_offset ) {
+		SDL_SetError("Corrupt compressed data seek table");
+		goto error;
+	}
+	maxpacked = 0;
+	for ( i = 0; i < z->nblocks; ++i ) {
+		len = z->size - i * z->blocksize;
+		if ( len > z->blocksize ) {
+			len = z->blocksize;
+		}
+		packedlen = z->offsets[i+1] - z->offsets[i];
+		if ( z->offsets[i+1] < z->offsets[i] || packedlen > len ) {
+			SDL_SetError("Corrupt compressed data seek table");
+			goto error;
+		}
+		if ( packedlen > maxpacked ) {
+			maxpacked = packedlen;
+		}
+	}
+
+	if ( base && avail >= table_offset ) {
+		z->base = (const Uint8 *)base;
+	} else if ( maxpacked > 0 ) {
+		z->packed = (Uint8 *)SDL_malloc(maxpacked);
+		if ( !z->packed ) {
+			SDL_OutOfMemory();
+			goto error;
+		}
+	}
+	z->block = (Uint8 *)SDL_malloc(SDL_min(z->blocksize, z->size) + 1);
+	if ( !z->block ) {
+		SDL_OutOfMemory();
+		goto error;
+	}
+	z->current = z->nblocks;
+
+#if SDL_RWOPS_ZLIB
+	if ( z->method == SDL_COMPRESS_ZLIB ) {
+		if ( inflateInit(&z->zstream) != Z_OK ) {
+			SDL_SetError("Couldn't initialize zlib");
+			goto error;
+		}
+		z->zinit = 1;
+	}
+#endif
+
+	rwops = SDL_AllocRW();
+	if ( !rwops ) {
+		goto error;
+	}
+	rwops->seek = compressed_seek;
+	rwops->read = compressed_read;
+	rwops->write = compressed_write;
+	rwops->close = compressed_close;
+	rwops->hidden.unknown.data1 = z;
+	return(rwops);
+
+error:
+	Compressed_Free(z);
+	return(NULL);
+}
+
+/* Read until 'buf' is full or the data runs out */
+static int Compress_ReadFull(SDL_RWops *src, Uint8 *buf, int len)
+{
+	int got = 0, n;
+
+	while ( got < len ) {
+		n = SDL_RWread(src, buf + got, 1, len - got);
+		if ( n < 0 ) {
+			return(-1);
+		}
+		if ( n == 0 ) {
+			break;
+		}
+		got += n;
+	}
+	return(got);
+}
+
+int SDL_CompressRW(SDL_RWops *src, SDL_RWops *dst, int method, int blocksize)
+{
+	Uint8 *raw = NULL;
+	Uint8 *packed = NULL;
+	Uint32 *table = NULL;
+	Uint32 *offsets = NULL;
+	Uint32 *grown;
+	Uint32 header[6];
+	Uint32 nblocks, maxblocks, size, pos;
+	int start, n, packedlen;
+	int status = -1;
+
+	if ( !src || !dst ) {
+		SDL_SetError("SDL_CompressRW(): passed NULL");
+		return(-1);
+	}
+	switch (method) {
+		case SDL_COMPRESS_LZ:
+			break;
+#if SDL_RWOPS_ZLIB
+		case SDL_COMPRESS_ZLIB:
+			break;
+#endif
+		default:
+			SDL_SetError("Unsupported compression method %d", method);
+			return(-1);
+	}
+	if ( blocksize == 0 ) {
+		blocksize = COMPRESS_DEFAULT_BLOCKSIZE;
+	}
+	if ( blocksize < COMPRESS_MIN_BLOCKSIZE || blocksize > COMPRESS_MAX_BLOCKSIZE ) {
+		SDL_SetError("SDL_CompressRW(): block size out of range");
+		return(-1);
+	}
+
+	raw = (Uint8 *)SDL_malloc(blocksize);
+	packed = (Uint8 *)SDL_malloc(blocksize);
+	maxblocks = 16;
+	offsets = (Uint32 *)SDL_malloc(maxblocks * sizeof(Uint32));
+	if ( method == SDL_COMPRESS_LZ ) {
+		table = (Uint32 *)SDL_malloc(sizeof(Uint32) << LZ_HASH_BITS);
+	}
+	if ( !raw || !packed || !offsets ||
+	     (method == SDL_COMPRESS_LZ && !table) ) {
+		SDL_OutOfMemory();
+		goto done;
+	}
+
+	/* The header is written last, when we know where everything is */
+	start = SDL_RWtell(dst);
+	SDL_memset(raw, 0, COMPRESS_HEADER_SIZE);
+	if ( SDL_RWwrite(dst, raw, COMPRESS_HEADER_SIZE, 1) != 1 ) {
+		goto done;
+	}
+	pos = COMPRESS_HEADER_SIZE;
+	size = 0;
+	nblocks = 0;
+
+	while ( (n = Compress_ReadFull(src, raw, blocksize)) > 0 ) {
+		if ( (Uint32)n > 0x7FFFFFFF - size || (Uint32)n > 0xFFFFFFFF - pos ) {
+			SDL_SetError("SDL_CompressRW(): too much data");
+			goto done;
+		}
+		if ( nblocks + 1 >= maxblocks ) {
+			maxblocks *= 2;
+			grown = (Uint32 *)SDL_realloc(offsets, maxblocks * sizeof(Uint32));
+			if ( !grown ) {
+				SDL_OutOfMemory();
+				goto done;
+			}
+			offsets = grown;
+		}
+
+		/* Blocks that don't get any smaller are stored */
+		packedlen = -1;
+		if ( method == SDL_COMPRESS_LZ ) {
+			packedlen = LZ_Compress(raw, n, packed, n - 1, table);
+		}
+#if SDL_RWOPS_ZLIB
+		if ( method == SDL_COMPRESS_ZLIB ) {
+			uLongf zlen = n - 1;
+			if ( compress2(packed, &zlen, raw, n, Z_BEST_COMPRESSION) == Z_OK ) {
+				packedlen = (int)zlen;
+			}
+		}
+#endif
+		if ( packedlen < 0 ) {
+			if ( SDL_RWwrite(dst, raw, n, 1) != 1 ) {
+				goto done;
+			}
+			packedlen = n;
+		} else if ( SDL_RWwrite(dst, packed, packedlen, 1) != 1 ) {
+			goto done;
+		}
+		offsets[nblocks++] = pos;
+		pos += packedlen;
+		size += n;
+		if ( n < blocksize ) {
+			break;
+		}
+	}
+	if ( n < 0 ) {
+		goto done;
+	}
+	offsets[nblocks] = pos;
+	if ( SDL_WriteLE32Array(dst, offsets, nblocks + 1) != nblocks + 1 ) {
+		goto done;
+	}
+
+	header[0] = COMPRESS_VERSION;
+	header[1] = method;
+	header[2] = blocksize;
+	header[3] = size;
+	header[4] = nblocks;
+	header[5] = pos;
+	if ( SDL_RWseek(dst, start, RW_SEEK_SET) < 0 ||
+	     SDL_RWwrite(dst, COMPRESS_MAGIC, 4, 1) != 1 ||
+	     SDL_WriteLE32Array(dst, header, SDL_arraysize(header)) != SDL_arraysize(header) ||
+	     SDL_RWseek(dst, start + (int)(pos + (nblocks + 1) * sizeof(Uint32)), RW_SEEK_SET) < 0 ) {
+		goto done;
+	}
+	status = 0;
+
+done:
+	if ( table ) {
+		SDL_free(table);
+	}
+	if ( offsets ) {
+		SDL_free(offsets);
+	}
+	if ( packed ) {
+		SDL_free(packed);
+	}
+	if ( raw ) {
+		SDL_free(raw);
+	}
+	return(status);
+}
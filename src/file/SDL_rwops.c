@@ -19,6 +19,12 @@
     Sam Lantinga
     slouken@libsdl.org
 */
+/* Use 64-bit file offsets on 32-bit systems, this has to come before any
+   system header is included */
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include "SDL_config.h"
 
 /* This file provides a general interface for SDL to read and write
@@ -27,6 +33,16 @@
 
 #include "SDL_endian.h"
 #include "SDL_rwops.h"
+#include "SDL_endian_c.h"
+
+#if HAVE_MMAP && HAVE_STDIO_H && !defined(__WIN32__)
+#define RWOPS_MMAP	1
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 
 #if defined(__WIN32__) && !defined(__SYMBIAN32__)
@@ -219,6 +235,44 @@ static int SDLCALL win32_file_seek(SDL_RWops *context, int offset, int whence)
 	SDL_Error(SDL_EFSEEK);
 	return -1; /* error */
 }
+#ifdef SDL_HAS_64BIT_TYPE
+static Sint64 win32_file_seek64(SDL_RWops *context, Sint64 offset, int whence)
+{
+	DWORD win32whence;
+	DWORD low;
+	LONG high;
+
+	if (!context || context->hidden.win32io.h == INVALID_HANDLE_VALUE) {
+		SDL_SetError("win32_file_seek: invalid context/file not opened");
+		return -1;
+	}
+
+	if (whence == RW_SEEK_CUR && context->hidden.win32io.buffer.left) {
+		offset -= context->hidden.win32io.buffer.left;
+	}
+	context->hidden.win32io.buffer.left = 0;
+
+	switch (whence) {
+		case RW_SEEK_SET:
+			win32whence = FILE_BEGIN; break;
+		case RW_SEEK_CUR:
+			win32whence = FILE_CURRENT; break;
+		case RW_SEEK_END:
+			win32whence = FILE_END; break;
+		default:
+			SDL_SetError("win32_file_seek: Unknown value for 'whence'");
+			return -1;
+	}
+
+	high = (LONG)(offset >> 32);
+	low = SetFilePointer(context->hidden.win32io.h, (LONG)(offset & 0xFFFFFFFF), &high, win32whence);
+	if ( low == INVALID_SET_FILE_POINTER && GetLastError() != NO_ERROR ) {
+		SDL_Error(SDL_EFSEEK);
+		return -1;
+	}
+	return ((Sint64)high << 32) | low;
+}
+#endif /* SDL_HAS_64BIT_TYPE */
 static int SDLCALL win32_file_read(SDL_RWops *context, void *ptr, int size, int maxnum)
 {
 	int		total_need; 
@@ -329,6 +383,23 @@ static int SDLCALL stdio_seek(SDL_RWops *context, int offset, int whence)
 		return(-1);
 	}
 }
+#ifdef SDL_HAS_64BIT_TYPE
+static Sint64 stdio_seek64(SDL_RWops *context, Sint64 offset, int whence)
+{
+#if HAVE_FSEEKO
+	if ( fseeko(context->hidden.stdio.fp, (off_t)offset, whence) == 0 ) {
+		return(ftello(context->hidden.stdio.fp));
+	}
+#else
+	if ( offset == (long)offset &&
+	     fseek(context->hidden.stdio.fp, (long)offset, whence) == 0 ) {
+		return(ftell(context->hidden.stdio.fp));
+	}
+#endif
+	SDL_Error(SDL_EFSEEK);
+	return(-1);
+}
+#endif /* SDL_HAS_64BIT_TYPE */
 static int SDLCALL stdio_read(SDL_RWops *context, void *ptr, int size, int maxnum)
 {
 	size_t nread;
@@ -433,6 +504,115 @@ static int SDLCALL mem_close(SDL_RWops *context)
 	return(0);
 }
 
+#if RWOPS_MMAP
+
+/* Read-only memory mapped files, these are read like constant memory.
+   Mapping a file costs more than reading a few pages of it, so small
+   files are read into memory instead.
+ */
+#define MMAP_MIN_SIZE	(64*1024)
+
+/* Writing fails the same way it does on a file opened with "rb" */
+static int SDLCALL mmap_write(SDL_RWops *context, const void *ptr, int size, int num)
+{
+	SDL_Error(SDL_EFWRITE);
+	return(0);
+}
+static int SDLCALL mmap_close(SDL_RWops *context)
+{
+	if ( context ) {
+		munmap(context->hidden.mem.base,
+		       context->hidden.mem.stop - context->hidden.mem.base);
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+static int SDLCALL mmap_closeheap(SDL_RWops *context)
+{
+	if ( context ) {
+		SDL_free(context->hidden.mem.base);
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+
+/* Read all of a small file, returns NULL if it didn't work */
+static void *mmap_readall(int fd, size_t size)
+{
+	Uint8 *data;
+	size_t got = 0;
+	ssize_t n;
+
+	data = (Uint8 *)SDL_malloc(size);
+	if ( data == NULL ) {
+		return(NULL);
+	}
+	while ( got < size ) {
+		n = read(fd, data + got, size - got);
+		if ( n <= 0 ) {
+			SDL_free(data);
+			return(NULL);
+		}
+		got += n;
+	}
+	return(data);
+}
+
+/* Returns NULL without setting an error if the file can't be mapped,
+   like when it's empty or not a regular file, so stdio can have a go.
+ */
+static SDL_RWops *mmap_open(const char *file)
+{
+	SDL_RWops *rwops;
+	struct stat st;
+	void *base;
+	size_t size;
+	int fd;
+
+	fd = open(file, O_RDONLY);
+	if ( fd < 0 ) {
+		return(NULL);
+	}
+	if ( fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+	     (Uint64)st.st_size > (size_t)-1 ) {
+		close(fd);
+		return(NULL);
+	}
+	size = (size_t)st.st_size;
+	if ( size < MMAP_MIN_SIZE ) {
+		base = mmap_readall(fd, size);
+		close(fd);
+		if ( base == NULL ) {
+			return(NULL);
+		}
+	} else {
+		base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if ( base == MAP_FAILED ) {
+			return(NULL);
+		}
+	}
+
+	rwops = SDL_AllocRW();
+	if ( rwops == NULL ) {
+		if ( size < MMAP_MIN_SIZE ) {
+			SDL_free(base);
+		} else {
+			munmap(base, size);
+		}
+		return(NULL);
+	}
+	rwops->seek = mem_seek;
+	rwops->read = mem_read;
+	rwops->write = mmap_write;
+	rwops->close = (size < MMAP_MIN_SIZE) ? mmap_closeheap : mmap_close;
+	rwops->hidden.mem.base = (Uint8 *)base;
+	rwops->hidden.mem.here = rwops->hidden.mem.base;
+	rwops->hidden.mem.stop = rwops->hidden.mem.base+size;
+	return(rwops);
+}
+#endif /* RWOPS_MMAP */
+
 
 /* Functions to create SDL_RWops structures from various data sources */
 
@@ -528,6 +708,21 @@ SDL_RWops *SDL_RWFromFile(const char *file, const char *mode)
 	return(rwops);
 }
 
+SDL_RWops *SDL_RWFromFileMapped(const char *file)
+{
+#if RWOPS_MMAP
+	SDL_RWops *rwops;
+
+	if ( file && *file ) {
+		rwops = mmap_open(file);
+		if ( rwops ) {
+			return(rwops);
+		}
+	}
+#endif
+	return(SDL_RWFromFile(file, "rb"));
+}
+
 #ifdef HAVE_STDIO_H
 SDL_RWops *SDL_RWFromFP(FILE *fp, int autoclose)
 {
@@ -596,6 +791,82 @@ void SDL_FreeRW(SDL_RWops *area)
 	SDL_free(area);
 }
 
+#ifdef SDL_HAS_64BIT_TYPE
+/* Our own SDL_RWops are recognized by their functions, anything else only
+   has the 32-bit seek */
+Sint64 SDL_RWseek64(SDL_RWops *context, Sint64 offset, int whence)
+{
+	if ( context->read == mem_read ) {
+		Sint64 pos, size;
+
+		pos = context->hidden.mem.here - context->hidden.mem.base;
+		size = context->hidden.mem.stop - context->hidden.mem.base;
+		switch (whence) {
+			case RW_SEEK_SET:
+				break;
+			case RW_SEEK_CUR:
+				offset += pos;
+				break;
+			case RW_SEEK_END:
+				offset += size;
+				break;
+			default:
+				SDL_SetError("Unknown value for 'whence'");
+				return(-1);
+		}
+		if ( offset < 0 ) {
+			offset = 0;
+		}
+		if ( offset > size ) {
+			offset = size;
+		}
+		context->hidden.mem.here = context->hidden.mem.base + (size_t)offset;
+		return(offset);
+	}
+#if defined(__WIN32__) && !defined(__SYMBIAN32__)
+	if ( context->seek == win32_file_seek ) {
+		return(win32_file_seek64(context, offset, whence));
+	}
+#endif
+#ifdef HAVE_STDIO_H
+	if ( context->seek == stdio_seek ) {
+		return(stdio_seek64(context, offset, whence));
+	}
+#endif
+	if ( offset < -0x7FFFFFFF || offset > 0x7FFFFFFF ) {
+		SDL_SetError("Seek offset out of range for this SDL_RWops");
+		return(-1);
+	}
+	return(context->seek(context, (int)offset, whence));
+}
+
+Sint64 SDL_RWsize(SDL_RWops *context)
+{
+	Sint64 pos, size;
+
+	if ( context->read == mem_read ) {
+		return(context->hidden.mem.stop - context->hidden.mem.base);
+	}
+	pos = SDL_RWseek64(context, 0, RW_SEEK_CUR);
+	if ( pos < 0 ) {
+		return(-1);
+	}
+	size = SDL_RWseek64(context, 0, RW_SEEK_END);
+	SDL_RWseek64(context, pos, RW_SEEK_SET);
+	return(size);
+}
+#endif /* SDL_HAS_64BIT_TYPE */
+
+const void *SDL_RWmap(SDL_RWops *context, size_t *size)
+{
+	if ( context->read != mem_read ) {
+		*size = 0;
+		return(NULL);
+	}
+	*size = context->hidden.mem.stop - context->hidden.mem.here;
+	return(context->hidden.mem.here);
+}
+
 /* Functions for dynamically reading and writing endian-specific values */
 
 Uint16 SDL_ReadLE16 (SDL_RWops *src)
@@ -671,3 +942,143 @@ int SDL_WriteBE64 (SDL_RWops *dst, Uint64 value)
 	value = SDL_SwapBE64(value);
 	return(SDL_RWwrite(dst, &value, (sizeof value), 1));
 }
+
+/* The largest number of items of 'size' bytes one read or write can take */
+#define MAX_RW_ITEMS(size)	(0x7FFFFFFF / (size))
+
+static size_t SDL_ReadArray(SDL_RWops *src, void *dst, size_t size, size_t n)
+{
+	Uint8 *data = (Uint8 *)dst;
+	size_t total = 0;
+	size_t chunk;
+	int got;
+
+	while ( total < n ) {
+		chunk = n - total;
+		if ( chunk > MAX_RW_ITEMS(size) ) {
+			chunk = MAX_RW_ITEMS(size);
+		}
+		got = SDL_RWread(src, data + total * size, (int)size, (int)chunk);
+		if ( got <= 0 ) {
+			break;
+		}
+		total += got;
+		if ( (size_t)got < chunk ) {
+			break;
+		}
+	}
+	return(total);
+}
+
+/* Values that need swapping go through a buffer, the caller's are const */
+static size_t SDL_WriteArray(SDL_RWops *dst, const void *src, size_t size, size_t n, SDL_bool swap)
+{
+	union {
+		Uint16 u16[2048];
+		Uint32 u32[1024];
+		Uint64 u64[512];
+	} buffer;
+	const Uint8 *data = (const Uint8 *)src;
+	const void *out;
+	size_t total = 0;
+	size_t chunk;
+	int done;
+
+	while ( total < n ) {
+		chunk = n - total;
+		if ( swap ) {
+			if ( chunk > sizeof(buffer) / size ) {
+				chunk = sizeof(buffer) / size;
+			}
+			SDL_memcpy(&buffer, data + total * size, chunk * size);
+			switch (size) {
+				case 2:
+					SDL_SwapArray16(buffer.u16, chunk);
+					break;
+				case 4:
+					SDL_SwapArray32(buffer.u32, chunk);
+					break;
+				default:
+					SDL_SwapArray64(buffer.u64, chunk);
+					break;
+			}
+			out = &buffer;
+		} else {
+			if ( chunk > MAX_RW_ITEMS(size) ) {
+				chunk = MAX_RW_ITEMS(size);
+			}
+			out = data + total * size;
+		}
+		done = SDL_RWwrite(dst, out, (int)size, (int)chunk);
+		if ( done <= 0 ) {
+			break;
+		}
+		total += done;
+		if ( (size_t)done < chunk ) {
+			break;
+		}
+	}
+	return(total);
+}
+
+size_t SDL_ReadLE16Array (SDL_RWops *src, Uint16 *dst, size_t n)
+{
+	n = SDL_ReadArray(src, dst, sizeof(*dst), n);
+	SDL_SwapArrayLE16(dst, n);
+	return(n);
+}
+size_t SDL_ReadBE16Array (SDL_RWops *src, Uint16 *dst, size_t n)
+{
+	n = SDL_ReadArray(src, dst, sizeof(*dst), n);
+	SDL_SwapArrayBE16(dst, n);
+	return(n);
+}
+size_t SDL_ReadLE32Array (SDL_RWops *src, Uint32 *dst, size_t n)
+{
+	n = SDL_ReadArray(src, dst, sizeof(*dst), n);
+	SDL_SwapArrayLE32(dst, n);
+	return(n);
+}
+size_t SDL_ReadBE32Array (SDL_RWops *src, Uint32 *dst, size_t n)
+{
+	n = SDL_ReadArray(src, dst, sizeof(*dst), n);
+	SDL_SwapArrayBE32(dst, n);
+	return(n);
+}
+size_t SDL_ReadLE64Array (SDL_RWops *src, Uint64 *dst, size_t n)
+{
+	n = SDL_ReadArray(src, dst, sizeof(*dst), n);
+	SDL_SwapArrayLE64(dst, n);
+	return(n);
+}
+size_t SDL_ReadBE64Array (SDL_RWops *src, Uint64 *dst, size_t n)
+{
+	n = SDL_ReadArray(src, dst, sizeof(*dst), n);
+	SDL_SwapArrayBE64(dst, n);
+	return(n);
+}
+
+size_t SDL_WriteLE16Array (SDL_RWops *dst, const Uint16 *src, size_t n)
+{
+	return(SDL_WriteArray(dst, src, sizeof(*src), n, SDL_BYTEORDER != SDL_LIL_ENDIAN));
+}
+size_t SDL_WriteBE16Array (SDL_RWops *dst, const Uint16 *src, size_t n)
+{
+	return(SDL_WriteArray(dst, src, sizeof(*src), n, SDL_BYTEORDER != SDL_BIG_ENDIAN));
+}
+size_t SDL_WriteLE32Array (SDL_RWops *dst, const Uint32 *src, size_t n)
+{
+	return(SDL_WriteArray(dst, src, sizeof(*src), n, SDL_BYTEORDER != SDL_LIL_ENDIAN));
+}
+size_t SDL_WriteBE32Array (SDL_RWops *dst, const Uint32 *src, size_t n)
+{
+	return(SDL_WriteArray(dst, src, sizeof(*src), n, SDL_BYTEORDER != SDL_BIG_ENDIAN));
+}
+size_t SDL_WriteLE64Array (SDL_RWops *dst, const Uint64 *src, size_t n)
+{
+	return(SDL_WriteArray(dst, src, sizeof(*src), n, SDL_BYTEORDER != SDL_LIL_ENDIAN));
+}
+size_t SDL_WriteBE64Array (SDL_RWops *dst, const Uint64 *src, size_t n)
+{
+	return(SDL_WriteArray(dst, src, sizeof(*src), n, SDL_BYTEORDER != SDL_BIG_ENDIAN));
+}
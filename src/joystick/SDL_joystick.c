@@ -120,6 +120,7 @@ SDL_Joystick *SDL_JoystickOpen(int device_index)
 
 	SDL_memset(joystick, 0, (sizeof *joystick));
 	joystick->index = device_index;
+	joystick->fd = -1;
 	if ( SDL_SYS_JoystickOpen(joystick) < 0 ) {
 		SDL_free(joystick);
 		return(NULL);
@@ -574,6 +575,23 @@ void SDL_JoystickUpdate(void)
 	}
 }
 
+/*
+ * Store the file descriptors of the open joysticks in 'fds', returning
+ * how many there are, or -1 if any of them have to be polled instead.
+ */
+int SDL_JoystickGetFDs(int *fds, int maxfds)
+{
+	int i;
+
+	for ( i=0; SDL_joysticks[i]; ++i ) {
+		if ( (SDL_joysticks[i]->fd < 0) || (i >= maxfds) ) {
+			return(-1);
+		}
+		fds[i] = SDL_joysticks[i]->fd;
+	}
+	return(i);
+}
+
 int SDL_JoystickEventState(int state)
 {
 #if SDL_EVENTS_DISABLED
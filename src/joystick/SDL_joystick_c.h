@@ -27,6 +27,9 @@
 /* The number of available joysticks on the system */
 extern Uint8 SDL_numjoysticks;
 
+/* Used by the event loop to wait for joystick input */
+extern int SDL_JoystickGetFDs(int *fds, int maxfds);
+
 /* Internal event queueing functions */
 extern int SDL_PrivateJoystickAxis(SDL_Joystick *joystick,
                                    Uint8 axis, Sint16 value);
@@ -47,6 +47,8 @@ struct _SDL_Joystick {
 	
 	struct joystick_hwdata *hwdata;	/* Driver dependent information */
 
+	int fd;			/* Readable on input, or -1 if polled */
+
 	int ref_count;		/* Reference count for multiple opens */
 };
 
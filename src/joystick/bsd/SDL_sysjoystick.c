@@ -177,7 +177,7 @@ SDL_SYS_JoystickInit(void)
 		SDL_snprintf(s, SDL_arraysize(s), "/dev/uhid%d", i);
 
 		nj.index = SDL_numjoysticks;
-		joynames[nj.index] = strdup(s);
+		joynames[nj.index] = SDL_strdup(s);
 
 		if (SDL_SYS_JoystickOpen(&nj) == 0) {
 			SDL_SYS_JoystickClose(&nj);
@@ -191,7 +191,7 @@ SDL_SYS_JoystickInit(void)
 		SDL_snprintf(s, SDL_arraysize(s), "/dev/joy%d", i);
 		fd = open(s, O_RDONLY);
 		if (fd != -1) {
-			joynames[SDL_numjoysticks++] = strdup(s);
+			joynames[SDL_numjoysticks++] = SDL_strdup(s);
 			close(fd);
 		}
 	}
@@ -279,7 +279,7 @@ SDL_SYS_JoystickOpen(SDL_Joystick *joy)
 	}
 	joy->hwdata = hw;
 	hw->fd = fd;
-	hw->path = strdup(path);
+	hw->path = SDL_strdup(path);
 	hw->x = 0;
 	hw->y = 0;
 	hw->xmin = 0xffff;
@@ -292,7 +292,7 @@ SDL_SYS_JoystickOpen(SDL_Joystick *joy)
 		joy->nbuttons = 2;
 		joy->nhats = 0;
 		joy->nballs = 0;
-		joydevnames[joy->index] = strdup("Gameport joystick");
+		joydevnames[joy->index] = SDL_strdup("Gameport joystick");
 		goto usbend;
 	} else {
 		hw->type = BSDJOY_UHID;
@@ -826,6 +826,7 @@ int SDL_SYS_JoystickOpen(SDL_Joystick *joystick)
 	SDL_memset(joystick->hwdata->abs_map, ABS_MAX, sizeof(*joystick->hwdata->abs_map)*ABS_MAX);
 #endif
 	joystick->hwdata->fd = fd;
+	joystick->fd = fd;
 
 	/* Set the joystick to non-blocking read mode */
 	fcntl(fd, F_SETFL, O_NONBLOCK);
@@ -0,0 +1,472 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Copying and filling rows of memory, for blits, rectangle fills and
+   audio buffers.
+
+   Each row stores both ends unaligned and the middle lined up on the
+   vector size, four vectors per step.  When all the rows together are
+   bigger than half the CPU cache, the middle is written around the
+   cache, so a big copy doesn't push out everything else.
+*/
+
+#include "SDL_stdinc.h"
+#include "SDL_cpuinfo.h"
+#include "../cpuinfo/SDL_simd.h"
+#include "SDL_copyrows_c.h"
+
+typedef void (*CopyRowFunc)(Uint8 *dst, const Uint8 *src, size_t len, int stream);
+typedef void (*FillRowFunc)(Uint8 *dst, Uint32 pattern, size_t len, int stream);
+typedef void (*FillRow3Func)(Uint8 *dst, const Uint8 *pattern, size_t len, int stream);
+
+/* Three byte pixels repeat every 48 bytes, or three SSE2 vectors, and
+   every 96 bytes, or three AVX2 vectors.  The fills load their vectors
+   from a buffer of the pixel repeated out past 96 bytes, starting from
+   however far into a pixel the destination is.
+*/
+#define PATTERN3_SIZE	128
+
+/* The pattern as it would be stored offset bytes into a row */
+static Uint32 RotatePattern(Uint32 pattern, size_t offset)
+{
+	Uint8 bytes[8];
+	Uint32 value;
+
+	SDL_memcpy(bytes, &pattern, 4);
+	SDL_memcpy(bytes + 4, &pattern, 4);
+	SDL_memcpy(&value, bytes + (offset & 3), 4);
+	return(value);
+}
+
+static void C_CopyRow(Uint8 *dst, const Uint8 *src, size_t len, int stream)
+{
+	SDL_memcpy(dst, src, len);
+}
+
+static void C_FillRow(Uint8 *dst, Uint32 pattern, size_t len, int stream)
+{
+	Uint8 bytes[4];
+	size_t i = 0, n;
+
+	SDL_memcpy(bytes, &pattern, 4);
+	if ( bytes[0] == bytes[1] && bytes[0] == bytes[2] && bytes[0] == bytes[3] ) {
+		SDL_memset(dst, bytes[0], len);
+		return;
+	}
+	while ( i < len && ((uintptr_t)(dst + i) & 3) ) {
+		dst[i] = bytes[i & 3];
+		++i;
+	}
+	n = (len - i) / 4;
+	if ( n ) {
+		SDL_memset4(dst + i, RotatePattern(pattern, i), n);
+		i += n * 4;
+	}
+	while ( i < len ) {
+		dst[i] = bytes[i & 3];
+		++i;
+	}
+}
+
+static void C_FillRow3(Uint8 *dst, const Uint8 *pattern, size_t len, int stream)
+{
+	size_t i = 0;
+
+	while ( i + 48 <= len ) {
+		SDL_memcpy(dst + i, pattern, 48);
+		i += 48;
+	}
+	if ( i < len ) {
+		SDL_memcpy(dst + i, pattern, len - i);
+	}
+}
+
+#if HAVE_AVX2_INTRINSICS
+#define AVX2_STORE(p, v) \
+	(stream ? _mm256_stream_si256((__m256i *)(p), v) : _mm256_store_si256((__m256i *)(p), v))
+
+/* Rows of at least 64 bytes */
+SDL_TARGETING("avx2") static void AVX2_CopyRow(Uint8 *dst, const Uint8 *src, size_t len, int stream)
+{
+	__m256i a, b, c, d;
+	size_t i;
+
+	a = _mm256_loadu_si256((const __m256i *)src);
+	b = _mm256_loadu_si256((const __m256i *)(src + len - 32));
+	_mm256_storeu_si256((__m256i *)dst, a);
+	_mm256_storeu_si256((__m256i *)(dst + len - 32), b);
+
+	for ( i = 32 - ((uintptr_t)dst & 31); i + 128 <= len; i += 128 ) {
+		a = _mm256_loadu_si256((const __m256i *)(src + i));
+		b = _mm256_loadu_si256((const __m256i *)(src + i + 32));
+		c = _mm256_loadu_si256((const __m256i *)(src + i + 64));
+		d = _mm256_loadu_si256((const __m256i *)(src + i + 96));
+		AVX2_STORE(dst + i, a);
+		AVX2_STORE(dst + i + 32, b);
+		AVX2_STORE(dst + i + 64, c);
+		AVX2_STORE(dst + i + 96, d);
+	}
+	for ( ; i + 32 <= len; i += 32 ) {
+		a = _mm256_loadu_si256((const __m256i *)(src + i));
+		AVX2_STORE(dst + i, a);
+	}
+}
+
+SDL_TARGETING("avx2") static void AVX2_FillRow(Uint8 *dst, Uint32 pattern, size_t len, int stream)
+{
+	__m256i v;
+	size_t i;
+
+	v = _mm256_set1_epi32((int)pattern);
+	_mm256_storeu_si256((__m256i *)dst, v);
+	v = _mm256_set1_epi32((int)RotatePattern(pattern, len - 32));
+	_mm256_storeu_si256((__m256i *)(dst + len - 32), v);
+
+	i = 32 - ((uintptr_t)dst & 31);
+	v = _mm256_set1_epi32((int)RotatePattern(pattern, i));
+	for ( ; i + 128 <= len; i += 128 ) {
+		AVX2_STORE(dst + i, v);
+		AVX2_STORE(dst + i + 32, v);
+		AVX2_STORE(dst + i + 64, v);
+		AVX2_STORE(dst + i + 96, v);
+	}
+	for ( ; i + 32 <= len; i += 32 ) {
+		AVX2_STORE(dst + i, v);
+	}
+}
+
+/* Rows of at least 32 bytes */
+SDL_TARGETING("avx2") static void AVX2_FillRow3(Uint8 *dst, const Uint8 *pattern, size_t len, int stream)
+{
+	__m256i a, b, c;
+	size_t i;
+
+	a = _mm256_loadu_si256((const __m256i *)pattern);
+	_mm256_storeu_si256((__m256i *)dst, a);
+	a = _mm256_loadu_si256((const __m256i *)(pattern + (len - 32) % 3));
+	_mm256_storeu_si256((__m256i *)(dst + len - 32), a);
+
+	i = 32 - ((uintptr_t)dst & 31);
+	pattern += i % 3;
+	a = _mm256_loadu_si256((const __m256i *)pattern);
+	b = _mm256_loadu_si256((const __m256i *)(pattern + 32));
+	c = _mm256_loadu_si256((const __m256i *)(pattern + 64));
+	for ( ; i + 96 <= len; i += 96 ) {
+		AVX2_STORE(dst + i, a);
+		AVX2_STORE(dst + i + 32, b);
+		AVX2_STORE(dst + i + 64, c);
+	}
+	if ( i + 32 <= len ) {
+		AVX2_STORE(dst + i, a);
+		if ( i + 64 <= len ) {
+			AVX2_STORE(dst + i + 32, b);
+		}
+	}
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+#if HAVE_SSE2_INTRINSICS
+#define SSE2_STORE(p, v) \
+	(stream ? _mm_stream_si128((__m128i *)(p), v) : _mm_store_si128((__m128i *)(p), v))
+
+/* Rows of at least 16 bytes */
+SDL_TARGETING("sse2") static void SSE2_CopyRow(Uint8 *dst, const Uint8 *src, size_t len, int stream)
+{
+	__m128i a, b, c, d;
+	size_t i;
+
+	a = _mm_loadu_si128((const __m128i *)src);
+	b = _mm_loadu_si128((const __m128i *)(src + len - 16));
+	_mm_storeu_si128((__m128i *)dst, a);
+	_mm_storeu_si128((__m128i *)(dst + len - 16), b);
+
+	for ( i = 16 - ((uintptr_t)dst & 15); i + 64 <= len; i += 64 ) {
+		a = _mm_loadu_si128((const __m128i *)(src + i));
+		b = _mm_loadu_si128((const __m128i *)(src + i + 16));
+		c = _mm_loadu_si128((const __m128i *)(src + i + 32));
+		d = _mm_loadu_si128((const __m128i *)(src + i + 48));
+		SSE2_STORE(dst + i, a);
+		SSE2_STORE(dst + i + 16, b);
+		SSE2_STORE(dst + i + 32, c);
+		SSE2_STORE(dst + i + 48, d);
+	}
+	for ( ; i + 16 <= len; i += 16 ) {
+		a = _mm_loadu_si128((const __m128i *)(src + i));
+		SSE2_STORE(dst + i, a);
+	}
+}
+
+/* Going down from the end, each block is loaded before it is stored, so
+   this is safe when dst overlaps the end of src */
+SDL_TARGETING("sse2") static void SSE2_CopyRowReverse(Uint8 *dst, const Uint8 *src, size_t len)
+{
+	__m128i a, b, c, d;
+	size_t i = len;
+
+	while ( i >= 64 ) {
+		i -= 64;
+		a = _mm_loadu_si128((const __m128i *)(src + i));
+		b = _mm_loadu_si128((const __m128i *)(src + i + 16));
+		c = _mm_loadu_si128((const __m128i *)(src + i + 32));
+		d = _mm_loadu_si128((const __m128i *)(src + i + 48));
+		_mm_storeu_si128((__m128i *)(dst + i), a);
+		_mm_storeu_si128((__m128i *)(dst + i + 16), b);
+		_mm_storeu_si128((__m128i *)(dst + i + 32), c);
+		_mm_storeu_si128((__m128i *)(dst + i + 48), d);
+	}
+	while ( i >= 16 ) {
+		i -= 16;
+		a = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), a);
+	}
+	while ( i > 0 ) {
+		--i;
+		dst[i] = src[i];
+	}
+}
+
+SDL_TARGETING("sse2") static void SSE2_FillRow(Uint8 *dst, Uint32 pattern, size_t len, int stream)
+{
+	__m128i v;
+	size_t i;
+
+	v = _mm_set1_epi32((int)pattern);
+	_mm_storeu_si128((__m128i *)dst, v);
+	v = _mm_set1_epi32((int)RotatePattern(pattern, len - 16));
+	_mm_storeu_si128((__m128i *)(dst + len - 16), v);
+
+	i = 16 - ((uintptr_t)dst & 15);
+	v = _mm_set1_epi32((int)RotatePattern(pattern, i));
+	for ( ; i + 64 <= len; i += 64 ) {
+		SSE2_STORE(dst + i, v);
+		SSE2_STORE(dst + i + 16, v);
+		SSE2_STORE(dst + i + 32, v);
+		SSE2_STORE(dst + i + 48, v);
+	}
+	for ( ; i + 16 <= len; i += 16 ) {
+		SSE2_STORE(dst + i, v);
+	}
+}
+
+/* Rows of at least 16 bytes */
+SDL_TARGETING("sse2") static void SSE2_FillRow3(Uint8 *dst, const Uint8 *pattern, size_t len, int stream)
+{
+	__m128i a, b, c;
+	size_t i;
+
+	a = _mm_loadu_si128((const __m128i *)pattern);
+	_mm_storeu_si128((__m128i *)dst, a);
+	a = _mm_loadu_si128((const __m128i *)(pattern + (len - 16) % 3));
+	_mm_storeu_si128((__m128i *)(dst + len - 16), a);
+
+	i = 16 - ((uintptr_t)dst & 15);
+	pattern += i % 3;
+	a = _mm_loadu_si128((const __m128i *)pattern);
+	b = _mm_loadu_si128((const __m128i *)(pattern + 16));
+	c = _mm_loadu_si128((const __m128i *)(pattern + 32));
+	for ( ; i + 48 <= len; i += 48 ) {
+		SSE2_STORE(dst + i, a);
+		SSE2_STORE(dst + i + 16, b);
+		SSE2_STORE(dst + i + 32, c);
+	}
+	if ( i + 16 <= len ) {
+		SSE2_STORE(dst + i, a);
+		if ( i + 32 <= len ) {
+			SSE2_STORE(dst + i + 16, b);
+		}
+	}
+}
+
+/* Streaming stores aren't ordered with the rest, fence them off */
+SDL_TARGETING("sse2") static void SSE2_StreamDone(void)
+{
+	_mm_sfence();
+}
+#endif /* HAVE_SSE2_INTRINSICS */
+
+static CopyRowFunc GetCopyRow(size_t len)
+{
+#if HAVE_AVX2_INTRINSICS
+	if ( len >= 64 && SDL_HasAVX2() ) {
+		return AVX2_CopyRow;
+	}
+#endif
+#if HAVE_SSE2_INTRINSICS
+	if ( len >= 16 && SDL_HasSSE2() ) {
+		return SSE2_CopyRow;
+	}
+#endif
+	return C_CopyRow;
+}
+
+static FillRowFunc GetFillRow(size_t len)
+{
+#if HAVE_AVX2_INTRINSICS
+	if ( len >= 64 && SDL_HasAVX2() ) {
+		return AVX2_FillRow;
+	}
+#endif
+#if HAVE_SSE2_INTRINSICS
+	if ( len >= 16 && SDL_HasSSE2() ) {
+		return SSE2_FillRow;
+	}
+#endif
+	return C_FillRow;
+}
+
+static FillRow3Func GetFillRow3(size_t len)
+{
+#if HAVE_AVX2_INTRINSICS
+	if ( len >= 32 && SDL_HasAVX2() ) {
+		return AVX2_FillRow3;
+	}
+#endif
+#if HAVE_SSE2_INTRINSICS
+	if ( len >= 16 && SDL_HasSSE2() ) {
+		return SSE2_FillRow3;
+	}
+#endif
+	return C_FillRow3;
+}
+
+/* Whether rows this big should bypass the cache */
+static int StreamRows(size_t len, int rows)
+{
+	static size_t threshold = 0;
+
+	if ( !threshold ) {
+		int cache = SDL_GetCPUCacheSize();
+		if ( cache > 0 ) {
+			threshold = (size_t)cache / 2;
+		} else {
+			threshold = (size_t)-1;
+		}
+	}
+	return ( len > threshold / rows );
+}
+
+void SDL_CopyRows(Uint8 *dst, int dstpitch, const Uint8 *src, int srcpitch, size_t len, int rows)
+{
+	CopyRowFunc copy;
+	int stream;
+
+	if ( len == 0 || rows <= 0 ) {
+		return;
+	}
+	/* Rows without gaps between them are one long row */
+	if ( (size_t)dstpitch == len && (size_t)srcpitch == len ) {
+		len *= rows;
+		rows = 1;
+	}
+	copy = GetCopyRow(len);
+	stream = (copy != C_CopyRow && StreamRows(len, rows));
+	while ( rows-- ) {
+		copy(dst, src, len, stream);
+		dst += dstpitch;
+		src += srcpitch;
+	}
+#if HAVE_SSE2_INTRINSICS
+	if ( stream ) {
+		SSE2_StreamDone();
+	}
+#endif
+}
+
+void SDL_CopyRowsReverse(Uint8 *dst, int dstpitch, const Uint8 *src, int srcpitch, size_t len, int rows)
+{
+	if ( len == 0 || rows <= 0 ) {
+		return;
+	}
+	dst += (rows - 1) * dstpitch;
+	src += (rows - 1) * srcpitch;
+#if HAVE_SSE2_INTRINSICS
+	if ( len >= 16 && SDL_HasSSE2() ) {
+		while ( rows-- ) {
+			SSE2_CopyRowReverse(dst, src, len);
+			dst -= dstpitch;
+			src -= srcpitch;
+		}
+		return;
+	}
+#endif
+	while ( rows-- ) {
+		SDL_revcpy(dst, src, len);
+		dst -= dstpitch;
+		src -= srcpitch;
+	}
+}
+
+void SDL_FillRows(Uint8 *dst, int pitch, Uint32 pattern, size_t len, int rows)
+{
+	FillRowFunc fill;
+	int stream;
+
+	if ( len == 0 || rows <= 0 ) {
+		return;
+	}
+	/* The pattern only carries on into the next row if len lines up */
+	if ( (size_t)pitch == len && (len & 3) == 0 ) {
+		len *= rows;
+		rows = 1;
+	}
+	fill = GetFillRow(len);
+	stream = (fill != C_FillRow && StreamRows(len, rows));
+	while ( rows-- ) {
+		fill(dst, pattern, len, stream);
+		dst += pitch;
+	}
+#if HAVE_SSE2_INTRINSICS
+	if ( stream ) {
+		SSE2_StreamDone();
+	}
+#endif
+}
+
+void SDL_FillRows3(Uint8 *dst, int pitch, const Uint8 *pixel, size_t len, int rows)
+{
+	Uint8 pattern[PATTERN3_SIZE];
+	FillRow3Func fill;
+	int i, stream;
+
+	if ( len == 0 || rows <= 0 ) {
+		return;
+	}
+	for ( i = 0; i < PATTERN3_SIZE; ++i ) {
+		pattern[i] = pixel[i % 3];
+	}
+	if ( (size_t)pitch == len && (len % 3) == 0 ) {
+		len *= rows;
+		rows = 1;
+	}
+	fill = GetFillRow3(len);
+	stream = (fill != C_FillRow3 && StreamRows(len, rows));
+	while ( rows-- ) {
+		fill(dst, pattern, len, stream);
+		dst += pitch;
+	}
+#if HAVE_SSE2_INTRINSICS
+	if ( stream ) {
+		SSE2_StreamDone();
+	}
+#endif
+}
@@ -0,0 +1,47 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_copyrows_c_h
+#define _SDL_copyrows_c_h
+
+#include "SDL_stdinc.h"
+
+/* Copy len bytes from each of rows rows of src to dst.
+   The rows must not overlap, unless dst comes after src and
+   SDL_CopyRowsReverse() is used, which starts from the end.
+*/
+extern void SDL_CopyRows(Uint8 *dst, int dstpitch, const Uint8 *src, int srcpitch, size_t len, int rows);
+extern void SDL_CopyRowsReverse(Uint8 *dst, int dstpitch, const Uint8 *src, int srcpitch, size_t len, int rows);
+
+/* Fill len bytes of each row with the four bytes of pattern, in the
+   order they are in memory, starting over at the start of each row.
+*/
+extern void SDL_FillRows(Uint8 *dst, int pitch, Uint32 pattern, size_t len, int rows);
+
+/* The same, repeating the three bytes of a 24-bit pixel */
+extern void SDL_FillRows3(Uint8 *dst, int pitch, const Uint8 *pixel, size_t len, int rows);
+
+#define SDL_CopyBlock(dst, src, len)	SDL_CopyRows(dst, 0, src, 0, len, 1)
+#define SDL_FillBlock(dst, pattern, len)	SDL_FillRows(dst, 0, pattern, len, 1)
+
+#endif /* _SDL_copyrows_c_h */
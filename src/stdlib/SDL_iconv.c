@@ -25,6 +25,7 @@
 
 #include "SDL_stdinc.h"
 #include "SDL_endian.h"
+#include "SDL_utf8_c.h"
 
 #if defined(HAVE_ICONV) && defined(HAVE_ICONV_H)
 
@@ -192,6 +193,27 @@ SDL_iconv_t SDL_iconv_open(const char *tocode, const char *fromcode)
 	return (SDL_iconv_t)-1;
 }
 
+/* The SDL_FromUTF8() and SDL_ToUTF8() format for an encoding, or -1 */
+static int GetUTFFormat(int format)
+{
+	switch ( format ) {
+	    case ENCODING_LATIN1:
+		return SDL_UTF_LATIN1;
+	    case ENCODING_UTF16BE:
+		return SDL_UTF_16BE;
+	    case ENCODING_UTF16LE:
+		return SDL_UTF_16LE;
+	    case ENCODING_UTF32BE:
+		return SDL_UTF_32BE;
+	    case ENCODING_UTF32LE:
+		return SDL_UTF_32LE;
+	    case ENCODING_UCS4:
+		return SDL_UTF_32NATIVE;
+	    default:
+		return -1;
+	}
+}
+
 size_t SDL_iconv(SDL_iconv_t cd,
                  const char **inbuf, size_t *inbytesleft,
                  char **outbuf, size_t *outbytesleft)
@@ -217,53 +239,40 @@ size_t SDL_iconv(SDL_iconv_t cd,
 
 	switch ( cd->src_fmt ) {
 	    case ENCODING_UTF16:
-		/* Scan for a byte order marker */
+		/* Look for a byte order marker at the start */
 		{
 			Uint8 *p = (Uint8 *)src;
-			size_t n = srclen / 2;
-			while ( n ) {
-				if ( p[0] == 0xFF && p[1] == 0xFE ) {
-					cd->src_fmt = ENCODING_UTF16BE;
-					break;
-				} else if ( p[0] == 0xFE && p[1] == 0xFF ) {
-					cd->src_fmt = ENCODING_UTF16LE;
-					break;
-				}
-				p += 2;
-				--n;
-			}
-			if ( n == 0 ) {
-				/* We can't tell, default to host order */
-				cd->src_fmt = ENCODING_UTF16NATIVE;
+			cd->src_fmt = ENCODING_UTF16NATIVE;
+			if ( srclen >= 2 && p[0] == 0xFF && p[1] == 0xFE ) {
+				cd->src_fmt = ENCODING_UTF16LE;
+				src += 2;
+				srclen -= 2;
+			} else if ( srclen >= 2 && p[0] == 0xFE && p[1] == 0xFF ) {
+				cd->src_fmt = ENCODING_UTF16BE;
+				src += 2;
+				srclen -= 2;
 			}
 		}
 		break;
 	    case ENCODING_UTF32:
-		/* Scan for a byte order marker */
+		/* Look for a byte order marker at the start */
 		{
 			Uint8 *p = (Uint8 *)src;
-			size_t n = srclen / 4;
-			while ( n ) {
-				if ( p[0] == 0xFF && p[1] == 0xFE &&
-				     p[2] == 0x00 && p[3] == 0x00 ) {
-					cd->src_fmt = ENCODING_UTF32BE;
-					break;
-				} else if ( p[0] == 0x00 && p[1] == 0x00 &&
-				            p[2] == 0xFE && p[3] == 0xFF ) {
-					cd->src_fmt = ENCODING_UTF32LE;
-					break;
-				}
-				p += 4;
-				--n;
-			}
-			if ( n == 0 ) {
-				/* We can't tell, default to host order */
-				cd->src_fmt = ENCODING_UTF32NATIVE;
+			cd->src_fmt = ENCODING_UTF32NATIVE;
+			if ( srclen >= 4 && p[0] == 0xFF && p[1] == 0xFE &&
+			     p[2] == 0x00 && p[3] == 0x00 ) {
+				cd->src_fmt = ENCODING_UTF32LE;
+				src += 4;
+				srclen -= 4;
+			} else if ( srclen >= 4 && p[0] == 0x00 && p[1] == 0x00 &&
+			            p[2] == 0xFE && p[3] == 0xFF ) {
+				cd->src_fmt = ENCODING_UTF32BE;
+				src += 4;
+				srclen -= 4;
 			}
 		}
 		break;
 	}
-
 	switch ( cd->dst_fmt ) {
 	    case ENCODING_UTF16:
 		/* Default to host order, need to add byte order marker */
@@ -287,6 +296,24 @@ size_t SDL_iconv(SDL_iconv_t cd,
 		break;
 	}
 
+	/* Save any byte order markers read or written */
+	*inbuf = src;
+	if ( inbytesleft ) {
+		*inbytesleft = srclen;
+	}
+	*outbuf = dst;
+	*outbytesleft = dstlen;
+
+	/* Conversions to and from UTF-8 have their own faster loops */
+	if ( srclen > 0 ) {
+		if ( cd->src_fmt == ENCODING_UTF8 && GetUTFFormat(cd->dst_fmt) >= 0 ) {
+			return SDL_FromUTF8(GetUTFFormat(cd->dst_fmt), inbuf, inbytesleft, outbuf, outbytesleft);
+		}
+		if ( cd->dst_fmt == ENCODING_UTF8 && GetUTFFormat(cd->src_fmt) >= 0 ) {
+			return SDL_ToUTF8(GetUTFFormat(cd->src_fmt), inbuf, inbytesleft, outbuf, outbytesleft);
+		}
+	}
+
 	total = 0;
 	while ( srclen > 0 ) {
 		/* Decode a character */
@@ -795,6 +822,82 @@ int SDL_iconv_close(SDL_iconv_t cd)
 
 #endif /* !HAVE_ICONV */
 
+/* Strings to and from UTF-8 in these encodings don't need SDL_iconv() */
+static struct {
+	const char *name;
+	int format;
+	size_t size;
+} utf_encodings[] = {
+	{ "UTF8",	SDL_UTF_8,	1 },
+	{ "UTF-8",	SDL_UTF_8,	1 },
+	{ "8859-1",	SDL_UTF_LATIN1,	1 },
+	{ "ISO-8859-1",	SDL_UTF_LATIN1,	1 },
+	{ "UTF16BE",	SDL_UTF_16BE,	2 },
+	{ "UTF-16BE",	SDL_UTF_16BE,	2 },
+	{ "UTF16LE",	SDL_UTF_16LE,	2 },
+	{ "UTF-16LE",	SDL_UTF_16LE,	2 },
+	{ "UTF32BE",	SDL_UTF_32BE,	4 },
+	{ "UTF-32BE",	SDL_UTF_32BE,	4 },
+	{ "UTF32LE",	SDL_UTF_32LE,	4 },
+	{ "UTF-32LE",	SDL_UTF_32LE,	4 },
+#if defined(HAVE_ICONV) && defined(HAVE_ICONV_H)
+	/* The C library follows ISO 10646 here */
+	{ "UCS4",	SDL_UTF_32BE,	4 },
+	{ "UCS-4",	SDL_UTF_32BE,	4 },
+#else
+	{ "UCS4",	SDL_UTF_32NATIVE, 4 },
+	{ "UCS-4",	SDL_UTF_32NATIVE, 4 },
+#endif
+};
+
+static int GetUTFEncoding(const char *code)
+{
+	int i;
+
+	for ( i = 0; i < SDL_arraysize(utf_encodings); ++i ) {
+		if ( SDL_strcasecmp(code, utf_encodings[i].name) == 0 ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* Every character converts in one pass into a buffer sized for the worst case */
+static char *SDL_UTFString(int to, int from, const char *inbuf, size_t inbytesleft)
+{
+	char *string;
+	size_t stringsize;
+	char *outbuf;
+	size_t outbytesleft;
+
+	if ( utf_encodings[from].format == SDL_UTF_8 ) {
+		stringsize = utf_encodings[to].size;
+	} else {
+		/* Two bytes of Latin-1 or UTF-16 can make three of UTF-8 */
+		stringsize = 2;
+	}
+	if ( inbytesleft > (((size_t)-1) - sizeof(Uint32)) / stringsize ) {
+		return NULL;
+	}
+	stringsize *= inbytesleft;
+	string = (char *) SDL_malloc(stringsize + sizeof(Uint32));
+	if ( !string ) {
+		return NULL;
+	}
+	outbuf = string;
+	outbytesleft = stringsize;
+
+	/* A partial character at the end is dropped, as SDL_iconv() would */
+	if ( utf_encodings[from].format == SDL_UTF_8 ) {
+		SDL_FromUTF8(utf_encodings[to].format, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
+	} else {
+		SDL_ToUTF8(utf_encodings[from].format, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
+	}
+	SDL_memset(outbuf, 0, sizeof(Uint32));
+
+	return string;
+}
+
 char *SDL_iconv_string(const char *tocode, const char *fromcode, const char *inbuf, size_t inbytesleft)
 {
 	SDL_iconv_t cd;
@@ -803,6 +906,7 @@ char *SDL_iconv_string(const char *tocode, const char *fromcode, const char *inb
 	char *outbuf;
 	size_t outbytesleft;
 	size_t retCode = 0;
+	int to, from;
 
 	if ( !tocode || !*tocode ) {
 		tocode = "UTF-8";
@@ -810,6 +914,13 @@ char *SDL_iconv_string(const char *tocode, const char *fromcode, const char *inb
 	if ( !fromcode || !*fromcode ) {
 		fromcode = "UTF-8";
 	}
+	to = GetUTFEncoding(tocode);
+	from = GetUTFEncoding(fromcode);
+	if ( to >= 0 && from >= 0 &&
+	     (utf_encodings[to].format == SDL_UTF_8) != (utf_encodings[from].format == SDL_UTF_8) ) {
+		return SDL_UTFString(to, from, inbuf, inbytesleft);
+	}
+
 	cd = SDL_iconv_open(tocode, fromcode);
 	if ( cd == (SDL_iconv_t)-1 ) {
 		return NULL;
@@ -24,8 +24,18 @@
 /* This file contains portable memory management functions for SDL */
 
 #include "SDL_stdinc.h"
+#include "SDL_error.h"
 
-#ifndef HAVE_MALLOC
+#ifdef SDL_MALLOC_THREADED
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+
+/* Only the mspaces are needed, SDL_malloc() is built on them below */
+#define ONLY_MSPACES 1
+#define FOOTERS 1
+#endif
+
+#if !defined(HAVE_MALLOC) || defined(SDL_MALLOC_THREADED)
 #define LACKS_SYS_TYPES_H
 #define LACKS_STDIO_H
 #define LACKS_STRINGS_H
@@ -2955,6 +2965,8 @@ static void internal_malloc_stats(mstate m) {
     fprintf(stderr, "max system bytes = %10lu\n", (unsigned long)(maxfp));
     fprintf(stderr, "system bytes     = %10lu\n", (unsigned long)(fp));
     fprintf(stderr, "in use bytes     = %10lu\n", (unsigned long)(used));
+#else
+    (void)maxfp;
 #endif
 
     POSTACTION(m);
@@ -4858,7 +4870,7 @@ void mspace_malloc_stats(mspace msp) {
 }
 
 size_t mspace_footprint(mspace msp) {
-  size_t result;
+  size_t result = 0;
   mstate ms = (mstate)msp;
   if (ok_magic(ms)) {
     result = ms->footprint;
@@ -4869,7 +4881,7 @@ size_t mspace_footprint(mspace msp) {
 
 
 size_t mspace_max_footprint(mspace msp) {
-  size_t result;
+  size_t result = 0;
   mstate ms = (mstate)msp;
   if (ok_magic(ms)) {
     result = ms->max_footprint;
@@ -5168,4 +5180,548 @@ History:
  
 */
 
-#endif /* !HAVE_MALLOC */
+
+/* ------------------- Thread caching SDL_malloc ------------------------- */
+
+#ifdef SDL_MALLOC_THREADED
+
+/*
+  SDL_malloc() built on the mspaces above.  Blocks of up to
+  MALLOC_SMALL_MAX bytes are kept by size class in a cache for each
+  thread, which takes them from and gives them back to an arena a batch
+  at a time.  Bigger blocks come straight from an arena.  Every arena has
+  its own lock, threads start out on different arenas and move to
+  another one when theirs is busy.  Because of FOOTERS, a block knows
+  which arena it came from, so any thread can free it.
+
+  Thread caches need native thread local storage, without it every
+  allocation goes to an arena picked by thread ID.  SDL's own thread
+  local storage only tells us when a thread exits, it allocates memory
+  itself so it can't be used to find the cache.
+*/
+
+#define MALLOC_CLASSES		SDL_MALLOC_CLASSES
+#define MALLOC_CLASS_SHIFT	4
+#define MALLOC_SMALL_MAX	(MALLOC_CLASSES << MALLOC_CLASS_SHIFT)
+#define MALLOC_CLASS_SIZE(c)	((size_t)((c) + 1) << MALLOC_CLASS_SHIFT)
+#define MALLOC_ARENAS		8
+#define MALLOC_BATCH		8	/* Blocks moved to or from an arena at once */
+#define MALLOC_CACHE_MAX	64	/* Free blocks a cache keeps per class */
+
+#if defined(__GNUC__) && !defined(__APPLE__)
+#define MALLOC_THREAD_LOCAL	__thread
+#elif defined(_MSC_VER)
+#define MALLOC_THREAD_LOCAL	__declspec(thread)
+#endif
+
+typedef struct SDL_MallocArena {
+	SDL_SpinLock lock;
+	mspace space;
+	long blocks[MALLOC_CLASSES];	/* Small blocks handed out without a cache */
+	size_t large_bytes;
+	size_t taken;		/* Bytes taken from this arena, cached blocks included */
+	size_t peak;
+	Uint32 acquires;
+	Uint32 contended;
+} SDL_MallocArena;
+
+typedef struct SDL_MallocCache {
+	void *freelist[MALLOC_CLASSES];	/* Linked through their first word */
+	int count[MALLOC_CLASSES];
+	long blocks[MALLOC_CLASSES];	/* Allocated minus freed by this thread */
+	size_t cached;
+	SDL_MallocArena *arena;
+	struct SDL_MallocCache *next;
+} SDL_MallocCache;
+
+static SDL_MallocArena malloc_arenas[MALLOC_ARENAS];
+static int malloc_narenas;
+static SDL_atomic_t malloc_ready;
+static SDL_SpinLock malloc_init_lock;
+static SDL_TLSID malloc_tls;
+
+/* Protected by malloc_stats_lock, only changed when threads come and go */
+static SDL_SpinLock malloc_stats_lock;
+static SDL_MallocCache *malloc_caches;
+static long malloc_retired[MALLOC_CLASSES];	/* From threads that exited */
+
+#ifdef MALLOC_THREAD_LOCAL
+static SDL_atomic_t malloc_next_arena;
+static MALLOC_THREAD_LOCAL SDL_MallocCache *malloc_cache;
+static MALLOC_THREAD_LOCAL int malloc_nocache;	/* Creating or destroying it */
+#endif
+
+static int Malloc_Init(void)
+{
+	int i;
+
+	SDL_AtomicLock(&malloc_init_lock);
+	if ( !SDL_AtomicGet(&malloc_ready) ) {
+		for ( i = malloc_narenas; i < MALLOC_ARENAS; ++i ) {
+			malloc_arenas[i].space = create_mspace(0, 0);
+			if ( !malloc_arenas[i].space ) {
+				break;
+			}
+		}
+		malloc_narenas = i;
+		if ( !malloc_tls ) {
+			malloc_tls = SDL_TLSCreate();
+		}
+		if ( malloc_narenas > 0 ) {
+			SDL_AtomicSet(&malloc_ready, 1);
+		}
+	}
+	SDL_AtomicUnlock(&malloc_init_lock);
+	return(malloc_narenas > 0);
+}
+
+/* Called with the arena locked */
+static void Arena_Taken(SDL_MallocArena *arena, size_t bytes)
+{
+	arena->taken += bytes;
+	if ( arena->taken > arena->peak ) {
+		arena->peak = arena->taken;
+	}
+}
+
+/* The usable size of a block, and its size class or -1 if it's large */
+static size_t Block_Size(void *mem)
+{
+	mchunkptr p = mem2chunk(mem);
+	return chunksize(p) - overhead_for(p);
+}
+
+static int Block_Class(size_t size)
+{
+	size >>= MALLOC_CLASS_SHIFT;
+	if ( size < 1 || size > MALLOC_CLASSES + 1 ) {
+		return(-1);
+	}
+	/* The arena can hand out a little more than was asked for */
+	if ( size > MALLOC_CLASSES ) {
+		size = MALLOC_CLASSES;
+	}
+	return((int)size - 1);
+}
+
+/* What a block counts for in the statistics */
+static size_t Block_Bytes(size_t size, int c)
+{
+	return (c < 0) ? size : MALLOC_CLASS_SIZE(c);
+}
+
+static SDL_MallocArena *Arena_For(void *mem)
+{
+	mspace space = (mspace)get_mstate_for(mem2chunk(mem));
+	int i;
+
+	for ( i = 0; i < malloc_narenas; ++i ) {
+		if ( malloc_arenas[i].space == space ) {
+			return(&malloc_arenas[i]);
+		}
+	}
+	return(NULL);
+}
+
+/* The arena for threads without a cache */
+static SDL_MallocArena *Arena_Default(void)
+{
+	Uint32 hash = SDL_ThreadID() * 2654435761U;
+	return(&malloc_arenas[(hash >> 16) % malloc_narenas]);
+}
+
+static void Arena_Lock(SDL_MallocArena *arena)
+{
+	if ( !SDL_AtomicTryLock(&arena->lock) ) {
+		SDL_AtomicLock(&arena->lock);
+		++arena->contended;
+	}
+	++arena->acquires;
+}
+
+/* Lock the arena, or the next one that isn't busy if it is */
+static SDL_MallocArena *Arena_LockAny(SDL_MallocArena *arena)
+{
+	SDL_MallocArena *other;
+	int i, first = (int)(arena - malloc_arenas);
+
+	for ( i = 0; i < malloc_narenas; ++i ) {
+		other = &malloc_arenas[(first + i) % malloc_narenas];
+		if ( SDL_AtomicTryLock(&other->lock) ) {
+			++other->acquires;
+			return(other);
+		}
+	}
+	Arena_Lock(arena);
+	return(arena);
+}
+
+static void *Arena_Alloc(SDL_MallocArena *arena, size_t bytes)
+{
+	void *mem;
+	size_t size = 0;
+	int c = -1;
+
+	arena = Arena_LockAny(arena);
+	mem = mspace_malloc(arena->space, bytes);
+	if ( mem ) {
+		size = Block_Size(mem);
+		c = Block_Class(size);
+		if ( c < 0 ) {
+			arena->large_bytes += size;
+		} else {
+			++arena->blocks[c];
+		}
+		Arena_Taken(arena, Block_Bytes(size, c));
+	}
+	SDL_AtomicUnlock(&arena->lock);
+	return(mem);
+}
+
+static void Arena_Free(void *mem)
+{
+	SDL_MallocArena *arena = Arena_For(mem);
+	size_t size = Block_Size(mem);
+	int c = Block_Class(size);
+
+	if ( !arena ) {
+		return;
+	}
+	Arena_Lock(arena);
+	if ( c < 0 ) {
+		arena->large_bytes -= size;
+	} else {
+		--arena->blocks[c];
+	}
+	arena->taken -= Block_Bytes(size, c);
+	mspace_free(arena->space, mem);
+	SDL_AtomicUnlock(&arena->lock);
+}
+
+#ifdef MALLOC_THREAD_LOCAL
+
+static void *Cache_Pop(SDL_MallocCache *cache, int c)
+{
+	void *mem = cache->freelist[c];
+
+	cache->freelist[c] = *(void **)mem;
+	--cache->count[c];
+	cache->cached -= MALLOC_CLASS_SIZE(c);
+	++cache->blocks[c];
+	return(mem);
+}
+
+/* Take a batch of blocks of class 'c' from an arena and return one */
+static void *Cache_Refill(SDL_MallocCache *cache, int c)
+{
+	SDL_MallocArena *arena;
+	size_t taken = 0;
+	void *mem;
+	int i, k;
+
+	arena = Arena_LockAny(cache->arena);
+	for ( i = 0; i < MALLOC_BATCH; ++i ) {
+		mem = mspace_malloc(arena->space, MALLOC_CLASS_SIZE(c));
+		if ( !mem ) {
+			break;
+		}
+		k = Block_Class(Block_Size(mem));
+		*(void **)mem = cache->freelist[k];
+		cache->freelist[k] = mem;
+		++cache->count[k];
+		cache->cached += MALLOC_CLASS_SIZE(k);
+		taken += MALLOC_CLASS_SIZE(k);
+	}
+	Arena_Taken(arena, taken);
+	SDL_AtomicUnlock(&arena->lock);
+
+	/* Stay on whichever arena wasn't busy */
+	cache->arena = arena;
+	for ( k = c; k < MALLOC_CLASSES; ++k ) {
+		if ( cache->freelist[k] ) {
+			return(Cache_Pop(cache, k));
+		}
+	}
+	return(NULL);
+}
+
+/* Give 'n' free blocks of class 'c' back to the arenas they came from */
+static void Cache_Flush(SDL_MallocCache *cache, int c, int n)
+{
+	SDL_MallocArena *arena, *locked = NULL;
+	void *mem;
+	int i;
+
+	for ( i = 0; i < n; ++i ) {
+		mem = cache->freelist[c];
+		cache->freelist[c] = *(void **)mem;
+		arena = Arena_For(mem);
+		if ( !arena ) {
+			continue;
+		}
+		if ( arena != locked ) {
+			if ( locked ) {
+				SDL_AtomicUnlock(&locked->lock);
+			}
+			Arena_Lock(arena);
+			locked = arena;
+		}
+		arena->taken -= MALLOC_CLASS_SIZE(c);
+		mspace_free(arena->space, mem);
+	}
+	if ( locked ) {
+		SDL_AtomicUnlock(&locked->lock);
+	}
+	cache->count[c] -= n;
+	cache->cached -= n * MALLOC_CLASS_SIZE(c);
+}
+
+static void SDLCALL Cache_Destroy(void *data)
+{
+	SDL_MallocCache *cache = (SDL_MallocCache *)data;
+	SDL_MallocCache **prev;
+	int c;
+
+	/* The thread is exiting, whatever it frees now goes to the arenas */
+	malloc_cache = NULL;
+	malloc_nocache = 1;
+
+	for ( c = 0; c < MALLOC_CLASSES; ++c ) {
+		if ( cache->count[c] ) {
+			Cache_Flush(cache, c, cache->count[c]);
+		}
+	}
+	SDL_AtomicLock(&malloc_stats_lock);
+	for ( prev = &malloc_caches; *prev != cache; prev = &(*prev)->next ) {
+		/* Keep looking */ ;
+	}
+	*prev = cache->next;
+	for ( c = 0; c < MALLOC_CLASSES; ++c ) {
+		malloc_retired[c] += cache->blocks[c];
+	}
+	SDL_AtomicUnlock(&malloc_stats_lock);
+
+	Arena_Free(cache);
+}
+
+static SDL_MallocCache *Cache_Create(void)
+{
+	SDL_MallocCache *cache;
+	Uint32 n;
+
+	if ( !SDL_AtomicGet(&malloc_ready) && !Malloc_Init() ) {
+		return(NULL);
+	}
+
+	/* Setting the thread local storage allocates memory too */
+	malloc_nocache = 1;
+	cache = (SDL_MallocCache *)Arena_Alloc(Arena_Default(), sizeof(*cache));
+	if ( !cache ) {
+		malloc_nocache = 0;
+		return(NULL);
+	}
+	memset(cache, 0, sizeof(*cache));
+	n = (Uint32)SDL_AtomicAdd(&malloc_next_arena, 1);
+	cache->arena = &malloc_arenas[n % malloc_narenas];
+	if ( SDL_TLSSet(malloc_tls, cache, Cache_Destroy) < 0 ) {
+		/* Don't try again for every allocation */
+		Arena_Free(cache);
+		return(NULL);
+	}
+
+	SDL_AtomicLock(&malloc_stats_lock);
+	cache->next = malloc_caches;
+	malloc_caches = cache;
+	SDL_AtomicUnlock(&malloc_stats_lock);
+
+	malloc_cache = cache;
+	malloc_nocache = 0;
+	return(cache);
+}
+
+static SDL_MallocCache *Cache_Get(void)
+{
+	if ( malloc_cache ) {
+		return(malloc_cache);
+	}
+	if ( malloc_nocache ) {
+		return(NULL);
+	}
+	return(Cache_Create());
+}
+
+#else
+
+#define Cache_Get()	((SDL_MallocCache *)NULL)
+#define Cache_Pop(cache, c)	NULL
+#define Cache_Refill(cache, c)	NULL
+#define Cache_Flush(cache, c, n)
+
+#endif /* MALLOC_THREAD_LOCAL */
+
+void *SDL_malloc(size_t size)
+{
+	SDL_MallocCache *cache;
+	int c;
+
+	if ( size <= MALLOC_SMALL_MAX ) {
+		c = (size == 0) ? 0 : (int)((size - 1) >> MALLOC_CLASS_SHIFT);
+		cache = Cache_Get();
+		if ( cache ) {
+			if ( cache->freelist[c] ) {
+				return(Cache_Pop(cache, c));
+			}
+			return(Cache_Refill(cache, c));
+		}
+		size = MALLOC_CLASS_SIZE(c);
+	}
+	if ( !SDL_AtomicGet(&malloc_ready) && !Malloc_Init() ) {
+		return(NULL);
+	}
+	return(Arena_Alloc(Arena_Default(), size));
+}
+
+void *SDL_calloc(size_t nmemb, size_t size)
+{
+	void *mem;
+
+	if ( size && nmemb > MAX_SIZE_T / size ) {
+		return(NULL);
+	}
+	size *= nmemb;
+	mem = SDL_malloc(size);
+	if ( mem && calloc_must_clear(mem2chunk(mem)) ) {
+		memset(mem, 0, size);
+	}
+	return(mem);
+}
+
+void *SDL_realloc(void *mem, size_t size)
+{
+	SDL_MallocArena *arena;
+	void *newmem;
+	size_t oldsize, newsize = 0;
+	int c, newc = -1;
+
+	if ( !mem ) {
+		return(SDL_malloc(size));
+	}
+	oldsize = Block_Size(mem);
+	c = Block_Class(oldsize);
+
+	if ( c < 0 && size > MALLOC_SMALL_MAX && (arena = Arena_For(mem)) ) {
+		/* The arena can often grow or shrink it in place */
+		Arena_Lock(arena);
+		newmem = mspace_realloc(arena->space, mem, size);
+		if ( newmem ) {
+			newsize = Block_Size(newmem);
+			newc = Block_Class(newsize);
+			arena->large_bytes -= oldsize;
+			arena->taken -= oldsize;
+			if ( newc < 0 ) {
+				arena->large_bytes += newsize;
+			} else {
+				++arena->blocks[newc];
+			}
+			Arena_Taken(arena, Block_Bytes(newsize, newc));
+		}
+		SDL_AtomicUnlock(&arena->lock);
+		return(newmem);
+	}
+
+	/* Keep the block if it's big enough and not much too big */
+	if ( size <= oldsize && (c >= 0 || size > oldsize / 2) ) {
+		return(mem);
+	}
+	newmem = SDL_malloc(size);
+	if ( newmem ) {
+		memcpy(newmem, mem, SDL_min(size, oldsize));
+		SDL_free(mem);
+	}
+	return(newmem);
+}
+
+void SDL_free(void *mem)
+{
+	SDL_MallocCache *cache;
+	int c;
+
+	if ( !mem ) {
+		return;
+	}
+	c = Block_Class(Block_Size(mem));
+	if ( c >= 0 && (cache = Cache_Get()) != NULL ) {
+		--cache->blocks[c];
+		*(void **)mem = cache->freelist[c];
+		cache->freelist[c] = mem;
+		++cache->count[c];
+		cache->cached += MALLOC_CLASS_SIZE(c);
+		if ( cache->count[c] > MALLOC_CACHE_MAX ) {
+			Cache_Flush(cache, c, MALLOC_CACHE_MAX / 2);
+		}
+		return;
+	}
+	Arena_Free(mem);
+}
+
+int SDL_GetMallocStats(SDL_MallocStats *stats)
+{
+	SDL_MallocArena *arena;
+	SDL_MallocCache *cache;
+	long blocks[MALLOC_CLASSES];
+	int i, c;
+
+	if ( !SDL_AtomicGet(&malloc_ready) && !Malloc_Init() ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	memset(stats, 0, sizeof(*stats));
+	memset(blocks, 0, sizeof(blocks));
+
+	for ( i = 0; i < malloc_narenas; ++i ) {
+		arena = &malloc_arenas[i];
+		for ( c = 0; c < MALLOC_CLASSES; ++c ) {
+			blocks[c] += arena->blocks[c];
+		}
+		stats->large_bytes += arena->large_bytes;
+		stats->peak += arena->peak;
+		stats->lock_acquires += arena->acquires;
+		stats->lock_contended += arena->contended;
+	}
+	stats->arenas = malloc_narenas;
+
+	SDL_AtomicLock(&malloc_stats_lock);
+	for ( cache = malloc_caches; cache; cache = cache->next ) {
+		for ( c = 0; c < MALLOC_CLASSES; ++c ) {
+			blocks[c] += cache->blocks[c];
+		}
+		stats->cached_bytes += cache->cached;
+		++stats->threads;
+	}
+	for ( c = 0; c < MALLOC_CLASSES; ++c ) {
+		blocks[c] += malloc_retired[c];
+	}
+	SDL_AtomicUnlock(&malloc_stats_lock);
+
+	for ( c = 0; c < MALLOC_CLASSES; ++c ) {
+		stats->class_size[c] = MALLOC_CLASS_SIZE(c);
+		if ( blocks[c] > 0 ) {
+			stats->class_bytes[c] = blocks[c] * MALLOC_CLASS_SIZE(c);
+		}
+		stats->in_use += stats->class_bytes[c];
+	}
+	stats->in_use += stats->large_bytes;
+	return(0);
+}
+
+#endif /* SDL_MALLOC_THREADED */
+
+#endif /* !HAVE_MALLOC || SDL_MALLOC_THREADED */
+
+#ifndef SDL_MALLOC_THREADED
+int SDL_GetMallocStats(SDL_MallocStats *stats)
+{
+	SDL_SetError("SDL_malloc() only keeps statistics when configured with --enable-threaded-malloc");
+	return(-1);
+}
+#endif
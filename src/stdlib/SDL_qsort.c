@@ -19,516 +19,563 @@
   3. This notice may not be removed or altered from any source distribution.
 */
 
+
 #include "SDL_config.h"
 
-#ifndef HAVE_QSORT
-#include "SDL_stdinc.h"
+/* This file contains the sorting functions for SDL */
 
-#ifdef assert
-#undef assert
-#endif
-#define assert(X)
-#ifdef malloc
-#undef malloc
-#endif
-#define malloc SDL_malloc
-#ifdef free
-#undef free
-#endif
-#define free SDL_free
-#ifdef memcpy
-#undef memcpy
-#endif
-#define memcpy SDL_memcpy
-#ifdef memmove
-#undef memmove
-#endif
-#define memmove SDL_memmove
-#ifdef qsortG
-#undef qsortG
-#endif
-#define qsortG SDL_qsort
+#include "SDL_stdinc.h"
+#include "SDL_thread.h"
 
 /*
-This code came from Gareth McCaughan, under the zlib license.
-Specifically this: https://www.mccaughan.org.uk/software/qsort.c-1.16
+  SDL_qsort() is an introsort: a quicksort that switches to heapsort when
+  it recurses too deep, so it's O(n log n) whatever the input, and that
+  leaves short ranges to an insertion sort.  The pivot is the median of
+  three elements, or of three medians of three for longer ranges.  The
+  partitioning stops on elements equal to the pivot, which keeps arrays
+  with lots of duplicates balanced.
+
+  The integer sorts are LSD radix sorts, one pass per byte of the key,
+  skipping bytes that are the same in every key.
+
+  SDL_qsort_parallel() sorts a run of the array on each thread of the
+  pool, then merges pairs of runs until one is left.  Every merge is cut
+  into pieces by binary searching for where each piece of the output
+  starts, so all the threads keep working until the last merge.
+*/
 
-Everything below this comment until the HAVE_QSORT #endif was from Gareth
-(any minor changes will be noted inline).
+#define SORT_INSERTION		16	/* Shorter ranges are insertion sorted */
+#define SORT_NINTHER		40	/* Longer ranges use the median of nine */
+#define RADIX_MIN		64	/* Shorter arrays are insertion sorted */
+#define PARALLEL_MIN_RUN	8192	/* Fewest elements a thread sorts */
+#define PARALLEL_MAX_RUNS	64
+
+/* How elements get moved, picked from their size and alignment */
+enum {
+	SORT_BYTES,
+	SORT_INTS,
+	SORT_INT,
+	SORT_LONGS,
+	SORT_LONG
+};
+
+typedef struct {
+	size_t size;
+	int type;
+	int (*compare)(const void *, const void *);
+} SDL_SortInfo;
+
+static void Sort_Init(SDL_SortInfo *info, const void *base, size_t size,
+                      int (*compare)(const void *, const void *))
+{
+	info->size = size;
+	info->compare = compare;
+	if ( (((uintptr_t)base | size) & (sizeof(long) - 1)) == 0 ) {
+		info->type = (size == sizeof(long)) ? SORT_LONG : SORT_LONGS;
+	} else if ( (((uintptr_t)base | size) & (sizeof(int) - 1)) == 0 ) {
+		info->type = (size == sizeof(int)) ? SORT_INT : SORT_INTS;
+	} else {
+		info->type = SORT_BYTES;
+	}
+}
 
-Thank you to Gareth for relicensing this code under the zlib license for our
-benefit!
+static void Sort_Swap(const SDL_SortInfo *info, char *a, char *b)
+{
+	size_t n;
+
+	switch (info->type) {
+	    case SORT_LONG: {
+		long t = *(long *)a;
+		*(long *)a = *(long *)b;
+		*(long *)b = t;
+	    }
+		break;
+	    case SORT_INT: {
+		int t = *(int *)a;
+		*(int *)a = *(int *)b;
+		*(int *)b = t;
+	    }
+		break;
+	    case SORT_LONGS:
+		for ( n = info->size / sizeof(long); n--; ) {
+			long t = ((long *)a)[n];
+			((long *)a)[n] = ((long *)b)[n];
+			((long *)b)[n] = t;
+		}
+		break;
+	    case SORT_INTS:
+		for ( n = info->size / sizeof(int); n--; ) {
+			int t = ((int *)a)[n];
+			((int *)a)[n] = ((int *)b)[n];
+			((int *)b)[n] = t;
+		}
+		break;
+	    default:
+		for ( n = info->size; n--; ) {
+			char t = a[n];
+			a[n] = b[n];
+			b[n] = t;
+		}
+		break;
+	}
+}
 
---ryan.
-*/
+static void Sort_Copy(const SDL_SortInfo *info, char *dst, const char *src)
+{
+	switch (info->type) {
+	    case SORT_LONG:
+		*(long *)dst = *(const long *)src;
+		break;
+	    case SORT_INT:
+		*(int *)dst = *(const int *)src;
+		break;
+	    default:
+		SDL_memcpy(dst, src, info->size);
+		break;
+	}
+}
 
-/* This is a drop-in replacement for the C library's |qsort()| routine.
- *
- * It is intended for use where you know or suspect that your
- * platform's qsort is bad. If that isn't the case, then you
- * should probably use the qsort your system gives you in preference
- * to mine -- it will likely have been tested and tuned better.
- *
- * Features:
- *   - Median-of-three pivoting (and more)
- *   - Truncation and final polishing by a single insertion sort
- *   - Early truncation when no swaps needed in pivoting step
- *   - Explicit recursion, guaranteed not to overflow
- *   - A few little wrinkles stolen from the GNU |qsort()|.
- *     (For the avoidance of doubt, no code was stolen, only
- *     broad ideas.)
- *   - separate code for non-aligned / aligned / word-size objects
- *
- * Earlier releases of this code used an idiosyncratic licence
- * I wrote myself, because I'm an idiot. The code is now released
- * under the "zlib/libpng licence"; you will find the actual
- * terms in the next comment. I request (but do not require)
- * that if you make any changes beyond the name of the exported
- * routine and reasonable tweaks to the TRUNC_* and
- * PIVOT_THRESHOLD values, you modify the _ID string so as
- * to make it clear that you have changed the code.
- *
- * If you find problems with this code, or find ways of
- * making it significantly faster, please let me know!
- * My e-mail address, valid as of early 2016 and for the
- * foreseeable future, is
- *    gareth.mccaughan@pobox.com
- * Thanks!
- *
- * Gareth McCaughan
- */
-
-/* Copyright (c) 1998-2021 Gareth McCaughan
- *
- * This software is provided 'as-is', without any express or implied
- * warranty. In no event will the authors be held liable for any
- * damages arising from the use of this software.
- *
- * Permission is granted to anyone to use this software for any purpose,
- * including commercial applications, and to alter it and redistribute it
- * freely, subject to the following restrictions:
- *
- * 1. The origin of this software must not be misrepresented;
- *    you must not claim that you wrote the original software.
- *    If you use this software in a product, an acknowledgment
- *    in the product documentation would be appreciated but
- *    is not required.
- *
- * 2. Altered source versions must be plainly marked as such,
- *    and must not be misrepresented as being the original software.
- *
- * 3. This notice may not be removed or altered from any source
- *    distribution.
- */
-
-/* Revision history since release:
- *   1998-03-19 v1.12 First release I have any records of.
- *   2007-09-02 v1.13 Fix bug kindly reported by Dan Bodoh
- *                    (premature termination of recursion).
- *                    Add a few clarifying comments.
- *                    Minor improvements to debug output.
- *   2016-02-21 v1.14 Replace licence with 2-clause BSD,
- *                    and clarify a couple of things in
- *                    comments. No code changes.
- *   2016-03-10 v1.15 Fix bug kindly reported by Ryan Gordon
- *                    (pre-insertion-sort messed up).
- *                    Disable DEBUG_QSORT by default.
- *                    Tweak comments very slightly.
- *   2021-02-20 v1.16 Fix bug kindly reported by Ray Gardner
- *                    (error in recursion leading to possible
- *                    stack overflow).
- *                    When checking alignment, avoid casting
- *                    pointer to possibly-smaller integer.
- */
-
-/* BEGIN SDL CHANGE ... commented this out with an #if 0 block. --ryan. */
-#if 0
-#include <assert.h>
-#include <stdint.h>
-#include <stdlib.h>
-#include <string.h>
-
-#undef DEBUG_QSORT
-
-static char _ID[]="<qsort.c gjm 1.16 2021-02-20>";
-#endif
-/* END SDL CHANGE ... commented this out with an #if 0 block. --ryan. */
-
-/* How many bytes are there per word? (Must be a power of 2,
- * and must in fact equal sizeof(int).)
- */
-#define WORD_BYTES sizeof(int)
-
-/* How big does our stack need to be? Answer: one entry per
- * bit in a |size_t|. (Actually, a bit less because we don't
- * recurse all the way down to size-1 subarrays.)
- */
-#define STACK_SIZE (8*sizeof(size_t))
-
-/* Different situations have slightly different requirements,
- * and we make life epsilon easier by using different truncation
- * points for the three different cases.
- * So far, I have tuned TRUNC_words and guessed that the same
- * value might work well for the other two cases. Of course
- * what works well on my machine might work badly on yours.
- */
-#define TRUNC_nonaligned	12
-#define TRUNC_aligned		12
-#define TRUNC_words		12*WORD_BYTES	/* nb different meaning */
-
-/* We use a simple pivoting algorithm for shortish sub-arrays
- * and a more complicated one for larger ones. The threshold
- * is PIVOT_THRESHOLD.
- */
-#define PIVOT_THRESHOLD 40
-
-typedef struct { char * first; char * last; } stack_entry;
-#define pushLeft {stack[stacktop].first=ffirst;stack[stacktop++].last=last;}
-#define pushRight {stack[stacktop].first=first;stack[stacktop++].last=llast;}
-#define doLeft {first=ffirst;llast=last;continue;}
-#define doRight {ffirst=first;last=llast;continue;}
-#define pop {if (--stacktop<0) break;\
-  first=ffirst=stack[stacktop].first;\
-  last=llast=stack[stacktop].last;\
-  continue;}
-
-/* Some comments on the implementation.
- * 1. When we finish partitioning the array into "low"
- *    and "high", we forget entirely about short subarrays,
- *    because they'll be done later by insertion sort.
- *    Doing lots of little insertion sorts might be a win
- *    on large datasets for locality-of-reference reasons,
- *    but it makes the code much nastier and increases
- *    bookkeeping overhead.
- * 2. We always save the longer and get to work on the
- *    shorter. This guarantees that whenever we push
- *    a k'th entry onto the stack we are about to get
- *    working on something of size <= N/2^k where N is
- *    the original array size; so the stack can't need
- *    more than log_2(max-array-size) entries.
- * 3. We choose a pivot by looking at the first, last
- *    and middle elements. We arrange them into order
- *    because it's easy to do that in conjunction with
- *    choosing the pivot, and it makes things a little
- *    easier in the partitioning step. Anyway, the pivot
- *    is the middle of these three. It's still possible
- *    to construct datasets where the algorithm takes
- *    time of order n^2, but it simply never happens in
- *    practice.
- * 3' Newsflash: On further investigation I find that
- *    it's easy to construct datasets where median-of-3
- *    simply isn't good enough. So on large-ish subarrays
- *    we do a more sophisticated pivoting: we take three
- *    sets of 3 elements, find their medians, and then
- *    take the median of those.
- * 4. We copy the pivot element to a separate place
- *    because that way we can always do our comparisons
- *    directly against a pointer to that separate place,
- *    and don't have to wonder "did we move the pivot
- *    element?". This makes the inner loop better.
- * 5. It's possible to make the pivoting even more
- *    reliable by looking at more candidates when n
- *    is larger. (Taking this to its logical conclusion
- *    results in a variant of quicksort that doesn't
- *    have that n^2 worst case.) However, the overhead
- *    from the extra bookkeeping means that it's just
- *    not worth while.
- * 6. This is pretty clean and portable code. Here are
- *    all the potential portability pitfalls and problems
- *    I know of:
- *      - In one place (the insertion sort) I construct
- *        a pointer that points just past the end of the
- *        supplied array, and assume that (a) it won't
- *        compare equal to any pointer within the array,
- *        and (b) it will compare equal to a pointer
- *        obtained by stepping off the end of the array.
- *        These might fail on some segmented architectures.
- *      - I assume that there are 8 bits in a |char| when
- *        computing the size of stack needed. This would
- *        fail on machines with 9-bit or 16-bit bytes.
- *      - I assume that if |((int)base&(sizeof(int)-1))==0|
- *        and |(size&(sizeof(int)-1))==0| then it's safe to
- *        get at array elements via |int*|s, and that if
- *        actually |size==sizeof(int)| as well then it's
- *        safe to treat the elements as |int|s. This might
- *        fail on systems that convert pointers to integers
- *        in non-standard ways.
- *      - I assume that |8*sizeof(size_t)<=INT_MAX|. This
- *        would be false on a machine with 8-bit |char|s,
- *        16-bit |int|s and 4096-bit |size_t|s. :-)
- */
-
-/* The recursion logic is the same in each case.
- * We keep chopping up until we reach subarrays of size
- * strictly less than Trunc; we leave these unsorted. */
-#define Recurse(Trunc)				\
-      { size_t l=last-ffirst,r=llast-first;	\
-        if (l<Trunc) {				\
-          if (r>=Trunc) doRight			\
-          else pop				\
-        }					\
-        else if (l<=r) { pushRight; doLeft }	\
-        else if (r>=Trunc) { pushLeft; doRight }\
-        else doLeft				\
-      }
-
-/* and so is the pivoting logic (note: last is inclusive): */
-#define Pivot(swapper,sz)			\
-  if (last-first>PIVOT_THRESHOLD*sz) mid=pivot_big(first,mid,last,sz,compare);\
-  else {	\
-    if (compare(first,mid)<0) {			\
-      if (compare(mid,last)>0) {		\
-        swapper(mid,last);			\
-        if (compare(first,mid)>0) swapper(first,mid);\
-      }						\
-    }						\
-    else {					\
-      if (compare(mid,last)>0) swapper(first,last)\
-      else {					\
-        swapper(first,mid);			\
-        if (compare(mid,last)>0) swapper(mid,last);\
-      }						\
-    }						\
-    first+=sz; last-=sz;			\
-  }
-
-#ifdef DEBUG_QSORT
-#include <stdio.h>
-#endif
-
-/* and so is the partitioning logic: */
-#define Partition(swapper,sz) {			\
-  do {						\
-    while (compare(first,pivot)<0) first+=sz;	\
-    while (compare(pivot,last)<0) last-=sz;	\
-    if (first<last) {				\
-      swapper(first,last);			\
-      first+=sz; last-=sz; }			\
-    else if (first==last) { first+=sz; last-=sz; break; }\
-  } while (first<=last);			\
+static void Sort_Insertion(const SDL_SortInfo *info, char *base, size_t nmemb)
+{
+	size_t size = info->size;
+	char *end = base + nmemb * size;
+	char *p, *q;
+
+	for ( p = base + size; p < end; p += size ) {
+		for ( q = p; q > base && info->compare(q - size, q) > 0; q -= size ) {
+			Sort_Swap(info, q - size, q);
+		}
+	}
 }
 
-/* and so is the pre-insertion-sort operation of putting
- * the smallest element into place as a sentinel.
- * Doing this makes the inner loop nicer. I got this
- * idea from the GNU implementation of qsort().
- * We find the smallest element from the first |nmemb|,
- * or the first |limit|, whichever is smaller;
- * therefore we must have ensured that the globally smallest
- * element is in the first |limit| (because our
- * quicksort recursion bottoms out only once we
- * reach subarrays smaller than |limit|).
- */
-#define PreInsertion(swapper,limit,sz)		\
-  first=base;					\
-  last=first + ((nmemb>limit ? limit : nmemb)-1)*sz;\
-  while (last!=base) {				\
-    if (compare(first,last)>0) first=last;	\
-    last-=sz; }					\
-  if (first!=base) swapper(first,(char*)base);
-
-/* and so is the insertion sort, in the first two cases: */
-#define Insertion(swapper)			\
-  last=((char*)base)+nmemb*size;		\
-  for (first=((char*)base)+size;first!=last;first+=size) {	\
-    char *test;					\
-    /* Find the right place for |first|.	\
-     * My apologies for var reuse. */		\
-    for (test=first-size;compare(test,first)>0;test-=size) ;	\
-    test+=size;					\
-    if (test!=first) {				\
-      /* Shift everything in [test,first)	\
-       * up by one, and place |first|		\
-       * where |test| is. */			\
-      memcpy(pivot,first,size);			\
-      memmove(test+size,test,first-test);	\
-      memcpy(test,pivot,size);			\
-    }						\
-  }
-
-#define SWAP_nonaligned(a,b) { \
-  register char *aa=(a),*bb=(b); \
-  register size_t sz=size; \
-  do { register char t=*aa; *aa++=*bb; *bb++=t; } while (--sz); }
-
-#define SWAP_aligned(a,b) { \
-  register int *aa=(int*)(a),*bb=(int*)(b); \
-  register size_t sz=size; \
-  do { register int t=*aa;*aa++=*bb; *bb++=t; } while (sz-=WORD_BYTES); }
-
-#define SWAP_words(a,b) { \
-  register int t=*((int*)a); *((int*)a)=*((int*)b); *((int*)b)=t; }
-
-/* ---------------------------------------------------------------------- */
-
-static char * pivot_big(char *first, char *mid, char *last, size_t size,
-                        int compare(const void *, const void *)) {
-  int d=(((last-first)/size)>>3)*size;
-#ifdef DEBUG_QSORT
-fprintf(stderr, "pivot_big: first=%p last=%p size=%lu n=%lu\n", first, (unsigned long)last, size, (unsigned long)((last-first+1)/size));
-#endif
-  char *m1,*m2,*m3;
-  { char *a=first, *b=first+d, *c=first+2*d;
-#ifdef DEBUG_QSORT
-fprintf(stderr,"< %d %d %d @ %p %p %p\n",*(int*)a,*(int*)b,*(int*)c, a,b,c);
-#endif
-    m1 = compare(a,b)<0 ?
-           (compare(b,c)<0 ? b : (compare(a,c)<0 ? c : a))
-         : (compare(a,c)<0 ? a : (compare(b,c)<0 ? c : b));
-  }
-  { char *a=mid-d, *b=mid, *c=mid+d;
-#ifdef DEBUG_QSORT
-fprintf(stderr,". %d %d %d @ %p %p %p\n",*(int*)a,*(int*)b,*(int*)c, a,b,c);
-#endif
-    m2 = compare(a,b)<0 ?
-           (compare(b,c)<0 ? b : (compare(a,c)<0 ? c : a))
-         : (compare(a,c)<0 ? a : (compare(b,c)<0 ? c : b));
-  }
-  { char *a=last-2*d, *b=last-d, *c=last;
-#ifdef DEBUG_QSORT
-fprintf(stderr,"> %d %d %d @ %p %p %p\n",*(int*)a,*(int*)b,*(int*)c, a,b,c);
-#endif
-    m3 = compare(a,b)<0 ?
-           (compare(b,c)<0 ? b : (compare(a,c)<0 ? c : a))
-         : (compare(a,c)<0 ? a : (compare(b,c)<0 ? c : b));
-  }
-#ifdef DEBUG_QSORT
-fprintf(stderr,"-> %d %d %d @ %p %p %p\n",*(int*)m1,*(int*)m2,*(int*)m3, m1,m2,m3);
-#endif
-  return compare(m1,m2)<0 ?
-           (compare(m2,m3)<0 ? m2 : (compare(m1,m3)<0 ? m3 : m1))
-         : (compare(m1,m3)<0 ? m1 : (compare(m2,m3)<0 ? m3 : m2));
+static void Sort_SiftDown(const SDL_SortInfo *info, char *base, size_t root, size_t nmemb)
+{
+	size_t size = info->size;
+	size_t child;
+
+	while ( (child = 2 * root + 1) < nmemb ) {
+		if ( child + 1 < nmemb &&
+		     info->compare(base + child * size, base + (child + 1) * size) < 0 ) {
+			++child;
+		}
+		if ( info->compare(base + root * size, base + child * size) >= 0 ) {
+			break;
+		}
+		Sort_Swap(info, base + root * size, base + child * size);
+		root = child;
+	}
 }
 
-/* ---------------------------------------------------------------------- */
-
-static void qsort_nonaligned(void *base, size_t nmemb, size_t size,
-           int (*compare)(const void *, const void *)) {
-
-  stack_entry stack[STACK_SIZE];
-  int stacktop=0;
-  char *first,*last;
-  char *pivot=malloc(size);
-  size_t trunc=TRUNC_nonaligned*size;
-  assert(pivot!=0);
-
-  first=(char*)base; last=first+(nmemb-1)*size;
-
-  if (last-first>=trunc) {
-    char *ffirst=first, *llast=last;
-    while (1) {
-      /* Select pivot */
-      { char * mid=first+size*((last-first)/size >> 1);
-        Pivot(SWAP_nonaligned,size);
-        memcpy(pivot,mid,size);
-      }
-      /* Partition. */
-      Partition(SWAP_nonaligned,size);
-      /* Prepare to recurse/iterate. */
-      Recurse(trunc)
-    }
-  }
-  PreInsertion(SWAP_nonaligned,TRUNC_nonaligned,size);
-  Insertion(SWAP_nonaligned);
-  free(pivot);
+static void Sort_Heap(const SDL_SortInfo *info, char *base, size_t nmemb)
+{
+	size_t i;
+
+	for ( i = nmemb / 2; i > 0; --i ) {
+		Sort_SiftDown(info, base, i - 1, nmemb);
+	}
+	for ( i = nmemb - 1; i > 0; --i ) {
+		Sort_Swap(info, base, base + i * info->size);
+		Sort_SiftDown(info, base, 0, i);
+	}
 }
 
-static void qsort_aligned(void *base, size_t nmemb, size_t size,
-           int (*compare)(const void *, const void *)) {
-
-  stack_entry stack[STACK_SIZE];
-  int stacktop=0;
-  char *first,*last;
-  char *pivot=malloc(size);
-  size_t trunc=TRUNC_aligned*size;
-  assert(pivot!=0);
-
-  first=(char*)base; last=first+(nmemb-1)*size;
-
-  if (last-first>=trunc) {
-    char *ffirst=first,*llast=last;
-    while (1) {
-      /* Select pivot */
-      { char * mid=first+size*((last-first)/size >> 1);
-        Pivot(SWAP_aligned,size);
-        memcpy(pivot,mid,size);
-      }
-      /* Partition. */
-      Partition(SWAP_aligned,size);
-      /* Prepare to recurse/iterate. */
-      Recurse(trunc)
-    }
-  }
-  PreInsertion(SWAP_aligned,TRUNC_aligned,size);
-  Insertion(SWAP_aligned);
-  free(pivot);
+static char *Sort_Median3(const SDL_SortInfo *info, char *a, char *b, char *c)
+{
+	if ( info->compare(a, b) < 0 ) {
+		if ( info->compare(b, c) < 0 ) {
+			return(b);
+		}
+		return (info->compare(a, c) < 0) ? c : a;
+	} else {
+		if ( info->compare(b, c) > 0 ) {
+			return(b);
+		}
+		return (info->compare(a, c) < 0) ? a : c;
+	}
 }
 
-static void qsort_words(void *base, size_t nmemb,
-           int (*compare)(const void *, const void *)) {
-
-  stack_entry stack[STACK_SIZE];
-  int stacktop=0;
-  char *first,*last;
-  char *pivot=malloc(WORD_BYTES);
-  assert(pivot!=0);
-
-  first=(char*)base; last=first+(nmemb-1)*WORD_BYTES;
-
-  if (last-first>=TRUNC_words) {
-    char *ffirst=first, *llast=last;
-    while (1) {
-#ifdef DEBUG_QSORT
-fprintf(stderr,"Doing %d:%d: ",
-        (first-(char*)base)/WORD_BYTES,
-        (last-(char*)base)/WORD_BYTES);
-#endif
-      /* Select pivot */
-      { char * mid=first+WORD_BYTES*((last-first) / (2*WORD_BYTES));
-        Pivot(SWAP_words,WORD_BYTES);
-        *(int*)pivot=*(int*)mid;
-#ifdef DEBUG_QSORT
-fprintf(stderr,"pivot = %p = #%lu = %d\n", mid, (unsigned long)(((int*)mid)-((int*)base)), *(int*)mid);
-#endif
-      }
-      /* Partition. */
-      Partition(SWAP_words,WORD_BYTES);
-#ifdef DEBUG_QSORT
-fprintf(stderr, "after partitioning first=#%lu last=#%lu\n", (first-(char*)base)/4lu, (last-(char*)base)/4lu);
-#endif
-      /* Prepare to recurse/iterate. */
-      Recurse(TRUNC_words)
-    }
-  }
-  PreInsertion(SWAP_words,TRUNC_words/WORD_BYTES,WORD_BYTES);
-  /* Now do insertion sort. */
-  last=((char*)base)+nmemb*WORD_BYTES;
-  for (first=((char*)base)+WORD_BYTES;first!=last;first+=WORD_BYTES) {
-    /* Find the right place for |first|. My apologies for var reuse */
-    int *pl=(int*)(first-WORD_BYTES),*pr=(int*)first;
-    *(int*)pivot=*(int*)first;
-    for (;compare(pl,pivot)>0;pr=pl,--pl) {
-      *pr=*pl; }
-    if (pr!=(int*)first) *pr=*(int*)pivot;
-  }
-  free(pivot);
+static void Sort_Intro(const SDL_SortInfo *info, char *base, size_t nmemb, int depth)
+{
+	size_t size = info->size;
+	size_t step, left, right;
+	char *lo, *hi, *mid;
+
+	while ( nmemb > SORT_INSERTION ) {
+		if ( depth-- == 0 ) {
+			Sort_Heap(info, base, nmemb);
+			return;
+		}
+
+		/* Move the pivot to the front */
+		mid = base + (nmemb / 2) * size;
+		hi = base + (nmemb - 1) * size;
+		if ( nmemb > SORT_NINTHER ) {
+			step = (nmemb / 8) * size;
+			mid = Sort_Median3(info,
+				Sort_Median3(info, base, base + step, base + 2 * step),
+				Sort_Median3(info, mid - step, mid, mid + step),
+				Sort_Median3(info, hi - 2 * step, hi - step, hi));
+		} else {
+			mid = Sort_Median3(info, base, mid, hi);
+		}
+		Sort_Swap(info, base, mid);
+
+		/* Partition the rest, then put the pivot between the halves */
+		lo = base + size;
+		for ( ;; ) {
+			while ( lo <= hi && info->compare(lo, base) < 0 ) {
+				lo += size;
+			}
+			while ( lo <= hi && info->compare(hi, base) > 0 ) {
+				hi -= size;
+			}
+			if ( lo >= hi ) {
+				break;
+			}
+			Sort_Swap(info, lo, hi);
+			lo += size;
+			hi -= size;
+		}
+		Sort_Swap(info, base, hi);
+
+		/* Recurse into the smaller half, so the stack stays shallow */
+		left = (hi - base) / size;
+		right = nmemb - left - 1;
+		if ( left < right ) {
+			Sort_Intro(info, base, left, depth);
+			base = hi + size;
+			nmemb = right;
+		} else {
+			Sort_Intro(info, hi + size, right, depth);
+			nmemb = left;
+		}
+	}
+	Sort_Insertion(info, base, nmemb);
 }
 
-/* ---------------------------------------------------------------------- */
+static void Sort_All(const SDL_SortInfo *info, char *base, size_t nmemb)
+{
+	size_t n;
+	int depth = 0;
 
-extern void qsortG(void *base, size_t nmemb, size_t size,
-           int (*compare)(const void *, const void *)) {
+	for ( n = nmemb; n > 1; n >>= 1 ) {
+		depth += 2;
+	}
+	Sort_Intro(info, base, nmemb, depth);
+}
+
+static void SDL_introsort(void *base, size_t nmemb, size_t size,
+                          int (*compare)(const void *, const void *))
+{
+	SDL_SortInfo info;
 
-  if (nmemb<=1) return;
-  if (((uintptr_t)base|size)&(WORD_BYTES-1))
-    qsort_nonaligned(base,nmemb,size,compare);
-  else if (size!=WORD_BYTES)
-    qsort_aligned(base,nmemb,size,compare);
-  else
-    qsort_words(base,nmemb,compare);
+	if ( nmemb < 2 || size == 0 ) {
+		return;
+	}
+	Sort_Init(&info, base, size, compare);
+	Sort_All(&info, (char *)base, nmemb);
 }
 
-#endif /* ifndef HAVE_QSORT */
+#ifndef HAVE_QSORT
+void SDL_qsort(void *base, size_t nmemb, size_t size,
+               int (*compare)(const void *, const void *))
+{
+	SDL_introsort(base, nmemb, size, compare);
+}
+#endif /* HAVE_QSORT */
 
-/* vi: set ts=4 sw=4 expandtab: */
+/* Integer sorts */
 
+static int Compare_u32(const void *a, const void *b)
+{
+	Uint32 x = *(const Uint32 *)a, y = *(const Uint32 *)b;
+	return (x > y) - (x < y);
+}
+
+static int Compare_s32(const void *a, const void *b)
+{
+	Sint32 x = *(const Sint32 *)a, y = *(const Sint32 *)b;
+	return (x > y) - (x < y);
+}
+
+/* 'flip' is xored with the keys, to sort signed values */
+static void Radix_Sort32(Uint32 *base, size_t nmemb, Uint32 flip,
+                         int (*compare)(const void *, const void *))
+{
+	size_t counts[4][256];
+	size_t i, j, sum, n;
+	Uint32 *tmp, *src, *dst, key;
+	int pass, shift;
+
+	if ( nmemb < RADIX_MIN ) {
+		for ( i = 1; i < nmemb; ++i ) {
+			key = base[i];
+			for ( j = i; j > 0 && (base[j-1] ^ flip) > (key ^ flip); --j ) {
+				base[j] = base[j-1];
+			}
+			base[j] = key;
+		}
+		return;
+	}
+	tmp = (Uint32 *)SDL_malloc(nmemb * sizeof(*tmp));
+	if ( !tmp ) {
+		SDL_introsort(base, nmemb, sizeof(*base), compare);
+		return;
+	}
+
+	SDL_memset(counts, 0, sizeof(counts));
+	for ( i = 0; i < nmemb; ++i ) {
+		key = base[i] ^ flip;
+		++counts[0][key & 0xFF];
+		++counts[1][(key >> 8) & 0xFF];
+		++counts[2][(key >> 16) & 0xFF];
+		++counts[3][key >> 24];
+	}
+
+	src = base;
+	dst = tmp;
+	for ( pass = 0; pass < 4; ++pass ) {
+		shift = pass * 8;
+		if ( counts[pass][((src[0] ^ flip) >> shift) & 0xFF] == nmemb ) {
+			continue;
+		}
+		for ( i = 0, sum = 0; i < 256; ++i ) {
+			n = counts[pass][i];
+			counts[pass][i] = sum;
+			sum += n;
+		}
+		for ( i = 0; i < nmemb; ++i ) {
+			key = src[i];
+			dst[counts[pass][((key ^ flip) >> shift) & 0xFF]++] = key;
+		}
+		src = dst;
+		dst = (dst == tmp) ? base : tmp;
+	}
+	if ( src != base ) {
+		SDL_memcpy(base, src, nmemb * sizeof(*base));
+	}
+	SDL_free(tmp);
+}
+
+void SDL_qsort_u32(Uint32 *base, size_t nmemb)
+{
+	Radix_Sort32(base, nmemb, 0, Compare_u32);
+}
+
+void SDL_qsort_s32(Sint32 *base, size_t nmemb)
+{
+	Radix_Sort32((Uint32 *)base, nmemb, 0x80000000, Compare_s32);
+}
+
+#ifdef SDL_HAS_64BIT_TYPE
+static int Compare_u64(const void *a, const void *b)
+{
+	Uint64 x = *(const Uint64 *)a, y = *(const Uint64 *)b;
+	return (x > y) - (x < y);
+}
+
+void SDL_qsort_u64(Uint64 *base, size_t nmemb)
+{
+	size_t counts[8][256];
+	size_t i, j, sum, n;
+	Uint64 *tmp, *src, *dst, key;
+	int pass, shift;
+
+	if ( nmemb < RADIX_MIN ) {
+		for ( i = 1; i < nmemb; ++i ) {
+			key = base[i];
+			for ( j = i; j > 0 && base[j-1] > key; --j ) {
+				base[j] = base[j-1];
+			}
+			base[j] = key;
+		}
+		return;
+	}
+	tmp = (Uint64 *)SDL_malloc(nmemb * sizeof(*tmp));
+	if ( !tmp ) {
+		SDL_introsort(base, nmemb, sizeof(*base), Compare_u64);
+		return;
+	}
+
+	SDL_memset(counts, 0, sizeof(counts));
+	for ( i = 0; i < nmemb; ++i ) {
+		key = base[i];
+		for ( pass = 0; pass < 8; ++pass ) {
+			++counts[pass][(size_t)(key >> (pass * 8)) & 0xFF];
+		}
+	}
+
+	src = base;
+	dst = tmp;
+	for ( pass = 0; pass < 8; ++pass ) {
+		shift = pass * 8;
+		if ( counts[pass][(size_t)(src[0] >> shift) & 0xFF] == nmemb ) {
+			continue;
+		}
+		for ( i = 0, sum = 0; i < 256; ++i ) {
+			n = counts[pass][i];
+			counts[pass][i] = sum;
+			sum += n;
+		}
+		for ( i = 0; i < nmemb; ++i ) {
+			key = src[i];
+			dst[counts[pass][(size_t)(key >> shift) & 0xFF]++] = key;
+		}
+		src = dst;
+		dst = (dst == tmp) ? base : tmp;
+	}
+	if ( src != base ) {
+		SDL_memcpy(base, src, nmemb * sizeof(*base));
+	}
+	SDL_free(tmp);
+}
+#endif /* SDL_HAS_64BIT_TYPE */
+
+/* Parallel merge sort */
+
+typedef struct {
+	SDL_SortInfo info;
+	char *src;
+	char *dst;
+	size_t nmemb;
+	size_t run;	/* Length of the sorted runs */
+	int parts;	/* Pieces each merge is cut into */
+} SDL_SortJob;
+
+static void SDLCALL Sort_RunJob(void *data, int first, int last)
+{
+	SDL_SortJob *job = (SDL_SortJob *)data;
+	size_t start;
+	int i;
+
+	for ( i = first; i < last; ++i ) {
+		start = (size_t)i * job->run;
+		if ( start < job->nmemb ) {
+			Sort_All(&job->info, job->src + start * job->info.size,
+			         SDL_min(job->run, job->nmemb - start));
+		}
+	}
+}
+
+/* How many of the first 'd' merged elements come from 'a' */
+static size_t Sort_CoRank(const SDL_SortInfo *info, const char *a, size_t alen,
+                          const char *b, size_t blen, size_t d)
+{
+	size_t size = info->size;
+	size_t lo = (d > blen) ? d - blen : 0;
+	size_t hi = (d < alen) ? d : alen;
+	size_t i, j;
+
+	while ( lo < hi ) {
+		i = lo + (hi - lo) / 2;
+		j = d - i;
+		/* Ties go to 'a', so a[i] has to come before b[j-1] */
+		if ( j > 0 && info->compare(b + (j - 1) * size, a + i * size) >= 0 ) {
+			lo = i + 1;
+		} else {
+			hi = i;
+		}
+	}
+	return(lo);
+}
+
+static void Sort_Merge(const SDL_SortInfo *info, const char *a, size_t alen,
+                       const char *b, size_t blen, char *dst)
+{
+	size_t size = info->size;
+	const char *aend = a + alen * size;
+	const char *bend = b + blen * size;
+
+	while ( a < aend && b < bend ) {
+		if ( info->compare(b, a) < 0 ) {
+			Sort_Copy(info, dst, b);
+			b += size;
+		} else {
+			Sort_Copy(info, dst, a);
+			a += size;
+		}
+		dst += size;
+	}
+	if ( a < aend ) {
+		SDL_memcpy(dst, a, aend - a);
+	} else if ( b < bend ) {
+		SDL_memcpy(dst, b, bend - b);
+	}
+}
+
+static void SDLCALL Sort_MergeJob(void *data, int first, int last)
+{
+	SDL_SortJob *job = (SDL_SortJob *)data;
+	size_t size = job->info.size;
+	size_t start, alen, blen, total, d0, d1, i0, i1;
+	const char *a, *b;
+	int t, part;
+
+	for ( t = first; t < last; ++t ) {
+		part = t % job->parts;
+		start = (size_t)(t / job->parts) * 2 * job->run;
+		alen = SDL_min(job->run, job->nmemb - start);
+		blen = SDL_min(job->run, job->nmemb - start - alen);
+		a = job->src + start * size;
+		b = a + alen * size;
+
+		/* The part of the output this piece fills */
+		total = alen + blen;
+		d0 = part * (total / job->parts) + SDL_min((size_t)part, total % job->parts);
+		d1 = (part + 1) * (total / job->parts) + SDL_min((size_t)part + 1, total % job->parts);
+		i0 = Sort_CoRank(&job->info, a, alen, b, blen, d0);
+		i1 = Sort_CoRank(&job->info, a, alen, b, blen, d1);
+		Sort_Merge(&job->info, a + i0 * size, i1 - i0,
+		           b + (d0 - i0) * size, (d1 - i1) - (d0 - i0),
+		           job->dst + (start + d0) * size);
+	}
+}
+
+void SDL_qsort_parallel(void *base, size_t nmemb, size_t size,
+                        int (*compare)(const void *, const void *))
+{
+	SDL_SortJob job;
+	char *tmp = NULL, *swap;
+	size_t runs, pairs, threads;
+
+	if ( nmemb < 2 || size == 0 ) {
+		return;
+	}
+
+	/* A run for each thread, the caller sorts one too */
+	threads = SDL_GetThreadPoolSize() + 1;
+	for ( runs = 1; runs < threads && runs < PARALLEL_MAX_RUNS; runs *= 2 ) {
+		/* Round up to a power of two */ ;
+	}
+	while ( runs > 1 && nmemb / runs < PARALLEL_MIN_RUN ) {
+		runs /= 2;
+	}
+	if ( runs > 1 ) {
+		tmp = (char *)SDL_malloc(nmemb * size);
+	}
+	if ( !tmp ) {
+		SDL_introsort(base, nmemb, size, compare);
+		return;
+	}
+
+	Sort_Init(&job.info, base, size, compare);
+	job.src = (char *)base;
+	job.dst = tmp;
+	job.nmemb = nmemb;
+	job.run = (nmemb + runs - 1) / runs;
+	SDL_ParallelFor((int)runs, 1, Sort_RunJob, &job);
+
+	while ( job.run < nmemb ) {
+		pairs = (nmemb + 2 * job.run - 1) / (2 * job.run);
+		job.parts = (int)((runs + pairs - 1) / pairs);
+		SDL_ParallelFor((int)pairs * job.parts, 1, Sort_MergeJob, &job);
+		swap = job.src;
+		job.src = job.dst;
+		job.dst = swap;
+		job.run *= 2;
+	}
+	if ( job.src != (char *)base ) {
+		SDL_memcpy(base, job.src, nmemb * size);
+	}
+	SDL_free(tmp);
+}
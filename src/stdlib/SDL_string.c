@@ -382,7 +382,7 @@ size_t SDL_strlcat(char *dst, const char *src, size_t maxlen)
 }
 #endif
 
-#ifndef HAVE_STRDUP
+#if !defined(HAVE_STRDUP) || defined(SDL_MALLOC_THREADED)
 char *SDL_strdup(const char *string)
 {
     size_t len = SDL_strlen(string)+1;
@@ -0,0 +1,510 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Conversions between UTF-8 and Latin-1, UTF-16 and UTF-32.
+
+   Most text is mostly ASCII, so runs of ASCII characters are checked
+   and copied 16 or 32 at a time, and only the rest is decoded one
+   character at a time.
+*/
+
+#include "SDL_stdinc.h"
+#include "../cpuinfo/SDL_simd.h"
+#include "SDL_utf8_c.h"
+
+#define UNKNOWN_ASCII	'?'
+#define UNKNOWN_UNICODE	0xFFFD
+
+static size_t UnitSize(int format)
+{
+	switch (format) {
+	    case SDL_UTF_16LE:
+	    case SDL_UTF_16BE:
+		return 2;
+	    case SDL_UTF_32LE:
+	    case SDL_UTF_32BE:
+		return 4;
+	    default:
+		return 1;
+	}
+}
+
+static void PutUnit(Uint8 *p, int format, Uint32 ch)
+{
+	switch (format) {
+	    case SDL_UTF_LATIN1:
+		p[0] = (Uint8)ch;
+		break;
+	    case SDL_UTF_16LE:
+		p[0] = (Uint8)ch;
+		p[1] = (Uint8)(ch >> 8);
+		break;
+	    case SDL_UTF_16BE:
+		p[0] = (Uint8)(ch >> 8);
+		p[1] = (Uint8)ch;
+		break;
+	    case SDL_UTF_32LE:
+		p[0] = (Uint8)ch;
+		p[1] = (Uint8)(ch >> 8);
+		p[2] = (Uint8)(ch >> 16);
+		p[3] = (Uint8)(ch >> 24);
+		break;
+	    case SDL_UTF_32BE:
+		p[0] = (Uint8)(ch >> 24);
+		p[1] = (Uint8)(ch >> 16);
+		p[2] = (Uint8)(ch >> 8);
+		p[3] = (Uint8)ch;
+		break;
+	}
+}
+
+static Uint32 GetUnit(const Uint8 *p, int format)
+{
+	switch (format) {
+	    case SDL_UTF_16LE:
+		return ((Uint32)p[1] << 8) | p[0];
+	    case SDL_UTF_16BE:
+		return ((Uint32)p[0] << 8) | p[1];
+	    case SDL_UTF_32LE:
+		return ((Uint32)p[3] << 24) | ((Uint32)p[2] << 16) |
+		       ((Uint32)p[1] << 8) | p[0];
+	    case SDL_UTF_32BE:
+		return ((Uint32)p[0] << 24) | ((Uint32)p[1] << 16) |
+		       ((Uint32)p[2] << 8) | p[3];
+	    default:
+		return p[0];
+	}
+}
+
+/* Decode one character (RFC 3629), returns how many bytes it used, or 0
+   if the input ends before the character does.  Overlong forms,
+   surrogates and anything past U+10FFFF come out as U+FFFD, using up
+   only the bytes that could have started a valid character.
+*/
+static size_t DecodeUTF8(const Uint8 *p, size_t len, Uint32 *ch)
+{
+	Uint8 lo = 0x80, hi = 0xBF;
+	size_t need, i;
+	Uint32 c = p[0];
+
+	if ( c < 0x80 ) {
+		*ch = c;
+		return 1;
+	} else if ( c < 0xC2 ) {
+		/* A stray continuation byte, or an overlong two byte form */
+		*ch = UNKNOWN_UNICODE;
+		return 1;
+	} else if ( c < 0xE0 ) {
+		need = 1;
+		c &= 0x1F;
+	} else if ( c < 0xF0 ) {
+		need = 2;
+		if ( c == 0xE0 ) {
+			lo = 0xA0;
+		} else if ( c == 0xED ) {
+			hi = 0x9F;
+		}
+		c &= 0x0F;
+	} else if ( c < 0xF5 ) {
+		need = 3;
+		if ( c == 0xF0 ) {
+			lo = 0x90;
+		} else if ( c == 0xF4 ) {
+			hi = 0x8F;
+		}
+		c &= 0x07;
+	} else {
+		*ch = UNKNOWN_UNICODE;
+		return 1;
+	}
+	for ( i = 1; i <= need; ++i ) {
+		if ( i >= len ) {
+			return 0;
+		}
+		if ( p[i] < lo || p[i] > hi ) {
+			*ch = UNKNOWN_UNICODE;
+			return i;
+		}
+		c = (c << 6) | (p[i] & 0x3F);
+		lo = 0x80;
+		hi = 0xBF;
+	}
+	*ch = c;
+	return i;
+}
+
+#if HAVE_AVX2_INTRINSICS
+SDL_TARGETING("avx2") static size_t AVX2_WidenASCII(const Uint8 *src, Uint8 *dst, size_t n, int format)
+{
+	__m256i v, w;
+	__m128i lo, hi;
+	size_t i;
+
+	for ( i = 0; i + 32 <= n; i += 32 ) {
+		v = _mm256_loadu_si256((const __m256i *)(src + i));
+		if ( _mm256_movemask_epi8(v) ) {
+			break;
+		}
+		lo = _mm256_castsi256_si128(v);
+		hi = _mm256_extracti128_si256(v, 1);
+		switch (format) {
+		    case SDL_UTF_LATIN1:
+			_mm256_storeu_si256((__m256i *)(dst + i), v);
+			break;
+		    case SDL_UTF_16LE:
+		    case SDL_UTF_16BE:
+			v = _mm256_cvtepu8_epi16(lo);
+			w = _mm256_cvtepu8_epi16(hi);
+			if ( format == SDL_UTF_16BE ) {
+				v = _mm256_slli_epi16(v, 8);
+				w = _mm256_slli_epi16(w, 8);
+			}
+			_mm256_storeu_si256((__m256i *)(dst + i * 2), v);
+			_mm256_storeu_si256((__m256i *)(dst + i * 2 + 32), w);
+			break;
+		    default:
+			v = _mm256_cvtepu8_epi32(lo);
+			w = _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8));
+			if ( format == SDL_UTF_32BE ) {
+				v = _mm256_slli_epi32(v, 24);
+				w = _mm256_slli_epi32(w, 24);
+			}
+			_mm256_storeu_si256((__m256i *)(dst + i * 4), v);
+			_mm256_storeu_si256((__m256i *)(dst + i * 4 + 32), w);
+			v = _mm256_cvtepu8_epi32(hi);
+			w = _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8));
+			if ( format == SDL_UTF_32BE ) {
+				v = _mm256_slli_epi32(v, 24);
+				w = _mm256_slli_epi32(w, 24);
+			}
+			_mm256_storeu_si256((__m256i *)(dst + i * 4 + 64), v);
+			_mm256_storeu_si256((__m256i *)(dst + i * 4 + 96), w);
+			break;
+		}
+	}
+	return(i);
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+#if HAVE_SSE2_INTRINSICS
+/* Interleaving with zero widens ASCII, the zero goes first for big-endian */
+#define SSE2_WIDEN(lohi, bits, v, big) \
+	((big) ? _mm_unpack##lohi##_epi##bits(zero, v) : _mm_unpack##lohi##_epi##bits(v, zero))
+
+SDL_TARGETING("sse2") static size_t SSE2_WidenASCII(const Uint8 *src, Uint8 *dst, size_t n, int format)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const int big = (format == SDL_UTF_16BE || format == SDL_UTF_32BE);
+	__m128i v, w;
+	size_t i;
+
+	for ( i = 0; i + 16 <= n; i += 16 ) {
+		v = _mm_loadu_si128((const __m128i *)(src + i));
+		if ( _mm_movemask_epi8(v) ) {
+			break;
+		}
+		switch (format) {
+		    case SDL_UTF_LATIN1:
+			_mm_storeu_si128((__m128i *)(dst + i), v);
+			break;
+		    case SDL_UTF_16LE:
+		    case SDL_UTF_16BE:
+			_mm_storeu_si128((__m128i *)(dst + i * 2), SSE2_WIDEN(lo, 8, v, big));
+			_mm_storeu_si128((__m128i *)(dst + i * 2 + 16), SSE2_WIDEN(hi, 8, v, big));
+			break;
+		    default:
+			w = SSE2_WIDEN(lo, 8, v, big);
+			_mm_storeu_si128((__m128i *)(dst + i * 4), SSE2_WIDEN(lo, 16, w, big));
+			_mm_storeu_si128((__m128i *)(dst + i * 4 + 16), SSE2_WIDEN(hi, 16, w, big));
+			w = SSE2_WIDEN(hi, 8, v, big);
+			_mm_storeu_si128((__m128i *)(dst + i * 4 + 32), SSE2_WIDEN(lo, 16, w, big));
+			_mm_storeu_si128((__m128i *)(dst + i * 4 + 48), SSE2_WIDEN(hi, 16, w, big));
+			break;
+		}
+	}
+	return(i);
+}
+
+/* The reverse: check 16 characters are ASCII, and pack them into bytes */
+SDL_TARGETING("sse2") static size_t SSE2_NarrowASCII(const Uint8 *src, Uint8 *dst, size_t n, int format)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a, b, c, d, e, mask;
+	size_t i = 0;
+
+	switch (format) {
+	    case SDL_UTF_LATIN1:
+		for ( ; i + 16 <= n; i += 16 ) {
+			a = _mm_loadu_si128((const __m128i *)(src + i));
+			if ( _mm_movemask_epi8(a) ) {
+				break;
+			}
+			_mm_storeu_si128((__m128i *)(dst + i), a);
+		}
+		break;
+	    case SDL_UTF_16LE:
+	    case SDL_UTF_16BE:
+		mask = _mm_set1_epi16((format == SDL_UTF_16BE) ? (short)0x80FF : (short)0xFF80);
+		for ( ; i + 16 <= n; i += 16 ) {
+			a = _mm_loadu_si128((const __m128i *)(src + i * 2));
+			b = _mm_loadu_si128((const __m128i *)(src + i * 2 + 16));
+			c = _mm_and_si128(_mm_or_si128(a, b), mask);
+			if ( _mm_movemask_epi8(_mm_cmpeq_epi16(c, zero)) != 0xFFFF ) {
+				break;
+			}
+			if ( format == SDL_UTF_16BE ) {
+				a = _mm_srli_epi16(a, 8);
+				b = _mm_srli_epi16(b, 8);
+			}
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(a, b));
+		}
+		break;
+	    default:
+		mask = _mm_set1_epi32((format == SDL_UTF_32BE) ? 0x80FFFFFF : 0xFFFFFF80);
+		for ( ; i + 16 <= n; i += 16 ) {
+			a = _mm_loadu_si128((const __m128i *)(src + i * 4));
+			b = _mm_loadu_si128((const __m128i *)(src + i * 4 + 16));
+			c = _mm_loadu_si128((const __m128i *)(src + i * 4 + 32));
+			d = _mm_loadu_si128((const __m128i *)(src + i * 4 + 48));
+			e = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+			if ( _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(e, mask), zero)) != 0xFFFF ) {
+				break;
+			}
+			if ( format == SDL_UTF_32BE ) {
+				a = _mm_srli_epi32(a, 24);
+				b = _mm_srli_epi32(b, 24);
+				c = _mm_srli_epi32(c, 24);
+				d = _mm_srli_epi32(d, 24);
+			}
+			a = _mm_packs_epi32(a, b);
+			c = _mm_packs_epi32(c, d);
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(a, c));
+		}
+		break;
+	}
+	return(i);
+}
+#endif /* HAVE_SSE2_INTRINSICS */
+
+/* These return how many ASCII characters were copied, the caller does the rest */
+static size_t WidenASCII(const Uint8 *src, Uint8 *dst, size_t n, int format)
+{
+#if HAVE_AVX2_INTRINSICS
+	if ( n >= 64 && SDL_HasAVX2() ) {
+		return AVX2_WidenASCII(src, dst, n, format);
+	}
+#endif
+#if HAVE_SSE2_INTRINSICS
+	if ( n >= 16 && SDL_HasSSE2() ) {
+		return SSE2_WidenASCII(src, dst, n, format);
+	}
+#endif
+	return(0);
+}
+
+static size_t NarrowASCII(const Uint8 *src, Uint8 *dst, size_t n, int format)
+{
+#if HAVE_SSE2_INTRINSICS
+	if ( n >= 16 && SDL_HasSSE2() ) {
+		return SSE2_NarrowASCII(src, dst, n, format);
+	}
+#endif
+	return(0);
+}
+
+size_t SDL_FromUTF8(int format, const char **inbuf, size_t *inbytesleft, char **outbuf, size_t *outbytesleft)
+{
+	const Uint8 *src = (const Uint8 *)*inbuf;
+	Uint8 *dst = (Uint8 *)*outbuf;
+	size_t srclen = *inbytesleft;
+	size_t dstlen = *outbytesleft;
+	const size_t size = UnitSize(format);
+	size_t total = 0;
+	size_t retCode = 0;
+	size_t i, n;
+	Uint32 ch;
+
+	while ( srclen > 0 ) {
+		if ( src[0] < 0x80 ) {
+			n = SDL_min(srclen, dstlen / size);
+			if ( n == 0 ) {
+				retCode = SDL_ICONV_E2BIG;
+				break;
+			}
+			i = WidenASCII(src, dst, n, format);
+			while ( i < n && src[i] < 0x80 ) {
+				PutUnit(dst + i * size, format, src[i]);
+				++i;
+			}
+			src += i;
+			srclen -= i;
+			dst += i * size;
+			dstlen -= i * size;
+			total += i;
+			continue;
+		}
+
+		n = DecodeUTF8(src, srclen, &ch);
+		if ( n == 0 ) {
+			retCode = SDL_ICONV_EINVAL;
+			break;
+		}
+		if ( format == SDL_UTF_LATIN1 ) {
+			if ( dstlen < 1 ) {
+				retCode = SDL_ICONV_E2BIG;
+				break;
+			}
+			*dst = (ch > 0xFF) ? UNKNOWN_ASCII : (Uint8)ch;
+			dst += 1;
+			dstlen -= 1;
+		} else if ( size == 2 && ch >= 0x10000 ) {
+			if ( dstlen < 4 ) {
+				retCode = SDL_ICONV_E2BIG;
+				break;
+			}
+			ch -= 0x10000;
+			PutUnit(dst, format, 0xD800 | (ch >> 10));
+			PutUnit(dst + 2, format, 0xDC00 | (ch & 0x3FF));
+			dst += 4;
+			dstlen -= 4;
+		} else {
+			if ( dstlen < size ) {
+				retCode = SDL_ICONV_E2BIG;
+				break;
+			}
+			PutUnit(dst, format, ch);
+			dst += size;
+			dstlen -= size;
+		}
+		src += n;
+		srclen -= n;
+		++total;
+	}
+
+	*inbuf = (const char *)src;
+	*inbytesleft = srclen;
+	*outbuf = (char *)dst;
+	*outbytesleft = dstlen;
+	return retCode ? retCode : total;
+}
+
+size_t SDL_ToUTF8(int format, const char **inbuf, size_t *inbytesleft, char **outbuf, size_t *outbytesleft)
+{
+	const Uint8 *src = (const Uint8 *)*inbuf;
+	Uint8 *dst = (Uint8 *)*outbuf;
+	size_t srclen = *inbytesleft;
+	size_t dstlen = *outbytesleft;
+	const size_t size = UnitSize(format);
+	size_t total = 0;
+	size_t retCode = 0;
+	size_t i, n;
+	Uint32 ch, ch2;
+
+	while ( srclen >= size ) {
+		ch = GetUnit(src, format);
+		if ( ch < 0x80 ) {
+			n = SDL_min(srclen / size, dstlen);
+			if ( n == 0 ) {
+				retCode = SDL_ICONV_E2BIG;
+				break;
+			}
+			i = NarrowASCII(src, dst, n, format);
+			while ( i < n && (ch = GetUnit(src + i * size, format)) < 0x80 ) {
+				dst[i] = (Uint8)ch;
+				++i;
+			}
+			src += i * size;
+			srclen -= i * size;
+			dst += i;
+			dstlen -= i;
+			total += i;
+			continue;
+		}
+
+		n = size;
+		if ( ch >= 0xD800 && ch <= 0xDFFF ) {
+			/* Only a high surrogate followed by a low one is valid */
+			if ( size != 2 || ch >= 0xDC00 ) {
+				ch = UNKNOWN_UNICODE;
+			} else if ( srclen < 4 ) {
+				retCode = SDL_ICONV_EINVAL;
+				break;
+			} else {
+				ch2 = GetUnit(src + 2, format);
+				if ( ch2 >= 0xDC00 && ch2 <= 0xDFFF ) {
+					ch = (((ch & 0x3FF) << 10) | (ch2 & 0x3FF)) + 0x10000;
+					n = 4;
+				} else {
+					ch = UNKNOWN_UNICODE;
+				}
+			}
+		} else if ( ch > 0x10FFFF ) {
+			ch = UNKNOWN_UNICODE;
+		}
+
+		if ( ch <= 0x7FF ) {
+			if ( dstlen < 2 ) {
+				retCode = SDL_ICONV_E2BIG;
+				break;
+			}
+			dst[0] = 0xC0 | (Uint8)(ch >> 6);
+			dst[1] = 0x80 | (Uint8)(ch & 0x3F);
+			dst += 2;
+			dstlen -= 2;
+		} else if ( ch <= 0xFFFF ) {
+			if ( dstlen < 3 ) {
+				retCode = SDL_ICONV_E2BIG;
+				break;
+			}
+			dst[0] = 0xE0 | (Uint8)(ch >> 12);
+			dst[1] = 0x80 | (Uint8)((ch >> 6) & 0x3F);
+			dst[2] = 0x80 | (Uint8)(ch & 0x3F);
+			dst += 3;
+			dstlen -= 3;
+		} else {
+			if ( dstlen < 4 ) {
+				retCode = SDL_ICONV_E2BIG;
+				break;
+			}
+			dst[0] = 0xF0 | (Uint8)(ch >> 18);
+			dst[1] = 0x80 | (Uint8)((ch >> 12) & 0x3F);
+			dst[2] = 0x80 | (Uint8)((ch >> 6) & 0x3F);
+			dst[3] = 0x80 | (Uint8)(ch & 0x3F);
+			dst += 4;
+			dstlen -= 4;
+		}
+		src += n;
+		srclen -= n;
+		++total;
+	}
+	if ( !retCode && srclen > 0 ) {
+		/* Part of a character is left over */
+		retCode = SDL_ICONV_EINVAL;
+	}
+
+	*inbuf = (const char *)src;
+	*inbytesleft = srclen;
+	*outbuf = (char *)dst;
+	*outbytesleft = dstlen;
+	return retCode ? retCode : total;
+}
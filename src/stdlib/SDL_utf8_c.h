@@ -0,0 +1,59 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_utf8_c_h
+#define _SDL_utf8_c_h
+
+#include "SDL_stdinc.h"
+#include "SDL_endian.h"
+
+/* The encodings that have fast conversions to and from UTF-8 */
+enum {
+	SDL_UTF_8,
+	SDL_UTF_LATIN1,
+	SDL_UTF_16LE,
+	SDL_UTF_16BE,
+	SDL_UTF_32LE,
+	SDL_UTF_32BE
+};
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+#define SDL_UTF_16NATIVE	SDL_UTF_16BE
+#define SDL_UTF_32NATIVE	SDL_UTF_32BE
+#else
+#define SDL_UTF_16NATIVE	SDL_UTF_16LE
+#define SDL_UTF_32NATIVE	SDL_UTF_32LE
+#endif
+
+/* Convert UTF-8 to one of the other encodings above, or back to UTF-8.
+
+   These work like SDL_iconv(): the buffer pointers and sizes are moved
+   past what was converted, and the return value is the number of
+   characters converted, SDL_ICONV_E2BIG if the output filled up, or
+   SDL_ICONV_EINVAL if the input ends partway through a character.
+   Invalid input is replaced with U+FFFD, or '?' in Latin-1, instead of
+   stopping the conversion.
+*/
+extern size_t SDL_FromUTF8(int format, const char **inbuf, size_t *inbytesleft, char **outbuf, size_t *outbytesleft);
+extern size_t SDL_ToUTF8(int format, const char **inbuf, size_t *inbytesleft, char **outbuf, size_t *outbytesleft);
+
+#endif /* _SDL_utf8_c_h */
@@ -25,10 +25,12 @@
 
 #include "SDL_mutex.h"
 #include "SDL_thread.h"
+#include "SDL_atomic.h"
 #include "SDL_thread_c.h"
 #include "SDL_systhread.h"
 
 #define ARRAY_CHUNKSIZE	32
+#define TLS_ALLOC_CHUNKSIZE	4
 /* The array of threads currently active in the application
    (except the main thread)
    The manipulation of an array here is safer than using a linked list.
@@ -141,28 +143,204 @@ static void SDL_DelThread(SDL_Thread *thread)
 #endif
 }
 
+/* Thread local storage */
+static SDL_atomic_t SDL_tls_id;
+
+SDL_TLSID SDL_TLSCreate(void)
+{
+	return (SDL_TLSID)(SDL_AtomicAdd(&SDL_tls_id, 1) + 1);
+}
+
+void *SDL_TLSGet(SDL_TLSID id)
+{
+	SDL_TLSData *storage;
+
+	storage = SDL_SYS_GetTLSData();
+	if ( !storage || id == 0 || id > storage->limit ) {
+		return(NULL);
+	}
+	return(storage->array[id-1].data);
+}
+
+/* Set a value without setting an error, so SDL_GetErrBuf() can use it */
+static int SDL_TLSSetValue(SDL_TLSID id, const void *value, void (SDLCALL *destructor)(void *))
+{
+	SDL_TLSData *storage;
+
+	storage = SDL_SYS_GetTLSData();
+	if ( !storage || id > storage->limit ) {
+		SDL_TLSData *new_storage;
+		unsigned int i, oldlimit, newlimit;
+
+		oldlimit = storage ? storage->limit : 0;
+		newlimit = (id + TLS_ALLOC_CHUNKSIZE);
+		new_storage = (SDL_TLSData *)SDL_malloc(
+			sizeof(*storage)+(newlimit-1)*sizeof(storage->array[0]));
+		if ( !new_storage ) {
+			return(-1);
+		}
+		new_storage->limit = newlimit;
+		for ( i = 0; i < newlimit; ++i ) {
+			if ( i < oldlimit ) {
+				new_storage->array[i] = storage->array[i];
+			} else {
+				new_storage->array[i].data = NULL;
+				new_storage->array[i].destructor = NULL;
+			}
+		}
+		if ( SDL_SYS_SetTLSData(new_storage) < 0 ) {
+			SDL_free(new_storage);
+			return(-1);
+		}
+		if ( storage ) {
+			SDL_free(storage);
+		}
+		storage = new_storage;
+	}
+	storage->array[id-1].data = (void *)value;
+	storage->array[id-1].destructor = destructor;
+	return(0);
+}
+
+int SDL_TLSSet(SDL_TLSID id, const void *value, void (SDLCALL *destructor)(void *))
+{
+	if ( id == 0 ) {
+		SDL_SetError("Invalid thread local storage ID");
+		return(-1);
+	}
+	if ( SDL_TLSSetValue(id, value, destructor) < 0 ) {
+		SDL_SetError("Couldn't set thread local storage");
+		return(-1);
+	}
+	return(0);
+}
+
+void SDL_TLSCleanup(void)
+{
+	SDL_TLSData *storage;
+	void (SDLCALL *destructor)(void *);
+	void *data;
+	unsigned int i;
+
+	storage = SDL_SYS_GetTLSData();
+	if ( storage ) {
+		/* Destructors may look at other values, so free the block last */
+		for ( i = 0; i < storage->limit; ++i ) {
+			data = storage->array[i].data;
+			destructor = storage->array[i].destructor;
+			storage->array[i].data = NULL;
+			storage->array[i].destructor = NULL;
+			if ( destructor ) {
+				destructor(data);
+			}
+		}
+		SDL_SYS_SetTLSData(NULL);
+		SDL_free(storage);
+	}
+}
+
+#if !SDL_THREAD_PTHREAD && !SDL_THREAD_WIN32
+/* Without native thread local storage, keep a list of the values for each
+   thread.  Threads not made by SDL_CreateThread() never free their entry.
+ */
+typedef struct SDL_TLSEntry {
+	Uint32 thread;
+	SDL_TLSData *storage;
+	struct SDL_TLSEntry *next;
+} SDL_TLSEntry;
+
+static SDL_SpinLock SDL_tls_lock;
+static SDL_TLSEntry *SDL_tls_entries;
+
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+	Uint32 thread = SDL_ThreadID();
+	SDL_TLSEntry *entry;
+	SDL_TLSData *storage = NULL;
+
+	SDL_AtomicLock(&SDL_tls_lock);
+	for ( entry = SDL_tls_entries; entry; entry = entry->next ) {
+		if ( entry->thread == thread ) {
+			storage = entry->storage;
+			break;
+		}
+	}
+	SDL_AtomicUnlock(&SDL_tls_lock);
+	return(storage);
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *storage)
+{
+	Uint32 thread = SDL_ThreadID();
+	SDL_TLSEntry *prev, *entry;
+
+	SDL_AtomicLock(&SDL_tls_lock);
+	prev = NULL;
+	for ( entry = SDL_tls_entries; entry; entry = entry->next ) {
+		if ( entry->thread == thread ) {
+			break;
+		}
+		prev = entry;
+	}
+	if ( entry ) {
+		if ( storage ) {
+			entry->storage = storage;
+		} else {
+			if ( prev ) {
+				prev->next = entry->next;
+			} else {
+				SDL_tls_entries = entry->next;
+			}
+			SDL_free(entry);
+		}
+	} else if ( storage ) {
+		entry = (SDL_TLSEntry *)SDL_malloc(sizeof(*entry));
+		if ( entry ) {
+			entry->thread = thread;
+			entry->storage = storage;
+			entry->next = SDL_tls_entries;
+			SDL_tls_entries = entry;
+		}
+	}
+	SDL_AtomicUnlock(&SDL_tls_lock);
+
+	if ( storage && !entry ) {
+		return(-1);
+	}
+	return(0);
+}
+#endif /* !SDL_THREAD_PTHREAD && !SDL_THREAD_WIN32 */
+
 /* The default (non-thread-safe) global error variable */
 static SDL_error SDL_global_error;
 
 /* Routine to get the thread-specific error variable */
 SDL_error *SDL_GetErrBuf(void)
 {
+	static SDL_SpinLock tls_lock;
+	static volatile SDL_TLSID tls_errbuf;
 	SDL_error *errbuf;
 
-	errbuf = &SDL_global_error;
-	if ( SDL_Threads ) {
-		int i;
-		Uint32 this_thread;
-
-		this_thread = SDL_ThreadID();
-		SDL_mutexP(thread_lock);
-		for ( i=0; i<SDL_numthreads; ++i ) {
-			if ( this_thread == SDL_Threads[i]->threadid ) {
-				errbuf = &SDL_Threads[i]->errbuf;
-				break;
-			}
+	if ( !tls_errbuf ) {
+		SDL_AtomicLock(&tls_lock);
+		if ( !tls_errbuf ) {
+			tls_errbuf = SDL_TLSCreate();
+		}
+		SDL_AtomicUnlock(&tls_lock);
+	}
+
+	/* SDL_TLSSet() would set an error on failure and come back here */
+	errbuf = (SDL_error *)SDL_TLSGet(tls_errbuf);
+	if ( errbuf == NULL ) {
+		errbuf = (SDL_error *)SDL_malloc(sizeof(*errbuf));
+		if ( errbuf == NULL ) {
+			return(&SDL_global_error);
+		}
+		SDL_memset(errbuf, 0, sizeof(*errbuf));
+		if ( SDL_TLSSetValue(tls_errbuf, errbuf, SDL_free) < 0 ) {
+			SDL_free(errbuf);
+			return(&SDL_global_error);
 		}
-		SDL_mutexV(thread_lock);
 	}
 	return(errbuf);
 }
@@ -202,6 +380,9 @@ void SDL_RunThread(void *data)
 
 	/* Run the function */
 	*statusloc = userfunc(userdata);
+
+	/* Clean up thread local storage */
+	SDL_TLSCleanup();
 }
 
 #ifdef SDL_PASSED_BEGINTHREAD_ENDTHREAD
@@ -54,11 +54,22 @@ struct SDL_Thread {
 	Uint32 threadid;
 	SYS_ThreadHandle handle;
 	int status;
-	SDL_error errbuf;
 	void *data;
 };
 
+/* The thread local values for one thread, indexed by SDL_TLSID-1 */
+typedef struct SDL_TLSData {
+	unsigned int limit;
+	struct {
+		void *data;
+		void (SDLCALL *destructor)(void *);
+	} array[1];
+} SDL_TLSData;
+
 /* This is the function called to run a thread */
 extern void SDL_RunThread(void *data);
 
+/* Call the destructors and free the thread local values of this thread */
+extern void SDL_TLSCleanup(void);
+
 #endif /* _SDL_thread_c_h */
@@ -0,0 +1,588 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* A work stealing thread pool built on the SDL thread primitives */
+
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_atomic.h"
+
+#define MAX_POOL_THREADS	64
+#define DEQUE_MINSIZE		64	/* Must be a power of two */
+#define CHUNKS_PER_THREAD	4	/* Default SDL_ParallelFor() split */
+
+struct SDL_Job {
+	void (SDLCALL *fn)(void *data);
+	void (SDLCALL *range_fn)(void *data, int first, int last);
+	void *data;
+	int first, last;
+
+	/* Counts down to 0 when the job is done, either 'count' for a
+	   single job or the counter shared by an SDL_ParallelFor() */
+	int *counter;
+	int count;
+
+	struct SDL_Job *next;	/* Free list */
+};
+
+/* A job queue: the owner pushes and pops at the tail, thieves and
+   outside threads take from the head */
+typedef struct SDL_JobDeque {
+	SDL_mutex *lock;
+	SDL_Job **jobs;
+	unsigned int size;
+	unsigned int head;
+	unsigned int tail;
+} SDL_JobDeque;
+
+typedef struct SDL_PoolWorker {
+	SDL_JobDeque deque;
+	SDL_Thread *thread;
+	int index;
+} SDL_PoolWorker;
+
+/* Each worker's SDL_PoolWorker, kept across restarts of the pool */
+static SDL_TLSID worker_tls;
+
+/* Set once the pool is up, the lock keeps two threads from both
+   starting it */
+static SDL_atomic_t pool_started;
+static SDL_SpinLock pool_init_lock;
+
+static struct {
+	SDL_mutex *lock;	/* Protects everything below */
+	SDL_cond *work;		/* Signaled when jobs are queued */
+	SDL_cond *done;		/* Broadcast when jobs finish */
+	int pending;		/* Jobs sitting in the queues */
+	int waiting;		/* Threads sleeping on 'done' */
+	int quit;
+	int nworkers;
+	int ndeques;		/* Workers set up, some may not have started */
+	unsigned int victim;	/* Where the next theft starts */
+	SDL_PoolWorker *workers;
+	SDL_JobDeque global;	/* Jobs from threads outside the pool */
+	SDL_Job *freelist;
+} pool;
+
+
+static int SDL_InitJobDeque(SDL_JobDeque *deque)
+{
+	deque->lock = SDL_CreateMutex();
+	deque->jobs = (SDL_Job **)SDL_malloc(DEQUE_MINSIZE*sizeof(SDL_Job *));
+	if ( !deque->lock || !deque->jobs ) {
+		return(-1);
+	}
+	deque->size = DEQUE_MINSIZE;
+	deque->head = deque->tail = 0;
+	return(0);
+}
+
+static void SDL_FreeJobDeque(SDL_JobDeque *deque)
+{
+	if ( deque->lock ) {
+		SDL_DestroyMutex(deque->lock);
+		deque->lock = NULL;
+	}
+	if ( deque->jobs ) {
+		SDL_free(deque->jobs);
+		deque->jobs = NULL;
+	}
+}
+
+/* Push jobs onto the tail of a deque, growing it as needed */
+static int SDL_PushJobs(SDL_JobDeque *deque, SDL_Job **jobs, int n)
+{
+	int i;
+
+	SDL_mutexP(deque->lock);
+	if ( (deque->tail - deque->head) + n > deque->size ) {
+		unsigned int size = deque->size;
+		SDL_Job **grown;
+
+		while ( (deque->tail - deque->head) + n > size ) {
+			size *= 2;
+		}
+		grown = (SDL_Job **)SDL_malloc(size*sizeof(SDL_Job *));
+		if ( grown == NULL ) {
+			SDL_mutexV(deque->lock);
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		for ( i = 0; deque->head + i != deque->tail; ++i ) {
+			grown[i] = deque->jobs[(deque->head + i) & (deque->size - 1)];
+		}
+		SDL_free(deque->jobs);
+		deque->jobs = grown;
+		deque->size = size;
+		deque->tail -= deque->head;
+		deque->head = 0;
+	}
+	for ( i = 0; i < n; ++i ) {
+		deque->jobs[deque->tail++ & (deque->size - 1)] = jobs[i];
+	}
+	SDL_mutexV(deque->lock);
+	return(0);
+}
+
+static SDL_Job *SDL_PopJob(SDL_JobDeque *deque, int steal)
+{
+	SDL_Job *job = NULL;
+
+	if ( deque->head == deque->tail ) {
+		return(NULL);	/* Peeking without the lock is fine here */
+	}
+	SDL_mutexP(deque->lock);
+	if ( deque->head != deque->tail ) {
+		if ( steal ) {
+			job = deque->jobs[deque->head++ & (deque->size - 1)];
+		} else {
+			job = deque->jobs[--deque->tail & (deque->size - 1)];
+		}
+	}
+	SDL_mutexV(deque->lock);
+	return(job);
+}
+
+/* Returns the index of the worker running this thread, or -1 */
+static int SDL_FindWorker(void)
+{
+	SDL_PoolWorker *worker;
+
+	worker = (SDL_PoolWorker *)SDL_TLSGet(worker_tls);
+	if ( worker == NULL ) {
+		return(-1);
+	}
+	return(worker->index);
+}
+
+/* Take a job from our own deque, then the global one, then steal */
+static SDL_Job *SDL_GrabJob(int self)
+{
+	SDL_Job *job = NULL;
+	int i;
+
+	if ( self >= 0 ) {
+		job = SDL_PopJob(&pool.workers[self].deque, 0);
+	}
+	if ( !job ) {
+		job = SDL_PopJob(&pool.global, 1);
+	}
+	if ( !job && pool.nworkers > 0 ) {
+		unsigned int start = pool.victim++;
+		for ( i = 0; !job && i < pool.nworkers; ++i ) {
+			int victim = (int)((start + i) % pool.nworkers);
+			if ( victim != self ) {
+				job = SDL_PopJob(&pool.workers[victim].deque, 1);
+			}
+		}
+	}
+	if ( job ) {
+		SDL_mutexP(pool.lock);
+		--pool.pending;
+		SDL_mutexV(pool.lock);
+	}
+	return(job);
+}
+
+static void SDL_RunJob(SDL_Job *job)
+{
+	if ( job->range_fn ) {
+		job->range_fn(job->data, job->first, job->last);
+	} else {
+		job->fn(job->data);
+	}
+
+	SDL_mutexP(pool.lock);
+	--*job->counter;
+	if ( pool.waiting ) {
+		SDL_CondBroadcast(pool.done);
+	}
+	if ( job->counter != &job->count ) {
+		/* Nobody holds a handle to SDL_ParallelFor() ranges */
+		job->next = pool.freelist;
+		pool.freelist = job;
+	}
+	SDL_mutexV(pool.lock);
+}
+
+/* Run queued jobs until the counter drops to zero */
+static void SDL_WaitJobCounter(int *counter)
+{
+	int self = SDL_FindWorker();
+
+	SDL_mutexP(pool.lock);
+	while ( *counter > 0 ) {
+		if ( pool.pending > 0 ) {
+			SDL_Job *job;
+
+			SDL_mutexV(pool.lock);
+			job = SDL_GrabJob(self);
+			if ( job ) {
+				SDL_RunJob(job);
+			}
+			SDL_mutexP(pool.lock);
+		} else {
+			++pool.waiting;
+			SDL_CondWait(pool.done, pool.lock);
+			--pool.waiting;
+		}
+	}
+	SDL_mutexV(pool.lock);
+}
+
+static int SDLCALL SDL_PoolWorkerThread(void *data)
+{
+	SDL_PoolWorker *worker = (SDL_PoolWorker *)data;
+	SDL_Job *job;
+
+	SDL_TLSSet(worker_tls, worker, NULL);
+	for ( ; ; ) {
+		job = SDL_GrabJob(worker->index);
+		if ( job ) {
+			SDL_RunJob(job);
+			continue;
+		}
+
+		SDL_mutexP(pool.lock);
+		while ( !pool.quit && pool.pending == 0 ) {
+			SDL_CondWait(pool.work, pool.lock);
+		}
+		if ( pool.quit ) {
+			SDL_mutexV(pool.lock);
+			break;
+		}
+		SDL_mutexV(pool.lock);
+	}
+	return(0);
+}
+
+/* Create the pool, called with pool_init_lock held */
+static int SDL_StartThreadPool(void)
+{
+	const char *env;
+	int i, nworkers;
+
+	if ( !worker_tls ) {
+		worker_tls = SDL_TLSCreate();
+	}
+
+	SDL_memset(&pool, 0, sizeof(pool));
+	pool.lock = SDL_CreateMutex();
+	pool.work = SDL_CreateCond();
+	pool.done = SDL_CreateCond();
+	if ( !pool.lock || !pool.work || !pool.done ||
+	     SDL_InitJobDeque(&pool.global) < 0 ) {
+		goto error;
+	}
+
+	nworkers = SDL_GetCPUCount();
+	env = SDL_getenv("SDL_THREADPOOL_SIZE");
+	if ( env ) {
+		nworkers = SDL_atoi(env);
+	}
+	if ( nworkers < 0 ) {
+		nworkers = 0;
+	} else if ( nworkers > MAX_POOL_THREADS ) {
+		nworkers = MAX_POOL_THREADS;
+	}
+	if ( nworkers > 0 ) {
+		pool.workers = (SDL_PoolWorker *)
+			SDL_malloc(nworkers*sizeof(SDL_PoolWorker));
+		if ( pool.workers == NULL ) {
+			goto error;
+		}
+		SDL_memset(pool.workers, 0, nworkers*sizeof(SDL_PoolWorker));
+	}
+
+	/* Set up all the deques before any worker can try to steal */
+	for ( i = 0; i < nworkers; ++i ) {
+		pool.workers[i].index = i;
+		if ( SDL_InitJobDeque(&pool.workers[i].deque) < 0 ) {
+			SDL_FreeJobDeque(&pool.workers[i].deque);
+			nworkers = i;
+			break;
+		}
+	}
+	pool.ndeques = nworkers;
+	pool.nworkers = nworkers;
+
+	for ( i = 0; i < nworkers; ++i ) {
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThread
+		pool.workers[i].thread = SDL_CreateThread(SDL_PoolWorkerThread, &pool.workers[i], NULL, NULL);
+#else
+		pool.workers[i].thread = SDL_CreateThread(SDL_PoolWorkerThread, &pool.workers[i]);
+#endif
+		if ( pool.workers[i].thread == NULL ) {
+			break;
+		}
+	}
+	/* Workers that didn't start are never handed any jobs, and without
+	   any workers at all, jobs run in the thread that submits them */
+	SDL_mutexP(pool.lock);
+	pool.nworkers = i;
+	SDL_mutexV(pool.lock);
+	SDL_AtomicSet(&pool_started, 1);
+	return(0);
+
+error:
+	if ( pool.workers ) {
+		SDL_free(pool.workers);
+	}
+	SDL_FreeJobDeque(&pool.global);
+	if ( pool.done ) {
+		SDL_DestroyCond(pool.done);
+	}
+	if ( pool.work ) {
+		SDL_DestroyCond(pool.work);
+	}
+	if ( pool.lock ) {
+		SDL_DestroyMutex(pool.lock);
+	}
+	SDL_memset(&pool, 0, sizeof(pool));
+	SDL_OutOfMemory();
+	return(-1);
+}
+
+/* Create the pool the first time it's needed */
+static int SDL_InitThreadPool(void)
+{
+	int status = 0;
+
+	if ( SDL_AtomicGet(&pool_started) ) {
+		return(0);
+	}
+	SDL_AtomicLock(&pool_init_lock);
+	if ( !SDL_AtomicGet(&pool_started) ) {
+		status = SDL_StartThreadPool();
+	}
+	SDL_AtomicUnlock(&pool_init_lock);
+	return(status);
+}
+
+/* Stop the workers, called by SDL_Quit() */
+void SDL_ThreadPoolQuit(void)
+{
+	SDL_Job *job;
+	int i;
+
+	if ( !SDL_AtomicGet(&pool_started) ) {
+		return;
+	}
+
+	SDL_mutexP(pool.lock);
+	pool.quit = 1;
+	SDL_CondBroadcast(pool.work);
+	SDL_mutexV(pool.lock);
+	for ( i = 0; i < pool.nworkers; ++i ) {
+		SDL_WaitThread(pool.workers[i].thread, NULL);
+	}
+	for ( i = 0; i < pool.ndeques; ++i ) {
+		SDL_FreeJobDeque(&pool.workers[i].deque);
+	}
+	if ( pool.workers ) {
+		SDL_free(pool.workers);
+	}
+	SDL_FreeJobDeque(&pool.global);
+
+	while ( pool.freelist ) {
+		job = pool.freelist;
+		pool.freelist = job->next;
+		SDL_free(job);
+	}
+	SDL_DestroyCond(pool.done);
+	SDL_DestroyCond(pool.work);
+	SDL_DestroyMutex(pool.lock);
+	SDL_memset(&pool, 0, sizeof(pool));
+	SDL_AtomicSet(&pool_started, 0);
+}
+
+/* Allocate jobs from the free list, called with the pool lock held */
+static SDL_Job *SDL_AllocJob(void)
+{
+	SDL_Job *job = pool.freelist;
+
+	if ( job ) {
+		pool.freelist = job->next;
+	} else {
+		job = (SDL_Job *)SDL_malloc(sizeof(*job));
+		if ( job == NULL ) {
+			return(NULL);
+		}
+	}
+	SDL_memset(job, 0, sizeof(*job));
+	return(job);
+}
+
+/* Queue jobs on this thread's deque, or the global one */
+static int SDL_QueueJobs(SDL_Job **jobs, int n)
+{
+	int self = SDL_FindWorker();
+	SDL_JobDeque *deque;
+
+	if ( self >= 0 ) {
+		deque = &pool.workers[self].deque;
+	} else {
+		deque = &pool.global;
+	}
+	if ( SDL_PushJobs(deque, jobs, n) < 0 ) {
+		return(-1);
+	}
+
+	SDL_mutexP(pool.lock);
+	pool.pending += n;
+	if ( n == 1 ) {
+		SDL_CondSignal(pool.work);
+	} else {
+		SDL_CondBroadcast(pool.work);
+	}
+	if ( pool.waiting ) {
+		/* Let waiting threads help out */
+		SDL_CondBroadcast(pool.done);
+	}
+	SDL_mutexV(pool.lock);
+	return(0);
+}
+
+SDL_Job *SDL_SubmitJob(void (SDLCALL *fn)(void *data), void *data)
+{
+	SDL_Job *job;
+
+	if ( SDL_InitThreadPool() < 0 ) {
+		return(NULL);
+	}
+
+	SDL_mutexP(pool.lock);
+	job = SDL_AllocJob();
+	SDL_mutexV(pool.lock);
+	if ( job == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	job->fn = fn;
+	job->data = data;
+	job->count = 1;
+	job->counter = &job->count;
+
+	if ( pool.nworkers == 0 || SDL_QueueJobs(&job, 1) < 0 ) {
+		/* No workers, just run it now */
+		SDL_RunJob(job);
+	}
+	return(job);
+}
+
+void SDL_WaitJob(SDL_Job *job)
+{
+	if ( job == NULL ) {
+		return;
+	}
+	SDL_WaitJobCounter(&job->count);
+
+	SDL_mutexP(pool.lock);
+	job->next = pool.freelist;
+	pool.freelist = job;
+	SDL_mutexV(pool.lock);
+}
+
+int SDL_ParallelFor(int count, int grain,
+                    void (SDLCALL *fn)(void *data, int first, int last),
+                    void *data)
+{
+	SDL_Job *stack_jobs[CHUNKS_PER_THREAD*8];
+	SDL_Job **jobs = stack_jobs;
+	int nchunks, chunk, remaining;
+	int i, first;
+
+	if ( count < 0 ) {
+		SDL_SetError("SDL_ParallelFor(): negative count");
+		return(-1);
+	}
+	if ( count == 0 ) {
+		return(0);
+	}
+	if ( SDL_InitThreadPool() < 0 || pool.nworkers == 0 ) {
+		fn(data, 0, count);
+		return(0);
+	}
+
+	/* Split the range, the caller runs chunks too while it waits */
+	chunk = count / ((pool.nworkers + 1) * CHUNKS_PER_THREAD);
+	if ( chunk < grain ) {
+		chunk = grain;
+	}
+	if ( chunk < 1 ) {
+		chunk = 1;
+	}
+	nchunks = (count + chunk - 1) / chunk;
+	if ( nchunks == 1 ) {
+		fn(data, 0, count);
+		return(0);
+	}
+	if ( nchunks > SDL_arraysize(stack_jobs) ) {
+		jobs = (SDL_Job **)SDL_malloc(nchunks*sizeof(SDL_Job *));
+		if ( jobs == NULL ) {
+			fn(data, 0, count);
+			return(0);
+		}
+	}
+
+	remaining = nchunks;
+	SDL_mutexP(pool.lock);
+	for ( i = 0, first = 0; i < nchunks; ++i, first += chunk ) {
+		jobs[i] = SDL_AllocJob();
+		if ( jobs[i] == NULL ) {
+			break;
+		}
+		jobs[i]->range_fn = fn;
+		jobs[i]->data = data;
+		jobs[i]->first = first;
+		jobs[i]->last = (count - first > chunk) ? first + chunk : count;
+		jobs[i]->counter = &remaining;
+	}
+	SDL_mutexV(pool.lock);
+
+	if ( i < nchunks || SDL_QueueJobs(jobs, nchunks) < 0 ) {
+		/* Out of memory, run what we have ourselves */
+		int n = i;
+		for ( i = 0; i < n; ++i ) {
+			SDL_RunJob(jobs[i]);
+		}
+		if ( n < nchunks ) {
+			fn(data, n * chunk, count);
+		}
+		remaining = 0;
+	}
+	SDL_WaitJobCounter(&remaining);
+
+	if ( jobs != stack_jobs ) {
+		SDL_free(jobs);
+	}
+	return(0);
+}
+
+int SDL_GetThreadPoolSize(void)
+{
+	SDL_InitThreadPool();
+	return(pool.nworkers);
+}
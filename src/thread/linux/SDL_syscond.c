@@ -0,0 +1,140 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Condition variables built on Linux futexes */
+
+#include "SDL_thread.h"
+#include "SDL_sysfutex.h"
+
+struct SDL_cond
+{
+	SDL_atomic_t seq;	/* Bumped by every signal */
+	SDL_atomic_t waiters;
+	int spin;
+};
+
+/* Create a condition variable */
+SDL_cond * SDL_CreateCond(void)
+{
+	SDL_cond *cond;
+
+	cond = (SDL_cond *) SDL_malloc(sizeof(SDL_cond));
+	if ( cond ) {
+		cond->seq.value = 0;
+		cond->waiters.value = 0;
+		cond->spin = FUTEX_SPIN_START;
+	} else {
+		SDL_OutOfMemory();
+	}
+	return(cond);
+}
+
+/* Destroy a condition variable */
+void SDL_DestroyCond(SDL_cond *cond)
+{
+	if ( cond ) {
+		SDL_free(cond);
+	}
+}
+
+static int SDL_WakeCond(SDL_cond *cond, int count)
+{
+	if ( ! cond ) {
+		SDL_SetError("Passed a NULL condition variable");
+		return -1;
+	}
+
+	/* Waiters are counted before they read the sequence number, so
+	   either they see this change or we see them.  Signal with the
+	   mutex held to be sure the wakeup goes to a thread that was
+	   already waiting, rather than one that started waiting after.
+	 */
+	SDL_AtomicAdd(&cond->seq, 1);
+	if ( SDL_AtomicGet(&cond->waiters) > 0 ) {
+		SDL_FutexWake(&cond->seq, count);
+	}
+	return 0;
+}
+
+/* Restart one of the threads that are waiting on the condition variable */
+int SDL_CondSignal(SDL_cond *cond)
+{
+	return SDL_WakeCond(cond, 1);
+}
+
+/* Restart all threads that are waiting on the condition variable */
+int SDL_CondBroadcast(SDL_cond *cond)
+{
+	return SDL_WakeCond(cond, 0x7FFFFFFF);
+}
+
+/* Wait on the condition variable for at most 'ms' milliseconds.  As with
+   pthreads, a waiter may occasionally wake up without being signaled.
+ */
+int SDL_CondWaitTimeout(SDL_cond *cond, SDL_mutex *mutex, Uint32 ms)
+{
+	struct timespec left, *wait;
+	Uint64 deadline = 0;
+	int seq, retval;
+
+	if ( ! cond ) {
+		SDL_SetError("Passed a NULL condition variable");
+		return -1;
+	}
+
+	wait = NULL;
+	if ( ms != SDL_MUTEX_MAXWAIT ) {
+		deadline = SDL_FutexClock() + (Uint64)ms * 1000000;
+		wait = &left;
+	}
+
+	SDL_AtomicAdd(&cond->waiters, 1);
+	seq = SDL_AtomicGet(&cond->seq);
+	if ( SDL_mutexV(mutex) < 0 ) {
+		SDL_AtomicAdd(&cond->waiters, -1);
+		return -1;
+	}
+
+	retval = 0;
+	if ( !SDL_FutexSpin(&cond->seq, seq, &cond->spin) ) {
+		while ( SDL_AtomicGet(&cond->seq) == seq ) {
+			if ( wait && !SDL_FutexTimeLeft(deadline, wait) ) {
+				retval = SDL_MUTEX_TIMEDOUT;
+				break;
+			}
+			SDL_FutexWait(&cond->seq, seq, wait);
+		}
+	}
+	SDL_AtomicAdd(&cond->waiters, -1);
+
+	SDL_mutexP(mutex);
+	return retval;
+}
+
+/* Wait on the condition variable, unlocking the provided mutex.
+   The mutex must be locked before entering this function!
+ */
+int SDL_CondWait(SDL_cond *cond, SDL_mutex *mutex)
+{
+	return SDL_CondWaitTimeout(cond, mutex, SDL_MUTEX_MAXWAIT);
+}
@@ -0,0 +1,127 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_sysfutex_h
+#define _SDL_sysfutex_h
+
+/* Helpers for the Linux futex semaphores and condition variables */
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "SDL_cpuinfo.h"
+#include "../../atomic/SDL_atomic_c.h"
+
+#ifndef FUTEX_WAIT_PRIVATE	/* Linux before 2.6.22 */
+#define FUTEX_WAIT_PRIVATE	FUTEX_WAIT
+#define FUTEX_WAKE_PRIVATE	FUTEX_WAKE
+#endif
+
+/* Adaptive spinning: each object keeps its own spin count, which grows
+   while spinning pays off and shrinks while it doesn't.  There's no
+   spinning on a single CPU, the thread we wait for can't run meanwhile.
+ */
+#define FUTEX_SPIN_MIN		16
+#define FUTEX_SPIN_START	128
+#define FUTEX_SPIN_MAX		4096
+
+/* Sleep while *addr is 'value', for at most the time in 'timeout' or
+   forever if it's NULL.  Returns 0 or an errno value, like EAGAIN if
+   *addr wasn't 'value', EINTR, or ETIMEDOUT.
+ */
+static __inline__ int SDL_FutexWait(SDL_atomic_t *addr, int value, const struct timespec *timeout)
+{
+	if ( syscall(SYS_futex, &addr->value, FUTEX_WAIT_PRIVATE, value, timeout, NULL, 0) < 0 ) {
+		return errno;
+	}
+	return 0;
+}
+
+/* Wake up to 'count' threads sleeping on addr */
+static __inline__ void SDL_FutexWake(SDL_atomic_t *addr, int count)
+{
+	syscall(SYS_futex, &addr->value, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/* The monotonic clock in nanoseconds, wall clock changes don't move it.
+   Without HAVE_CLOCK_GETTIME we may not be linked with -lrt.
+ */
+static __inline__ Uint64 SDL_FutexClock(void)
+{
+	struct timespec now;
+#if HAVE_CLOCK_GETTIME
+	clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+	syscall(SYS_clock_gettime, CLOCK_MONOTONIC, &now);
+#endif
+	return (Uint64)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/* Fill in the time left until 'deadline', returns 0 if it has passed.
+   The futex timeout is relative and measured on the monotonic clock.
+ */
+static __inline__ int SDL_FutexTimeLeft(Uint64 deadline, struct timespec *left)
+{
+	Uint64 now = SDL_FutexClock();
+
+	if ( now >= deadline ) {
+		return 0;
+	}
+	left->tv_sec = (time_t)((deadline - now) / 1000000000);
+	left->tv_nsec = (long)((deadline - now) % 1000000000);
+	return 1;
+}
+
+/* Spin while *addr is 'value', adapting *spin.  Returns 1 if it changed */
+static __inline__ int SDL_FutexSpin(SDL_atomic_t *addr, int value, int *spin)
+{
+	static int cpus = 0;
+	int i, limit;
+
+	if ( !cpus ) {
+		cpus = SDL_GetCPUCount();
+	}
+	if ( cpus <= 1 ) {
+		return 0;
+	}
+
+	limit = *spin;
+	for ( i = 0; i < limit; ++i ) {
+		if ( addr->value != value ) {
+			if ( limit < FUTEX_SPIN_MAX ) {
+				*spin = limit * 2;
+			}
+			return 1;
+		}
+		SDL_CPUPause();
+	}
+	if ( limit > FUTEX_SPIN_MIN ) {
+		*spin = limit / 2;
+	}
+	return 0;
+}
+
+#endif /* _SDL_sysfutex_h */
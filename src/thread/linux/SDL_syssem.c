@@ -0,0 +1,141 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Semaphores built on Linux futexes */
+
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+#include "SDL_sysfutex.h"
+
+struct SDL_semaphore {
+	SDL_atomic_t count;
+	SDL_atomic_t waiters;	/* Threads sleeping, or about to */
+	int spin;
+};
+
+/* Create a semaphore, initialized with value */
+SDL_sem *SDL_CreateSemaphore(Uint32 initial_value)
+{
+	SDL_sem *sem = (SDL_sem *) SDL_malloc(sizeof(SDL_sem));
+	if ( sem ) {
+		sem->count.value = initial_value;
+		sem->waiters.value = 0;
+		sem->spin = FUTEX_SPIN_START;
+	} else {
+		SDL_OutOfMemory();
+	}
+	return sem;
+}
+
+void SDL_DestroySemaphore(SDL_sem *sem)
+{
+	if ( sem ) {
+		SDL_free(sem);
+	}
+}
+
+int SDL_SemTryWait(SDL_sem *sem)
+{
+	int value;
+
+	if ( ! sem ) {
+		SDL_SetError("Passed a NULL semaphore");
+		return -1;
+	}
+
+	do {
+		value = SDL_AtomicGet(&sem->count);
+		if ( value == 0 ) {
+			return SDL_MUTEX_TIMEDOUT;
+		}
+	} while ( !SDL_AtomicCAS(&sem->count, value, value - 1) );
+	return 0;
+}
+
+int SDL_SemWaitTimeout(SDL_sem *sem, Uint32 timeout)
+{
+	struct timespec left, *wait;
+	Uint64 deadline = 0;
+	int retval;
+
+	/* Try the easy cases first */
+	retval = SDL_SemTryWait(sem);
+	if ( retval != SDL_MUTEX_TIMEDOUT || timeout == 0 ) {
+		return retval;
+	}
+	if ( SDL_FutexSpin(&sem->count, 0, &sem->spin) ) {
+		retval = SDL_SemTryWait(sem);
+		if ( retval != SDL_MUTEX_TIMEDOUT ) {
+			return retval;
+		}
+	}
+
+	wait = NULL;
+	if ( timeout != SDL_MUTEX_MAXWAIT ) {
+		deadline = SDL_FutexClock() + (Uint64)timeout * 1000000;
+		wait = &left;
+	}
+
+	/* SDL_SemPost() adds to the count before it looks for waiters, and
+	   we're counted as a waiter before looking at the count, so one of
+	   us always sees the other.
+	 */
+	SDL_AtomicAdd(&sem->waiters, 1);
+	while ( (retval = SDL_SemTryWait(sem)) == SDL_MUTEX_TIMEDOUT ) {
+		if ( wait && !SDL_FutexTimeLeft(deadline, wait) ) {
+			break;
+		}
+		SDL_FutexWait(&sem->count, 0, wait);
+	}
+	SDL_AtomicAdd(&sem->waiters, -1);
+
+	return retval;
+}
+
+int SDL_SemWait(SDL_sem *sem)
+{
+	return SDL_SemWaitTimeout(sem, SDL_MUTEX_MAXWAIT);
+}
+
+Uint32 SDL_SemValue(SDL_sem *sem)
+{
+	Uint32 value = 0;
+	if ( sem ) {
+		value = (Uint32)SDL_AtomicGet(&sem->count);
+	}
+	return value;
+}
+
+int SDL_SemPost(SDL_sem *sem)
+{
+	if ( ! sem ) {
+		SDL_SetError("Passed a NULL semaphore");
+		return -1;
+	}
+
+	SDL_AtomicAdd(&sem->count, 1);
+	if ( SDL_AtomicGet(&sem->waiters) > 0 ) {
+		SDL_FutexWake(&sem->count, 1);
+	}
+	return 0;
+}
@@ -118,3 +118,44 @@ void SDL_SYS_KillThread(SDL_Thread *thread)
 	pthread_kill(thread->handle, SIGKILL);
 #endif
 }
+
+/* Thread local storage, which also cleans up after threads that weren't
+   made by SDL_CreateThread() when they exit */
+static pthread_key_t thread_local_storage;
+static pthread_once_t thread_local_once = PTHREAD_ONCE_INIT;
+static int thread_local_ok = 0;
+
+static void CleanupTLS(void *data)
+{
+	/* pthreads clears the value before calling us, put it back */
+	pthread_setspecific(thread_local_storage, data);
+	SDL_TLSCleanup();
+}
+
+static void CreateTLSKey(void)
+{
+	if ( pthread_key_create(&thread_local_storage, CleanupTLS) == 0 ) {
+		thread_local_ok = 1;
+	}
+}
+
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+	pthread_once(&thread_local_once, CreateTLSKey);
+	if ( !thread_local_ok ) {
+		return(NULL);
+	}
+	return((SDL_TLSData *)pthread_getspecific(thread_local_storage));
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *data)
+{
+	pthread_once(&thread_local_once, CreateTLSKey);
+	if ( !thread_local_ok ) {
+		return(-1);
+	}
+	if ( pthread_setspecific(thread_local_storage, data) != 0 ) {
+		return(-1);
+	}
+	return(0);
+}
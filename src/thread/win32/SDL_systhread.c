@@ -27,6 +27,7 @@
 #include <windows.h>
 
 #include "SDL_thread.h"
+#include "SDL_atomic.h"
 #include "../SDL_thread_c.h"
 #include "../SDL_systhread.h"
 
@@ -160,3 +161,38 @@ void SDL_SYS_KillThread(SDL_Thread *thread)
 {
 	TerminateThread(thread->handle, FALSE);
 }
+
+/* Thread local storage.  Only threads made by SDL_CreateThread() free
+   their values when they exit.
+ */
+static DWORD thread_local_storage = TLS_OUT_OF_INDEXES;
+static SDL_SpinLock thread_local_lock;
+
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+	if ( thread_local_storage == TLS_OUT_OF_INDEXES ) {
+		SDL_AtomicLock(&thread_local_lock);
+		if ( thread_local_storage == TLS_OUT_OF_INDEXES ) {
+			thread_local_storage = TlsAlloc();
+		}
+		SDL_AtomicUnlock(&thread_local_lock);
+		if ( thread_local_storage == TLS_OUT_OF_INDEXES ) {
+			return(NULL);
+		}
+	}
+	return((SDL_TLSData *)TlsGetValue(thread_local_storage));
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *data)
+{
+	if ( thread_local_storage == TLS_OUT_OF_INDEXES ) {
+		SDL_SYS_GetTLSData();
+		if ( thread_local_storage == TLS_OUT_OF_INDEXES ) {
+			return(-1);
+		}
+	}
+	if ( !TlsSetValue(thread_local_storage, data) ) {
+		return(-1);
+	}
+	return(0);
+}
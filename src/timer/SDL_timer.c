@@ -25,6 +25,7 @@
 #include "SDL_timer_c.h"
 #include "SDL_mutex.h"
 #include "SDL_systimer.h"
+#include "../events/SDL_events_c.h"
 
 /* #define DEBUG_TIMERS */
 
@@ -42,13 +43,188 @@ struct _SDL_TimerID {
 	Uint32 interval;
 	SDL_NewTimerCallback cb;
 	void *param;
-	Uint32 last_alarm;
-	struct _SDL_TimerID *next;
+	Uint32 deadline;		/* SDL_GetTicks() value when it's due */
+	int heap_index;			/* -1 if not scheduled */
+	struct _SDL_TimerID *next;	/* Next unused timer */
 };
 
-static SDL_TimerID SDL_timers = NULL;
+/* Threaded timers are kept in a binary min-heap ordered by deadline.
+   Timer structures are never freed while the timer subsystem is running,
+   so that removing a timer that has already been cancelled is harmless.
+ */
+static SDL_TimerID *SDL_timer_heap = NULL;
+static int SDL_timer_heap_size = 0;
+static int SDL_timer_heap_alloc = 0;
+static SDL_TimerID SDL_timer_pool = NULL;
+
+/* The timer whose callback is running, and whether it has been removed */
+static SDL_TimerID SDL_timer_current = NULL;
+static SDL_bool SDL_timer_current_removed = SDL_FALSE;
+
 static SDL_mutex *SDL_timer_mutex;
-static volatile SDL_bool list_changed = SDL_FALSE;
+static SDL_cond *SDL_timer_cond;
+static SDL_bool SDL_timer_wakeup = SDL_FALSE;
+
+/* Deadlines wrap around with SDL_GetTicks() */
+#define TIMER_BEFORE(a, b)	((Sint32)((a) - (b)) < 0)
+
+static void SDL_TimerHeapSet(int index, SDL_TimerID t)
+{
+	SDL_timer_heap[index] = t;
+	t->heap_index = index;
+}
+
+static void SDL_TimerHeapUp(int index)
+{
+	SDL_TimerID t = SDL_timer_heap[index];
+	int parent;
+
+	while ( index > 0 ) {
+		parent = (index - 1) / 2;
+		if ( !TIMER_BEFORE(t->deadline, SDL_timer_heap[parent]->deadline) ) {
+			break;
+		}
+		SDL_TimerHeapSet(index, SDL_timer_heap[parent]);
+		index = parent;
+	}
+	SDL_TimerHeapSet(index, t);
+}
+
+static void SDL_TimerHeapDown(int index)
+{
+	SDL_TimerID t = SDL_timer_heap[index];
+	int child;
+
+	for ( ; ; ) {
+		child = 2 * index + 1;
+		if ( child >= SDL_timer_heap_size ) {
+			break;
+		}
+		if ( (child + 1 < SDL_timer_heap_size) &&
+		     TIMER_BEFORE(SDL_timer_heap[child+1]->deadline,
+		                  SDL_timer_heap[child]->deadline) ) {
+			++child;
+		}
+		if ( !TIMER_BEFORE(SDL_timer_heap[child]->deadline, t->deadline) ) {
+			break;
+		}
+		SDL_TimerHeapSet(index, SDL_timer_heap[child]);
+		index = child;
+	}
+	SDL_TimerHeapSet(index, t);
+}
+
+static int SDL_TimerHeapInsert(SDL_TimerID t)
+{
+	if ( SDL_timer_heap_size == SDL_timer_heap_alloc ) {
+		int alloc = SDL_timer_heap_alloc ? 2 * SDL_timer_heap_alloc : 16;
+		SDL_TimerID *heap;
+
+		heap = (SDL_TimerID *)SDL_realloc(SDL_timer_heap,
+		                                  alloc * sizeof(*heap));
+		if ( heap == NULL ) {
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		SDL_timer_heap = heap;
+		SDL_timer_heap_alloc = alloc;
+	}
+	SDL_TimerHeapSet(SDL_timer_heap_size++, t);
+	SDL_TimerHeapUp(t->heap_index);
+	return(0);
+}
+
+static void SDL_TimerHeapRemove(SDL_TimerID t)
+{
+	int index = t->heap_index;
+	SDL_TimerID last;
+
+	t->heap_index = -1;
+	last = SDL_timer_heap[--SDL_timer_heap_size];
+	if ( last != t ) {
+		SDL_TimerHeapSet(index, last);
+		if ( (index > 0) &&
+		     TIMER_BEFORE(last->deadline,
+		                  SDL_timer_heap[(index - 1) / 2]->deadline) ) {
+			SDL_TimerHeapUp(index);
+		} else {
+			SDL_TimerHeapDown(index);
+		}
+	}
+}
+
+static SDL_bool SDL_TimerScheduled(SDL_TimerID t)
+{
+	return ( (t->heap_index >= 0) && (t->heap_index < SDL_timer_heap_size) &&
+	         (SDL_timer_heap[t->heap_index] == t) ) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Return a timer to the pool -- called with the timer mutex held */
+static void SDL_FreeTimer(SDL_TimerID t)
+{
+	t->heap_index = -1;
+	t->cb = NULL;
+	t->next = SDL_timer_pool;
+	SDL_timer_pool = t;
+	--SDL_timer_running;
+}
+
+/* Cancel every timer -- called with the timer mutex held */
+static void SDL_RemoveAllTimers(void)
+{
+	while ( SDL_timer_heap_size > 0 ) {
+		SDL_TimerID t = SDL_timer_heap[0];
+		SDL_TimerHeapRemove(t);
+		SDL_FreeTimer(t);
+	}
+	if ( SDL_timer_current ) {
+		SDL_timer_current_removed = SDL_TRUE;
+	}
+}
+
+/* Let a thread sleeping in SDL_ThreadedTimerWait() see a new deadline */
+static void SDL_TimersChanged(void)
+{
+	SDL_timer_wakeup = SDL_TRUE;
+	SDL_CondSignal(SDL_timer_cond);
+}
+
+#ifdef SDL_HAS_64BIT_TYPE
+#if !SDL_TIMER_UNIX && !SDL_TIMER_WIN32
+/* Fall back to the millisecond clock */
+Uint64 SDL_GetPerformanceCounter(void)
+{
+	return(SDL_GetTicks());
+}
+
+Uint64 SDL_GetPerformanceFrequency(void)
+{
+	return(1000);
+}
+#endif
+
+#if !SDL_TIMER_UNIX
+void SDL_DelayPrecise(Uint64 ns)
+{
+	Uint64 start, target, now, freq;
+
+	freq = SDL_GetPerformanceFrequency();
+	start = SDL_GetPerformanceCounter();
+	target = start + (ns / 1000000000) * freq +
+	         (ns % 1000000000) * freq / 1000000000;
+
+	/* Sleep while we're well clear of the deadline, then spin */
+	now = start;
+	while ( (now < target) && ((target - now) * 1000 / freq > 2) ) {
+		SDL_Delay((Uint32)((target - now) * 1000 / freq) - 2);
+		now = SDL_GetPerformanceCounter();
+	}
+	while ( now < target ) {
+		now = SDL_GetPerformanceCounter();
+	}
+}
+#endif
+#endif /* SDL_HAS_64BIT_TYPE */
 
 /* Set whether or not the timer should use a thread.
    This should not be called while the timer subsystem is running.
@@ -75,11 +251,17 @@ int SDL_TimerInit(void)
 	if ( SDL_timer_started ) {
 		SDL_TimerQuit();
 	}
+	/* A timer thread started by SDL_SYS_TimerInit() needs these */
+	SDL_timer_mutex = SDL_CreateMutex();
+	SDL_timer_cond = SDL_CreateCond();
 	if ( ! SDL_timer_threaded ) {
 		retval = SDL_SYS_TimerInit();
 	}
-	if ( SDL_timer_threaded ) {
-		SDL_timer_mutex = SDL_CreateMutex();
+	if ( ! SDL_timer_threaded ) {
+		SDL_DestroyCond(SDL_timer_cond);
+		SDL_timer_cond = NULL;
+		SDL_DestroyMutex(SDL_timer_mutex);
+		SDL_timer_mutex = NULL;
 	}
 	if ( retval == 0 ) {
 		SDL_timer_started = 1;
@@ -89,14 +271,30 @@ int SDL_TimerInit(void)
 
 void SDL_TimerQuit(void)
 {
+	SDL_TimerID t;
+
 	SDL_SetTimer(0, NULL);
 	if ( SDL_timer_threaded < 2 ) {
 		SDL_SYS_TimerQuit();
 	}
 	if ( SDL_timer_threaded ) {
+		SDL_DestroyCond(SDL_timer_cond);
+		SDL_timer_cond = NULL;
 		SDL_DestroyMutex(SDL_timer_mutex);
 		SDL_timer_mutex = NULL;
 	}
+	while ( SDL_timer_pool ) {
+		t = SDL_timer_pool;
+		SDL_timer_pool = t->next;
+		SDL_free(t);
+	}
+	if ( SDL_timer_heap ) {
+		SDL_free(SDL_timer_heap);
+		SDL_timer_heap = NULL;
+	}
+	SDL_timer_heap_size = 0;
+	SDL_timer_heap_alloc = 0;
+	SDL_timer_wakeup = SDL_FALSE;
 	SDL_timer_started = 0;
 	SDL_timer_threaded = 0;
 }
@@ -104,77 +302,117 @@ void SDL_TimerQuit(void)
 void SDL_ThreadedTimerCheck(void)
 {
 	Uint32 now, ms;
-	SDL_TimerID t, prev, next;
-	SDL_bool removed;
+	SDL_TimerID t;
 
 	SDL_mutexP(SDL_timer_mutex);
-	list_changed = SDL_FALSE;
 	now = SDL_GetTicks();
-	for ( prev = NULL, t = SDL_timers; t; t = next ) {
-		removed = SDL_FALSE;
-		ms = t->interval - SDL_TIMESLICE;
-		next = t->next;
-		if ( (int)(now - t->last_alarm) > (int)ms ) {
-			struct _SDL_TimerID timer;
-
-			if ( (now - t->last_alarm) < t->interval ) {
-				t->last_alarm += t->interval;
-			} else {
-				t->last_alarm = now;
-			}
+
+	/* Each timer runs at most once per check, since a timer that has
+	   fallen behind is rescheduled relative to 'now'. */
+	while ( SDL_timer_heap_size > 0 &&
+	        !TIMER_BEFORE(now, SDL_timer_heap[0]->deadline) ) {
+		t = SDL_timer_heap[0];
+		SDL_TimerHeapRemove(t);
 #ifdef DEBUG_TIMERS
-			printf("Executing timer %p (thread = %d)\n",
-				t, SDL_ThreadID());
+		printf("Executing timer %p (thread = %d)\n",
+			t, SDL_ThreadID());
 #endif
-			timer = *t;
-			SDL_mutexV(SDL_timer_mutex);
-			ms = timer.cb(timer.interval, timer.param);
-			SDL_mutexP(SDL_timer_mutex);
-			if ( list_changed ) {
-				/* Abort, list of timers modified */
-				/* FIXME: what if ms was changed? */
-				break;
-			}
-			if ( ms != t->interval ) {
-				if ( ms ) {
-					t->interval = ROUND_RESOLUTION(ms);
-				} else {
-					/* Remove timer from the list */
+		SDL_timer_current = t;
+		SDL_timer_current_removed = SDL_FALSE;
+		SDL_mutexV(SDL_timer_mutex);
+		ms = t->cb(t->interval, t->param);
+		SDL_mutexP(SDL_timer_mutex);
+		SDL_timer_current = NULL;
+
+		if ( SDL_timer_current_removed || !ms ) {
+			/* Remove timer */
 #ifdef DEBUG_TIMERS
-					printf("SDL: Removing timer %p\n", t);
+			printf("SDL: Removing timer %p\n", t);
 #endif
-					if ( prev ) {
-						prev->next = next;
-					} else {
-						SDL_timers = next;
-					}
-					SDL_free(t);
-					--SDL_timer_running;
-					removed = SDL_TRUE;
-				}
-			}
+			SDL_FreeTimer(t);
+			continue;
 		}
-		/* Don't update prev if the timer has disappeared */
-		if ( ! removed ) {
-			prev = t;
+
+		/* Keep to the original schedule unless we've fallen behind */
+		t->interval = ms;
+		t->deadline += ms;
+		if ( TIMER_BEFORE(t->deadline, now) ||
+		     (t->deadline == now) ) {
+			t->deadline = now + ms;
+		}
+		if ( SDL_TimerHeapInsert(t) < 0 ) {
+			SDL_FreeTimer(t);
 		}
 	}
 	SDL_mutexV(SDL_timer_mutex);
 }
 
+int SDL_ThreadedTimerTimeout(void)
+{
+	int timeout;
+
+	timeout = -1;
+	SDL_mutexP(SDL_timer_mutex);
+	if ( SDL_timer_heap_size > 0 ) {
+		timeout = (int)(SDL_timer_heap[0]->deadline - SDL_GetTicks());
+		if ( timeout < 0 ) {
+			timeout = 0;
+		}
+	}
+	SDL_mutexV(SDL_timer_mutex);
+	return(timeout);
+}
+
+void SDL_ThreadedTimerWait(void)
+{
+	int timeout;
+
+	SDL_mutexP(SDL_timer_mutex);
+	if ( ! SDL_timer_wakeup ) {
+		timeout = -1;
+		if ( SDL_timer_heap_size > 0 ) {
+			timeout = (int)(SDL_timer_heap[0]->deadline - SDL_GetTicks());
+		}
+		if ( timeout < 0 && SDL_timer_heap_size == 0 ) {
+			SDL_CondWait(SDL_timer_cond, SDL_timer_mutex);
+		} else if ( timeout > 0 ) {
+			SDL_CondWaitTimeout(SDL_timer_cond, SDL_timer_mutex,
+			                    (Uint32)timeout);
+		}
+	}
+	SDL_timer_wakeup = SDL_FALSE;
+	SDL_mutexV(SDL_timer_mutex);
+}
+
+void SDL_ThreadedTimerWakeup(void)
+{
+	SDL_mutexP(SDL_timer_mutex);
+	SDL_TimersChanged();
+	SDL_mutexV(SDL_timer_mutex);
+}
+
 static SDL_TimerID SDL_AddTimerInternal(Uint32 interval, SDL_NewTimerCallback callback, void *param)
 {
 	SDL_TimerID t;
-	t = (SDL_TimerID) SDL_malloc(sizeof(struct _SDL_TimerID));
+
+	if ( SDL_timer_pool ) {
+		t = SDL_timer_pool;
+		SDL_timer_pool = t->next;
+	} else {
+		t = (SDL_TimerID) SDL_malloc(sizeof(struct _SDL_TimerID));
+	}
 	if ( t ) {
-		t->interval = ROUND_RESOLUTION(interval);
+		t->interval = interval;
 		t->cb = callback;
 		t->param = param;
-		t->last_alarm = SDL_GetTicks();
-		t->next = SDL_timers;
-		SDL_timers = t;
+		t->deadline = SDL_GetTicks() + interval;
+		t->next = NULL;
 		++SDL_timer_running;
-		list_changed = SDL_TRUE;
+		if ( SDL_TimerHeapInsert(t) < 0 ) {
+			SDL_FreeTimer(t);
+			return NULL;
+		}
+		SDL_TimersChanged();
 	}
 #ifdef DEBUG_TIMERS
 	printf("SDL_AddTimer(%d) = %08x num_timers = %d\n", interval, (Uint32)t, SDL_timer_running);
@@ -200,30 +438,30 @@ SDL_TimerID SDL_AddTimer(Uint32 interval, SDL_NewTimerCallback callback, void *p
 	SDL_mutexP(SDL_timer_mutex);
 	t = SDL_AddTimerInternal(interval, callback, param);
 	SDL_mutexV(SDL_timer_mutex);
+	if ( SDL_timer_threaded == 2 ) {
+		/* Let the event thread know about the new deadline */
+		SDL_WakeupEventThread();
+	}
 	return t;
 }
 
 SDL_bool SDL_RemoveTimer(SDL_TimerID id)
 {
-	SDL_TimerID t, prev = NULL;
 	SDL_bool removed;
 
 	removed = SDL_FALSE;
+	if ( ! id || ! SDL_timer_mutex ) {
+		return removed;
+	}
 	SDL_mutexP(SDL_timer_mutex);
-	/* Look for id in the linked list of timers */
-	for (t = SDL_timers; t; prev=t, t = t->next ) {
-		if ( t == id ) {
-			if(prev) {
-				prev->next = t->next;
-			} else {
-				SDL_timers = t->next;
-			}
-			SDL_free(t);
-			--SDL_timer_running;
-			removed = SDL_TRUE;
-			list_changed = SDL_TRUE;
-			break;
-		}
+	if ( SDL_TimerScheduled(id) ) {
+		SDL_TimerHeapRemove(id);
+		SDL_FreeTimer(id);
+		removed = SDL_TRUE;
+	} else if ( (id == SDL_timer_current) && !SDL_timer_current_removed ) {
+		/* It's running, SDL_ThreadedTimerCheck() will free it */
+		SDL_timer_current_removed = SDL_TRUE;
+		removed = SDL_TRUE;
 	}
 #ifdef DEBUG_TIMERS
 	printf("SDL_RemoveTimer(%08x) = %d num_timers = %d thread = %d\n", (Uint32)id, removed, SDL_timer_running, SDL_ThreadID());
@@ -253,13 +491,7 @@ int SDL_SetTimer(Uint32 ms, SDL_TimerCallback callback)
 	}
 	if ( SDL_timer_running ) {	/* Stop any currently running timer */
 		if ( SDL_timer_threaded ) {
-			while ( SDL_timers ) {
-				SDL_TimerID freeme = SDL_timers;
-				SDL_timers = SDL_timers->next;
-				SDL_free(freeme);
-			}
-			SDL_timer_running = 0;
-			list_changed = SDL_TRUE;
+			SDL_RemoveAllTimers();
 		} else {
 			SDL_SYS_StopTimer();
 			SDL_timer_running = 0;
@@ -280,6 +512,9 @@ int SDL_SetTimer(Uint32 ms, SDL_TimerCallback callback)
 	if ( SDL_timer_threaded ) {
 		SDL_mutexV(SDL_timer_mutex);
 	}
+	if ( SDL_timer_threaded == 2 ) {
+		SDL_WakeupEventThread();
+	}
 
 	return retval;
 }
@@ -44,3 +44,12 @@ extern void SDL_TimerQuit(void);
 
 /* This function is called from the SDL event thread if it is available */
 extern void SDL_ThreadedTimerCheck(void);
+
+/* Milliseconds until SDL_ThreadedTimerCheck() has work to do, or -1 */
+extern int SDL_ThreadedTimerTimeout(void);
+
+/* Used by timer threads to sleep until the next timer is due, or until
+   SDL_ThreadedTimerWakeup() is called.
+ */
+extern void SDL_ThreadedTimerWait(void);
+extern void SDL_ThreadedTimerWakeup(void);
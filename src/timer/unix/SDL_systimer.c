@@ -50,6 +50,16 @@
 #define USE_ITIMER
 #endif
 
+/* The performance counter uses clock_gettime() even when SDL_GetTicks()
+   doesn't, if it's in the C library (glibc 2.17 and newer).
+ */
+#if HAVE_CLOCK_GETTIME
+#define USE_PERF_CLOCK_GETTIME
+#elif defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 17)))
+#define USE_PERF_CLOCK_GETTIME
+#include <time.h>
+#endif
+
 /* The first ticks value of the application */
 #ifdef HAVE_CLOCK_GETTIME
 static struct timespec start;
@@ -58,8 +68,25 @@ static struct timeval start;
 #endif /* HAVE_CLOCK_GETTIME */
 
 
+#ifdef USE_PERF_CLOCK_GETTIME
+/* CLOCK_MONOTONIC_RAW isn't slewed by NTP, if the kernel has it */
+static clockid_t perf_clock = CLOCK_MONOTONIC;
+
+/* How much clock_nanosleep() tends to overshoot, in nanoseconds */
+static Uint32 sleep_slop = 100000;
+#endif
+
 void SDL_StartTicks(void)
 {
+#ifdef USE_PERF_CLOCK_GETTIME
+#ifdef CLOCK_MONOTONIC_RAW
+	struct timespec now;
+	if ( clock_gettime(CLOCK_MONOTONIC_RAW, &now) == 0 ) {
+		perf_clock = CLOCK_MONOTONIC_RAW;
+	}
+#endif
+#endif
+
 	/* Set first ticks value */
 #if HAVE_CLOCK_GETTIME
 	clock_gettime(CLOCK_MONOTONIC,&start);
@@ -68,6 +95,96 @@ void SDL_StartTicks(void)
 #endif
 }
 
+#ifdef SDL_HAS_64BIT_TYPE
+Uint64 SDL_GetPerformanceCounter(void)
+{
+#ifdef USE_PERF_CLOCK_GETTIME
+	struct timespec now;
+
+	clock_gettime(perf_clock, &now);
+	return((Uint64)now.tv_sec * 1000000000 + now.tv_nsec);
+#else
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return((Uint64)now.tv_sec * 1000000 + now.tv_usec);
+#endif
+}
+
+Uint64 SDL_GetPerformanceFrequency(void)
+{
+#ifdef USE_PERF_CLOCK_GETTIME
+	return(1000000000);
+#else
+	return(1000000);
+#endif
+}
+
+void SDL_DelayPrecise(Uint64 ns)
+{
+#if defined(USE_PERF_CLOCK_GETTIME) && defined(TIMER_ABSTIME)
+	struct timespec deadline, wake, now;
+	Uint64 target;
+	Sint64 overshoot;
+
+	/* Sleep until just before the deadline on the clock we measure
+	   with, then spin for the rest.  clock_nanosleep() can't sleep on
+	   CLOCK_MONOTONIC_RAW, but the two clocks only differ by NTP slew.
+	 */
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	target = (Uint64)now.tv_sec * 1000000000 + now.tv_nsec + ns;
+	deadline.tv_sec = (time_t)(target / 1000000000);
+	deadline.tv_nsec = (long)(target % 1000000000);
+	if ( ns > sleep_slop ) {
+		target -= sleep_slop;
+		wake.tv_sec = (time_t)(target / 1000000000);
+		wake.tv_nsec = (long)(target % 1000000000);
+		while ( clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+		                        &wake, NULL) == EINTR ) {
+			;
+		}
+
+		/* Track how late we wake up, to sleep as long as is safe */
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		overshoot = (Sint64)(now.tv_sec - wake.tv_sec) * 1000000000 +
+		            (now.tv_nsec - wake.tv_nsec);
+		if ( overshoot < 0 ) {
+			overshoot = 0;
+		} else if ( overshoot > 2000000 ) {
+			overshoot = 2000000;
+		}
+		/* Settle on about twice the usual overshoot */
+		sleep_slop = (Uint32)((sleep_slop * 7 + overshoot * 2) / 8);
+		if ( sleep_slop < 20000 ) {
+			sleep_slop = 20000;
+		}
+	}
+	do {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+	} while ( (now.tv_sec < deadline.tv_sec) ||
+	          ((now.tv_sec == deadline.tv_sec) &&
+	           (now.tv_nsec < deadline.tv_nsec)) );
+#else
+	Uint64 start, target, now, freq;
+
+	freq = SDL_GetPerformanceFrequency();
+	start = SDL_GetPerformanceCounter();
+	target = start + (ns / 1000000000) * freq +
+	         (ns % 1000000000) * freq / 1000000000;
+
+	/* SDL_Delay() is good to about a millisecond here */
+	now = start;
+	while ( (now < target) && ((target - now) * 1000 / freq > 2) ) {
+		SDL_Delay((Uint32)((target - now) * 1000 / freq) - 2);
+		now = SDL_GetPerformanceCounter();
+	}
+	while ( now < target ) {
+		now = SDL_GetPerformanceCounter();
+	}
+#endif
+}
+#endif /* SDL_HAS_64BIT_TYPE */
+
 Uint32 SDL_GetTicks (void)
 {
 #if HAVE_CLOCK_GETTIME
@@ -200,7 +317,7 @@ static int RunTimer(void *unused)
 		if ( SDL_timer_running ) {
 			SDL_ThreadedTimerCheck();
 		}
-		SDL_Delay(1);
+		SDL_ThreadedTimerWait();
 	}
 	return(0);
 }
@@ -219,6 +336,7 @@ void SDL_SYS_TimerQuit(void)
 {
 	timer_alive = 0;
 	if ( timer ) {
+		SDL_ThreadedTimerWakeup();
 		SDL_WaitThread(timer, NULL);
 		timer = NULL;
 	}
@@ -109,6 +109,28 @@ void SDL_Delay(Uint32 ms)
 	Sleep(ms);
 }
 
+#ifdef SDL_HAS_64BIT_TYPE
+Uint64 SDL_GetPerformanceCounter(void)
+{
+	LARGE_INTEGER counter;
+
+	if ( !QueryPerformanceCounter(&counter) ) {
+		return(timeGetTime());
+	}
+	return(counter.QuadPart);
+}
+
+Uint64 SDL_GetPerformanceFrequency(void)
+{
+	LARGE_INTEGER frequency;
+
+	if ( !QueryPerformanceFrequency(&frequency) ) {
+		return(1000);
+	}
+	return(frequency.QuadPart);
+}
+#endif
+
 /* Data to handle a single periodic alarm */
 static UINT timerID = 0;
 
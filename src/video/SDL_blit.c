@@ -26,6 +26,7 @@
 #include "SDL_blit.h"
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
+#include "../stdlib/SDL_copyrows_c.h"
 
 #if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && SDL_ASSEMBLY_ROUTINES
 #define MMX_ASMBLIT
@@ -165,8 +166,9 @@ static void SDL_BlitCopy(SDL_BlitInfo *info)
 	srcskip = w+info->s_skip;
 	dstskip = w+info->d_skip;
 
+	/* SDL_CopyRows() does better on anything with SSE2 */
 #ifdef SSE_ASMBLIT
-	if(SDL_HasSSE())
+	if(SDL_HasSSE() && !SDL_HasSSE2())
 	{
 		while ( h-- ) {
 			SDL_memcpySSE(dst, src, w);
@@ -180,7 +182,7 @@ static void SDL_BlitCopy(SDL_BlitInfo *info)
 	else
 #endif
 #ifdef MMX_ASMBLIT
-	if(SDL_HasMMX())
+	if(SDL_HasMMX() && !SDL_HasSSE2())
 	{
 		while ( h-- ) {
 			SDL_memcpyMMX(dst, src, w);
@@ -193,11 +195,7 @@ static void SDL_BlitCopy(SDL_BlitInfo *info)
 	}
 	else
 #endif
-	while ( h-- ) {
-		SDL_memcpy(dst, src, w);
-		src += srcskip;
-		dst += dstskip;
-	}
+	SDL_CopyRows(dst, dstskip, src, srcskip, w, h);
 }
 
 static void SDL_BlitCopyOverlap(SDL_BlitInfo *info)
@@ -219,13 +217,7 @@ static void SDL_BlitCopyOverlap(SDL_BlitInfo *info)
 			dst += dstskip;
 		}
 	} else {
-		src += ((h-1) * srcskip);
-		dst += ((h-1) * dstskip);
-		while ( h-- ) {
-			SDL_revcpy(dst, src, w);
-			src -= srcskip;
-			dst -= dstskip;
-		}
+		SDL_CopyRowsReverse(dst, dstskip, src, srcskip, w, h);
 	}
 }
 
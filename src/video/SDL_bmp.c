@@ -35,6 +35,7 @@
 
 #include "SDL_video.h"
 #include "SDL_endian.h"
+#include "../file/SDL_endian_c.h"
 
 /* Compression encodings for BMP files */
 #ifndef BI_RGB
@@ -55,11 +56,15 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 	Uint32 Rmask;
 	Uint32 Gmask;
 	Uint32 Bmask;
+	Uint32 masks[3];
+	Uint32 colors[256];
 	SDL_Palette *palette;
 	Uint8 *bits;
 	Uint8 *top, *end;
 	SDL_bool topDown;
 	int ExpandBMP;
+	const Uint8 *mapped, *mapstart;
+	size_t maplen;
 
 	/* The Win32 BMP file header (14 bytes) */
 	char   magic[2];
@@ -220,9 +225,11 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 				case 15:
 				case 16:
 				case 32:
-					Rmask = SDL_ReadLE32(src);
-					Gmask = SDL_ReadLE32(src);
-					Bmask = SDL_ReadLE32(src);
+					SDL_memset(masks, 0, sizeof(masks));
+					SDL_ReadLE32Array(src, masks, 3);
+					Rmask = masks[0];
+					Gmask = masks[1];
+					Bmask = masks[2];
 					break;
 				default:
 					break;
@@ -252,20 +259,25 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			was_error = SDL_TRUE;
 			goto done;
 		}
+		/* The colors are stored as BGR or BGRA, read them all at once */
+		SDL_memset(colors, 0, sizeof(colors));
 		if ( biSize == 12 ) {
+			Uint8 *bgr = (Uint8 *)colors;
+			SDL_RWread(src, bgr, 3, biClrUsed);
 			for ( i = 0; i < (int)biClrUsed; ++i ) {
-				SDL_RWread(src, &palette->colors[i].b, 1, 1);
-				SDL_RWread(src, &palette->colors[i].g, 1, 1);
-				SDL_RWread(src, &palette->colors[i].r, 1, 1);
+				palette->colors[i].b = bgr[i*3+0];
+				palette->colors[i].g = bgr[i*3+1];
+				palette->colors[i].r = bgr[i*3+2];
 				palette->colors[i].unused = 0;
-			}	
+			}
 		} else {
+			SDL_ReadLE32Array(src, colors, biClrUsed);
 			for ( i = 0; i < (int)biClrUsed; ++i ) {
-				SDL_RWread(src, &palette->colors[i].b, 1, 1);
-				SDL_RWread(src, &palette->colors[i].g, 1, 1);
-				SDL_RWread(src, &palette->colors[i].r, 1, 1);
-				SDL_RWread(src, &palette->colors[i].unused, 1, 1);
-			}	
+				palette->colors[i].b = (Uint8)colors[i];
+				palette->colors[i].g = (Uint8)(colors[i] >> 8);
+				palette->colors[i].r = (Uint8)(colors[i] >> 16);
+				palette->colors[i].unused = (Uint8)(colors[i] >> 24);
+			}
 		}
 		palette->ncolors = biClrUsed;
 	}
@@ -288,6 +300,7 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			pad  = (((bmpPitch)%4) ? (4-((bmpPitch)%4)) : 0);
 			break;
 		default:
+			bmpPitch = surface->pitch;
 			pad  = ((surface->pitch%4) ?
 					(4-(surface->pitch%4)) : 0);
 			break;
@@ -297,6 +310,15 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 	} else {
 		bits = end - surface->pitch;
 	}
+
+	/* If the whole image is in memory, use it from there */
+	mapped = (const Uint8 *)SDL_RWmap(src, &maplen);
+	if ( mapped && maplen < (size_t)surface->h *
+	     (bmpPitch + pad) ) {
+		mapped = NULL;
+	}
+	mapstart = mapped;
+
 	while ( bits >= top && bits < end ) {
 		switch (ExpandBMP) {
 			case 1:
@@ -305,7 +327,9 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			int   shift = (8-ExpandBMP);
 			for ( i=0; i<surface->w; ++i ) {
 				if ( i%(8/ExpandBMP) == 0 ) {
-					if ( !SDL_RWread(src, &pixel, 1, 1) ) {
+					if ( mapped ) {
+						pixel = *mapped++;
+					} else if ( !SDL_RWread(src, &pixel, 1, 1) ) {
 						SDL_SetError(
 					"Error reading from BMP");
 						was_error = SDL_TRUE;
@@ -324,7 +348,10 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			break;
 
 			default:
-			if ( SDL_RWread(src, bits, 1, surface->pitch)
+			if ( mapped ) {
+				SDL_memcpy(bits, mapped, surface->pitch);
+				mapped += surface->pitch;
+			} else if ( SDL_RWread(src, bits, 1, surface->pitch)
 							 != surface->pitch ) {
 				SDL_Error(SDL_EFREAD);
 				was_error = SDL_TRUE;
@@ -340,30 +367,23 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 					}
 				}
 			}
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
 			/* Byte-swap the pixels if needed. Note that the 24bpp
 			   case has already been taken care of above. */
 			switch(biBitCount) {
 				case 15:
-				case 16: {
-				        Uint16 *pix = (Uint16 *)bits;
-					for(i = 0; i < surface->w; i++)
-					        pix[i] = SDL_Swap16(pix[i]);
+				case 16:
+					SDL_SwapArrayLE16((Uint16 *)bits, surface->w);
 					break;
-				}
-
-				case 32: {
-				        Uint32 *pix = (Uint32 *)bits;
-					for(i = 0; i < surface->w; i++)
-					        pix[i] = SDL_Swap32(pix[i]);
+				case 32:
+					SDL_SwapArrayLE32((Uint32 *)bits, surface->w);
 					break;
-				}
 			}
-#endif
 			break;
 		}
 		/* Skip padding bytes, ugh */
-		if ( pad ) {
+		if ( mapped ) {
+			mapped += pad;
+		} else if ( pad ) {
 			Uint8 padbyte;
 			for ( i=0; i<pad; ++i ) {
 				SDL_RWread(src, &padbyte, 1, 1);
@@ -375,6 +395,9 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			bits -= surface->pitch;
 		}
 	}
+	if ( mapped ) {
+		SDL_RWseek(src, (int)(mapped - mapstart), RW_SEEK_CUR);
+	}
 done:
 	if ( was_error ) {
 		if ( src ) {
@@ -521,15 +544,20 @@ int SDL_SaveBMP_RW (SDL_Surface *saveme, SDL_RWops *dst, int freedst)
 		if ( surface->format->palette ) {
 			SDL_Color *colors;
 			int       ncolors;
+			Uint32    bgra[256];
 
 			colors = surface->format->palette->colors;
 			ncolors = surface->format->palette->ncolors;
+			if ( ncolors > 256 ) {
+				ncolors = 256;
+			}
 			for ( i=0; i<ncolors; ++i ) {
-				SDL_RWwrite(dst, &colors[i].b, 1, 1);
-				SDL_RWwrite(dst, &colors[i].g, 1, 1);
-				SDL_RWwrite(dst, &colors[i].r, 1, 1);
-				SDL_RWwrite(dst, &colors[i].unused, 1, 1);
+				bgra[i] = (Uint32)colors[i].b |
+				          ((Uint32)colors[i].g << 8) |
+				          ((Uint32)colors[i].r << 16) |
+				          ((Uint32)colors[i].unused << 24);
 			}
+			SDL_WriteLE32Array(dst, bgra, ncolors);
 		}
 
 		/* Write the bitmap offset */
@@ -0,0 +1,193 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Frame pacing support */
+
+#include "SDL_timer.h"
+#include "SDL_sysvideo.h"
+
+
+Uint32 SDL_GetRefreshInterval(void)
+{
+	SDL_VideoDevice *video = current_video;
+	SDL_VideoDevice *this  = current_video;
+
+	if ( video && video->GetRefreshInterval ) {
+		return video->GetRefreshInterval(this);
+	}
+	return(0);
+}
+
+#ifdef SDL_HAS_64BIT_TYPE
+
+/* How close the interval must be to a whole number of refresh periods
+   for frames to be lined up with vertical retrace, in 1/1000ths */
+#define VBLANK_TOLERANCE	20
+
+static struct {
+	Uint32 interval;	/* Target interval in microseconds, or 0 */
+	Uint64 freq;		/* Performance counter frequency */
+	Uint64 period;		/* Target interval in counter ticks */
+	Uint64 refresh;		/* Refresh period in counter ticks, if synced */
+	Uint64 deadline;	/* Counter value the current frame ends at */
+	Uint64 last;		/* Counter value the last frame ended at */
+	int started;
+	SDL_FrameStats stats;
+	double total;
+} pacer;
+
+static Uint64 SDL_TicksToNS(Uint64 ticks)
+{
+	if ( pacer.freq == 1000000000 ) {
+		return ticks;
+	}
+	return (ticks * 1000000) / (pacer.freq / 1000);
+}
+
+void SDL_SetFrameInterval(Uint32 usec)
+{
+	Uint32 refresh;
+
+	pacer.freq = SDL_GetPerformanceFrequency();
+	pacer.interval = usec;
+	pacer.period = ((Uint64)usec * pacer.freq) / 1000000;
+	pacer.refresh = 0;
+	pacer.started = 0;
+
+	/* Line up with the retrace if the interval is a whole number of
+	   refresh periods and the driver can wait for one */
+	refresh = SDL_GetRefreshInterval();
+	if ( usec && refresh && current_video && current_video->WaitVBlank ) {
+		Uint32 frames = (usec + refresh / 2) / refresh;
+		Uint32 error;
+
+		if ( frames > 0 ) {
+			error = (usec > frames * refresh) ?
+			        (usec - frames * refresh) : (frames * refresh - usec);
+			if ( (Uint64)error * 1000 <=
+			     (Uint64)refresh * frames * VBLANK_TOLERANCE ) {
+				pacer.refresh = ((Uint64)refresh * pacer.freq) / 1000000;
+			}
+		}
+	}
+	pacer.stats.interval = usec;
+}
+
+static void SDL_UpdateFrameStats(Uint32 frame)
+{
+	SDL_FrameStats *stats = &pacer.stats;
+	int bin;
+
+	if ( stats->frames == 0 || frame < stats->frame_min ) {
+		stats->frame_min = frame;
+	}
+	if ( frame > stats->frame_max ) {
+		stats->frame_max = frame;
+	}
+	++stats->frames;
+	pacer.total += frame;
+	stats->frame_avg = (Uint32)(pacer.total / stats->frames);
+
+	bin = ((int)frame - (int)stats->interval + SDL_FRAME_HISTOGRAM_STEP/2);
+	if ( bin < 0 ) {
+		bin = (bin + 1) / SDL_FRAME_HISTOGRAM_STEP - 1;
+	} else {
+		bin = bin / SDL_FRAME_HISTOGRAM_STEP;
+	}
+	bin += SDL_FRAME_HISTOGRAM_BINS/2;
+	if ( bin < 0 ) {
+		bin = 0;
+	} else if ( bin >= SDL_FRAME_HISTOGRAM_BINS ) {
+		bin = SDL_FRAME_HISTOGRAM_BINS-1;
+	}
+	++stats->histogram[bin];
+}
+
+Uint32 SDL_PaceFrame(void)
+{
+	Uint64 now;
+	Uint32 frame;
+
+	if ( ! pacer.freq ) {
+		pacer.freq = SDL_GetPerformanceFrequency();
+	}
+	now = SDL_GetPerformanceCounter();
+	if ( ! pacer.started ) {
+		pacer.started = 1;
+		pacer.last = now;
+		pacer.deadline = now + pacer.period;
+		return(0);
+	}
+
+	if ( pacer.period ) {
+		if ( now > pacer.deadline ) {
+			++pacer.stats.missed;
+		} else {
+			if ( pacer.refresh ) {
+				/* Sleep to within half a refresh of the deadline,
+				   and let the retrace decide the exact time */
+				Uint64 target = pacer.deadline - pacer.refresh / 2;
+				if ( now < target ) {
+					SDL_DelayPrecise(SDL_TicksToNS(target - now));
+				}
+				if ( current_video && current_video->WaitVBlank &&
+				     current_video->WaitVBlank(current_video) == 0 ) {
+					/* Follow the display clock from here on */
+					pacer.deadline = SDL_GetPerformanceCounter();
+				}
+			}
+			now = SDL_GetPerformanceCounter();
+			if ( now < pacer.deadline ) {
+				SDL_DelayPrecise(SDL_TicksToNS(pacer.deadline - now));
+				now = SDL_GetPerformanceCounter();
+			}
+		}
+
+		/* Keep to the schedule, unless we've dropped a whole frame */
+		if ( now > pacer.deadline &&
+		     now - pacer.deadline >= pacer.period ) {
+			pacer.deadline = now + pacer.period;
+		} else {
+			pacer.deadline += pacer.period;
+		}
+	}
+
+	frame = (Uint32)(((now - pacer.last) * 1000000) / pacer.freq);
+	pacer.last = now;
+	SDL_UpdateFrameStats(frame);
+	return(frame);
+}
+
+void SDL_GetFrameStats(SDL_FrameStats *stats)
+{
+	*stats = pacer.stats;
+}
+
+void SDL_ResetFrameStats(void)
+{
+	SDL_memset(&pacer.stats, 0, sizeof(pacer.stats));
+	pacer.stats.interval = pacer.interval;
+	pacer.total = 0.0;
+}
+
+#endif /* SDL_HAS_64BIT_TYPE */
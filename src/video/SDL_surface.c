@@ -29,6 +29,7 @@
 #include "SDL_pixels_c.h"
 #include "SDL_leaks.h"
 #include "SDL_cpuinfo.h"
+#include "../stdlib/SDL_copyrows_c.h"
 
 
 /* Public routines */
@@ -548,59 +549,14 @@ static int SDL_FillRect4(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 	return -1;
 }
 
-/* 
- * This function performs a fast fill of the given rectangle with 'color'
+/*
+ * Fill an already clipped rectangle of a locked software surface
  */
-int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
+static void SDL_FillRectLocked(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 {
-	SDL_VideoDevice *video = current_video;
-	SDL_VideoDevice *this  = current_video;
-	int x, y;
+	int x;
 	Uint8 *row;
 
-	/* This function doesn't work on surfaces < 8 bpp */
-	if ( dst->format->BitsPerPixel < 8 ) {
-		switch(dst->format->BitsPerPixel) {
-		    case 1:
-			return SDL_FillRect1(dst, dstrect, color);
-			break;
-		    case 4:
-			return SDL_FillRect4(dst, dstrect, color);
-			break;
-		    default:
-			SDL_SetError("Fill rect on unsupported surface format");
-			return(-1);
-			break;
-		}
-	}
-
-	/* If 'dstrect' == NULL, then fill the whole surface */
-	if ( dstrect ) {
-		/* Perform clipping */
-		if ( !SDL_IntersectRect(dstrect, &dst->clip_rect, dstrect) ) {
-			return(0);
-		}
-	} else {
-		dstrect = &dst->clip_rect;
-	}
-
-	/* Check for hardware acceleration */
-	if ( ((dst->flags & SDL_HWSURFACE) == SDL_HWSURFACE) &&
-					video->info.blit_fill ) {
-		SDL_Rect hw_rect;
-		if ( dst == SDL_VideoSurface ) {
-			hw_rect = *dstrect;
-			hw_rect.x += current_video->offset_x;
-			hw_rect.y += current_video->offset_y;
-			dstrect = &hw_rect;
-		}
-		return(video->FillHWRect(this, dst, dstrect, color));
-	}
-
-	/* Perform software fill */
-	if ( SDL_LockSurface(dst) != 0 ) {
-		return(-1);
-	}
 	row = (Uint8 *)dst->pixels+dstrect->y*dst->pitch+
 			dstrect->x*dst->format->BytesPerPixel;
 #if SDL_ARM_NEON_BLITTERS
@@ -620,8 +576,7 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
             break;
         }
 
-        SDL_UnlockSurface(dst);
-        return(0);
+        return;
     }
 #endif
 #if SDL_ARM_SIMD_BLITTERS
@@ -641,138 +596,225 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 			break;
 		}
 
-		SDL_UnlockSurface(dst);
-		return(0);
+		return;
 	}
 #endif
 	if ( dst->format->palette || (color == 0) ) {
 		x = dstrect->w*dst->format->BytesPerPixel;
-		if ( !color && !((uintptr_t)row&3) && !(x&3) && !(dst->pitch&3) ) {
-			int n = x >> 2;
-			for ( y=dstrect->h; y; --y ) {
-				SDL_memset4(row, 0, n);
-				row += dst->pitch;
-			}
-		} else {
 #ifdef __powerpc__
-			/*
-			 * SDL_memset() on PPC (both glibc and codewarrior) uses
-			 * the dcbz (Data Cache Block Zero) instruction, which
-			 * causes an alignment exception if the destination is
-			 * uncachable, so only use it on software surfaces
-			 */
-			if((dst->flags & SDL_HWSURFACE) == SDL_HWSURFACE) {
-				if(dstrect->w >= 8) {
-					/*
-					 * 64-bit stores are probably most
-					 * efficient to uncached video memory
-					 */
-					double fill;
-					SDL_memset(&fill, color, (sizeof fill));
-					for(y = dstrect->h; y; y--) {
-						Uint8 *d = row;
-						unsigned n = x;
-						unsigned nn;
-						Uint8 c = color;
-						double f = fill;
-						while((unsigned long)d
-						      & (sizeof(double) - 1)) {
-							*d++ = c;
-							n--;
-						}
-						nn = n / (sizeof(double) * 4);
-						while(nn) {
-							((double *)d)[0] = f;
-							((double *)d)[1] = f;
-							((double *)d)[2] = f;
-							((double *)d)[3] = f;
-							d += 4*sizeof(double);
-							nn--;
-						}
-						n &= ~(sizeof(double) * 4 - 1);
-						nn = n / sizeof(double);
-						while(nn) {
-							*(double *)d = f;
-							d += sizeof(double);
-							nn--;
-						}
-						n &= ~(sizeof(double) - 1);
-						while(n) {
-							*d++ = c;
-							n--;
-						}
-						row += dst->pitch;
+		/*
+		 * SDL_memset() on PPC (both glibc and codewarrior) uses
+		 * the dcbz (Data Cache Block Zero) instruction, which
+		 * causes an alignment exception if the destination is
+		 * uncachable, so only use it on software surfaces
+		 */
+		if((dst->flags & SDL_HWSURFACE) == SDL_HWSURFACE) {
+			int y;
+			if ( !color && !((uintptr_t)row&3) && !(x&3) && !(dst->pitch&3) ) {
+				int n = x >> 2;
+				for ( y=dstrect->h; y; --y ) {
+					SDL_memset4(row, 0, n);
+					row += dst->pitch;
+				}
+			} else if(dstrect->w >= 8) {
+				/*
+				 * 64-bit stores are probably most
+				 * efficient to uncached video memory
+				 */
+				double fill;
+				SDL_memset(&fill, color, (sizeof fill));
+				for(y = dstrect->h; y; y--) {
+					Uint8 *d = row;
+					unsigned n = x;
+					unsigned nn;
+					Uint8 c = color;
+					double f = fill;
+					while((unsigned long)d
+					      & (sizeof(double) - 1)) {
+						*d++ = c;
+						n--;
 					}
-				} else {
-					/* narrow boxes */
-					for(y = dstrect->h; y; y--) {
-						Uint8 *d = row;
-						Uint8 c = color;
-						int n = x;
-						while(n) {
-							*d++ = c;
-							n--;
-						}
-						row += dst->pitch;
+					nn = n / (sizeof(double) * 4);
+					while(nn) {
+						((double *)d)[0] = f;
+						((double *)d)[1] = f;
+						((double *)d)[2] = f;
+						((double *)d)[3] = f;
+						d += 4*sizeof(double);
+						nn--;
 					}
+					n &= ~(sizeof(double) * 4 - 1);
+					nn = n / sizeof(double);
+					while(nn) {
+						*(double *)d = f;
+						d += sizeof(double);
+						nn--;
+					}
+					n &= ~(sizeof(double) - 1);
+					while(n) {
+						*d++ = c;
+						n--;
+					}
+					row += dst->pitch;
 				}
-			} else
-#endif /* __powerpc__ */
-			{
+			} else {
+				/* narrow boxes */
 				for(y = dstrect->h; y; y--) {
-					SDL_memset(row, color, x);
+					Uint8 *d = row;
+					Uint8 c = color;
+					int n = x;
+					while(n) {
+						*d++ = c;
+						n--;
+					}
 					row += dst->pitch;
 				}
 			}
-		}
+		} else
+#endif /* __powerpc__ */
+		SDL_FillRows(row, dst->pitch, (color & 0xFF) * 0x01010101, x, dstrect->h);
 	} else {
 		switch (dst->format->BytesPerPixel) {
 		    case 2:
-			for ( y=dstrect->h; y; --y ) {
-				Uint16 *pixels = (Uint16 *)row;
-				Uint16 c = (Uint16)color;
-				Uint32 cc = (Uint32)c << 16 | c;
-				int n = dstrect->w;
-				if((uintptr_t)pixels & 3) {
-					*pixels++ = c;
-					n--;
-				}
-				if(n >> 1)
-					SDL_memset4(pixels, cc, n >> 1);
-				if(n & 1)
-					pixels[n - 1] = c;
-				row += dst->pitch;
-			}
+			SDL_FillRows(row, dst->pitch, (color & 0xFFFF) * 0x00010001,
+			             dstrect->w * 2, dstrect->h);
 			break;
 
 		    case 3:
 			#if SDL_BYTEORDER == SDL_BIG_ENDIAN
 				color <<= 8;
 			#endif
-			for ( y=dstrect->h; y; --y ) {
-				Uint8 *pixels = row;
-				for ( x=dstrect->w; x; --x ) {
-					SDL_memcpy(pixels, &color, 3);
-					pixels += 3;
-				}
-				row += dst->pitch;
-			}
+			SDL_FillRows3(row, dst->pitch, (Uint8 *)&color,
+			              dstrect->w * 3, dstrect->h);
 			break;
 
 		    case 4:
-			for(y = dstrect->h; y; --y) {
-				SDL_memset4(row, color, dstrect->w);
-				row += dst->pitch;
-			}
+			SDL_FillRows(row, dst->pitch, color, dstrect->w * 4, dstrect->h);
 			break;
 		}
 	}
+}
+
+/* 
+ * This function performs a fast fill of the given rectangle with 'color'
+ */
+int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
+{
+	SDL_VideoDevice *video = current_video;
+	SDL_VideoDevice *this  = current_video;
+
+	/* This function doesn't work on surfaces < 8 bpp */
+	if ( dst->format->BitsPerPixel < 8 ) {
+		switch(dst->format->BitsPerPixel) {
+		    case 1:
+			return SDL_FillRect1(dst, dstrect, color);
+			break;
+		    case 4:
+			return SDL_FillRect4(dst, dstrect, color);
+			break;
+		    default:
+			SDL_SetError("Fill rect on unsupported surface format");
+			return(-1);
+			break;
+		}
+	}
+
+	/* If 'dstrect' == NULL, then fill the whole surface */
+	if ( dstrect ) {
+		/* Perform clipping */
+		if ( !SDL_IntersectRect(dstrect, &dst->clip_rect, dstrect) ) {
+			return(0);
+		}
+	} else {
+		dstrect = &dst->clip_rect;
+	}
+
+	/* Check for hardware acceleration */
+	if ( ((dst->flags & SDL_HWSURFACE) == SDL_HWSURFACE) &&
+					video->info.blit_fill ) {
+		SDL_Rect hw_rect;
+		if ( dst == SDL_VideoSurface ) {
+			hw_rect = *dstrect;
+			hw_rect.x += current_video->offset_x;
+			hw_rect.y += current_video->offset_y;
+			dstrect = &hw_rect;
+		}
+		return(video->FillHWRect(this, dst, dstrect, color));
+	}
+
+	/* Perform software fill */
+	if ( SDL_LockSurface(dst) != 0 ) {
+		return(-1);
+	}
+	SDL_FillRectLocked(dst, dstrect, color);
 	SDL_UnlockSurface(dst);
 
 	/* We're done! */
 	return(0);
 }
 
+/*
+ * Fill a batch of rectangles, clipping them all and locking only once
+ */
+int SDL_FillRects(SDL_Surface *dst, SDL_Rect *rects, int n, Uint32 color)
+{
+	SDL_VideoDevice *video = current_video;
+	SDL_VideoDevice *this  = current_video;
+	int i;
+
+	if ( n > 0 && !rects ) {
+		SDL_SetError("SDL_FillRects() passed NULL rects");
+		return(-1);
+	}
+
+	/* The packed pixel formats go through SDL_FillRect() for the error */
+	if ( dst->format->BitsPerPixel < 8 ) {
+		for ( i = 0; i < n; ++i ) {
+			if ( SDL_FillRect(dst, &rects[i], color) < 0 ) {
+				return(-1);
+			}
+		}
+		return(0);
+	}
+
+	/* Perform clipping, empty rectangles are skipped below */
+	for ( i = 0; i < n; ++i ) {
+		SDL_IntersectRect(&rects[i], &dst->clip_rect, &rects[i]);
+	}
+
+	/* Check for hardware acceleration */
+	if ( ((dst->flags & SDL_HWSURFACE) == SDL_HWSURFACE) &&
+					video->info.blit_fill ) {
+		SDL_Rect hw_rect;
+		for ( i = 0; i < n; ++i ) {
+			if ( !rects[i].w || !rects[i].h ) {
+				continue;
+			}
+			hw_rect = rects[i];
+			if ( dst == SDL_VideoSurface ) {
+				hw_rect.x += current_video->offset_x;
+				hw_rect.y += current_video->offset_y;
+			}
+			if ( video->FillHWRect(this, dst, &hw_rect, color) < 0 ) {
+				return(-1);
+			}
+		}
+		return(0);
+	}
+
+	/* Perform software fill */
+	if ( SDL_LockSurface(dst) != 0 ) {
+		return(-1);
+	}
+	for ( i = 0; i < n; ++i ) {
+		if ( rects[i].w && rects[i].h ) {
+			SDL_FillRectLocked(dst, &rects[i], color);
+		}
+	}
+	SDL_UnlockSurface(dst);
+	return(0);
+}
+
 /*
  * Lock a surface to directly access the pixels
  */
@@ -147,6 +147,12 @@ struct SDL_VideoDevice {
 	/* Frees a previously allocated video surface */
 	void (*FreeHWSurface)(_THIS, SDL_Surface *surface);
 
+	/* Returns the display refresh period in microseconds, or 0 */
+	Uint32 (*GetRefreshInterval)(_THIS);
+
+	/* Waits for the next vertical retrace, or returns -1 if it can't */
+	int (*WaitVBlank)(_THIS);
+
 	/* * * */
 	/* Gamma support */
 
@@ -258,6 +264,14 @@ struct SDL_VideoDevice {
 	/* Handle any queued OS events */
 	void (*PumpEvents)(_THIS);
 
+	/* Store up to 'maxfds' file descriptors that become readable when
+	   PumpEvents() has something to do, and return how many there are,
+	   or -1 if the driver has to be polled.  If PumpEvents() needs to
+	   run again after some time without input, 'timeout' is lowered to
+	   that many milliseconds (it starts at -1, for no limit).
+	 */
+	int (*GetEventFDs)(_THIS, int *fds, int maxfds, int *timeout);
+
 	/* * * */
 	/* Data common to all drivers */
 	SDL_Surface *screen;
@@ -36,6 +36,12 @@ void DUMMY_PumpEvents(_THIS)
 	/* do nothing. */
 }
 
+int DUMMY_GetEventFDs(_THIS, int *fds, int maxfds, int *timeout)
+{
+	/* There is never any input to wait for */
+	return(0);
+}
+
 void DUMMY_InitOSKeymap(_THIS)
 {
 	/* do nothing. */
@@ -28,6 +28,7 @@
 */
 extern void DUMMY_InitOSKeymap(_THIS);
 extern void DUMMY_PumpEvents(_THIS);
+extern int DUMMY_GetEventFDs(_THIS, int *fds, int maxfds, int *timeout);
 
 /* end of SDL_nullevents_c.h ... */
 
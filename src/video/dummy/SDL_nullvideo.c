@@ -126,6 +126,7 @@ static SDL_VideoDevice *DUMMY_CreateDevice(int devindex)
 	device->GetWMInfo = NULL;
 	device->InitOSKeymap = DUMMY_InitOSKeymap;
 	device->PumpEvents = DUMMY_PumpEvents;
+	device->GetEventFDs = DUMMY_GetEventFDs;
 
 	device->free = DUMMY_DeleteDevice;
 
@@ -1076,6 +1076,26 @@ void FB_PumpEvents(_THIS)
 	} while ( posted );
 }
 
+int FB_GetEventFDs(_THIS, int *fds, int maxfds, int *timeout)
+{
+	int numfds = 0;
+
+	if ( keyboard_fd >= 0 && numfds < maxfds ) {
+		fds[numfds++] = keyboard_fd;
+	}
+	if ( mouse_fd >= 0 && numfds < maxfds ) {
+		fds[numfds++] = mouse_fd;
+	}
+
+	/* Watch for the console being switched back to us */
+	if ( switched_away ) {
+		if ( (*timeout < 0) || (*timeout > 10) ) {
+			*timeout = 10;
+		}
+	}
+	return(numfds);
+}
+
 void FB_InitOSKeymap(_THIS)
 {
 	int i;
@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <errno.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 
@@ -155,6 +156,8 @@ static void FB_FreeHWSurface(_THIS, SDL_Surface *surface);
 static void FB_WaitVBL(_THIS);
 static void FB_WaitIdle(_THIS);
 static int FB_FlipHWSurface(_THIS, SDL_Surface *surface);
+static Uint32 FB_GetRefreshInterval(_THIS);
+static int FB_WaitVBlank(_THIS);
 #if !SDL_THREADS_DISABLED
 static int FB_TripleBufferingThread(void *d);
 static void FB_TripleBufferInit(_THIS);
@@ -268,6 +271,8 @@ static SDL_VideoDevice *FB_CreateDevice(int devindex)
 	this->UnlockHWSurface = FB_UnlockHWSurface;
 	this->FlipHWSurface = FB_FlipHWSurface;
 	this->FreeHWSurface = FB_FreeHWSurface;
+	this->GetRefreshInterval = FB_GetRefreshInterval;
+	this->WaitVBlank = FB_WaitVBlank;
 	this->SetCaption = NULL;
 	this->SetIcon = NULL;
 	this->IconifyWindow = NULL;
@@ -275,6 +280,7 @@ static SDL_VideoDevice *FB_CreateDevice(int devindex)
 	this->GetWMInfo = NULL;
 	this->InitOSKeymap = FB_InitOSKeymap;
 	this->PumpEvents = FB_PumpEvents;
+	this->GetEventFDs = FB_GetEventFDs;
 
 	this->free = FB_DeleteDevice;
 
@@ -1459,8 +1465,60 @@ static void FB_UnlockHWSurface(_THIS, SDL_Surface *surface)
 	}
 }
 
+/* Wait for vertical retrace using the kernel driver, if it can */
+static int FB_WaitVSyncIoctl(_THIS)
+{
+	__u32 crtc = 0;
+
+	if ( no_vsync_ioctl ) {
+		return(-1);
+	}
+	if ( ioctl(console_fd, FBIO_WAITFORVSYNC, &crtc) < 0 ) {
+		if ( errno != EINTR ) {
+			no_vsync_ioctl = 1;
+		}
+		return(-1);
+	}
+	return(0);
+}
+
 static void FB_WaitVBL(_THIS)
 {
+	FB_WaitVSyncIoctl(this);
+}
+
+static int FB_WaitVBlank(_THIS)
+{
+	if ( switched_away ) {
+		return(-1);
+	}
+	if ( wait_vbl != FB_WaitVBL ) {
+		/* The accelerated drivers poll the card directly */
+		wait_vbl(this);
+		return(0);
+	}
+	return FB_WaitVSyncIoctl(this);
+}
+
+static Uint32 FB_GetRefreshInterval(_THIS)
+{
+	struct fb_var_screeninfo *vinfo = &cache_vinfo;
+	double htotal, vtotal;
+
+	if ( vinfo->pixclock == 0 ) {
+		return(0);
+	}
+	htotal = (double)vinfo->xres + vinfo->left_margin +
+	         vinfo->right_margin + vinfo->hsync_len;
+	vtotal = (double)vinfo->yres + vinfo->upper_margin +
+	         vinfo->lower_margin + vinfo->vsync_len;
+	if ( (vinfo->vmode & FB_VMODE_MASK) == FB_VMODE_INTERLACED ) {
+		vtotal /= 2.0;
+	} else if ( (vinfo->vmode & FB_VMODE_MASK) == FB_VMODE_DOUBLE ) {
+		vtotal *= 2.0;
+	}
+	/* pixclock is in picoseconds */
+	return (Uint32)((htotal * vtotal * vinfo->pixclock) / 1000000.0);
 }
 
 static void FB_WaitIdle(_THIS)
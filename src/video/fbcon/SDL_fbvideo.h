@@ -115,6 +115,7 @@ struct SDL_PrivateVideoData {
 
 	void (*wait_vbl)(_THIS);
 	void (*wait_idle)(_THIS);
+	int no_vsync_ioctl;	/* FBIO_WAITFORVSYNC failed, don't retry */
 };
 /* Old variable names */
 #define console_fd		(this->hidden->console_fd)
@@ -164,6 +165,7 @@ struct SDL_PrivateVideoData {
 #define screen_palette		(this->hidden->screen_palette)
 #define wait_vbl		(this->hidden->wait_vbl)
 #define wait_idle		(this->hidden->wait_idle)
+#define no_vsync_ioctl		(this->hidden->no_vsync_ioctl)
 
 /* Accelerator types that are supported by the driver, but are not
    necessarily in the kernel headers on the system we compile on.
@@ -174,6 +176,9 @@ struct SDL_PrivateVideoData {
 #ifndef FB_ACCEL_3DFX_BANSHEE
 #define FB_ACCEL_3DFX_BANSHEE	31	/* 3Dfx Banshee			*/
 #endif
+#ifndef FBIO_WAITFORVSYNC
+#define FBIO_WAITFORVSYNC	_IOW('F', 0x20, __u32)
+#endif
 
 /* These functions are defined in SDL_fbvideo.c */
 extern void FB_SavePaletteTo(_THIS, int palette_len, __u16 *area);
@@ -39,6 +39,7 @@
 #include "../SDL_sysvideo.h"
 #include "../../events/SDL_sysevents.h"
 #include "../../events/SDL_events_c.h"
+#include "../../stdlib/SDL_utf8_c.h"
 #include "SDL_x11video.h"
 #include "SDL_x11dga_c.h"
 #include "SDL_x11modes_c.h"
@@ -64,244 +65,6 @@ SDLKey X11_TranslateKeycode(Display *display, KeyCode kc);
 int X11_PendingConfigureNotifyWidth = -1;
 int X11_PendingConfigureNotifyHeight = -1;
 
-#ifdef X_HAVE_UTF8_STRING
-Uint32 Utf8ToUcs4(const Uint8 *utf8)
-{
-	Uint32 c;
-	int i = 1;
-	int noOctets = 0;
-	int firstOctetMask = 0;
-	unsigned char firstOctet = utf8[0];
-	if (firstOctet < 0x80) {
-		/*
-		  Characters in the range:
-		    00000000 to 01111111 (ASCII Range)
-		  are stored in one octet:
-		    0xxxxxxx (The same as its ASCII representation)
-		  The least 6 significant bits of the first octet is the most 6 significant nonzero bits
-		  of the UCS4 representation.
-		*/
-		noOctets = 1;
-		firstOctetMask = 0x7F;  /* 0(1111111) - The most significant bit is ignored */
-	} else if ((firstOctet & 0xE0) /* get the most 3 significant bits by AND'ing with 11100000 */
-	              == 0xC0 ) {  /* see if those 3 bits are 110. If so, the char is in this range */
-		/*
-		  Characters in the range:
-		    00000000 10000000 to 00000111 11111111
-		  are stored in two octets:
-		    110xxxxx 10xxxxxx
-		  The least 5 significant bits of the first octet is the most 5 significant nonzero bits
-		  of the UCS4 representation.
-		*/
-		noOctets = 2;
-		firstOctetMask = 0x1F;  /* 000(11111) - The most 3 significant bits are ignored */
-	} else if ((firstOctet & 0xF0) /* get the most 4 significant bits by AND'ing with 11110000 */
-	              == 0xE0) {  /* see if those 4 bits are 1110. If so, the char is in this range */
-		/*
-		  Characters in the range:
-		    00001000 00000000 to 11111111 11111111
-		  are stored in three octets:
-		    1110xxxx 10xxxxxx 10xxxxxx
-		  The least 4 significant bits of the first octet is the most 4 significant nonzero bits
-		  of the UCS4 representation.
-		*/
-		noOctets = 3;
-		firstOctetMask = 0x0F; /* 0000(1111) - The most 4 significant bits are ignored */
-	} else if ((firstOctet & 0xF8) /* get the most 5 significant bits by AND'ing with 11111000 */
-	              == 0xF0) {  /* see if those 5 bits are 11110. If so, the char is in this range */
-		/*
-		  Characters in the range:
-		    00000001 00000000 00000000 to 00011111 11111111 11111111
-		  are stored in four octets:
-		    11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-		  The least 3 significant bits of the first octet is the most 3 significant nonzero bits
-		  of the UCS4 representation.
-		*/
-		noOctets = 4;
-		firstOctetMask = 0x07; /* 11110(111) - The most 5 significant bits are ignored */
-	} else if ((firstOctet & 0xFC) /* get the most 6 significant bits by AND'ing with 11111100 */
-	              == 0xF8) { /* see if those 6 bits are 111110. If so, the char is in this range */
-		/*
-		  Characters in the range:
-		    00000000 00100000 00000000 00000000 to
-		    00000011 11111111 11111111 11111111
-		  are stored in five octets:
-		    111110xx 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx
-		  The least 2 significant bits of the first octet is the most 2 significant nonzero bits
-		  of the UCS4 representation.
-		*/
-		noOctets = 5;
-		firstOctetMask = 0x03; /* 111110(11) - The most 6 significant bits are ignored */
-	} else if ((firstOctet & 0xFE) /* get the most 7 significant bits by AND'ing with 11111110 */
-	              == 0xFC) { /* see if those 7 bits are 1111110. If so, the char is in this range */
-		/*
-		  Characters in the range:
-		    00000100 00000000 00000000 00000000 to
-		    01111111 11111111 11111111 11111111
-		  are stored in six octets:
-		    1111110x 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx
-		  The least significant bit of the first octet is the most significant nonzero bit
-		  of the UCS4 representation.
-		*/
-		noOctets = 6;
-		firstOctetMask = 0x01; /* 1111110(1) - The most 7 significant bits are ignored */
-	} else
-		return 0;  /* The given chunk is not a valid UTF-8 encoded Unicode character */
-	
-	/*
-	  The least noOctets significant bits of the first octet is the most 2 significant nonzero bits
-	  of the UCS4 representation.
-	  The first 6 bits of the UCS4 representation is the least 8-noOctets-1 significant bits of
-	  firstOctet if the character is not ASCII. If so, it's the least 7 significant bits of firstOctet.
-	  This done by AND'ing firstOctet with its mask to trim the bits used for identifying the
-	  number of continuing octets (if any) and leave only the free bits (the x's)
-	  Sample:
-	  1-octet:    0xxxxxxx  &  01111111 = 0xxxxxxx
-	  2-octets:  110xxxxx  &  00011111 = 000xxxxx
-	*/
-	c = firstOctet & firstOctetMask;
-	
-	/* Now, start filling c.ucs4 with the bits from the continuing octets from utf8. */
-	for (i = 1; i < noOctets; i++) {
-		/* A valid continuing octet is of the form 10xxxxxx */
-		if ((utf8[i] & 0xC0) /* get the most 2 significant bits by AND'ing with 11000000 */
-		    != 0x80) /* see if those 2 bits are 10. If not, the is a malformed sequence. */
-			/*The given chunk is a partial sequence at the end of a string that could
-			   begin a valid character */
-			return 0;
-		
-		/* Make room for the next 6-bits */
-		c <<= 6;
-		
-		/*
-		  Take only the least 6 significance bits of the current octet (utf8[i]) and fill the created room
-		  of c.ucs4 with them.
-		  This done by AND'ing utf8[i] with 00111111 and the OR'ing the result with c.ucs4.
-		*/
-		c |= utf8[i] & 0x3F;
-	}
-	return c;
-}
-
-/* Given a UTF-8 encoded string pointed to by utf8 of length length in
-   bytes, returns the corresponding UTF-16 encoded string in the
-   buffer pointed to by utf16.  The maximum number of UTF-16 encoding
-   units (i.e., Unit16s) allowed in the buffer is specified in
-   utf16_max_length.  The return value is the number of UTF-16
-   encoding units placed in the output buffer pointed to by utf16.
-
-   In case of an error, -1 is returned, leaving some unusable partial
-   results in the output buffer.
-
-   The caller must estimate the size of utf16 buffer by itself before
-   calling this function.  Insufficient output buffer is considered as
-   an error, and once an error occured, this function doesn't give any
-   clue how large the result will be.
-
-   The error cases include following:
-
-   - Invalid byte sequences were in the input UTF-8 bytes.  The caller
-     has no way to know what point in the input buffer was the
-     errornous byte.
-
-   - The input contained a character (a valid UTF-8 byte sequence)
-     whose scalar value exceeded the range that UTF-16 can represent
-     (i.e., characters whose Unicode scalar value above 0x110000).
-
-   - The output buffer has no enough space to hold entire utf16 data.
-
-   Please note:
-
-   - '\0'-termination is not assumed both on the input UTF-8 string
-     and on the output UTF-16 string; any legal zero byte in the input
-     UTF-8 string will be converted to a 16-bit zero in output.  As a
-     side effect, the last UTF-16 encoding unit stored in the output
-     buffer will have a non-zero value if the input UTF-8 was not
-     '\0'-terminated.
-
-   - UTF-8 aliases are *not* considered as an error.  They are
-     converted to UTF-16.  For example, 0xC0 0xA0, 0xE0 0x80 0xA0, 
-     and 0xF0 0x80 0x80 0xA0 are all mapped to a single UTF-16
-     encoding unit 0x0020.
-
-   - Three byte UTF-8 sequences whose value corresponds to a surrogate
-     code or other reserved scalar value are not considered as an
-     error either.  They may cause an invalid UTF-16 data (e.g., those
-     containing unpaired surrogates).
-
-*/
-
-static int Utf8ToUtf16(const Uint8 *utf8, const int utf8_length, Uint16 *utf16, const int utf16_max_length) {
-
-    /* p moves over the output buffer.  max_ptr points to the next to the last slot of the buffer.  */
-    Uint16 *p = utf16;
-    Uint16 const *const max_ptr = utf16 + utf16_max_length;
-
-    /* end_of_input points to the last byte of input as opposed to the next to the last byte.  */
-    Uint8 const *const end_of_input = utf8 + utf8_length - 1;
-
-    while (utf8 <= end_of_input) {
-	Uint8 const c = *utf8;
-	if (p >= max_ptr) {
-	    /* No more output space.  */
-	    return -1;
-	}
-	if (c < 0x80) {
-	    /* One byte ASCII.  */
-	    *p++ = c;
-	    utf8 += 1;
-	} else if (c < 0xC0) {
-	    /* Follower byte without preceeding leader bytes.  */
-	    return -1;
-	} else if (c < 0xE0) {
-	    /* Two byte sequence.  We need one follower byte.  */
-	    if (end_of_input - utf8 < 1 || (((utf8[1] ^ 0x80)) & 0xC0)) {
-		return -1;
-	    }
-	    *p++ = (Uint16)(0xCF80 + (c << 6) + utf8[1]);
-	    utf8 += 2;
-	} else if (c < 0xF0) {
-	    /* Three byte sequence.  We need two follower byte.  */
-	    if (end_of_input - utf8 < 2 || (((utf8[1] ^ 0x80) | (utf8[2] ^ 0x80)) & 0xC0)) {
-		return -1;
-	    }
-	    *p++ = (Uint16)(0xDF80 + (c << 12) + (utf8[1] << 6) + utf8[2]);
-	    utf8 += 3;
-	} else if (c < 0xF8) {
-	    int plane;
-	    /* Four byte sequence.  We need three follower bytes.  */
-	    if (end_of_input - utf8 < 3 || (((utf8[1] ^ 0x80) | (utf8[2] ^0x80) | (utf8[3] ^ 0x80)) & 0xC0)) {
-		return -1;
-	    }
-	    plane = (-0xC8 + (c << 2) + (utf8[1] >> 4));
-	    if (plane == 0) {
-		/* This four byte sequence is an alias that
-                   corresponds to a Unicode scalar value in BMP.
-		   It fits in an UTF-16 encoding unit.  */
-		*p++ = (Uint16)(0xDF80 + (utf8[1] << 12) + (utf8[2] << 6) + utf8[3]);
-	    } else if (plane <= 16) {
-		/* This is a legal four byte sequence that corresponds to a surrogate pair.  */
-		if (p + 1 >= max_ptr) {
-		    /* No enough space on the output buffer for the pair.  */
-		    return -1;
-		}
-		*p++ = (Uint16)(0xE5B8 + (c << 8) + (utf8[1] << 2) + (utf8[2] >> 4));
-		*p++ = (Uint16)(0xDB80 + ((utf8[2] & 0x0F) << 6) + utf8[3]);
-	    } else {
-		/* This four byte sequence is out of UTF-16 code space.  */
-		return -1;
-	    }
-	    utf8 += 4;
-	} else {
-	    /* Longer sequence or unused byte.  */
-	    return -1;
-	}
-    }
-    return p - utf16;
-}
-
-#endif
-
 /* Check to see if this is a repeated key.
    (idea shamelessly lifted from GII -- thanks guys! :)
  */
@@ -628,6 +391,10 @@ printf("KeyPress (X11 keycode = 0x%X)\n", xevent.xkey.keycode);
 			Uint16 *utf16data = utf16buf;
 			int utf16size;
 			int utf16length;
+			const char *utf8ptr;
+			size_t utf8left;
+			char *utf16ptr;
+			size_t utf16left;
 
 			count = Xutf8LookupString(SDL_IC, &xevent.xkey, keydata, sizeof(keybuf), &xkeysym, &status);
 			if (XBufferOverflow == status) {
@@ -683,14 +450,19 @@ printf("KeyPress (X11 keycode = 0x%X)\n", xevent.xkey.keycode);
 			      break;
 			    }
 			  }
-			  utf16length = Utf8ToUtf16((Uint8 *)keydata, count, utf16data, utf16size);
-			  if (utf16length < 0) {
-			    /* The keydata contained an invalid byte
-			       sequence.  It should be a bug of the IM
-			       or Xlib... */
+			  utf8ptr = keydata;
+			  utf8left = count;
+			  utf16ptr = (char *)utf16data;
+			  utf16left = utf16size;
+			  if (SDL_FromUTF8(SDL_UTF_16NATIVE, &utf8ptr, &utf8left, &utf16ptr, &utf16left) == SDL_ICONV_EINVAL) {
+			    /* The keydata ended partway through a
+			       character.  It should be a bug of the IM
+			       or Xlib...  Invalid bytes elsewhere come
+			       through as U+FFFD. */
 			    SDL_SetError("Oops! Xutf8LookupString returned an invalid UTF-8 sequence!");
 			    break;
 			  }
+			  utf16length = (utf16size - utf16left) / sizeof(Uint16);
 
 			  /* Deliver all UTF-16 encoding units.  At
 			     this moment, SDL event queue has a
@@ -965,6 +737,40 @@ int X11_Pending(Display *display)
 	return(0);
 }
 
+int X11_GetEventFDs(_THIS, int *fds, int maxfds, int *timeout)
+{
+	Uint32 now;
+	int wait;
+
+	if ( maxfds < 1 ) {
+		return(-1);
+	}
+	fds[0] = ConnectionNumber(SDL_Display);
+
+	/* Events Xlib has already read won't show up on the connection */
+	if ( XEventsQueued(SDL_Display, QueuedAlready) ) {
+		*timeout = 0;
+	}
+
+	/* Pending fullscreen switches and screensaver resets are timed */
+	now = SDL_GetTicks();
+	if ( switch_waiting ) {
+		wait = (int)(switch_time - now);
+		if ( wait < 0 ) {
+			wait = 0;
+		}
+		if ( (*timeout < 0) || (wait < *timeout) ) {
+			*timeout = wait;
+		}
+	}
+	if ( !allow_screensaver ) {
+		if ( (*timeout < 0) || (*timeout > 5000) ) {
+			*timeout = 5000;
+		}
+	}
+	return(1);
+}
+
 void X11_PumpEvents(_THIS)
 {
 	int pending;
@@ -315,6 +315,34 @@ static void get_real_resolution(_THIS, int* w, int* h)
     *h = DisplayHeight(SDL_Display, SDL_Screen);
 }
 
+/* Returns the refresh period of the current mode, in microseconds */
+Uint32 X11_GetRefreshInterval(_THIS)
+{
+#if SDL_VIDEO_DRIVER_X11_VIDMODE
+    if ( use_vidmode ) {
+        SDL_NAME(XF86VidModeModeLine) mode;
+        int dotclock;
+
+        if ( SDL_NAME(XF86VidModeGetModeLine)(SDL_Display, SDL_Screen, &dotclock, &mode) &&
+             dotclock > 0 && mode.htotal > 0 && mode.vtotal > 0 ) {
+            /* dotclock is in kHz */
+            return (Uint32)(((double)mode.htotal * mode.vtotal * 1000.0) / dotclock);
+        }
+    }
+#endif /* SDL_VIDEO_DRIVER_X11_VIDMODE */
+
+#if SDL_VIDEO_DRIVER_X11_XRANDR
+    if ( use_xrandr && screen_config ) {
+        short rate = XRRConfigCurrentRate(screen_config);
+        if ( rate > 0 ) {
+            return 1000000 / rate;
+        }
+    }
+#endif /* SDL_VIDEO_DRIVER_X11_XRANDR */
+
+    return 0;
+}
+
 /* Called after mapping a window - waits until the window is mapped */
 void X11_WaitMapped(_THIS, Window win)
 {
@@ -40,3 +40,4 @@ extern void X11_WaitMapped(_THIS, Window win);
 extern void X11_WaitUnmapped(_THIS, Window win);
 extern int X11_EnterFullScreen(_THIS);
 extern int X11_LeaveFullScreen(_THIS);
+extern Uint32 X11_GetRefreshInterval(_THIS);
@@ -175,6 +175,8 @@ static SDL_VideoDevice *X11_CreateDevice(int devindex)
 		device->CheckMouseMode = X11_CheckMouseMode;
 		device->InitOSKeymap = X11_InitOSKeymap;
 		device->PumpEvents = X11_PumpEvents;
+		device->GetEventFDs = X11_GetEventFDs;
+		device->GetRefreshInterval = X11_GetRefreshInterval;
 
 		device->free = X11_DeleteDevice;
 	}
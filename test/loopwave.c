@@ -103,6 +103,21 @@ int main(int argc, char *argv[])
 	while ( ! done && (SDL_GetAudioStatus() == SDL_AUDIO_PLAYING) )
 		SDL_Delay(1000);
 
+	/* Report how well the audio thread kept up */
+	{ SDL_AudioStats stats;
+	  int frames, ms;
+		if ( SDL_GetAudioLatency(&frames, &ms) == 0 ) {
+			printf("Audio latency: %d frames (%d ms)\n", frames, ms);
+		}
+		if ( SDL_GetAudioStats(&stats) == 0 ) {
+			printf("Audio callbacks: %u (min %u us, avg %u us, max %u us)\n",
+			       stats.callbacks, stats.callback_min,
+			       stats.callback_avg, stats.callback_max);
+			printf("Audio underruns: %u, fake stream buffers: %u\n",
+			       stats.xruns, stats.fake_streams);
+		}
+	}
+
 	/* Clean up on signal */
 	SDL_CloseAudio();
 	SDL_FreeWAV(wave.sound);
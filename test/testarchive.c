@@ -0,0 +1,285 @@
+
+/* Builds SDL archives, and compares reading files out of one against
+   reading the same files loose.
+
+   testarchive -c [-lz|-zlib] archive file...	writes an archive of the files
+   testarchive [count]				runs the benchmark
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#include "SDL.h"
+
+/* WARNING ! these files will be destroyed by this test program */
+#define ARCHIVE_NAME	"sdlarch.pak"
+#define LOOSE_NAME	"sdlarch%04d.dat"
+
+#define DEFAULT_COUNT	2000
+#define ROUNDS		5
+#define MAX_SIZE	8192
+
+static int count;
+static char **files;
+static int *sizes;
+static int *order;
+static Uint8 buf[MAX_SIZE];
+
+static void cleanup(void)
+{
+	int i;
+
+	if ( files ) {
+		for ( i = 0; i < count; ++i ) {
+			if ( files[i] ) {
+				unlink(files[i]);
+				free(files[i]);
+			}
+		}
+		free(files);
+	}
+	free(sizes);
+	free(order);
+	unlink(ARCHIVE_NAME);
+}
+
+static void quit(int rc)
+{
+	cleanup();
+	SDL_Quit();
+	exit(rc);
+}
+
+static int create(int argc, char *argv[])
+{
+	const char *archive;
+	int method = 0;
+
+	if ( argc > 0 && SDL_strcmp(argv[0], "-lz") == 0 ) {
+		method = SDL_COMPRESS_LZ;
+		--argc;
+		++argv;
+	} else if ( argc > 0 && SDL_strcmp(argv[0], "-zlib") == 0 ) {
+		method = SDL_COMPRESS_ZLIB;
+		--argc;
+		++argv;
+	}
+	if ( argc < 1 ) {
+		fprintf(stderr, "Usage: testarchive -c [-lz|-zlib] archive file...\n");
+		return(1);
+	}
+	archive = argv[0];
+	if ( SDL_SaveArchive(archive, (const char **)argv + 1, NULL, argc - 1, method) < 0 ) {
+		fprintf(stderr, "Couldn't write %s: %s\n", archive, SDL_GetError());
+		return(1);
+	}
+	printf("Wrote %d files to %s\n", argc - 1, archive);
+	return(0);
+}
+
+/* Runs copied from a small dictionary, so the files compress somewhat */
+static void make_files(void)
+{
+	FILE *fp;
+	Uint8 dict[1024];
+	Uint32 seed = 12345;
+	int i, j, k, tmp;
+
+	files = (char **)calloc(count, sizeof(*files));
+	sizes = (int *)malloc(count * sizeof(*sizes));
+	order = (int *)malloc(count * sizeof(*order));
+	if ( !files || !sizes || !order ) {
+		fprintf(stderr, "Out of memory\n");
+		quit(1);
+	}
+	for ( i = 0; i < (int)sizeof(dict); ++i ) {
+		seed = seed * 1103515245 + 12345;
+		dict[i] = (Uint8)(seed >> 16);
+	}
+	for ( i = 0; i < count; ++i ) {
+		files[i] = (char *)malloc(32);
+		if ( !files[i] ) {
+			fprintf(stderr, "Out of memory\n");
+			quit(1);
+		}
+		SDL_snprintf(files[i], 32, LOOSE_NAME, i);
+		seed = seed * 1103515245 + 12345;
+		sizes[i] = 64 + (seed >> 8) % (MAX_SIZE - 64);
+		for ( j = 0; j < sizes[i]; ++j ) {
+			if ( j % 32 == 0 ) {
+				seed = seed * 1103515245 + 12345;
+				k = (seed >> 8) % (sizeof(dict) - 32);
+			}
+			buf[j] = dict[k + j % 32];
+		}
+		fp = fopen(files[i], "wb");
+		if ( !fp || fwrite(buf, sizes[i], 1, fp) != 1 ) {
+			fprintf(stderr, "Couldn't write %s\n", files[i]);
+			if ( fp ) {
+				fclose(fp);
+			}
+			quit(1);
+		}
+		fclose(fp);
+		order[i] = i;
+	}
+
+	/* Read them in a different order than they were written */
+	for ( i = count - 1; i > 0; --i ) {
+		seed = seed * 1103515245 + 12345;
+		j = (seed >> 8) % (i + 1);
+		tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+}
+
+/* Open, read and close every file, returns the sum of the bytes read */
+static Uint32 read_all(const char *what, SDL_Archive *archive, int use_stdio)
+{
+	SDL_RWops *rw;
+	Uint64 start, ticks;
+	Uint32 sum = 0;
+	int round, i, n, j;
+	FILE *fp;
+
+	start = SDL_GetPerformanceCounter();
+	for ( round = 0; round < ROUNDS; ++round ) {
+		for ( i = 0; i < count; ++i ) {
+			const char *name = files[order[i]];
+
+			if ( archive ) {
+				rw = SDL_RWFromArchive(archive, name);
+			} else if ( use_stdio ) {
+				fp = fopen(name, "rb");
+				rw = fp ? SDL_RWFromFP(fp, 1) : NULL;
+			} else {
+				rw = SDL_RWFromFile(name, "rb");
+			}
+			if ( !rw ) {
+				fprintf(stderr, "Couldn't open %s: %s\n", name, SDL_GetError());
+				quit(1);
+			}
+			n = SDL_RWread(rw, buf, 1, sizeof(buf));
+			SDL_RWclose(rw);
+			if ( n != sizes[order[i]] ) {
+				fprintf(stderr, "Read %d bytes of %s, expected %d\n",
+				        n, name, sizes[order[i]]);
+				quit(1);
+			}
+			for ( j = 0; j < n; j += 16 ) {
+				sum = sum * 31 + buf[j];
+			}
+		}
+	}
+	ticks = SDL_GetPerformanceCounter() - start;
+	printf("%-24s %8.2f us per file\n", what,
+	       (double)ticks * 1000000.0 / SDL_GetPerformanceFrequency() / (ROUNDS * count));
+	return(sum);
+}
+
+static void check(Uint32 sum, Uint32 expected)
+{
+	if ( sum != expected ) {
+		fprintf(stderr, "Data read differs from the loose files\n");
+		quit(1);
+	}
+}
+
+/* Write an archive and read everything from it mapped and through stdio */
+static void bench_archive(const char *what, int method, Uint32 sum)
+{
+	SDL_Archive *archive;
+	SDL_RWops *rw;
+	char label[64];
+	FILE *fp;
+
+	if ( SDL_SaveArchive(ARCHIVE_NAME, (const char **)files, NULL, count, method) < 0 ) {
+		printf("%s: %s\n", what, SDL_GetError());
+		return;
+	}
+	rw = SDL_RWFromFile(ARCHIVE_NAME, "rb");
+	if ( rw ) {
+		printf("%s archive is %d KB\n", what, SDL_RWseek(rw, 0, RW_SEEK_END) / 1024);
+		SDL_RWclose(rw);
+	}
+
+	archive = SDL_OpenArchive(ARCHIVE_NAME);
+	if ( !archive ) {
+		fprintf(stderr, "Couldn't open %s: %s\n", ARCHIVE_NAME, SDL_GetError());
+		quit(1);
+	}
+	if ( SDL_GetArchiveSize(archive) != count ) {
+		fprintf(stderr, "Archive has %d files, expected %d\n",
+		        SDL_GetArchiveSize(archive), count);
+		quit(1);
+	}
+	SDL_snprintf(label, sizeof(label), "%s, mapped", what);
+	check(read_all(label, archive, 0), sum);
+	SDL_CloseArchive(archive);
+
+	fp = fopen(ARCHIVE_NAME, "rb");
+	archive = fp ? SDL_OpenArchive_RW(SDL_RWFromFP(fp, 1), 1) : NULL;
+	if ( !archive ) {
+		fprintf(stderr, "Couldn't open %s: %s\n", ARCHIVE_NAME, SDL_GetError());
+		quit(1);
+	}
+	SDL_snprintf(label, sizeof(label), "%s, shared file", what);
+	check(read_all(label, archive, 0), sum);
+
+	/* Things that shouldn't work */
+	rw = SDL_RWFromArchive(archive, "no such file");
+	if ( rw ) {
+		fprintf(stderr, "Found a file that isn't in the archive\n");
+		quit(1);
+	}
+	rw = SDL_RWFromArchive(archive, files[0]);
+	if ( !rw || SDL_RWwrite(rw, buf, 1, 1) != -1 ||
+	     SDL_RWseek(rw, 0, RW_SEEK_END) != sizes[0] ||
+	     SDL_RWseek(rw, -10, RW_SEEK_CUR) != sizes[0] - 10 ||
+	     SDL_RWread(rw, buf, 1, sizeof(buf)) != 10 ) {
+		fprintf(stderr, "Seeking in an archived file failed\n");
+		quit(1);
+	}
+	SDL_RWclose(rw);
+	SDL_CloseArchive(archive);
+}
+
+int main(int argc, char *argv[])
+{
+	Uint32 sum;
+
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return(1);
+	}
+	if ( argc > 1 && SDL_strcmp(argv[1], "-c") == 0 ) {
+		int rc = create(argc - 2, argv + 2);
+		SDL_Quit();
+		return(rc);
+	}
+
+	count = (argc > 1) ? atoi(argv[1]) : DEFAULT_COUNT;
+	if ( count <= 0 ) {
+		count = DEFAULT_COUNT;
+	}
+	printf("Creating %d files...\n", count);
+	make_files();
+
+	/* Run through everything once so all of it is in the disk cache */
+	sum = read_all("Warming up", NULL, 0);
+
+	check(read_all("Loose, SDL_RWFromFile", NULL, 0), sum);
+	check(read_all("Loose, SDL_RWFromFP", NULL, 1), sum);
+	bench_archive("Stored", 0, sum);
+	bench_archive("LZ", SDL_COMPRESS_LZ, sum);
+	bench_archive("zlib", SDL_COMPRESS_ZLIB, sum);
+
+	printf("All tests passed\n");
+	quit(0);
+	return(0);
+}
@@ -0,0 +1,143 @@
+
+/* Compare a mutex, a spinlock and atomic operations guarding a counter */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+#include "SDL_thread.h"
+#include "SDL_atomic.h"
+
+#define DEFAULT_THREADS	4
+#define DEFAULT_ITERS	1000000
+#define MAX_THREADS	64
+
+static int iterations = DEFAULT_ITERS;
+static SDL_mutex *mutex;
+static SDL_SpinLock spinlock;
+static SDL_atomic_t atomic;
+static int counter;
+
+/* Call this instead of exit(), so we can clean up SDL: atexit() is evil. */
+static void quit(int rc)
+{
+	SDL_Quit();
+	exit(rc);
+}
+
+int SDLCALL MutexThread(void *data)
+{
+	int i;
+	for ( i = 0; i < iterations; ++i ) {
+		SDL_mutexP(mutex);
+		++counter;
+		SDL_mutexV(mutex);
+	}
+	return(0);
+}
+
+int SDLCALL SpinLockThread(void *data)
+{
+	int i;
+	for ( i = 0; i < iterations; ++i ) {
+		SDL_AtomicLock(&spinlock);
+		++counter;
+		SDL_AtomicUnlock(&spinlock);
+	}
+	return(0);
+}
+
+int SDLCALL AddThread(void *data)
+{
+	int i;
+	for ( i = 0; i < iterations; ++i ) {
+		SDL_AtomicAdd(&atomic, 1);
+	}
+	return(0);
+}
+
+int SDLCALL CASThread(void *data)
+{
+	int i, value;
+	for ( i = 0; i < iterations; ++i ) {
+		do {
+			value = SDL_AtomicGet(&atomic);
+		} while ( !SDL_AtomicCAS(&atomic, value, value + 1) );
+	}
+	return(0);
+}
+
+static void RunTest(const char *name, int (SDLCALL *fn)(void *), int nthreads)
+{
+	SDL_Thread *threads[MAX_THREADS];
+	Uint32 start, ms;
+	int i, total;
+
+	counter = 0;
+	SDL_AtomicSet(&atomic, 0);
+
+	start = SDL_GetTicks();
+	for ( i = 0; i < nthreads; ++i ) {
+		threads[i] = SDL_CreateThread(fn, NULL);
+		if ( threads[i] == NULL ) {
+			fprintf(stderr, "Couldn't create thread: %s\n", SDL_GetError());
+			quit(1);
+		}
+	}
+	for ( i = 0; i < nthreads; ++i ) {
+		SDL_WaitThread(threads[i], NULL);
+	}
+	ms = SDL_GetTicks() - start;
+	if ( ms == 0 ) {
+		ms = 1;
+	}
+
+	total = counter + SDL_AtomicGet(&atomic);
+	printf("%-14s %6d ms  %10.0f ops/sec\n", name, ms,
+	       (double)nthreads * iterations * 1000.0 / ms);
+	if ( total != nthreads * iterations ) {
+		fprintf(stderr, "%s counted %d, expected %d!\n",
+		        name, total, nthreads * iterations);
+		quit(1);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int nthreads = DEFAULT_THREADS;
+
+	if ( argc > 1 ) {
+		nthreads = atoi(argv[1]);
+	}
+	if ( argc > 2 ) {
+		iterations = atoi(argv[2]);
+	}
+	if ( nthreads <= 0 || nthreads > MAX_THREADS || iterations < 0 ) {
+		fprintf(stderr, "Usage: %s [threads] [iterations]\n", argv[0]);
+		return(1);
+	}
+
+	/* Load the SDL library */
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n",SDL_GetError());
+		return(1);
+	}
+
+	mutex = SDL_CreateMutex();
+	if ( mutex == NULL ) {
+		fprintf(stderr, "Couldn't create mutex: %s\n", SDL_GetError());
+		quit(1);
+	}
+	printf("%d CPUs, %d threads, %d increments each, atomics are %s\n",
+	       SDL_GetCPUCount(), nthreads, iterations,
+	       SDL_AtomicIsLockFree() ? "lock free" : "emulated");
+
+	RunTest("SDL_mutex", MutexThread, nthreads);
+	RunTest("SDL_SpinLock", SpinLockThread, nthreads);
+	RunTest("SDL_AtomicAdd", AddThread, nthreads);
+	RunTest("SDL_AtomicCAS", CASThread, nthreads);
+
+	SDL_DestroyMutex(mutex);
+	SDL_Quit();
+	return(0);
+}
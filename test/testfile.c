@@ -40,6 +40,312 @@ static void rwops_error_quit( unsigned line, SDL_RWops *rwops) {
 
 #define RWOP_ERR_QUIT(x)	rwops_error_quit( __LINE__, (x) )
 
+/* benchmark : read a big file through each backend */
+#define BENCH_SIZE	(16*1024*1024)
+#define BENCH_CHUNK	4096
+#define BENCH_PASSES	8
+
+static Uint32 bench_read( const char *name, SDL_RWops *rwops ) {
+	static Uint8 chunk[BENCH_CHUNK];
+	Uint32 start, ms, sum = 0;
+	int pass, i, n;
+
+	start = SDL_GetTicks();
+	for ( pass = 0; pass < BENCH_PASSES; ++pass ) {
+		rwops->seek(rwops,0,RW_SEEK_SET);
+		while ( (n = rwops->read(rwops,chunk,1,BENCH_CHUNK)) > 0 ) {
+			for ( i = 0; i < n; i += 64 ) {
+				sum += chunk[i];
+			}
+		}
+	}
+	ms = SDL_GetTicks() - start;
+	if ( ms == 0 ) {
+		ms = 1;
+	}
+	printf("%-14s %6d ms  %8.1f MB/s\n", name, ms,
+	       (double)BENCH_SIZE * BENCH_PASSES / (1024.0*1024.0) * 1000.0 / ms);
+	return sum;
+}
+
+/* a source that takes a millisecond per read, like a cold disk */
+static int SDLCALL slow_read( SDL_RWops *context, void *ptr, int size, int maxnum ) {
+	SDL_RWops *mem = (SDL_RWops *)context->hidden.unknown.data1;
+	SDL_Delay(1);
+	return mem->read(mem,ptr,size,maxnum);
+}
+
+static int SDLCALL slow_seek( SDL_RWops *context, int offset, int whence ) {
+	SDL_RWops *mem = (SDL_RWops *)context->hidden.unknown.data1;
+	return mem->seek(mem,offset,whence);
+}
+
+static int SDLCALL slow_close( SDL_RWops *context ) {
+	SDL_RWops *mem = (SDL_RWops *)context->hidden.unknown.data1;
+	mem->close(mem);
+	SDL_FreeRW(context);
+	return 0;
+}
+
+/* stream from the slow source, doing a millisecond of work per chunk */
+static void bench_stream( const char *name, SDL_RWops *rwops, int size ) {
+	static Uint8 chunk[64*1024];
+	Uint32 start, ms;
+	int total = 0, n;
+
+	start = SDL_GetTicks();
+	while ( (n = rwops->read(rwops,chunk,1,sizeof(chunk))) > 0 ) {
+		total += n;
+		SDL_Delay(1);
+	}
+	ms = SDL_GetTicks() - start;
+	if (total != size)									RWOP_ERR_QUIT(rwops);
+	printf("%-14s %6d ms\n", name, ms);
+}
+
+static void benchmark_slow( Uint8 *data, int size ) {
+	SDL_RWops *slow, *rwops;
+
+	printf("streaming %d KB from a slow source in 64 KB chunks\n", size/1024);
+	slow = SDL_AllocRW();
+	if (!slow)											RWOP_ERR_QUIT(slow);
+	slow->read = slow_read;
+	slow->seek = slow_seek;
+	slow->close = slow_close;
+	slow->hidden.unknown.data1 = SDL_RWFromMem(data,size);
+	bench_stream("direct",slow,size);
+
+	slow->seek(slow,0,RW_SEEK_SET);
+	rwops = SDL_RWFromRWAsync(slow,64*1024,4);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	bench_stream("async",rwops,size);
+	rwops->close(rwops);
+}
+
+/* data that compresses about as well as typical game assets: runs copied
+   from a small dictionary, with some noise in between */
+static void make_compressible( Uint8 *data, int size ) {
+	Uint8 dict[1024];
+	Uint32 seed = 1;
+	int i, j, run;
+
+	for ( i = 0; i < (int)sizeof(dict); ++i ) {
+		seed = seed * 1103515245 + 12345;
+		dict[i] = (Uint8)(seed >> 16);
+	}
+	for ( i = 0; i < size; i += run ) {
+		seed = seed * 1103515245 + 12345;
+		run = 4 + (seed >> 16) % 60;
+		j = (seed >> 8) % (sizeof(dict) - run);
+		if ( run > size - i ) {
+			run = size - i;
+		}
+		if ( (seed >> 28) == 0 ) {
+			data[i] = (Uint8)seed;	/* noise */
+			run = 1;
+		} else {
+			SDL_memcpy(data+i,dict+j,run);
+		}
+	}
+}
+
+/* compress the data, then read it back through each kind of source */
+static void benchmark_compressed( Uint8 *data, int method, const char *name ) {
+	SDL_RWops *rwops, *file;
+	Uint32 check, start, ms;
+	char test_buf[20];
+	int i, packed;
+	FILE *fp;
+
+	rwops = SDL_RWFromMem(data,BENCH_SIZE);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	check = bench_read("uncompressed",rwops);
+	rwops->seek(rwops,0,RW_SEEK_SET);
+	file = SDL_RWFromFile(FBASENAME2,"wb");
+	if (!file)											RWOP_ERR_QUIT(rwops);
+	start = SDL_GetTicks();
+	if (SDL_CompressRW(rwops,file,method,0) < 0) {
+		printf("%s: %s\n", name, SDL_GetError());
+		file->close(file);
+		rwops->close(rwops);
+		return;
+	}
+	ms = SDL_GetTicks() - start;
+	packed = file->seek(file,0,RW_SEEK_END);
+	file->close(file);
+	rwops->close(rwops);
+	printf("%s compressed %d MB to %d%% in %d ms\n", name,
+	       BENCH_SIZE/(1024*1024), (int)((Sint64)packed * 100 / BENCH_SIZE), ms);
+
+	rwops = SDL_RWFromCompressed(SDL_RWFromFile(FBASENAME2,"rb"),1);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	if (check != bench_read("file",rwops))				RWOP_ERR_QUIT(rwops);
+	rwops->close(rwops);
+
+	fp = fopen(FBASENAME2,"rb");
+	if (!fp)											RWOP_ERR_QUIT(NULL);
+	rwops = SDL_RWFromCompressed(SDL_RWFromFP(fp,1),1);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	if (check != bench_read("stdio",rwops))				RWOP_ERR_QUIT(rwops);
+
+	/* seeks land anywhere in a block and reads cross block edges */
+	for ( i = 0; i < 1000; ++i ) {
+		static Uint8 chunk[3*64*1024];
+		int pos = (i * 7919 * 13) % BENCH_SIZE;
+		int len = (i * 397) % sizeof(chunk);
+
+		if ( i % 2 ) {
+			if (pos != rwops->seek(rwops,pos,RW_SEEK_SET))	RWOP_ERR_QUIT(rwops);
+		} else {
+			pos = rwops->seek(rwops,0,RW_SEEK_CUR);
+		}
+		if ( pos + len > BENCH_SIZE ) {
+			len = BENCH_SIZE - pos;
+		}
+		if (len != rwops->read(rwops,chunk,1,len))		RWOP_ERR_QUIT(rwops);
+		if (SDL_memcmp(chunk,data+pos,len))				RWOP_ERR_QUIT(rwops);
+	}
+	if (BENCH_SIZE-10 != rwops->seek(rwops,-10,RW_SEEK_END))	RWOP_ERR_QUIT(rwops);
+	if (5 != rwops->read(rwops,test_buf,2,10))			RWOP_ERR_QUIT(rwops);
+	if (SDL_memcmp(test_buf,data+BENCH_SIZE-10,10))		RWOP_ERR_QUIT(rwops);
+	if (0 != rwops->read(rwops,test_buf,1,1))			RWOP_ERR_QUIT(rwops);
+	if (-1 != rwops->write(rwops,test_buf,1,1))			RWOP_ERR_QUIT(rwops);
+	rwops->close(rwops);
+
+	/* data cut short is caught when it's opened */
+	truncate(FBASENAME2, packed - 8);
+	rwops = SDL_RWFromCompressed(SDL_RWFromFile(FBASENAME2,"rb"),1);
+	if (rwops)											RWOP_ERR_QUIT(rwops);
+}
+
+static void benchmark( void ) {
+	SDL_RWops *rwops;
+	SDL_RWAsyncStats stats;
+	Uint8 *data;
+	char test_buf[20];
+	const Uint8 *mapped;
+	size_t maplen;
+	Uint32 check, sum, start, ms;
+	int pass, i;
+	FILE *fp;
+
+	data = (Uint8 *)malloc(BENCH_SIZE);
+	if (!data)											RWOP_ERR_QUIT(NULL);
+	for ( i = 0; i < BENCH_SIZE; ++i ) {
+		data[i] = (Uint8)(i * 7 + (i >> 12));
+	}
+	rwops = SDL_RWFromFile(FBASENAME1,"wb");
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	if (1 != rwops->write(rwops,data,BENCH_SIZE,1))		RWOP_ERR_QUIT(rwops);
+	rwops->close(rwops);
+	printf("reading %d MB %d times in %d byte chunks\n",
+	       BENCH_SIZE/(1024*1024), BENCH_PASSES, BENCH_CHUNK);
+
+	fp = fopen(FBASENAME1,"rb");
+	if (!fp)											RWOP_ERR_QUIT(NULL);
+	rwops = SDL_RWFromFP(fp,1);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	check = bench_read("stdio",rwops);
+	rwops->close(rwops);
+
+	rwops = SDL_RWFromMem(data,BENCH_SIZE);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	if (check != bench_read("mem",rwops))				RWOP_ERR_QUIT(rwops);
+	rwops->close(rwops);
+
+	fp = fopen(FBASENAME1,"rb");
+	if (!fp)											RWOP_ERR_QUIT(NULL);
+	rwops = SDL_RWFromRWAsync(SDL_RWFromFP(fp,1),0,0);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	if (check != bench_read("stdio+async",rwops))		RWOP_ERR_QUIT(rwops);
+	if (SDL_GetRWAsyncStats(rwops,&stats) < 0)			RWOP_ERR_QUIT(rwops);
+	printf("  %u reads, %u hits, %u stalls (%u us), %u seeks, %u fills\n",
+	       stats.reads, stats.hits, stats.stalls, stats.stall_us,
+	       stats.seeks, stats.fills);
+
+	/* seeks and odd sized reads must give the same data as the file */
+	rwops->seek(rwops,0,RW_SEEK_SET);
+	for ( i = 0; i < 1000; ++i ) {
+		static Uint8 chunk[3*BENCH_CHUNK];
+		int pos = (i * 7919 * 13) % BENCH_SIZE;
+		int len = (i * 37) % sizeof(chunk);
+		int n;
+
+		if ( i % 3 == 0 ) {
+			/* just keep reading */
+			pos = rwops->seek(rwops,0,RW_SEEK_CUR);
+		} else if ( i % 3 == 1 ) {
+			if (pos != rwops->seek(rwops,pos,RW_SEEK_SET))	RWOP_ERR_QUIT(rwops);
+		} else {
+			pos = rwops->seek(rwops,(i % 5) * 100,RW_SEEK_CUR);
+		}
+		if ( pos + len > BENCH_SIZE ) {
+			len = BENCH_SIZE - pos;
+		}
+		n = rwops->read(rwops,chunk,1,len);
+		if (n != len || SDL_memcmp(chunk,data+pos,len))	RWOP_ERR_QUIT(rwops);
+	}
+
+	/* relative seeks past the buffers, and a failed seek, keep the position */
+	if (0 != rwops->seek(rwops,0,RW_SEEK_SET))			RWOP_ERR_QUIT(rwops);
+	if (1 != rwops->read(rwops,test_buf,1,1))			RWOP_ERR_QUIT(rwops);
+	if (500001 != rwops->seek(rwops,500000,RW_SEEK_CUR))	RWOP_ERR_QUIT(rwops);
+	if (1 != rwops->read(rwops,test_buf,1,1))			RWOP_ERR_QUIT(rwops);
+	if (test_buf[0] != (char)data[500001])				RWOP_ERR_QUIT(rwops);
+	if (100002 != rwops->seek(rwops,-400000,RW_SEEK_CUR))	RWOP_ERR_QUIT(rwops);
+	if (10 != rwops->read(rwops,test_buf,1,10))			RWOP_ERR_QUIT(rwops);
+	if (SDL_memcmp(test_buf,data+100002,10))			RWOP_ERR_QUIT(rwops);
+	if (-1 != rwops->seek(rwops,-1,RW_SEEK_SET))		RWOP_ERR_QUIT(rwops);
+	if (10 != rwops->read(rwops,test_buf,1,10))			RWOP_ERR_QUIT(rwops);
+	if (SDL_memcmp(test_buf,data+100012,10))			RWOP_ERR_QUIT(rwops);
+	if (BENCH_SIZE-10 != rwops->seek(rwops,-10,RW_SEEK_END))	RWOP_ERR_QUIT(rwops);
+	if (5 != rwops->read(rwops,test_buf,2,10))			RWOP_ERR_QUIT(rwops);
+	if (SDL_memcmp(test_buf,data+BENCH_SIZE-10,10))		RWOP_ERR_QUIT(rwops);
+	if (0 != rwops->read(rwops,test_buf,1,1))			RWOP_ERR_QUIT(rwops);
+	rwops->close(rwops);
+
+	rwops = SDL_RWFromFile(FBASENAME1,"rb");
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	if (check != bench_read("file",rwops))				RWOP_ERR_QUIT(rwops);
+	rwops->close(rwops);
+
+	rwops = SDL_RWFromFileMapped(FBASENAME1);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+	if (check != bench_read("mapped file",rwops))		RWOP_ERR_QUIT(rwops);
+
+	/* same thing without the copy, if the file was mapped */
+	rwops->seek(rwops,0,RW_SEEK_SET);
+	mapped = (const Uint8 *)SDL_RWmap(rwops,&maplen);
+	if (mapped) {
+		if (maplen != BENCH_SIZE)						RWOP_ERR_QUIT(rwops);
+		sum = 0;
+		start = SDL_GetTicks();
+		for ( pass = 0; pass < BENCH_PASSES; ++pass ) {
+			for ( i = 0; i < BENCH_SIZE; i += 64 ) {
+				sum += mapped[i];
+			}
+		}
+		ms = SDL_GetTicks() - start;
+		if ( ms == 0 ) {
+			ms = 1;
+		}
+		printf("%-14s %6d ms  %8.1f MB/s\n", "SDL_RWmap", ms,
+		       (double)BENCH_SIZE * BENCH_PASSES / (1024.0*1024.0) * 1000.0 / ms);
+		if (sum != check)								RWOP_ERR_QUIT(rwops);
+	} else {
+		printf("file isn't memory mapped\n");
+	}
+	rwops->close(rwops);
+	benchmark_slow(data,4*1024*1024);
+
+	printf("reading compressed data %d times in %d byte chunks\n",
+	       BENCH_PASSES, BENCH_CHUNK);
+	make_compressible(data,BENCH_SIZE);
+	benchmark_compressed(data,SDL_COMPRESS_LZ,"LZ");
+	benchmark_compressed(data,SDL_COMPRESS_ZLIB,"zlib");
+	free(data);
+}
+
 
 
 int main(int argc, char *argv[])
@@ -177,6 +483,63 @@ int main(int argc, char *argv[])
 														RWOP_ERR_QUIT(rwops);
 	rwops->close(rwops);
 	printf("test5 OK\n");
+
+/* test6 : 64-bit seeks, size and mapping */
+	rwops = SDL_RWFromFileMapped(FBASENAME1);
+	if (!rwops)											RWOP_ERR_QUIT(rwops);
+#ifdef SDL_HAS_64BIT_TYPE
+	if (54!=SDL_RWsize(rwops))							RWOP_ERR_QUIT(rwops);
+	if (47!=SDL_RWseek64(rwops,-7,RW_SEEK_END))			RWOP_ERR_QUIT(rwops);
+	if (47!=SDL_RWtell64(rwops))						RWOP_ERR_QUIT(rwops);
+#else
+	if (47!=rwops->seek(rwops,-7,RW_SEEK_END))			RWOP_ERR_QUIT(rwops);
+#endif
+	{
+		size_t maplen;
+		const char *mapped = (const char *)SDL_RWmap(rwops,&maplen);
+		if (mapped && (maplen != 7 || SDL_memcmp(mapped,"1234567",7)))
+														RWOP_ERR_QUIT(rwops);
+		printf("test6 OK (%s)\n", mapped ? "mapped" : "not mapped");
+	}
+	rwops->close(rwops);
+
+/* test7 : endian arrays match the single value functions */
+	{
+		Uint16 a16[100];
+		Uint32 a32[100];
+		Uint64 a64[100];
+		Uint8 mem[800];
+		int i;
+
+		for ( i = 0; i < 800; ++i ) {
+			mem[i] = (Uint8)(i * 13 + 5);
+		}
+		rwops = SDL_RWFromMem(mem,sizeof(mem));
+		if (!rwops)										RWOP_ERR_QUIT(rwops);
+		if (100!=SDL_ReadBE16Array(rwops,a16,100))		RWOP_ERR_QUIT(rwops);
+		if (100!=SDL_ReadLE32Array(rwops,a32,100))		RWOP_ERR_QUIT(rwops);
+		if (25!=SDL_ReadBE64Array(rwops,a64,100))		RWOP_ERR_QUIT(rwops); /* short read */
+		rwops->seek(rwops,0,RW_SEEK_SET);
+		for ( i = 0; i < 100; ++i )
+			if (a16[i]!=SDL_ReadBE16(rwops))			RWOP_ERR_QUIT(rwops);
+		for ( i = 0; i < 100; ++i )
+			if (a32[i]!=SDL_ReadLE32(rwops))			RWOP_ERR_QUIT(rwops);
+		for ( i = 0; i < 25; ++i )
+			if (a64[i]!=SDL_ReadBE64(rwops))			RWOP_ERR_QUIT(rwops);
+		rwops->seek(rwops,0,RW_SEEK_SET);
+		if (100!=SDL_WriteLE16Array(rwops,a16,100))		RWOP_ERR_QUIT(rwops);
+		if (100!=SDL_WriteBE32Array(rwops,a32,100))		RWOP_ERR_QUIT(rwops);
+		if (25!=SDL_WriteLE64Array(rwops,a64,50))		RWOP_ERR_QUIT(rwops); /* full */
+		rwops->seek(rwops,0,RW_SEEK_SET);
+		for ( i = 0; i < 100; ++i )
+			if (a16[i]!=SDL_ReadLE16(rwops))			RWOP_ERR_QUIT(rwops);
+		for ( i = 0; i < 100; ++i )
+			if (a32[i]!=SDL_ReadBE32(rwops))			RWOP_ERR_QUIT(rwops);
+		rwops->close(rwops);
+		printf("test7 OK\n");
+	}
+
+	benchmark();
 	cleanup();
 	return 0; /* all ok */
 }
@@ -0,0 +1,349 @@
+
+/* Check SDL_FillRect(), SDL_FillRects() and overlapping blits of a surface
+   onto itself at 8, 16, 24 and 32 bpp against a simple per-pixel version.
+
+   testfill [iterations]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define DEFAULT_ITERATIONS	2000
+#define SURFACE_W	157
+#define SURFACE_H	41
+#define MAX_RECTS	8
+
+static Uint32 seed = 12345;
+static SDL_Surface *surface;
+static Uint8 *expected;
+static Uint8 *scratch;
+
+/* Call this instead of exit(), so we can clean up SDL: atexit() is evil. */
+static void quit(int rc)
+{
+	if ( surface ) {
+		SDL_FreeSurface(surface);
+	}
+	free(expected);
+	free(scratch);
+	SDL_Quit();
+	exit(rc);
+}
+
+static Uint32 random_next(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) | (seed << 16);
+}
+
+/* A random number in [lo, hi] */
+static int random_range(int lo, int hi)
+{
+	return lo + (int)(random_next() % (Uint32)(hi - lo + 1));
+}
+
+static SDL_Surface *create_surface(int bpp)
+{
+	Uint32 rmask = 0, gmask = 0, bmask = 0;
+
+	switch (bpp) {
+	    case 16:
+		rmask = 0xF800; gmask = 0x07E0; bmask = 0x001F;
+		break;
+	    case 24:
+	    case 32:
+		rmask = 0xFF0000; gmask = 0x00FF00; bmask = 0x0000FF;
+		break;
+	}
+	return SDL_CreateRGBSurface(SDL_SWSURFACE, SURFACE_W, SURFACE_H, bpp,
+	                            rmask, gmask, bmask, 0);
+}
+
+/* Store a pixel the way SDL does for each depth */
+static void put_pixel(Uint8 *row, int x, int bpp, Uint32 color)
+{
+	Uint8 *p = row + x * bpp;
+
+	switch (bpp) {
+	    case 1:
+		*p = (Uint8)color;
+		break;
+	    case 2:
+		*(Uint16 *)p = (Uint16)color;
+		break;
+	    case 3:
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		p[0] = (Uint8)(color >> 16);
+		p[1] = (Uint8)(color >> 8);
+		p[2] = (Uint8)color;
+#else
+		p[0] = (Uint8)color;
+		p[1] = (Uint8)(color >> 8);
+		p[2] = (Uint8)(color >> 16);
+#endif
+		break;
+	    case 4:
+		*(Uint32 *)p = color;
+		break;
+	}
+}
+
+/* Clip 'rect' to 'clip' without using SDL, returns 0 if nothing is left */
+static int clip_rect(const SDL_Rect *rect, const SDL_Rect *clip, SDL_Rect *out)
+{
+	int x0 = SDL_max(rect->x, clip->x);
+	int y0 = SDL_max(rect->y, clip->y);
+	int x1 = SDL_min(rect->x + rect->w, clip->x + clip->w);
+	int y1 = SDL_min(rect->y + rect->h, clip->y + clip->h);
+
+	if ( x1 <= x0 || y1 <= y0 ) {
+		return(0);
+	}
+	out->x = (Sint16)x0;
+	out->y = (Sint16)y0;
+	out->w = (Uint16)(x1 - x0);
+	out->h = (Uint16)(y1 - y0);
+	return(1);
+}
+
+static void reference_fill(const SDL_Rect *rect, Uint32 color)
+{
+	int bpp = surface->format->BytesPerPixel;
+	int x, y;
+
+	for ( y = rect->y; y < rect->y + rect->h; ++y ) {
+		Uint8 *row = expected + y * surface->pitch;
+		for ( x = rect->x; x < rect->x + rect->w; ++x ) {
+			put_pixel(row, x, bpp, color);
+		}
+	}
+}
+
+static void compare(const char *what, int iteration)
+{
+	int bpp = surface->format->BytesPerPixel;
+	int x, y;
+
+	for ( y = 0; y < surface->h; ++y ) {
+		const Uint8 *have = (const Uint8 *)surface->pixels + y * surface->pitch;
+		const Uint8 *want = expected + y * surface->pitch;
+		if ( SDL_memcmp(have, want, surface->w * bpp) == 0 ) {
+			continue;
+		}
+		for ( x = 0; SDL_memcmp(have + x * bpp, want + x * bpp, bpp) == 0; ++x ) {
+			/* Find the first pixel that differs */ ;
+		}
+		fprintf(stderr, "%d bpp %s, iteration %d: pixel (%d,%d) is wrong\n",
+		        bpp * 8, what, iteration, x, y);
+		quit(1);
+	}
+}
+
+static void random_pixels(void)
+{
+	int i, size = surface->pitch * surface->h;
+
+	for ( i = 0; i < size; ++i ) {
+		((Uint8 *)surface->pixels)[i] = (Uint8)random_next();
+	}
+	SDL_memcpy(expected, surface->pixels, size);
+}
+
+/* A rectangle that may hang over any edge of the surface */
+static void random_rect(SDL_Rect *rect)
+{
+	rect->x = (Sint16)random_range(-8, surface->w + 8);
+	rect->y = (Sint16)random_range(-4, surface->h + 4);
+	rect->w = (Uint16)random_range(0, surface->w + 16);
+	rect->h = (Uint16)random_range(0, 8);
+}
+
+static Uint32 random_color(void)
+{
+	Uint32 mask = 0xFFFFFFFF >> (32 - surface->format->BitsPerPixel);
+
+	/* Zero takes the SDL_memset() path, so make it common */
+	if ( (random_next() % 8) == 0 ) {
+		return(0);
+	}
+	return random_next() & mask;
+}
+
+/* Every width at every alignment, where the row fill loops have their tails */
+static void check_widths(void)
+{
+	SDL_Rect rect, clip;
+	Uint32 color;
+	int w, x;
+
+	SDL_SetClipRect(surface, NULL);
+	SDL_GetClipRect(surface, &clip);
+	random_pixels();
+	for ( w = 1; w <= 96; ++w ) {
+		for ( x = 0; x < 8; ++x ) {
+			rect.x = (Sint16)x;
+			rect.y = (Sint16)random_range(0, surface->h - 3);
+			rect.w = (Uint16)w;
+			rect.h = 3;
+			color = random_color();
+			reference_fill(&rect, color);
+			if ( SDL_FillRect(surface, &rect, color) < 0 ) {
+				fprintf(stderr, "SDL_FillRect() failed: %s\n", SDL_GetError());
+				quit(1);
+			}
+			compare("fill width", w);
+		}
+	}
+}
+
+static void check_fills(int iterations)
+{
+	SDL_Rect rects[MAX_RECTS], want[MAX_RECTS], clip;
+	Uint32 color;
+	int i, j, n;
+
+	random_pixels();
+	for ( i = 0; i < iterations; ++i ) {
+		/* Half of the time with a clip rectangle */
+		if ( random_next() & 1 ) {
+			SDL_Rect area;
+			random_rect(&area);
+			area.h = (Uint16)random_range(0, surface->h);
+			SDL_SetClipRect(surface, &area);
+		} else {
+			SDL_SetClipRect(surface, NULL);
+		}
+		SDL_GetClipRect(surface, &clip);
+
+		color = random_color();
+		n = random_range(1, MAX_RECTS);
+		for ( j = 0; j < n; ++j ) {
+			random_rect(&rects[j]);
+			if ( clip_rect(&rects[j], &clip, &want[j]) ) {
+				reference_fill(&want[j], color);
+			} else {
+				want[j].w = want[j].h = 0;
+			}
+		}
+
+		if ( n == 1 ) {
+			if ( SDL_FillRect(surface, &rects[0], color) < 0 ) {
+				fprintf(stderr, "SDL_FillRect() failed: %s\n", SDL_GetError());
+				quit(1);
+			}
+			compare("SDL_FillRect", i);
+			continue;
+		}
+		if ( SDL_FillRects(surface, rects, n, color) < 0 ) {
+			fprintf(stderr, "SDL_FillRects() failed: %s\n", SDL_GetError());
+			quit(1);
+		}
+		compare("SDL_FillRects", i);
+		for ( j = 0; j < n; ++j ) {
+			if ( !want[j].w ) {
+				if ( rects[j].w && rects[j].h ) {
+					fprintf(stderr, "%d bpp SDL_FillRects, iteration %d: rect %d wasn't emptied\n",
+					        surface->format->BitsPerPixel, i, j);
+					quit(1);
+				}
+			} else if ( SDL_memcmp(&rects[j], &want[j], sizeof(want[j])) != 0 ) {
+				fprintf(stderr, "%d bpp SDL_FillRects, iteration %d: rect %d was clipped wrong\n",
+				        surface->format->BitsPerPixel, i, j);
+				quit(1);
+			}
+		}
+	}
+	SDL_SetClipRect(surface, NULL);
+}
+
+/* Blit part of the surface onto itself, shifted by a few pixels */
+static void check_overlap(int iterations)
+{
+	int bpp = surface->format->BytesPerPixel;
+	SDL_Rect src, dst;
+	int i, y;
+
+	SDL_SetClipRect(surface, NULL);
+	random_pixels();
+	for ( i = 0; i < iterations; ++i ) {
+		/* Keep both rectangles inside the surface, so nothing is clipped */
+		src.w = (Uint16)random_range(1, surface->w - 16);
+		src.h = (Uint16)random_range(1, surface->h - 8);
+		src.x = (Sint16)random_range(8, surface->w - 8 - src.w);
+		src.y = (Sint16)random_range(4, surface->h - 4 - src.h);
+		dst.x = (Sint16)(src.x + random_range(-8, 8));
+		dst.y = (Sint16)(src.y + random_range(-4, 4));
+
+		/* The reference goes through a separate buffer */
+		for ( y = 0; y < src.h; ++y ) {
+			SDL_memcpy(scratch + y * src.w * bpp,
+			           expected + (src.y + y) * surface->pitch + src.x * bpp,
+			           src.w * bpp);
+		}
+		for ( y = 0; y < src.h; ++y ) {
+			SDL_memcpy(expected + (dst.y + y) * surface->pitch + dst.x * bpp,
+			           scratch + y * src.w * bpp,
+			           src.w * bpp);
+		}
+
+		if ( SDL_BlitSurface(surface, &src, surface, &dst) < 0 ) {
+			fprintf(stderr, "SDL_BlitSurface() failed: %s\n", SDL_GetError());
+			quit(1);
+		}
+		compare("overlapping blit", i);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const int depths[] = { 8, 16, 24, 32 };
+	int iterations = DEFAULT_ITERATIONS;
+	int i;
+
+	if ( argc > 1 ) {
+		iterations = atoi(argv[1]);
+	}
+	if ( iterations < 1 ) {
+		fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+		return(1);
+	}
+
+	/* Load the SDL library */
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n",SDL_GetError());
+		return(1);
+	}
+
+	for ( i = 0; i < SDL_arraysize(depths); ++i ) {
+		surface = create_surface(depths[i]);
+		if ( !surface ) {
+			fprintf(stderr, "Couldn't create %d bpp surface: %s\n",
+			        depths[i], SDL_GetError());
+			quit(1);
+		}
+		expected = (Uint8 *)malloc(surface->pitch * surface->h);
+		scratch = (Uint8 *)malloc(surface->pitch * surface->h);
+		if ( !expected || !scratch ) {
+			fprintf(stderr, "Out of memory\n");
+			quit(1);
+		}
+
+		printf("Checking %d bpp\n", depths[i]);
+		check_widths();
+		check_fills(iterations);
+		check_overlap(iterations);
+
+		SDL_FreeSurface(surface);
+		surface = NULL;
+		free(expected);
+		expected = NULL;
+		free(scratch);
+		scratch = NULL;
+	}
+	printf("All fills and blits passed\n");
+
+	quit(0);
+	return(0);
+}
@@ -1,8 +1,11 @@
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "SDL.h"
 
+#define BENCH_ROUNDS	500
+
 static size_t widelen(char *data)
 {
 	size_t len = 0;
@@ -13,6 +16,104 @@ static size_t widelen(char *data)
 	return len;
 }
 
+/* Convert the same text many times, returns megabytes per second */
+static double convert_speed(const char *tocode, const char *fromcode, const char *data, size_t len, int use_iconv)
+{
+	SDL_iconv_t cd = (SDL_iconv_t)-1;
+	char *buffer = NULL;
+	const char *inbuf;
+	char *outbuf;
+	size_t inbytesleft, outbytesleft;
+	Uint64 start, ticks;
+	int i;
+
+	if ( use_iconv ) {
+		cd = SDL_iconv_open(tocode, fromcode);
+		buffer = (char *)malloc(len * 4);
+		if ( cd == (SDL_iconv_t)-1 || !buffer ) {
+			free(buffer);
+			return 0.0;
+		}
+	}
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < BENCH_ROUNDS; ++i ) {
+		if ( use_iconv ) {
+			inbuf = data;
+			inbytesleft = len;
+			outbuf = buffer;
+			outbytesleft = len * 4;
+			while ( inbytesleft > 0 ) {
+				size_t oldinbytesleft = inbytesleft;
+				if ( SDL_iconv(cd, &inbuf, &inbytesleft, &outbuf, &outbytesleft) == SDL_ICONV_EILSEQ ) {
+					++inbuf;
+					--inbytesleft;
+				}
+				if ( inbytesleft == oldinbytesleft ) {
+					break;
+				}
+			}
+		} else {
+			SDL_free(SDL_iconv_string(tocode, fromcode, data, len));
+		}
+	}
+	ticks = SDL_GetPerformanceCounter() - start;
+	if ( use_iconv ) {
+		SDL_iconv_close(cd);
+		free(buffer);
+	}
+	return ((double)len * BENCH_ROUNDS / (1024.0 * 1024.0)) /
+	       ((double)ticks / SDL_GetPerformanceFrequency());
+}
+
+/* Time the whole file to and from UTF-8 with SDL_iconv_string() and SDL_iconv() */
+static void benchmark(FILE *file)
+{
+	static const struct {
+		const char *name;
+		size_t unit;
+	} formats[] = {
+		{ "ISO-8859-1", 1 },
+		{ "UTF-16LE", 2 },
+		{ "UTF-16BE", 2 },
+		{ "UTF-32LE", 4 },
+		{ "UCS-4", 4 },
+	};
+	char *utf8, *text;
+	size_t len, textlen;
+	int i;
+
+	fseek(file, 0, SEEK_END);
+	len = (size_t)ftell(file);
+	rewind(file);
+	utf8 = (char *)malloc(len + 1);
+	if ( !utf8 || fread(utf8, 1, len, file) != len ) {
+		free(utf8);
+		return;
+	}
+	utf8[len] = '\0';
+
+	fprintf(stderr, "\nConverting %u bytes, %d times:\n", (unsigned)len, BENCH_ROUNDS);
+	for ( i = 0; i < SDL_arraysize(formats); ++i ) {
+		fprintf(stderr, "UTF-8 -> %-10s  SDL_iconv_string %7.1f MB/s, SDL_iconv %7.1f MB/s\n",
+		        formats[i].name,
+		        convert_speed(formats[i].name, "UTF-8", utf8, len, 0),
+		        convert_speed(formats[i].name, "UTF-8", utf8, len, 1));
+
+		/* The file has no zeros, so the text ends at the first zero unit */
+		text = SDL_iconv_string(formats[i].name, "UTF-8", utf8, len);
+		textlen = 0;
+		while ( text && SDL_memcmp(text + textlen, "\0\0\0\0", formats[i].unit) != 0 ) {
+			textlen += formats[i].unit;
+		}
+		fprintf(stderr, "%-10s -> UTF-8  SDL_iconv_string %7.1f MB/s, SDL_iconv %7.1f MB/s\n",
+		        formats[i].name,
+		        convert_speed("UTF-8", formats[i].name, text, textlen, 0),
+		        convert_speed("UTF-8", formats[i].name, text, textlen, 1));
+		SDL_free(text);
+	}
+	free(utf8);
+}
+
 int main(int argc, char *argv[])
 {
 	const char * formats[] = {
@@ -71,5 +172,9 @@ int main(int argc, char *argv[])
 	}
 
 	fprintf(stderr, "\nTotal errors: %d\n", errors);
+
+	benchmark(file);
+	fclose(file);
+
 	return (errors ? errors + 1 : 0);
 }
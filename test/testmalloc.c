@@ -0,0 +1,270 @@
+
+/* Compare SDL_malloc() against the C library malloc() with several threads
+   allocating and freeing at once.  Configure SDL with and without
+   --enable-threaded-malloc and run this to pick the allocator for a
+   machine and workload.
+
+   testmalloc [threads] [iterations]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+#include "SDL_thread.h"
+
+#define DEFAULT_THREADS	4
+#define DEFAULT_ITERS	1000000
+#define MAX_THREADS	64
+#define SLOTS		1024	/* Blocks each thread holds on to */
+#define HANDOFF		4096	/* Blocks passed to another thread to free */
+
+typedef struct {
+	const char *name;
+	void *(*alloc)(size_t);
+	void (*release)(void *);
+} Allocator;
+
+typedef struct {
+	const Allocator *allocator;
+	Uint32 seed;
+	int failed;
+	void *handoff[HANDOFF];
+} ThreadData;
+
+static int iterations = DEFAULT_ITERS;
+static ThreadData data[MAX_THREADS];
+
+/* Call this instead of exit(), so we can clean up SDL: atexit() is evil. */
+static void quit(int rc)
+{
+	SDL_Quit();
+	exit(rc);
+}
+
+static void *libc_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+static void libc_free(void *mem)
+{
+	free(mem);
+}
+
+static void *sdl_malloc(size_t size)
+{
+	return SDL_malloc(size);
+}
+
+static void sdl_free(void *mem)
+{
+	SDL_free(mem);
+}
+
+static const Allocator allocators[] = {
+	{ "malloc", libc_malloc, libc_free },
+	{ "SDL_malloc", sdl_malloc, sdl_free }
+};
+
+static Uint32 random_next(Uint32 *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return(*seed >> 8);
+}
+
+/* Mostly small blocks, like events and surface headers, some bigger ones */
+static size_t random_size(Uint32 *seed)
+{
+	Uint32 r = random_next(seed);
+
+	if ( r % 100 < 90 ) {
+		return 1 + (r >> 7) % 256;
+	} else if ( r % 100 < 99 ) {
+		return 257 + (r >> 7) % 4096;
+	} else {
+		return 4353 + (r >> 7) % 65536;
+	}
+}
+
+/* Tag the ends of a block so overlapping blocks show up */
+static void *alloc_block(const Allocator *allocator, size_t size, Uint8 tag)
+{
+	Uint8 *mem = (Uint8 *)allocator->alloc(size);
+
+	if ( mem ) {
+		mem[0] = tag;
+		mem[size - 1] = tag;
+	}
+	return(mem);
+}
+
+static int check_block(void *mem, size_t size, Uint8 tag)
+{
+	return (((Uint8 *)mem)[0] == tag && ((Uint8 *)mem)[size - 1] == tag);
+}
+
+int SDLCALL AllocThread(void *arg)
+{
+	ThreadData *td = (ThreadData *)arg;
+	const Allocator *allocator = td->allocator;
+	void *slots[SLOTS];
+	size_t sizes[SLOTS];
+	Uint32 seed = td->seed;
+	int i, n;
+
+	SDL_memset(slots, 0, sizeof(slots));
+	for ( i = 0; i < iterations; ++i ) {
+		n = random_next(&seed) % SLOTS;
+		if ( slots[n] ) {
+			if ( !check_block(slots[n], sizes[n], (Uint8)n) ) {
+				td->failed = 1;
+			}
+			allocator->release(slots[n]);
+			slots[n] = NULL;
+		} else {
+			sizes[n] = random_size(&seed);
+			slots[n] = alloc_block(allocator, sizes[n], (Uint8)n);
+			if ( !slots[n] ) {
+				td->failed = 1;
+			}
+		}
+	}
+	for ( n = 0; n < SLOTS; ++n ) {
+		if ( slots[n] ) {
+			allocator->release(slots[n]);
+		}
+	}
+
+	/* Leave some blocks for another thread to free */
+	for ( i = 0; i < HANDOFF; ++i ) {
+		td->handoff[i] = alloc_block(allocator, random_size(&seed), 0xA5);
+	}
+	return(0);
+}
+
+int SDLCALL FreeThread(void *arg)
+{
+	ThreadData *td = (ThreadData *)arg;
+	int i;
+
+	for ( i = 0; i < HANDOFF; ++i ) {
+		if ( !td->handoff[i] || ((Uint8 *)td->handoff[i])[0] != 0xA5 ) {
+			td->failed = 1;
+		}
+		td->allocator->release(td->handoff[i]);
+	}
+	return(0);
+}
+
+static void RunThreads(int (SDLCALL *fn)(void *), int nthreads, int shift)
+{
+	SDL_Thread *threads[MAX_THREADS];
+	int i;
+
+	for ( i = 0; i < nthreads; ++i ) {
+		threads[i] = SDL_CreateThread(fn, &data[(i + shift) % nthreads]);
+		if ( threads[i] == NULL ) {
+			fprintf(stderr, "Couldn't create thread: %s\n", SDL_GetError());
+			quit(1);
+		}
+	}
+	for ( i = 0; i < nthreads; ++i ) {
+		SDL_WaitThread(threads[i], NULL);
+	}
+}
+
+static void RunTest(const Allocator *allocator, int nthreads)
+{
+	Uint64 start, ticks;
+	double seconds;
+	int i;
+
+	for ( i = 0; i < nthreads; ++i ) {
+		data[i].allocator = allocator;
+		data[i].seed = 1234 + i;
+		data[i].failed = 0;
+	}
+
+	start = SDL_GetPerformanceCounter();
+	RunThreads(AllocThread, nthreads, 0);
+	/* Each thread frees the blocks the one before it left behind */
+	RunThreads(FreeThread, nthreads, 1);
+	ticks = SDL_GetPerformanceCounter() - start;
+	seconds = (double)ticks / SDL_GetPerformanceFrequency();
+
+	printf("%-12s %2d threads  %8.1f ms  %12.0f ops/sec\n",
+	       allocator->name, nthreads, seconds * 1000.0,
+	       (double)nthreads * (iterations + 2 * HANDOFF) / seconds);
+	for ( i = 0; i < nthreads; ++i ) {
+		if ( data[i].failed ) {
+			fprintf(stderr, "%s returned a bad block!\n", allocator->name);
+			quit(1);
+		}
+	}
+}
+
+static void PrintStats(void)
+{
+	SDL_MallocStats stats;
+	int i;
+
+	if ( SDL_GetMallocStats(&stats) < 0 ) {
+		printf("No allocator statistics: %s\n", SDL_GetError());
+		return;
+	}
+	printf("SDL_malloc: %u arenas, %u threads with caches\n",
+	       stats.arenas, stats.threads);
+	for ( i = 0; i < SDL_MALLOC_CLASSES; ++i ) {
+		if ( stats.class_bytes[i] ) {
+			printf("  %4u byte blocks: %8u bytes in use\n",
+			       (unsigned)stats.class_size[i], (unsigned)stats.class_bytes[i]);
+		}
+	}
+	printf("  Larger blocks:    %8u bytes in use\n", (unsigned)stats.large_bytes);
+	printf("  In use %u, cached %u, peak %u bytes\n", (unsigned)stats.in_use,
+	       (unsigned)stats.cached_bytes, (unsigned)stats.peak);
+	printf("  Arena locks taken %u times, %u contended\n",
+	       stats.lock_acquires, stats.lock_contended);
+}
+
+int main(int argc, char *argv[])
+{
+	int maxthreads = DEFAULT_THREADS;
+	int nthreads, i;
+
+	if ( argc > 1 ) {
+		maxthreads = atoi(argv[1]);
+	}
+	if ( argc > 2 ) {
+		iterations = atoi(argv[2]);
+	}
+	if ( maxthreads <= 0 || maxthreads > MAX_THREADS || iterations < 0 ) {
+		fprintf(stderr, "Usage: %s [threads] [iterations]\n", argv[0]);
+		return(1);
+	}
+
+	/* Load the SDL library */
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n",SDL_GetError());
+		return(1);
+	}
+	printf("%d CPUs, up to %d threads, %d operations each\n",
+	       SDL_GetCPUCount(), maxthreads, iterations);
+
+	for ( nthreads = 1; ; nthreads *= 2 ) {
+		if ( nthreads > maxthreads ) {
+			nthreads = maxthreads;
+		}
+		for ( i = 0; i < SDL_arraysize(allocators); ++i ) {
+			RunTest(&allocators[i], nthreads);
+		}
+		if ( nthreads == maxthreads ) {
+			break;
+		}
+	}
+	PrintStats();
+
+	SDL_Quit();
+	return(0);
+}
@@ -0,0 +1,161 @@
+
+/* Compare the SDL thread pool against starting a thread per task */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+#include "SDL_thread.h"
+
+#define DEFAULT_TASKS	2000
+#define DEFAULT_WORK	20000
+#define BATCH		64	/* Threads alive at once in the naive test */
+
+static int work = DEFAULT_WORK;
+static Uint32 *results;
+
+/* Call this instead of exit(), so we can clean up SDL: atexit() is evil. */
+static void quit(int rc)
+{
+	SDL_Quit();
+	exit(rc);
+}
+
+static Uint32 Crunch(int task)
+{
+	Uint32 x = (Uint32)task + 1;
+	int i;
+
+	for ( i = 0; i < work; ++i ) {
+		x = x * 1664525 + 1013904223;
+		x ^= x >> 13;
+	}
+	return(x);
+}
+
+int SDLCALL ThreadTask(void *data)
+{
+	int task = (int)(size_t)data;
+	results[task] = Crunch(task);
+	return(0);
+}
+
+void SDLCALL JobTask(void *data)
+{
+	int task = (int)(size_t)data;
+	results[task] = Crunch(task);
+}
+
+void SDLCALL RangeTask(void *data, int first, int last)
+{
+	int task;
+	for ( task = first; task < last; ++task ) {
+		results[task] = Crunch(task);
+	}
+}
+
+static void Report(const char *name, int tasks, Uint32 start)
+{
+	Uint32 ms = SDL_GetTicks() - start;
+	if ( ms == 0 ) {
+		ms = 1;
+	}
+	printf("%-22s %6d ms  %8.0f tasks/sec\n", name, ms,
+	       (double)tasks * 1000.0 / ms);
+}
+
+int main(int argc, char *argv[])
+{
+	SDL_Thread *threads[BATCH];
+	SDL_Job **jobs;
+	Uint32 start, check, sum;
+	int tasks = DEFAULT_TASKS;
+	int i, j, n;
+
+	if ( argc > 1 ) {
+		tasks = atoi(argv[1]);
+	}
+	if ( argc > 2 ) {
+		work = atoi(argv[2]);
+	}
+	if ( tasks <= 0 || work < 0 ) {
+		fprintf(stderr, "Usage: %s [tasks] [work per task]\n", argv[0]);
+		return(1);
+	}
+
+	/* Load the SDL library */
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n",SDL_GetError());
+		return(1);
+	}
+
+	results = (Uint32 *)malloc(tasks * sizeof(*results));
+	jobs = (SDL_Job **)malloc(tasks * sizeof(*jobs));
+	if ( !results || !jobs ) {
+		fprintf(stderr, "Out of memory\n");
+		quit(1);
+	}
+	printf("%d CPUs, %d pool workers, %d tasks of %d steps\n",
+	       SDL_GetCPUCount(), SDL_GetThreadPoolSize(), tasks, work);
+
+	start = SDL_GetTicks();
+	check = 0;
+	for ( i = 0; i < tasks; ++i ) {
+		check += Crunch(i);
+	}
+	Report("single thread", tasks, start);
+
+	start = SDL_GetTicks();
+	for ( i = 0; i < tasks; i += n ) {
+		n = (tasks - i < BATCH) ? (tasks - i) : BATCH;
+		for ( j = 0; j < n; ++j ) {
+			threads[j] = SDL_CreateThread(ThreadTask, (void *)(size_t)(i + j));
+			if ( threads[j] == NULL ) {
+				fprintf(stderr, "Couldn't create thread: %s\n", SDL_GetError());
+				quit(1);
+			}
+		}
+		for ( j = 0; j < n; ++j ) {
+			SDL_WaitThread(threads[j], NULL);
+		}
+	}
+	Report("thread per task", tasks, start);
+
+	SDL_memset(results, 0, tasks * sizeof(*results));
+	start = SDL_GetTicks();
+	for ( i = 0; i < tasks; ++i ) {
+		jobs[i] = SDL_SubmitJob(JobTask, (void *)(size_t)i);
+		if ( jobs[i] == NULL ) {
+			fprintf(stderr, "Couldn't submit job: %s\n", SDL_GetError());
+			quit(1);
+		}
+	}
+	for ( i = 0; i < tasks; ++i ) {
+		SDL_WaitJob(jobs[i]);
+	}
+	Report("SDL_SubmitJob", tasks, start);
+	for ( i = 0, sum = 0; i < tasks; ++i ) {
+		sum += results[i];
+	}
+	if ( sum != check ) {
+		fprintf(stderr, "SDL_SubmitJob gave the wrong answer!\n");
+		quit(1);
+	}
+
+	SDL_memset(results, 0, tasks * sizeof(*results));
+	start = SDL_GetTicks();
+	SDL_ParallelFor(tasks, 0, RangeTask, NULL);
+	Report("SDL_ParallelFor", tasks, start);
+	for ( i = 0, sum = 0; i < tasks; ++i ) {
+		sum += results[i];
+	}
+	if ( sum != check ) {
+		fprintf(stderr, "SDL_ParallelFor gave the wrong answer!\n");
+		quit(1);
+	}
+
+	free(jobs);
+	free(results);
+	SDL_Quit();
+	return(0);
+}
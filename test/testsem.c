@@ -1,5 +1,6 @@
 
-/* Simple test of the SDL semaphore code */
+/* Simple test of the SDL semaphore code, followed by a benchmark of the
+   semaphore and condition variable wakeup latency and throughput */
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,6 +10,8 @@
 #include "SDL_thread.h"
 
 #define NUM_THREADS 10
+#define NUM_ROUNDS 100000
+#define NUM_CONSUMERS 4
 
 static SDL_sem *sem;
 int alive = 1;
@@ -58,6 +61,140 @@ static void TestWaitTimeout(void)
 	/* Check to make sure the return value indicates timed out */
 	if (retval != SDL_MUTEX_TIMEDOUT) 
 		fprintf(stderr, "SDL_SemWaitTimeout returned: %d; expected: %d\n", retval, SDL_MUTEX_TIMEDOUT);
+
+	SDL_DestroySemaphore(sem);
+}
+
+static SDL_sem *ping, *pong;
+static SDL_mutex *lock;
+static SDL_cond *cond;
+static int turn;
+
+int SDLCALL PongSem(void *data)
+{
+	int i;
+	for ( i = 0; i < NUM_ROUNDS; ++i ) {
+		SDL_SemWait(ping);
+		SDL_SemPost(pong);
+	}
+	return 0;
+}
+
+int SDLCALL PongCond(void *data)
+{
+	int i;
+	SDL_mutexP(lock);
+	for ( i = 0; i < NUM_ROUNDS; ++i ) {
+		while ( turn != 1 ) {
+			SDL_CondWait(cond, lock);
+		}
+		turn = 0;
+		SDL_CondSignal(cond);
+	}
+	SDL_mutexV(lock);
+	return 0;
+}
+
+int SDLCALL Consumer(void *data)
+{
+	int *count = (int *)data;
+	for ( ; ; ) {
+		SDL_SemWait(sem);
+		if ( !alive ) {
+			break;
+		}
+		++*count;
+	}
+	return 0;
+}
+
+static void Report(const char *name, Uint64 start, int ops)
+{
+	double usec;
+
+	usec = (double)(SDL_GetPerformanceCounter() - start) * 1000000.0 /
+	       SDL_GetPerformanceFrequency();
+	printf("%-26s %8.2f usec/op  %10.0f ops/sec\n", name,
+	       usec / ops, ops * 1000000.0 / usec);
+}
+
+static void TestPerformance(void)
+{
+	SDL_Thread *thread, *consumers[NUM_CONSUMERS];
+	int counts[NUM_CONSUMERS];
+	Uint64 start;
+	int i, total;
+
+	printf("Benchmarking, %d CPUs\n", SDL_GetCPUCount());
+
+	/* Uncontended post and wait */
+	sem = SDL_CreateSemaphore(0);
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < NUM_ROUNDS; ++i ) {
+		SDL_SemPost(sem);
+		SDL_SemWait(sem);
+	}
+	Report("SDL_sem uncontended", start, NUM_ROUNDS);
+
+	/* Wakeup latency: bounce between two threads */
+	ping = SDL_CreateSemaphore(0);
+	pong = SDL_CreateSemaphore(0);
+	thread = SDL_CreateThread(PongSem, NULL);
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < NUM_ROUNDS; ++i ) {
+		SDL_SemPost(ping);
+		SDL_SemWait(pong);
+	}
+	Report("SDL_sem round trip", start, NUM_ROUNDS);
+	SDL_WaitThread(thread, NULL);
+	SDL_DestroySemaphore(ping);
+	SDL_DestroySemaphore(pong);
+
+	lock = SDL_CreateMutex();
+	cond = SDL_CreateCond();
+	turn = 0;
+	thread = SDL_CreateThread(PongCond, NULL);
+	start = SDL_GetPerformanceCounter();
+	SDL_mutexP(lock);
+	for ( i = 0; i < NUM_ROUNDS; ++i ) {
+		turn = 1;
+		SDL_CondSignal(cond);
+		while ( turn != 0 ) {
+			SDL_CondWait(cond, lock);
+		}
+	}
+	SDL_mutexV(lock);
+	Report("SDL_cond round trip", start, NUM_ROUNDS);
+	SDL_WaitThread(thread, NULL);
+	SDL_DestroyCond(cond);
+	SDL_DestroyMutex(lock);
+
+	/* Throughput: one producer feeding several consumers */
+	alive = 1;
+	for ( i = 0; i < NUM_CONSUMERS; ++i ) {
+		counts[i] = 0;
+		consumers[i] = SDL_CreateThread(Consumer, &counts[i]);
+	}
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < NUM_ROUNDS; ++i ) {
+		SDL_SemPost(sem);
+	}
+	while ( SDL_SemValue(sem) > 0 ) {
+		SDL_Delay(0);
+	}
+	Report("SDL_sem producer/consumer", start, NUM_ROUNDS);
+	alive = 0;
+	for ( i = 0; i < NUM_CONSUMERS; ++i ) {
+		SDL_SemPost(sem);
+	}
+	for ( i = 0, total = 0; i < NUM_CONSUMERS; ++i ) {
+		SDL_WaitThread(consumers[i], NULL);
+		total += counts[i];
+	}
+	if ( total != NUM_ROUNDS ) {
+		fprintf(stderr, "Consumers got %d posts, expected %d\n", total, NUM_ROUNDS);
+	}
+	SDL_DestroySemaphore(sem);
 }
 
 int main(int argc, char **argv)
@@ -103,6 +240,8 @@ int main(int argc, char **argv)
 
 	TestWaitTimeout();
 
+	TestPerformance();
+
 	SDL_Quit();
 	return(0);
 }
@@ -0,0 +1,265 @@
+
+/* Time the SDL sorts against the C library qsort() on different inputs,
+   and check that they sort correctly.
+
+   testsort [count]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define DEFAULT_COUNT	1000000
+
+typedef struct {
+	Uint32 key;
+	Uint32 index;
+	Uint8 pad[4];
+} Record;
+
+static Uint32 seed = 12345;
+static Uint32 *input;
+static Uint32 *work;
+
+/* Call this instead of exit(), so we can clean up SDL: atexit() is evil. */
+static void quit(int rc)
+{
+	free(input);
+	free(work);
+	SDL_Quit();
+	exit(rc);
+}
+
+static Uint32 random_next(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) | (seed << 16);
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+	Uint32 x = *(const Uint32 *)a, y = *(const Uint32 *)b;
+	return (x > y) - (x < y);
+}
+
+static int compare_s32(const void *a, const void *b)
+{
+	Sint32 x = *(const Sint32 *)a, y = *(const Sint32 *)b;
+	return (x > y) - (x < y);
+}
+
+static int compare_record(const void *a, const void *b)
+{
+	const Record *x = (const Record *)a, *y = (const Record *)b;
+	return (x->key > y->key) - (x->key < y->key);
+}
+
+static void make_input(const char *kind, size_t count)
+{
+	size_t i;
+
+	for ( i = 0; i < count; ++i ) {
+		if ( SDL_strcmp(kind, "sorted") == 0 ) {
+			input[i] = (Uint32)i;
+		} else if ( SDL_strcmp(kind, "reverse") == 0 ) {
+			input[i] = (Uint32)(count - i);
+		} else if ( SDL_strcmp(kind, "organ pipe") == 0 ) {
+			input[i] = (Uint32)((i < count / 2) ? i : count - i);
+		} else if ( SDL_strcmp(kind, "duplicates") == 0 ) {
+			input[i] = random_next() % 16;
+		} else {
+			input[i] = random_next();
+		}
+	}
+}
+
+static Uint32 checksum(const Uint32 *data, size_t count)
+{
+	Uint32 sum = 0;
+	size_t i;
+
+	for ( i = 0; i < count; ++i ) {
+		sum += data[i] * 2654435761U;
+	}
+	return(sum);
+}
+
+static void check_sorted(const char *what, const Uint32 *data, size_t count, Uint32 sum)
+{
+	size_t i;
+
+	for ( i = 1; i < count; ++i ) {
+		if ( data[i-1] > data[i] ) {
+			fprintf(stderr, "%s: element %u is out of order\n", what, (unsigned)i);
+			quit(1);
+		}
+	}
+	if ( checksum(data, count) != sum ) {
+		fprintf(stderr, "%s: elements were lost\n", what);
+		quit(1);
+	}
+}
+
+static void run_sort(const char *what, int method, size_t count)
+{
+	Uint64 start, ticks;
+	Uint32 sum = checksum(input, count);
+
+	SDL_memcpy(work, input, count * sizeof(*work));
+	start = SDL_GetPerformanceCounter();
+	switch (method) {
+	    case 0:
+		qsort(work, count, sizeof(*work), compare_u32);
+		break;
+#ifndef HAVE_QSORT
+	    case 1:
+		SDL_qsort(work, count, sizeof(*work), compare_u32);
+		break;
+#endif
+	    case 2:
+		SDL_qsort_parallel(work, count, sizeof(*work), compare_u32);
+		break;
+	    case 3:
+		SDL_qsort_u32(work, count);
+		break;
+	}
+	ticks = SDL_GetPerformanceCounter() - start;
+	printf("  %-20s %8.2f ms\n", what,
+	       (double)ticks * 1000.0 / SDL_GetPerformanceFrequency());
+	check_sorted(what, work, count, sum);
+}
+
+/* Short arrays and odd element sizes, where the edge cases are */
+static void check_small(void)
+{
+	Record records[300];
+	Sint32 ints[300];
+	Uint32 keys[300];
+#ifdef SDL_HAS_64BIT_TYPE
+	Uint64 longs[300];
+#endif
+	size_t count, i;
+
+	for ( count = 0; count < SDL_arraysize(records); count += 1 + count / 8 ) {
+		for ( i = 0; i < count; ++i ) {
+			records[i].key = random_next() % 50;
+			records[i].index = (Uint32)i;
+			keys[i] = records[i].key;
+			ints[i] = (Sint32)random_next();
+#ifdef SDL_HAS_64BIT_TYPE
+			longs[i] = ((Uint64)random_next() << 32) | random_next();
+#endif
+		}
+		SDL_qsort_parallel(records, count, sizeof(*records), compare_record);
+		SDL_qsort_u32(keys, count);
+		SDL_qsort_s32(ints, count);
+#ifdef SDL_HAS_64BIT_TYPE
+		SDL_qsort_u64(longs, count);
+#endif
+		for ( i = 1; i < count; ++i ) {
+			if ( records[i-1].key > records[i].key || keys[i-1] > keys[i] ||
+			     ints[i-1] > ints[i] ) {
+				fprintf(stderr, "Sorting %u elements failed\n", (unsigned)count);
+				quit(1);
+			}
+#ifdef SDL_HAS_64BIT_TYPE
+			if ( longs[i-1] > longs[i] ) {
+				fprintf(stderr, "Sorting %u 64-bit keys failed\n", (unsigned)count);
+				quit(1);
+			}
+#endif
+		}
+		for ( i = 0; i < count; ++i ) {
+			if ( records[i].key != keys[i] ) {
+				fprintf(stderr, "Sorting %u records lost some\n", (unsigned)count);
+				quit(1);
+			}
+		}
+	}
+}
+
+/* Big arrays of records and signed keys through the generic merge */
+static void check_large(size_t count)
+{
+	Record *records;
+	Sint32 *ints = (Sint32 *)work;
+	size_t i;
+
+	records = (Record *)malloc(count * sizeof(*records));
+	if ( !records ) {
+		fprintf(stderr, "Out of memory\n");
+		quit(1);
+	}
+	for ( i = 0; i < count; ++i ) {
+		records[i].key = input[i];
+		records[i].index = (Uint32)i;
+	}
+	SDL_qsort_parallel(records, count, sizeof(*records), compare_record);
+	for ( i = 1; i < count; ++i ) {
+		if ( records[i-1].key > records[i].key ) {
+			fprintf(stderr, "Sorting records failed\n");
+			free(records);
+			quit(1);
+		}
+	}
+	free(records);
+
+	SDL_memcpy(ints, input, count * sizeof(*ints));
+	SDL_qsort_s32(ints, count);
+	for ( i = 1; i < count; ++i ) {
+		if ( compare_s32(&ints[i-1], &ints[i]) > 0 ) {
+			fprintf(stderr, "Sorting signed keys failed\n");
+			quit(1);
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const char *kinds[] = {
+		"sorted", "reverse", "random", "duplicates", "organ pipe"
+	};
+	size_t count = DEFAULT_COUNT;
+	int i;
+
+	if ( argc > 1 ) {
+		count = (size_t)atoi(argv[1]);
+	}
+	if ( count < 1 ) {
+		fprintf(stderr, "Usage: %s [count]\n", argv[0]);
+		return(1);
+	}
+
+	/* Load the SDL library */
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n",SDL_GetError());
+		return(1);
+	}
+	input = (Uint32 *)malloc(count * sizeof(*input));
+	work = (Uint32 *)malloc(count * sizeof(*work));
+	if ( !input || !work ) {
+		fprintf(stderr, "Out of memory\n");
+		quit(1);
+	}
+	printf("Sorting %u integers, %d thread pool workers\n",
+	       (unsigned)count, SDL_GetThreadPoolSize());
+
+	check_small();
+	for ( i = 0; i < SDL_arraysize(kinds); ++i ) {
+		printf("%s:\n", kinds[i]);
+		make_input(kinds[i], count);
+		run_sort("qsort", 0, count);
+#ifndef HAVE_QSORT
+		/* Otherwise SDL_qsort() is the C library qsort() above */
+		run_sort("SDL_qsort", 1, count);
+#endif
+		run_sort("SDL_qsort_parallel", 2, count);
+		run_sort("SDL_qsort_u32", 3, count);
+	}
+	check_large(count);
+	printf("All sorts passed\n");
+
+	quit(0);
+	return(0);
+}